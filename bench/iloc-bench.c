@@ -0,0 +1,268 @@
+/**
+ * @file iloc-bench.c
+ * @brief ILOC simulator benchmarks
+ *
+ * This driver builds a few loop- and call-heavy ILOC programs directly (i.e.,
+ * without going through the front end) and reports how many instructions per
+ * second the simulator executes with each available configuration.
+ */
+
+#include <time.h>
+
+#include "iloc.h"
+#include "jit.h"
+
+#ifndef SKIP_IN_DOXYGEN
+
+jmp_buf decaf_error;
+
+void Error_throw_printf (const char* format, ...)
+{
+    longjmp(decaf_error, 1);
+}
+
+/*
+ * Macros for more convenient program construction
+ */
+
+#define EMIT0OP(FORM)             InsnList_add(code, ILOCInsn_new_0op(FORM))
+#define EMIT1OP(FORM,OP1)         InsnList_add(code, ILOCInsn_new_1op(FORM,OP1))
+#define EMIT2OP(FORM,OP1,OP2)     InsnList_add(code, ILOCInsn_new_2op(FORM,OP1,OP2))
+#define EMIT3OP(FORM,OP1,OP2,OP3) InsnList_add(code, ILOCInsn_new_3op(FORM,OP1,OP2,OP3))
+#define BP                        base_register()
+#define SP                        stack_register()
+#define RET                       return_register()
+
+#endif
+
+/**
+ * @brief Number of timed runs per configuration (the fastest one is reported)
+ */
+#define BENCH_RUNS 3
+
+/**
+ * @brief Emit a standard function prologue
+ */
+void emit_prologue (InsnList* code, const char* name, int local_size)
+{
+    EMIT1OP(LABEL, call_label(name));
+    EMIT1OP(PUSH, BP);
+    EMIT2OP(I2I, SP, BP);
+    EMIT3OP(ADD_I, SP, int_const(-local_size), SP);
+}
+
+/**
+ * @brief Emit a standard function epilogue
+ */
+void emit_epilogue (InsnList* code, Operand epilogue_label)
+{
+    EMIT1OP(LABEL, epilogue_label);
+    EMIT2OP(I2I, BP, SP);
+    EMIT1OP(POP, BP);
+    EMIT0OP(RETURN);
+}
+
+/**
+ * @brief Build the code from tests/inputs/super_cool.decaf with a larger trip
+ * count:
+ *
+ *     def int main() {
+ *         int a;
+ *         a = 0;
+ *         while (a < N) { a = a + 1; }
+ *         return a;
+ *     }
+ */
+InsnList* build_counting_loop (long n)
+{
+    InsnList* code = InsnList_new();
+    Operand epilogue = anonymous_label();
+    Operand cond = anonymous_label();
+    Operand body = anonymous_label();
+    Operand done = anonymous_label();
+    Operand r[7];
+    for (int i = 0; i < 7; i++) {
+        r[i] = virtual_register();
+    }
+
+    emit_prologue(code, "main", WORD_SIZE);
+    EMIT2OP(LOAD_I, int_const(0), r[0]);
+    EMIT3OP(STORE_AI, r[0], BP, int_const(-8));
+    EMIT1OP(LABEL, cond);
+    EMIT3OP(LOAD_AI, BP, int_const(-8), r[1]);
+    EMIT2OP(LOAD_I, int_const(n), r[2]);
+    EMIT3OP(CMP_LT, r[1], r[2], r[3]);
+    EMIT3OP(CBR, r[3], body, done);
+    EMIT1OP(LABEL, body);
+    EMIT3OP(LOAD_AI, BP, int_const(-8), r[4]);
+    EMIT2OP(LOAD_I, int_const(1), r[5]);
+    EMIT3OP(ADD, r[4], r[5], r[6]);
+    EMIT3OP(STORE_AI, r[6], BP, int_const(-8));
+    EMIT1OP(JUMP, cond);
+    EMIT1OP(LABEL, done);
+    EMIT3OP(LOAD_AI, BP, int_const(-8), r[1]);
+    EMIT2OP(I2I, r[1], RET);
+    EMIT1OP(JUMP, epilogue);
+    emit_epilogue(code, epilogue);
+    return code;
+}
+
+/**
+ * @brief Build a call-heavy program: naive recursive Fibonacci, preceded by a
+ * number of (never-called) filler functions to make the program larger
+ *
+ *     def int fib(int n) {
+ *         if (n < 2) { return n; }
+ *         return fib(n-1) + fib(n-2);
+ *     }
+ *     def int main() { return fib(N); }
+ */
+InsnList* build_recursive_fib (long n, int num_filler_functions)
+{
+    InsnList* code = InsnList_new();
+    char name[MAX_ID_LEN];
+    for (int i = 0; i < num_filler_functions; i++) {
+        Operand epilogue = anonymous_label();
+        Operand r = virtual_register();
+        snprintf(name, MAX_ID_LEN, "filler%d", i);
+        emit_prologue(code, name, 0);
+        EMIT2OP(LOAD_I, int_const(i), r);
+        EMIT2OP(I2I, r, RET);
+        EMIT1OP(JUMP, epilogue);
+        emit_epilogue(code, epilogue);
+    }
+
+    Operand epilogue = anonymous_label();
+    Operand base_case = anonymous_label();
+    Operand recurse = anonymous_label();
+    Operand r[7];
+    for (int i = 0; i < 7; i++) {
+        r[i] = virtual_register();
+    }
+    emit_prologue(code, "fib", 0);
+    EMIT3OP(LOAD_AI, BP, int_const(PARAM_BP_OFFSET), r[0]);
+    EMIT2OP(LOAD_I, int_const(2), r[1]);
+    EMIT3OP(CMP_LT, r[0], r[1], r[2]);
+    EMIT3OP(CBR, r[2], base_case, recurse);
+    EMIT1OP(LABEL, base_case);
+    EMIT2OP(I2I, r[0], RET);
+    EMIT1OP(JUMP, epilogue);
+    EMIT1OP(LABEL, recurse);
+    EMIT3OP(LOAD_AI, BP, int_const(PARAM_BP_OFFSET), r[3]);
+    EMIT3OP(ADD_I, r[3], int_const(-1), r[4]);
+    EMIT1OP(PUSH, r[4]);
+    EMIT1OP(CALL, call_label("fib"));
+    EMIT3OP(ADD_I, SP, int_const(WORD_SIZE), SP);
+    EMIT1OP(PUSH, RET);
+    EMIT3OP(LOAD_AI, BP, int_const(PARAM_BP_OFFSET), r[3]);
+    EMIT3OP(ADD_I, r[3], int_const(-2), r[4]);
+    EMIT1OP(PUSH, r[4]);
+    EMIT1OP(CALL, call_label("fib"));
+    EMIT3OP(ADD_I, SP, int_const(WORD_SIZE), SP);
+    EMIT1OP(POP, r[5]);
+    EMIT3OP(ADD, r[5], RET, r[6]);
+    EMIT2OP(I2I, r[6], RET);
+    EMIT1OP(JUMP, epilogue);
+    emit_epilogue(code, epilogue);
+
+    epilogue = anonymous_label();
+    emit_prologue(code, "main", 0);
+    EMIT2OP(LOAD_I, int_const(n), r[0]);
+    EMIT1OP(PUSH, r[0]);
+    EMIT1OP(CALL, call_label("fib"));
+    EMIT3OP(ADD_I, SP, int_const(WORD_SIZE), SP);
+    EMIT1OP(JUMP, epilogue);
+    emit_epilogue(code, epilogue);
+    return code;
+}
+
+/**
+ * @brief Run a program once with the given options
+ *
+ * @returns CPU time in seconds
+ */
+double time_run (InsnList* program, SimulatorOptions* options, int* return_value)
+{
+    clock_t start = clock();
+    *return_value = run_simulator_with_options(program, options);
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/**
+ * @brief Benchmark a program with a single simulator configuration and print
+ * one line of results
+ */
+void bench_config (const char* name, const char* config, InsnList* program,
+                   SimulatorOptions* options)
+{
+    double best = -1.0;
+    int return_value = 0;
+    for (int i = 0; i < BENCH_RUNS; i++) {
+        double secs = time_run(program, options, &return_value);
+        if (best < 0.0 || secs < best) {
+            best = secs;
+        }
+    }
+    printf("%-16s %-20s %12ld %9.3f %10.1f   (returned %d)\n", name, config,
+            options->num_executed, best,
+            (best > 0.0 ? options->num_executed / best / 1e6 : 0.0), return_value);
+}
+
+/**
+ * @brief Benchmark a program with every simulator configuration
+ */
+void bench_program (const char* name, InsnList* program)
+{
+    SimulatorOptions options;
+    SimulatorOptions_init(&options);
+
+    options.fuse = false;
+    options.dispatch = SWITCH_DISPATCH;
+    bench_config(name, "switch", program, &options);
+    if (threaded_dispatch_available()) {
+        options.dispatch = THREADED_DISPATCH;
+        bench_config(name, "threaded", program, &options);
+    }
+
+    options.fuse = true;
+    options.dispatch = SWITCH_DISPATCH;
+    bench_config(name, "switch+fused", program, &options);
+    if (threaded_dispatch_available()) {
+        options.dispatch = THREADED_DISPATCH;
+        bench_config(name, "threaded+fused", program, &options);
+    }
+
+    if (jit_available()) {
+        options.jit = true;
+        bench_config(name, "jit", program, &options);
+        options.unchecked = true;
+        bench_config(name, "jit-unchecked", program, &options);
+        options.jit = false;
+        options.unchecked = false;
+    }
+
+    options.paranoid = true;
+    bench_config(name, "paranoid", program, &options);
+}
+
+/**
+ * @brief Benchmark entry point
+ */
+int main (void)
+{
+    printf("%-16s %-20s %12s %9s %10s\n", "PROGRAM", "CONFIG", "INSNS", "SECONDS", "MINSNS/S");
+
+    InsnList* loop = build_counting_loop(5000000);
+    bench_program("counting_loop", loop);
+    InsnList_free(loop);
+
+    InsnList* fib = build_recursive_fib(27, 0);
+    bench_program("fib", fib);
+    InsnList_free(fib);
+
+    InsnList* big_fib = build_recursive_fib(27, 1000);
+    bench_program("fib_1000_funcs", big_fib);
+    InsnList_free(big_fib);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file arena.h
+ * @brief Arena (bump) allocation for compiler data structures
+ *
+ * Objects that live until the end of a compilation (ILOC instructions,
+ * instruction lists, and AST attributes) are allocated with
+ * @ref arena_calloc. If an arena is current, this carves the object out of a
+ * large block and @ref arena_release does nothing; the whole arena is then
+ * released at once with @ref Arena_free. If no arena is current (e.g., in
+ * tools that build ILOC programs directly), both fall back to @c calloc and
+ * @c free.
+ *
+ * Defining @c ARENA_USE_MALLOC at compile time (e.g.,
+ * "make DEFS=-DARENA_USE_MALLOC") disables arenas entirely so that every
+ * object is allocated and released individually, which lets valgrind report
+ * leaks of individual objects.
+ */
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Default size of an arena block in bytes (larger objects get a block
+ * of their own)
+ */
+#define ARENA_BLOCK_SIZE 65536
+
+/**
+ * @brief Contiguous chunk of arena memory
+ */
+typedef struct ArenaBlock
+{
+    struct ArenaBlock* next;    /**< @brief Previously filled block (or @c NULL) */
+    size_t size;                /**< @brief Usable bytes in this block */
+    size_t used;                /**< @brief Bytes already handed out */
+} ArenaBlock;
+
+/**
+ * @brief Arena allocator (a chain of blocks that are released together)
+ */
+typedef struct Arena
+{
+    ArenaBlock* blocks;     /**< @brief Current block (followed by all earlier blocks) */
+    size_t allocated;       /**< @brief Total bytes handed out */
+    size_t reserved;        /**< @brief Total bytes in all blocks */
+} Arena;
+
+/**
+ * @brief Allocate and initialize an empty arena
+ */
+Arena* Arena_new ();
+
+/**
+ * @brief Allocate zero-initialized memory from an arena
+ *
+ * The memory is suitably aligned for any type and remains valid until the
+ * arena is released.
+ *
+ * @param arena Arena to allocate from
+ * @param size Number of bytes to allocate
+ * @returns Pointer to the new memory
+ */
+void* Arena_alloc (Arena* arena, size_t size);
+
+/**
+ * @brief Release an arena and everything allocated from it
+ *
+ * If the arena is current, no arena is current afterwards.
+ *
+ * @param arena Arena to release
+ */
+void Arena_free (Arena* arena);
+
+/**
+ * @brief Set the arena used by @ref arena_calloc (or @c NULL for none)
+ *
+ * Objects allocated while an arena is current must not be released (with
+ * @ref arena_release) after a different arena (or none) becomes current.
+ * Has no effect if @c ARENA_USE_MALLOC is defined.
+ *
+ * @param arena New current arena
+ */
+void set_current_arena (Arena* arena);
+
+/**
+ * @brief Test whether allocations currently come from an arena
+ *
+ * Containers of arena-allocated objects can skip walking their elements on
+ * deallocation if this returns true.
+ */
+bool arena_is_active ();
+
+/**
+ * @brief Allocate zero-initialized memory from the current arena (or with
+ * @c calloc if there is no current arena)
+ *
+ * @param size Number of bytes to allocate
+ * @returns Pointer to the new memory
+ */
+void* arena_calloc (size_t size);
+
+/**
+ * @brief Release memory allocated by @ref arena_calloc (does nothing if it
+ * came from an arena)
+ *
+ * @param ptr Pointer to release
+ */
+void arena_release (void* ptr);
+
+#endif
@@ -0,0 +1,53 @@
+/**
+ * @file assembler.h
+ * @brief Text ILOC assembler
+ *
+ * The assembler reads ILOC in exactly the syntax printed by
+ * @ref InsnList_print (one instruction or label per line, with an optional
+ * comment after a semicolon) and builds the corresponding @ref InsnList, so
+ * hand-written or externally generated ILOC can be run like compiled Decaf.
+ * For example:
+ *
+ *     main:
+ *       push BP
+ *       loadAI [BP-8] => r1  ; load local
+ *       cbr r1 => l0, l1
+ *     l0:
+ *       print "done\n"
+ *
+ * Whitespace between tokens is flexible, and blank lines and lines that
+ * contain only a comment are ignored. As in the printed form, a label named
+ * @c l followed by digits is a jump label and any other name is a call label
+ * (function).
+ *
+ * The scanner is hand-written and makes a single pass over the text without
+ * backtracking; instructions are allocated with @ref arena_calloc.
+ */
+#ifndef __ASSEMBLER_H
+#define __ASSEMBLER_H
+
+#include "iloc.h"
+
+/**
+ * @brief Assemble ILOC text into an instruction list
+ *
+ * @param text ILOC source text (need not be NUL-terminated)
+ * @param size Length of @p text in bytes
+ * @param error_msg Buffer (of at least @ref MAX_ERROR_LEN characters) that
+ * receives a description of the first syntax error, if any
+ * @returns Instruction list (or @c NULL if the text contains a syntax error)
+ */
+InsnList* assemble_iloc (const char* text, size_t size, char* error_msg);
+
+/**
+ * @brief Read and assemble an ILOC text file (see @ref assemble_iloc)
+ *
+ * @param filename Name of the file to read
+ * @param error_msg Buffer (of at least @ref MAX_ERROR_LEN characters) that
+ * receives a description of the error, if any
+ * @returns Instruction list (or @c NULL if the file cannot be read or contains
+ * a syntax error)
+ */
+InsnList* assemble_iloc_file (const char* filename, char* error_msg);
+
+#endif
@@ -0,0 +1,214 @@
+/**
+ * @file cfg.h
+ * @brief Control-flow graphs of ILOC functions
+ *
+ * A control-flow graph (CFG) splits one function into basic blocks: maximal
+ * straight-line runs of instructions that are only entered at the top and
+ * only left at the bottom. A new block starts at every jump label and after
+ * every @c jump, @c cbr, and @c return; calls do not end a block. Each
+ * function starts at its call label, so the first block is the entry block.
+ *
+ * Besides the predecessor and successor edges, the builder computes:
+ *
+ *   * a reverse postorder (RPO) of the blocks reachable from the entry
+ *   * the immediate dominator of every reachable block, using the algorithm
+ *     of Lengauer and Tarjan ("A Fast Algorithm for Finding Dominators in a
+ *     Flowgraph"), plus a numbering of the dominator tree so that dominance
+ *     queries take constant time
+ *   * the natural loops (one per header, merging all back edges into it),
+ *     their nesting, and the loop depth of every block
+ *
+ * All per-block data is stored in flat arrays indexed by block ID (edges in
+ * compressed form), so building a CFG takes near-linear time in the number of
+ * instructions and blocks even for large functions.
+ *
+ * A CFG refers to the instructions of its function by index but does not own
+ * them; it must be rebuilt after instructions are added, removed, or moved.
+ */
+#ifndef __CFG_H
+#define __CFG_H
+
+#include "insnvector.h"
+
+/**
+ * @brief Basic block
+ */
+typedef struct BasicBlock
+{
+    int first;          /**< @brief Index of the first instruction (in @ref ControlFlowGraph::insns) */
+    int end;            /**< @brief Index one past the last instruction */
+    int* succs;         /**< @brief Successor block IDs (into @ref ControlFlowGraph::edges) */
+    int num_succs;      /**< @brief Number of successors (at most two) */
+    int* preds;         /**< @brief Predecessor block IDs (into @ref ControlFlowGraph::edges) */
+    int num_preds;      /**< @brief Number of predecessors */
+    int rpo;            /**< @brief Position in reverse postorder (or -1 if unreachable) */
+    int idom;           /**< @brief Immediate dominator (or -1 for the entry and unreachable blocks) */
+    int dom_pre;        /**< @brief Preorder number in the dominator tree */
+    int dom_post;       /**< @brief Postorder number in the dominator tree */
+    int loop;           /**< @brief Header of the innermost loop containing the block (or -1) */
+    int loop_parent;    /**< @brief For loop headers, the header of the enclosing loop (or -1) */
+    int loop_depth;     /**< @brief Number of loops containing the block */
+} BasicBlock;
+
+/**
+ * @brief Control-flow graph of a single function
+ */
+typedef struct ControlFlowGraph
+{
+    const char* name;       /**< @brief Function name (or @c NULL for code before the first function) */
+    ILOCInsn** insns;       /**< @brief Instructions of the function (not owned; may contain @c NULL slots) */
+    int num_insns;          /**< @brief Number of instruction slots */
+    BasicBlock* blocks;     /**< @brief Blocks in code order (block 0 is the entry) */
+    int num_blocks;         /**< @brief Number of blocks */
+    int* edges;             /**< @brief Storage for all successor and predecessor arrays */
+    int* rpo;               /**< @brief IDs of the reachable blocks in reverse postorder */
+    int num_reachable;      /**< @brief Number of blocks reachable from the entry */
+    int* block_of_insn;     /**< @brief Block ID of every instruction slot */
+    int num_loops;          /**< @brief Number of natural loops (i.e., loop headers) */
+
+    /**
+     * @brief Next CFG (if stored in a list)
+     */
+    struct ControlFlowGraph* next;
+
+} ControlFlowGraph;
+
+/**
+ * @brief Test whether an instruction is a jump label definition
+ */
+bool ILOCInsn_is_jump_label (ILOCInsn* insn);
+
+/**
+ * @brief Test whether an instruction is a call label (function) definition
+ */
+bool ILOCInsn_is_call_label (ILOCInsn* insn);
+
+/**
+ * @brief Look up the last (non-deleted) instruction of a block (or @c NULL)
+ */
+ILOCInsn* BasicBlock_last_insn (ControlFlowGraph* cfg, BasicBlock* block);
+
+/**
+ * @brief Look up the ID of the jump label that starts a block (or -1)
+ */
+int BasicBlock_label (ControlFlowGraph* cfg, BasicBlock* block);
+
+/**
+ * @brief Build the CFG of a single function
+ *
+ * @param name Function name (or @c NULL)
+ * @param insns Instructions of the function (slots may be @c NULL, e.g., for
+ * instructions deleted from an @ref InsnVector)
+ * @param num_insns Number of instruction slots
+ * @returns Newly allocated CFG
+ */
+ControlFlowGraph* ControlFlowGraph_new (const char* name, ILOCInsn** insns, int num_insns);
+
+/**
+ * @brief Test whether one block dominates another (constant time)
+ *
+ * Every reachable block dominates itself; unreachable blocks neither dominate
+ * nor are dominated by any block.
+ *
+ * @param cfg CFG containing both blocks
+ * @param a ID of the potential dominator
+ * @param b ID of the potentially dominated block
+ * @returns True if and only if every path from the entry to @p b passes
+ * through @p a
+ */
+bool ControlFlowGraph_dominates (ControlFlowGraph* cfg, int a, int b);
+
+/**
+ * @brief Print a CFG in GraphViz (DOT) format
+ *
+ * Blocks are shown as boxes listing their instructions, with back edges
+ * drawn in bold and the dominator and loop depth of each block in its label.
+ *
+ * @param cfg CFG to print
+ * @param output File stream to print to
+ */
+void ControlFlowGraph_print_dot (ControlFlowGraph* cfg, FILE* output);
+
+/**
+ * @brief Deallocate a CFG (but not the instructions it refers to)
+ */
+void ControlFlowGraph_free (ControlFlowGraph* cfg);
+
+DECL_LIST_TYPE (CFG, ControlFlowGraph*)
+
+/**
+ * @brief Build the CFGs of all functions in a program
+ *
+ * Functions are delimited by call labels. Any instructions before the first
+ * call label form an unnamed function of their own.
+ *
+ * @param program Program instructions (must not change while the CFGs are
+ * in use)
+ * @returns List of CFGs in program order
+ */
+CFGList* build_cfgs (InsnVector* program);
+
+/**
+ * @brief Print the CFGs of a program in GraphViz (DOT) format, with one
+ * cluster per function
+ *
+ * @param cfgs List of CFGs to print
+ * @param output File stream to print to
+ */
+void CFGList_print_dot (CFGList* cfgs, FILE* output);
+
+/**
+ * @brief Calls between the functions of a program
+ *
+ * Calls are resolved by name; calls to functions that are not part of the
+ * program are ignored.
+ *
+ * A virtual register is shared if several functions use it, or if it is live
+ * at the entry or across a call of a recursive function (the activations of
+ * such a function write the same virtual registers).
+ */
+typedef struct CallGraph
+{
+    ControlFlowGraph** funcs;   /**< @brief CFGs of all functions (in list order) */
+    int num_funcs;              /**< @brief Number of functions */
+    int** callees;              /**< @brief Callee indices of every function (one per call site) */
+    int* num_callees;           /**< @brief Number of call sites of every function */
+    bool* shares_registers;     /**< @brief Functions that use a virtual register that another function (or activation) also uses */
+    bool* shared_regs;          /**< @brief Virtual registers used by more than one function or live across a recursive call (indexed by ID) */
+    int max_reg;                /**< @brief Largest virtual register ID in the program (or -1 if there are none) */
+} CallGraph;
+
+/**
+ * @brief Build the call graph of a program
+ *
+ * @param cfgs CFGs of all functions of the program
+ * @returns Newly allocated call graph
+ */
+CallGraph* CallGraph_new (CFGList* cfgs);
+
+/**
+ * @brief Look up a function by name
+ *
+ * @returns Function index (or -1 if there is no such function)
+ */
+int CallGraph_find (CallGraph* graph, const char* name);
+
+/**
+ * @brief Test whether a function can (directly or indirectly) call itself
+ */
+bool CallGraph_is_recursive (CallGraph* graph, int func);
+
+/**
+ * @brief Order the functions so that callees come before their callers
+ * (except within cycles of recursive functions)
+ *
+ * @returns Newly allocated array of function indices
+ */
+int* CallGraph_postorder (CallGraph* graph);
+
+/**
+ * @brief Deallocate a call graph (but not the CFGs)
+ */
+void CallGraph_free (CallGraph* graph);
+
+#endif
@@ -31,6 +31,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
+
 /**
  * @brief Maximum size (in bytes) of any Decaf source file
  */
@@ -133,6 +135,9 @@ void Error_throw_printf (const char* format, ...);
     /** @brief Add an item to the end of a list. */ \
     void NAME ## List_add (NAME ## List* list, ELEMTYPE item); \
     \
+    /** @brief Move all items from one list to the end of another in constant time (leaving the source list empty). */ \
+    void NAME ## List_splice (NAME ## List* list, NAME ## List* source); \
+    \
     /** @brief Look up the size of a list. */ \
     int NAME ## List_size (NAME ## List* list); \
     \
@@ -156,9 +161,40 @@ void Error_throw_printf (const char* format, ...);
  * @param FREEFUNC Name of the function to call to deallocate each element
  */
 #define DEF_LIST_IMPL(NAME, ELEMTYPE, FREEFUNC) \
+    DEF_LIST_IMPL_USING(NAME, ELEMTYPE, FREEFUNC, \
+            calloc(1, sizeof(NAME ## List)), free, false)
+
+/**
+ * @brief Define a list implementation for elements that are allocated with
+ * @ref arena_calloc
+ *
+ * The list structure itself is also allocated from the current arena, and
+ * deallocating a list does not visit its elements if an arena is current
+ * (they are released along with the arena).
+ *
+ * @param NAME Prefix for the list struct name (actual name will be @c NAMEList)
+ * @param ELEMTYPE Type of the elements to be stored (must be a struct pointer)
+ * @param FREEFUNC Name of the function to call to deallocate each element
+ */
+#define DEF_ARENA_LIST_IMPL(NAME, ELEMTYPE, FREEFUNC) \
+    DEF_LIST_IMPL_USING(NAME, ELEMTYPE, FREEFUNC, \
+            arena_calloc(sizeof(NAME ## List)), arena_release, arena_is_active())
+
+/**
+ * @brief Define a list implementation with custom allocation (used by
+ * @ref DEF_LIST_IMPL and @ref DEF_ARENA_LIST_IMPL)
+ *
+ * @param NAME Prefix for the list struct name (actual name will be @c NAMEList)
+ * @param ELEMTYPE Type of the elements to be stored (must be a struct pointer)
+ * @param FREEFUNC Name of the function to call to deallocate each element
+ * @param ALLOC Expression that allocates a zeroed list structure
+ * @param RELEASE Name of the function that deallocates a list structure
+ * @param SKIP_ELEMENTS Expression that is true if elements need not be freed
+ */
+#define DEF_LIST_IMPL_USING(NAME, ELEMTYPE, FREEFUNC, ALLOC, RELEASE, SKIP_ELEMENTS) \
     NAME ## List* NAME ## List_new () \
     { \
-        NAME ## List* list = (NAME ## List*)calloc(1, sizeof(NAME ## List)); \
+        NAME ## List* list = (NAME ## List*)ALLOC; \
         CHECK_MALLOC_PTR(list); \
         list->head = NULL; \
         list->tail = NULL; \
@@ -176,6 +212,22 @@ void Error_throw_printf (const char* format, ...);
         } \
         list->size++; \
     } \
+    void NAME ## List_splice (NAME ## List* list, NAME ## List* source) \
+    { \
+        if (source->head == NULL) { \
+            return; \
+        } \
+        if (list->head == NULL) { \
+            list->head = source->head; \
+        } else { \
+            list->tail->next = source->head; \
+        } \
+        list->tail = source->tail; \
+        list->size += source->size; \
+        source->head = NULL; \
+        source->tail = NULL; \
+        source->size = 0; \
+    } \
     int NAME ## List_size (NAME ## List* list) \
     { \
         return list->size; \
@@ -186,13 +238,15 @@ void Error_throw_printf (const char* format, ...);
     } \
     void NAME ## List_free (NAME ## List* list) \
     { \
-        ELEMTYPE next = list->head; \
-        while (next != NULL) { \
-            ELEMTYPE cur = next; \
-            next = cur->next; \
-            FREEFUNC(cur); \
+        if (!(SKIP_ELEMENTS)) { \
+            ELEMTYPE next = list->head; \
+            while (next != NULL) { \
+                ELEMTYPE cur = next; \
+                next = cur->next; \
+                FREEFUNC(cur); \
+            } \
         } \
-        free(list); \
+        RELEASE(list); \
     }
 
 /**
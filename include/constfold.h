@@ -0,0 +1,66 @@
+/**
+ * @file constfold.h
+ * @brief Constant folding and propagation
+ *
+ * Code generation materializes every literal with @c loadI and computes every
+ * operator with a register-register instruction, even when the operands are
+ * known. This pass tracks the registers that hold known constants within each
+ * basic block and rewrites the instructions that use them:
+ *
+ *   * operations on constants are folded into a single @c loadI
+ *   * copies (@c i2i) of constants become @c loadI, so the constant keeps
+ *     propagating
+ *   * @c add, @c sub, and @c mult with one constant operand become @c addI or
+ *     @c multI, and trivial immediates (@c addI 0, @c multI 1, @c multI 0)
+ *     become copies or constants
+ *   * @c cbr on a constant becomes a @c jump
+ *
+ * Folding follows the simulator's 64-bit wrapping arithmetic; divisions that
+ * would fail at run time (by zero or overflowing) are left alone. Calls
+ * forget all constants, since a (recursive) callee may write the same
+ * registers.
+ *
+ * Finally, @c loadI instructions whose results are no longer live (see
+ * @ref Liveness_new) are removed, except in functions that share registers
+ * with others (see @ref CallGraph), since liveness does not look past calls
+ * and returns.
+ */
+#ifndef __CONSTFOLD_H
+#define __CONSTFOLD_H
+
+#include "iloc.h"
+
+/**
+ * @brief Counts of changes made by @ref fold_constants
+ */
+typedef struct ConstantFoldingStats
+{
+    int folded;             /**< @brief Operations replaced by their constant result */
+    int propagated;         /**< @brief Copies of constants replaced by @c loadI */
+    int immediates;         /**< @brief Operations rewritten to immediate forms (or simplified) */
+    int branches;           /**< @brief Conditional branches resolved to jumps */
+    int removed;            /**< @brief Dead @c loadI instructions removed */
+} ConstantFoldingStats;
+
+/**
+ * @brief Evaluate an operation like the simulator does (with wrapping)
+ *
+ * @param form Operation (binary, immediate, @c not, or @c neg; the second
+ * operand of unary operations is ignored)
+ * @param a First operand
+ * @param b Second operand (or immediate)
+ * @param result Receives the result
+ * @returns True if and only if the result is defined (e.g., not a division
+ * by zero)
+ */
+bool fold_operation (InsnForm form, long a, long b, long* result);
+
+/**
+ * @brief Fold and propagate constants in a program
+ *
+ * @param program Program to rewrite in place
+ * @param stats Receives counts of the changes made (may be @c NULL)
+ */
+void fold_constants (InsnList* program, ConstantFoldingStats* stats);
+
+#endif
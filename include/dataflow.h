@@ -0,0 +1,241 @@
+/**
+ * @file dataflow.h
+ * @brief Iterative bit-vector dataflow analysis over ILOC control-flow graphs
+ *
+ * A dataflow problem associates four bit sets with every basic block of a
+ * CFG (see cfg.h): the local @c gen and @c kill sets, which the client fills
+ * in, and the @c in and @c out sets, which @ref DataflowProblem_solve
+ * computes. The transfer function of every block is
+ *
+ *     out = gen | (in & ~kill)        (forward problems)
+ *     in  = gen | (out & ~kill)       (backward problems)
+ *
+ * and the values flowing into a block are combined by union or intersection.
+ * The solver keeps a worklist ordered by reverse postorder (for backward
+ * problems, by postorder), so acyclic code converges in a single pass and
+ * loops take about one extra pass per nesting level.
+ *
+ * All sets of a problem are stored contiguously as arrays of 64-bit words,
+ * so the per-block operations are simple word-parallel loops.
+ *
+ * Two instances are provided:
+ *
+ *   * @ref Liveness_new (backward, union): bits are virtual registers
+ *   * @ref ReachingDefs_new (forward, union): bits are definitions, plus one
+ *     "undefined" pseudo-definition per register at the function entry so
+ *     that reads of possibly uninitialized registers can be reported at
+ *     compile time (see @ref check_uninitialized_reads)
+ */
+#ifndef __DATAFLOW_H
+#define __DATAFLOW_H
+
+#include "cfg.h"
+
+/**
+ * @brief Dataflow direction
+ */
+typedef enum DataflowDirection
+{
+    DATAFLOW_FORWARD,   /**< @brief Facts flow from predecessors to successors */
+    DATAFLOW_BACKWARD   /**< @brief Facts flow from successors to predecessors */
+} DataflowDirection;
+
+/**
+ * @brief Operation that combines the facts flowing into a block
+ */
+typedef enum DataflowMeet
+{
+    DATAFLOW_UNION,         /**< @brief A fact holds if it holds along any path ("may") */
+    DATAFLOW_INTERSECTION   /**< @brief A fact holds if it holds along every path ("must") */
+} DataflowMeet;
+
+/**
+ * @brief Bit-vector dataflow problem and its solution
+ */
+typedef struct DataflowProblem
+{
+    ControlFlowGraph* cfg;          /**< @brief CFG the problem is defined on (not owned) */
+    DataflowDirection direction;    /**< @brief Direction of flow */
+    DataflowMeet meet;              /**< @brief Meet operation */
+    int num_bits;                   /**< @brief Number of facts */
+    int words;                      /**< @brief Number of 64-bit words per set */
+    uint64_t* gen;                  /**< @brief Facts generated by each block (filled by the client) */
+    uint64_t* kill;                 /**< @brief Facts killed by each block (filled by the client) */
+    uint64_t* in;                   /**< @brief Facts at the start of each block */
+    uint64_t* out;                  /**< @brief Facts at the end of each block */
+    uint64_t* boundary;             /**< @brief Facts flowing into the entry (forward) or out of exits (backward) */
+    int iterations;                 /**< @brief Number of block visits made by the solver */
+} DataflowProblem;
+
+/**
+ * @brief Allocate a problem with empty @c gen, @c kill, and boundary sets
+ *
+ * @param cfg CFG to analyze
+ * @param num_bits Number of facts
+ * @param direction Direction of flow
+ * @param meet Meet operation
+ * @returns Newly allocated problem
+ */
+DataflowProblem* DataflowProblem_new (ControlFlowGraph* cfg, int num_bits,
+        DataflowDirection direction, DataflowMeet meet);
+
+/**
+ * @brief Look up one of a block's sets (e.g., <tt>DataflowProblem_set(p, p->in, b)</tt>)
+ */
+uint64_t* DataflowProblem_set (DataflowProblem* problem, uint64_t* sets, int block);
+
+/**
+ * @brief Compute the @c in and @c out sets of every block (maximal fixed point)
+ */
+void DataflowProblem_solve (DataflowProblem* problem);
+
+/**
+ * @brief Deallocate a problem
+ */
+void DataflowProblem_free (DataflowProblem* problem);
+
+/**
+ * @brief Add a fact to a set
+ */
+void bitset_add (uint64_t* set, int bit);
+
+/**
+ * @brief Remove a fact from a set
+ */
+void bitset_remove (uint64_t* set, int bit);
+
+/**
+ * @brief Test whether a set contains a fact
+ */
+bool bitset_contains (uint64_t* set, int bit);
+
+/**
+ * @brief Dense numbering of the virtual registers used in a function
+ *
+ * Register IDs are handed out program-wide, so the registers of a single
+ * function occupy a narrow range of IDs; the lookup table covers only that
+ * range.
+ */
+typedef struct RegisterIndex
+{
+    int min_id;         /**< @brief Smallest register ID used in the function */
+    int max_id;         /**< @brief Largest register ID used in the function */
+    int* index;         /**< @brief Dense index of every ID in [min_id, max_id] (or -1) */
+    int* regs;          /**< @brief Register ID of every dense index */
+    int num_regs;       /**< @brief Number of distinct registers */
+} RegisterIndex;
+
+/**
+ * @brief Number the virtual registers read or written in a function (in
+ * order of first appearance)
+ */
+RegisterIndex* RegisterIndex_new (ControlFlowGraph* cfg);
+
+/**
+ * @brief Look up the dense index of a register operand
+ *
+ * @returns Dense index (or -1 if the operand is not a virtual register of the
+ * function)
+ */
+int RegisterIndex_lookup (RegisterIndex* regs, Operand* op);
+
+/**
+ * @brief Deallocate a register numbering
+ */
+void RegisterIndex_free (RegisterIndex* regs);
+
+/**
+ * @brief Compute live virtual registers (bits are dense register indices)
+ *
+ * @param cfg CFG to analyze
+ * @param regs Register numbering of the function
+ * @returns Solved problem; @c in and @c out hold the registers live at the
+ * start and end of each block
+ */
+DataflowProblem* Liveness_new (ControlFlowGraph* cfg, RegisterIndex* regs);
+
+/**
+ * @brief Test whether a function may read a register before writing it
+ * (e.g., a value left over from a previous invocation)
+ */
+bool ControlFlowGraph_reads_undefined (ControlFlowGraph* cfg);
+
+/**
+ * @brief Test whether an instruction only computes its result (so that it
+ * can be removed if the result is dead)
+ *
+ * Loads are included only if they are relative to BP (and thus cannot fail).
+ */
+bool ILOCInsn_is_pure (ILOCInsn* insn);
+
+/**
+ * @brief Delete instructions whose results are never read
+ *
+ * An instruction is deleted if the predicate accepts it and it writes a
+ * virtual register that is dead afterwards. Liveness is recomputed until no
+ * more instructions can be deleted, so chains of dead computations are
+ * removed completely.
+ *
+ * @param code Instructions of the program (the CFG's instructions must be
+ * slots of this vector)
+ * @param cfg CFG of the function to clean up
+ * @param is_removable Predicate for instructions without side effects
+ * @returns Number of deleted instructions
+ */
+int remove_dead_code (InsnVector* code, ControlFlowGraph* cfg, bool (*is_removable)(ILOCInsn* insn));
+
+/**
+ * @brief Reaching definitions of a function
+ *
+ * Definitions are numbered so that all definitions of a register are
+ * adjacent; bit @c num_defs+r is the pseudo-definition "register @c r is
+ * uninitialized", which is generated at the entry.
+ */
+typedef struct ReachingDefs
+{
+    DataflowProblem* problem;   /**< @brief Solved problem */
+    RegisterIndex* regs;        /**< @brief Register numbering (not owned) */
+    int num_defs;               /**< @brief Number of real definitions */
+    int* def_insn;              /**< @brief Instruction index of every definition */
+    int* def_of_insn;           /**< @brief Definition number of every instruction (or -1) */
+    int* first_def;             /**< @brief First definition of every register (with an end sentinel) */
+} ReachingDefs;
+
+/**
+ * @brief Compute reaching definitions
+ *
+ * @param cfg CFG to analyze
+ * @param regs Register numbering of the function
+ * @returns Newly allocated reaching definitions
+ */
+ReachingDefs* ReachingDefs_new (ControlFlowGraph* cfg, RegisterIndex* regs);
+
+/**
+ * @brief Apply the effect of one instruction to a set of reaching
+ * definitions
+ *
+ * @param defs Reaching definitions of the function
+ * @param set Set to update (e.g., a copy of a block's @c in set)
+ * @param index Instruction index
+ */
+void ReachingDefs_step (ReachingDefs* defs, uint64_t* set, int index);
+
+/**
+ * @brief Deallocate reaching definitions
+ */
+void ReachingDefs_free (ReachingDefs* defs);
+
+/**
+ * @brief Report reads of possibly uninitialized virtual registers
+ *
+ * A read is reported if some path from the function entry reaches it
+ * without writing the register. Each report has the same form as the
+ * simulator's run-time warning, followed by the function and instruction.
+ *
+ * @param program Program to check
+ * @param output File stream to print warnings to
+ * @returns Number of warnings printed
+ */
+int check_uninitialized_reads (InsnVector* program, FILE* output);
+
+#endif
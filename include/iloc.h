@@ -21,19 +21,22 @@
 #define WORD_SIZE 8
 
 /**
- * @brief Machine memory size (64K)
+ * @brief Default machine memory size (64K; see @c SimulatorOptions::mem_size)
  */
 #define MEM_SIZE  65536
 
 /**
- * @brief Maximum number of virtual registers
+ * @brief Largest supported machine memory size (1G)
  */
-#define MAX_VIRTUAL_REGS 2048
+#define MAX_MEM_SIZE (1 << 30)
 
 /**
- * @brief Maximum number of instructions
+ * @brief Maximum number of virtual registers
+ *
+ * This is only a sanity limit on register IDs; the simulator's register file
+ * is sized to the highest register ID that the program actually uses.
  */
-#define MAX_INSTRUCTIONS 2048
+#define MAX_VIRTUAL_REGS (1 << 20)
 
 /**
  * @brief Base pointer offset for parameters
@@ -70,6 +73,10 @@ typedef enum OperandType
 
 /**
  * @brief ILOC operand structure
+ *
+ * Operands are small enough to pass by value: text (call labels and string
+ * constants) is stored in the string intern table (see @ref intern_string)
+ * and only referenced here.
  */
 typedef struct Operand
 {
@@ -81,11 +88,22 @@ typedef struct Operand
     union {
         int id;                     /**< @brief Virtual/physical register or jump label ID */
         long imm;                   /**< @brief Integer constant/literal */
-        char str[MAX_LINE_LEN];     /**< @brief String constant/literal */
+        const char* str;            /**< @brief Call label or string constant/literal (interned) */
     };
 
 } Operand;
 
+/**
+ * @brief Look up (or add) a string in the program-wide string intern table
+ *
+ * Equal strings are always interned as the same pointer, so interned strings
+ * can be compared by address. Interned strings are never deallocated.
+ *
+ * @param string String to intern
+ * @returns Canonical copy of @p string
+ */
+const char* intern_string (const char* string);
+
 /**
  * @brief Create a empty operand
  */
@@ -197,6 +215,29 @@ typedef enum InsnForm
 
 } InsnForm;
 
+/**
+ * @brief Role of an operand slot in an instruction form
+ *
+ * Roles are fixed per form and operand position (see
+ * @ref InsnForm_operand_role), so analyses can classify operands without
+ * examining individual instructions. Implicit effects (e.g., @c push and
+ * @c pop updating SP, or @c call writing RET) are not included.
+ */
+typedef enum OperandRole
+{
+    OPERAND_UNUSED,     /**< @brief Slot is not used by the form */
+    OPERAND_USE,        /**< @brief Value that is read (a register unless the form also accepts constants) */
+    OPERAND_DEF,        /**< @brief Register that is written */
+    OPERAND_CONST,      /**< @brief Integer constant */
+    OPERAND_TARGET,     /**< @brief Jump or call target */
+    OPERAND_LABEL       /**< @brief Label defined by a @c LABEL pseudo-instruction */
+} OperandRole;
+
+/**
+ * @brief Maximum number of registers read by a single instruction
+ */
+#define MAX_INSN_USES 3
+
 /**
  * @brief ILOC instruction
  * 
@@ -207,13 +248,19 @@ typedef enum InsnForm
  *   * @ref ILOCInsn_new_0op
  * 
  * There is also a copy constructor (@ref ILOCInsn_copy). Instructions should
- * be deallocated using @ref ILOCInsn_free.
+ * be deallocated using @ref ILOCInsn_free. Instructions and instruction lists
+ * are allocated from the current arena if there is one (see arena.h).
  * 
  * Members:
  *   * @ref ILOCInsn_set_comment
  *   * @ref ILOCInsn_copy
  *   * @ref ILOCInsn_print
  *   * @ref ILOCInsn_get_operand_count
+ *   * @ref ILOCInsn_get_uses
+ *   * @ref ILOCInsn_get_def
+ *   * @ref ILOCInsn_is_frame_setup
+ *   * @ref ILOCInsn_is_frame_teardown
+ *   * @ref ILOCInsn_is_stack_adjust
  *   * @ref ILOCInsn_get_read_registers
  *   * @ref ILOCInsn_get_write_register
 
@@ -234,11 +281,12 @@ typedef struct ILOCInsn
     Operand op[3];
 
     /**
-     * @brief Comment associated with this instruction
+     * @brief Comment associated with this instruction (interned; see
+     * @ref intern_string)
      * 
-     * An empty string (only a null terminator) indicates there is no comment.
+     * @c NULL indicates there is no comment.
      */
-    char comment[MAX_LINE_LEN];
+    const char* comment;
 
     /**
      * @brief Next instruction (if stored in a list)
@@ -309,6 +357,14 @@ ILOCInsn* ILOCInsn_copy (ILOCInsn* insn);
  */
 void ILOCInsn_print (ILOCInsn* insn, FILE* output);
 
+/**
+ * @brief Get the ILOC mnemonic of an instruction form
+ *
+ * @param form Instruction form (or @ref HALT)
+ * @returns Mnemonic as used by @ref ILOCInsn_print (e.g., "loadAI" or "cmp_LT")
+ */
+const char* InsnForm_to_string (InsnForm form);
+
 /**
  * @brief Count the number of operands in an instruction
  * 
@@ -317,12 +373,70 @@ void ILOCInsn_print (ILOCInsn* insn, FILE* output);
  */
 int ILOCInsn_get_operand_count (ILOCInsn* insn);
 
+/**
+ * @brief Look up the role of an operand slot (constant time)
+ *
+ * @param form Instruction form (superinstruction forms have no operands)
+ * @param index Operand index (0-2)
+ * @returns Role of the operand in every instruction of the given form
+ */
+OperandRole InsnForm_operand_role (InsnForm form, int index);
+
+/**
+ * @brief Find the registers that are read by an instruction (without
+ * allocating)
+ *
+ * The results point into the instruction, so they can also be used to
+ * rewrite the registers in place (e.g., during register allocation).
+ *
+ * @param insn Instruction to examine
+ * @param uses Array of at least @ref MAX_INSN_USES entries that receives
+ * pointers to the register operands that are read (in operand order)
+ * @returns Number of registers read
+ */
+int ILOCInsn_get_uses (ILOCInsn* insn, Operand** uses);
+
+/**
+ * @brief Find the register that is written by an instruction (without
+ * allocating)
+ *
+ * @param insn Instruction to examine
+ * @returns Pointer to the register operand that is written (or @c NULL if
+ * there is none)
+ */
+Operand* ILOCInsn_get_def (ILOCInsn* insn);
+
+/**
+ * @brief Test whether an instruction sets up the frame pointer in a prologue
+ * (<tt>i2i SP => BP</tt>)
+ *
+ * @param insn Instruction to examine (may be @c NULL)
+ */
+bool ILOCInsn_is_frame_setup (ILOCInsn* insn);
+
+/**
+ * @brief Test whether an instruction releases the frame in an epilogue
+ * (<tt>i2i BP => SP</tt>)
+ *
+ * @param insn Instruction to examine (may be @c NULL)
+ */
+bool ILOCInsn_is_frame_teardown (ILOCInsn* insn);
+
+/**
+ * @brief Test whether an instruction adjusts the stack pointer by a constant
+ * (<tt>addI SP, c => SP</tt>, e.g., to allocate locals)
+ *
+ * @param insn Instruction to examine (may be @c NULL)
+ */
+bool ILOCInsn_is_stack_adjust (ILOCInsn* insn);
+
 /**
  * @brief Get a list of registers that are read from by this instruction
  * 
  * This function returns the registers inside of a new "fake" instruction
  * because C doesn't allow us to return an array of operands -- don't
- * forget to deallocate that instruction when you're done with it.
+ * forget to deallocate that instruction when you're done with it. Analyses
+ * should use @ref ILOCInsn_get_uses instead, which does not allocate.
  * 
  * @param insn Instruction to examine
  * @returns Fake @c NOP instruction with the relevant registers as operands
@@ -354,6 +468,17 @@ DECL_LIST_TYPE (Insn, ILOCInsn*)
  */
 void InsnList_print (InsnList* list, FILE* output);
 
+/**
+ * @brief Check the operand shapes of every instruction in a list
+ *
+ * The assembler accepts any operand in any position; this check rejects
+ * malformed instructions before the optimization passes see them. Prints an
+ * error message and exits if an instruction is invalid.
+ *
+ * @param list List of instructions to check
+ */
+void InsnList_verify (InsnList* list);
+
 /**
  * @brief Create a new AST visitor that allocates addresses for all variable symbols
  *
@@ -385,6 +510,19 @@ void insnlist_attr_print (InsnList* list, FILE* output);
  */
 void ASTNode_copy_code (ASTNode* dest, ASTNode* src);
 
+/**
+ * @brief Move code attribute from one AST node to the end of another
+ *
+ * Unlike @ref ASTNode_copy_code, this takes constant time and does not copy
+ * any instructions; the source node's code attribute is left empty. Code
+ * generation uses this so that the total work is linear in the size of the
+ * generated code regardless of the depth of the AST.
+ *
+ * @param dest Pointer to destination AST node
+ * @param src Pointer to source AST node
+ */
+void ASTNode_move_code (ASTNode* dest, ASTNode* src);
+
 /**
  * @brief Add/append an instruction to the code attribute (instruction list) for an AST node
  * 
@@ -421,6 +559,582 @@ void ASTNode_set_temp_reg (ASTNode* node, Operand reg);
  */
 Operand ASTNode_get_temp_reg (ASTNode* node);
 
+#ifndef SKIP_IN_DOXYGEN
+#if WORD_SIZE == 4
+    typedef int32_t word_t;
+    #define PRIW "%" PRId32
+#else
+    typedef int64_t word_t;
+    #define PRIW "%" PRId64
+#endif
+typedef uint8_t byte_t;
+#endif
+
+/**
+ * @brief Initial value of every simulated register (helps find code gen bugs)
+ */
+#define UNINIT_REG       (-9999999)
+
+/**
+ * @brief Register file index of the stack pointer
+ *
+ * The simulated register file holds the special registers first, followed by
+ * the virtual registers, so every register operand decodes to a plain array
+ * index and the file only needs to be as large as the program requires.
+ */
+#define REG_SP           0
+
+/**
+ * @brief Register file index of the base pointer
+ */
+#define REG_BP           1
+
+/**
+ * @brief Register file index of the return value register
+ */
+#define REG_RET          2
+
+/**
+ * @brief Register file index of virtual register r0 (virtual register rN is
+ * at index @c FIRST_VIRTUAL_REG + N)
+ */
+#define FIRST_VIRTUAL_REG 3
+
+/**
+ * @brief Decoder-only form that marks the end of the program (there is no
+ * corresponding ILOC instruction)
+ */
+#define HALT             ((InsnForm)(PHI + 1))
+
+/**
+ * @brief Number of forms that can appear in a decoded program
+ */
+#define NUM_DECODED_FORMS (PHI + 2)
+
+/**
+ * @brief Superinstruction table: pairs of forms that the simulator executes as
+ * a single handler (see @ref DecodedProgram_fuse)
+ *
+ * Each entry lists the forms in execution order and how the fused handler ends
+ * (@c NEXT for straight-line code or @c TRANSFER if the last instruction is a
+ * branch). Use the fusion profile (@ref FusionProfile) to find good candidates.
+ */
+#define FUSED_PAIRS(X) \
+    X(LOAD_I,   ADD,      NEXT)     \
+    X(LOAD_I,   SUB,      NEXT)     \
+    X(LOAD_I,   MULT,     NEXT)     \
+    X(LOAD_I,   CMP_LT,   NEXT)     \
+    X(LOAD_I,   CMP_LE,   NEXT)     \
+    X(LOAD_I,   CMP_EQ,   NEXT)     \
+    X(LOAD_I,   CMP_NE,   NEXT)     \
+    X(LOAD_I,   CMP_GE,   NEXT)     \
+    X(LOAD_I,   CMP_GT,   NEXT)     \
+    X(LOAD_I,   STORE_AI, NEXT)     \
+    X(LOAD_AI,  LOAD_I,   NEXT)     \
+    X(LOAD_AI,  LOAD_AI,  NEXT)     \
+    X(LOAD_AI,  ADD,      NEXT)     \
+    X(LOAD_AI,  SUB,      NEXT)     \
+    X(LOAD_AI,  ADD_I,    NEXT)     \
+    X(LOAD_AI,  PUSH,     NEXT)     \
+    X(ADD_I,    PUSH,     NEXT)     \
+    X(ADD,      STORE_AI, NEXT)     \
+    X(I2I,      PUSH,     NEXT)     \
+    X(CMP_LT,   CBR,      TRANSFER) \
+    X(CMP_LE,   CBR,      TRANSFER) \
+    X(CMP_EQ,   CBR,      TRANSFER) \
+    X(CMP_NE,   CBR,      TRANSFER) \
+    X(CMP_GE,   CBR,      TRANSFER) \
+    X(CMP_GT,   CBR,      TRANSFER) \
+    X(STORE_AI, JUMP,     TRANSFER) \
+    X(I2I,      JUMP,     TRANSFER)
+
+/**
+ * @brief Superinstruction table: triples of forms (matched before pairs)
+ */
+#define FUSED_TRIPLES(X) \
+    X(LOAD_AI, LOAD_I, ADD,    NEXT)     \
+    X(LOAD_AI, LOAD_I, SUB,    NEXT)     \
+    X(LOAD_I,  CMP_LT, CBR,    TRANSFER) \
+    X(LOAD_I,  CMP_LE, CBR,    TRANSFER) \
+    X(LOAD_I,  CMP_EQ, CBR,    TRANSFER) \
+    X(LOAD_I,  CMP_NE, CBR,    TRANSFER) \
+    X(LOAD_I,  CMP_GE, CBR,    TRANSFER) \
+    X(LOAD_I,  CMP_GT, CBR,    TRANSFER)
+
+#ifndef SKIP_IN_DOXYGEN
+#define FUSED_PAIR_FORM(A,B,END)     FUSED_##A##_##B,
+#define FUSED_TRIPLE_FORM(A,B,C,END) FUSED_##A##_##B##_##C,
+#endif
+
+/**
+ * @brief Decoder-only superinstruction forms (numbered after @ref HALT)
+ *
+ * For example, @c FUSED_LOAD_I_ADD executes a @c loadI followed by an @c add.
+ */
+typedef enum FusedForm
+{
+    FUSED_FORMS_START = PHI + 1,    /**< @brief Same as @ref HALT (not a fused form) */
+#ifndef SKIP_IN_DOXYGEN
+    FUSED_PAIRS(FUSED_PAIR_FORM)
+    FUSED_TRIPLES(FUSED_TRIPLE_FORM)
+#endif
+    NUM_DISPATCH_FORMS              /**< @brief Number of forms the simulator can dispatch on */
+} FusedForm;
+
+/**
+ * @brief Maximum number of instructions a simulated program may execute
+ */
+#define TIMEOUT_NUM_INSTRUCTIONS 100000000
+
+/**
+ * @brief Pre-decoded ILOC instruction
+ *
+ * Compact, fixed-size form of an @ref ILOCInsn that the simulator executes
+ * instead of walking the original instruction list. Register operands are
+ * resolved to indices into the machine register file and jump labels are
+ * resolved to instruction indices, so the interpreter never has to touch the
+ * (much larger) original instruction.
+ */
+typedef struct DecodedInsn
+{
+    /**
+     * @brief Type ("form") of instruction
+     */
+    InsnForm form;
+
+    /**
+     * @brief Resolved operands
+     *
+     * Register operands are stored as register file indices, and jump labels
+     * and call targets as the index of the first instruction after the label.
+     * Unused or non-register operands are -1.
+     */
+    int op[3];
+
+    /**
+     * @brief Immediate operand (if the instruction has one)
+     */
+    long imm;
+
+    /**
+     * @brief Text operand (string to print or function to call)
+     *
+     * Points into the original instruction, which must outlive the decoded
+     * program.
+     */
+    const char* str;
+
+} DecodedInsn;
+
+/**
+ * @brief Information about call targets (i.e., functions)
+ *
+ * This information is prefetched with a single pass over the instruction
+ * before it is simulated.
+ */
+typedef struct CallTarget
+{
+    /**
+     * @brief Function name (points into the label instruction; @c NULL for an
+     * empty table slot)
+     */
+    const char* name;
+
+    /**
+     * @brief Index of corresponding label "instruction"
+     */
+    int index;
+
+} CallTarget;
+
+/**
+ * @brief Hash table of call targets indexed by function name
+ *
+ * Uses open addressing with linear probing, so lookups take expected constant
+ * time regardless of the number of functions.
+ */
+typedef struct CallTargetTable
+{
+    /**
+     * @brief Table slots
+     */
+    CallTarget* entries;
+
+    /**
+     * @brief Number of slots (always a power of two)
+     */
+    int capacity;
+
+    /**
+     * @brief Number of occupied slots
+     */
+    int size;
+
+} CallTargetTable;
+
+/**
+ * @brief Allocate a new, empty call target table
+ *
+ * @param num_targets Expected number of call targets (the table grows as
+ * needed)
+ * @returns Pointer to new table
+ */
+CallTargetTable* CallTargetTable_new (int num_targets);
+
+/**
+ * @brief Add a call target to a table (if it is not already present)
+ *
+ * @param table Table to add to
+ * @param name Function name (must outlive the table)
+ * @param index Index of the function's label instruction
+ */
+void CallTargetTable_add (CallTargetTable* table, const char* name, int index);
+
+/**
+ * @brief Look up a call target by name
+ *
+ * @param table Table to search
+ * @param name Function name
+ * @returns Index of the function's label instruction (or -1 if not found)
+ */
+int CallTargetTable_find (CallTargetTable* table, const char* name);
+
+/**
+ * @brief Deallocate a call target table
+ *
+ * @param table Table to deallocate
+ */
+void CallTargetTable_free (CallTargetTable* table);
+
+/**
+ * @brief ILOC program lowered into a contiguous array of decoded instructions
+ *
+ * Instruction indices match the positions of the instructions in the original
+ * @c InsnList, so they can be used directly as return addresses.
+ */
+typedef struct DecodedProgram
+{
+    /**
+     * @brief Decoded instructions
+     */
+    DecodedInsn* code;
+
+    /**
+     * @brief Original instruction for each index (used for tracing and error
+     * messages only)
+     */
+    ILOCInsn** source;
+
+    /**
+     * @brief Number of instructions
+     */
+    int size;
+
+    /**
+     * @brief Number of entries in the register file (the special registers
+     * plus virtual registers up to the highest ID used by the program)
+     */
+    int num_regs;
+
+    /**
+     * @brief Call targets (function name to label instruction index)
+     */
+    CallTargetTable* call_targets;
+
+} DecodedProgram;
+
+/**
+ * @brief Decode an ILOC program for simulation
+ *
+ * @param program List of ILOC instructions (must outlive the decoded program)
+ * @returns Pointer to new decoded program
+ */
+DecodedProgram* DecodedProgram_new (InsnList* program);
+
+/**
+ * @brief Decode the operands of a program whose source instructions, register
+ * count, and call targets are already filled in (used by
+ * @ref DecodedProgram_new and by loaders of prebuilt programs)
+ *
+ * The @c code array must have room for @c size+1 instructions (the last one
+ * becomes a @c HALT sentinel).
+ *
+ * @param program Partially-initialized decoded program
+ * @param jump_targets Index of the instruction after each jump label, by label
+ * ID (or -1 for labels that do not appear in the program)
+ * @param num_labels Number of entries in @c jump_targets
+ */
+void DecodedProgram_decode (DecodedProgram* program, int* jump_targets, int num_labels);
+
+/**
+ * @brief Verify a single decoded instruction
+ *
+ * Checks operand shapes, register ranges, and the existence of jump labels and
+ * call targets. Prints an error message and exits if the instruction is
+ * invalid.
+ *
+ * @param program Decoded program
+ * @param index Index of instruction to verify
+ */
+void DecodedProgram_verify_insn (DecodedProgram* program, int index);
+
+/**
+ * @brief Verify all instructions in a decoded program (see
+ * @ref DecodedProgram_verify_insn)
+ *
+ * @param program Decoded program to verify
+ */
+void DecodedProgram_verify (DecodedProgram* program);
+
+/**
+ * @brief Deallocate a decoded program
+ *
+ * @param program Decoded program to deallocate
+ */
+void DecodedProgram_free (DecodedProgram* program);
+
+/**
+ * @brief Find the longest superinstruction that matches the code at an index
+ *
+ * @param program Decoded program
+ * @param index Index of the first instruction of the sequence
+ * @returns Fused form (or @ref HALT if no entry in the fusion table matches)
+ */
+InsnForm DecodedProgram_match_fusion (DecodedProgram* program, int index);
+
+/**
+ * @brief Replace instruction sequences with superinstructions
+ *
+ * Every instruction that starts a sequence in the fusion table
+ * (@ref FUSED_PAIRS and @ref FUSED_TRIPLES) gets the corresponding fused form;
+ * its handler executes the whole sequence without intermediate dispatch. The
+ * following instructions are left untouched (they may still be jump targets),
+ * so fusion never changes behavior. The original forms remain available
+ * through @c program->source. Fused programs can only be run by the
+ * interpreter (not traced, verified, or compiled).
+ *
+ * @param program Decoded program to rewrite
+ * @returns Number of instructions that were fused
+ */
+int DecodedProgram_fuse (DecodedProgram* program);
+
+/**
+ * @brief Execution counts of straight-line instruction sequences, used to tune
+ * the fusion table
+ */
+typedef struct FusionProfile
+{
+    /**
+     * @brief Number of executions of each pair of consecutive forms
+     * (indexed by <tt>first * NUM_DECODED_FORMS + second</tt>)
+     */
+    long* pairs;
+
+    /**
+     * @brief Number of executions of each triple of consecutive forms
+     */
+    long* triples;
+
+    /**
+     * @brief Number of program locations where each superinstruction applies
+     */
+    int sites[NUM_DISPATCH_FORMS];
+
+    /**
+     * @brief Total number of instructions executed
+     */
+    long executed;
+
+} FusionProfile;
+
+/**
+ * @brief Allocate and initialize an empty fusion profile
+ */
+FusionProfile* FusionProfile_new ();
+
+/**
+ * @brief Print the most frequently executed sequences and whether the fusion
+ * table covers them
+ *
+ * @param profile Profile to print
+ * @param output File stream to print to
+ * @param max_entries Maximum number of sequences to print
+ */
+void FusionProfile_print (FusionProfile* profile, FILE* output, int max_entries);
+
+/**
+ * @brief Deallocate a fusion profile
+ */
+void FusionProfile_free (FusionProfile* profile);
+
+/**
+ * @brief Simulator instruction dispatch strategy
+ */
+typedef enum DispatchMode
+{
+    SWITCH_DISPATCH,    /**< @brief Portable dispatch through a central @c switch */
+    THREADED_DISPATCH   /**< @brief Direct-threaded dispatch using computed gotos (GCC/Clang only) */
+} DispatchMode;
+
+/**
+ * @brief Execution profile (see profile.h)
+ */
+typedef struct ExecutionProfile ExecutionProfile;
+
+/**
+ * @brief Binary trace ring buffer (see trace.h)
+ */
+typedef struct TraceBuffer TraceBuffer;
+
+/**
+ * @brief Simulator configuration (and statistics from the most recent run)
+ *
+ * Initialize with @ref SimulatorOptions_init before changing any settings.
+ */
+typedef struct SimulatorOptions
+{
+    /**
+     * @brief Print the machine state before executing each instruction
+     */
+    bool print_trace;
+
+    /**
+     * @brief Re-verify every instruction as it is executed
+     *
+     * By default, the whole program is verified once before it runs and the
+     * simulator then trusts it. In paranoid mode, the load-time verification
+     * is skipped and every executed instruction is checked instead (including
+     * return addresses popped from the stack).
+     */
+    bool paranoid;
+
+    /**
+     * @brief Instruction dispatch strategy
+     */
+    DispatchMode dispatch;
+
+    /**
+     * @brief Translate the program to native code instead of interpreting it
+     *
+     * Ignored (falling back to the interpreter) if tracing, paranoid mode, or
+     * either kind of profiling is enabled or if the platform is not supported (see jit.h).
+     */
+    bool jit;
+
+    /**
+     * @brief Omit runtime safety checks from native code
+     *
+     * Only affects the JIT; drops memory range, stack overflow/underflow,
+     * timeout, and uninitialized register checks. Faulty programs may crash.
+     */
+    bool unchecked;
+
+    /**
+     * @brief Execute common instruction sequences as superinstructions
+     *
+     * Ignored (no fusion) if tracing, paranoid mode, or profiling is enabled.
+     */
+    bool fuse;
+
+    /**
+     * @brief Record executed instruction sequences (or @c NULL to disable)
+     *
+     * Profiling runs the interpreter without fusion and with a per-instruction
+     * hook, so it is much slower than a normal run.
+     */
+    FusionProfile* fusion_profile;
+
+    /**
+     * @brief Execution profile to fill in (or @c NULL to disable profiling)
+     *
+     * Like the fusion profile, this disables fusion and the JIT and adds a
+     * per-instruction hook; runs without a profile are unaffected.
+     */
+    ExecutionProfile* profile;
+
+    /**
+     * @brief Binary trace buffer to record into (or @c NULL to disable)
+     *
+     * Like profiling, tracing disables fusion and the JIT and adds a
+     * per-instruction hook.
+     */
+    TraceBuffer* trace;
+
+    /**
+     * @brief Size of the simulated address space in bytes
+     *
+     * Defaults to @ref MEM_SIZE. The stack starts at the top of the address
+     * space, so larger sizes allow deeper recursion.
+     */
+    int mem_size;
+
+    /**
+     * @brief Number of instructions executed (output)
+     */
+    long num_executed;
+
+} SimulatorOptions;
+
+/**
+ * @brief Print a machine state in the format of the simulator's text trace
+ *
+ * Prints the special registers, all initialized virtual registers, the stack,
+ * and all non-zero memory words below the stack.
+ *
+ * @param reg Register file
+ * @param num_regs Number of entries in the register file
+ * @param mem Address space
+ * @param mem_size Size of the address space in bytes
+ * @param output File stream to print to
+ */
+void print_machine_state (word_t* reg, int num_regs, byte_t* mem, int mem_size, FILE* output);
+
+/**
+ * @brief Test whether the simulator was built with threaded dispatch support
+ *
+ * @returns True if and only if @c THREADED_DISPATCH is available
+ */
+bool threaded_dispatch_available ();
+
+/**
+ * @brief Initialize simulator options to their default values
+ *
+ * The default is no tracing and the fastest available dispatch strategy.
+ *
+ * @param options Options structure to initialize
+ */
+void SimulatorOptions_init (SimulatorOptions* options);
+
+/**
+ * @brief Check that an address space can hold the static area and at least
+ * one stack word (prints an error message and exits if not)
+ *
+ * @param mem_size Size of the address space in bytes
+ */
+void assert_valid_mem_size (int mem_size);
+
+/**
+ * @brief Run ILOC simulator on an ILOC program with the given options
+ *
+ * @param program List of ILOC instructions
+ * @param options Simulator options (also receives run statistics)
+ * @returns Function return value of @c main
+ */
+int run_simulator_with_options (InsnList* program, SimulatorOptions* options);
+
+/**
+ * @brief Run ILOC simulator on an already-decoded ILOC program with the given
+ * options
+ *
+ * The program may be modified (e.g., by superinstruction fusion) but is not
+ * deallocated.
+ *
+ * @param program Decoded program
+ * @param options Simulator options (also receives run statistics)
+ * @returns Function return value of @c main
+ */
+int run_decoded_program (DecodedProgram* program, SimulatorOptions* options);
+
 /**
  * @brief Run ILOC simulator on an ILOC program
  * 
@@ -0,0 +1,67 @@
+/**
+ * @file inline.h
+ * @brief Function inlining
+ *
+ * Every call pays for the @c call itself, a prologue (@c push BP,
+ * <tt>i2i SP => BP</tt>, and <tt>addI SP</tt>), an epilogue, and a
+ * @c return. This pass replaces calls to small functions by copies of their
+ * bodies:
+ *
+ *   * the prologue and epilogue are dropped, and every @c return (except a
+ *     final one) becomes a @c jump past the copy
+ *   * the callee's local variables move into the caller's stack frame, which
+ *     grows by the largest local area of any function inlined into it
+ *   * parameters (still pushed by the caller) are addressed relative to a new
+ *     register that holds SP at the call instead of BP; a load of a parameter
+ *     whose pushed register or constant is still intact becomes a copy of it
+ *   * registers and jump labels are renamed, so that every copy has its own
+ *
+ * Functions are processed in postorder of the call graph, so a callee has
+ * already absorbed its own small callees when it is inlined. A function is
+ * inlined only if it is not recursive, has at most @ref INLINE_MAX_SIZE
+ * instructions besides its prologue and epilogues, and follows the standard
+ * frame layout: BP is only used to address locals and parameters, SP is
+ * only adjusted by constants, SP is the same on every path to a given
+ * instruction, and every @c return is part of an epilogue. As for SSA form
+ * (see ssa.h), it must not share registers with other functions or read a
+ * register before writing it. Callers stop inlining once they reach
+ * @ref INLINE_MAX_CALLER_SIZE instructions.
+ *
+ * The original functions are kept (they may still be called elsewhere).
+ */
+#ifndef __INLINE_H
+#define __INLINE_H
+
+#include "iloc.h"
+
+/**
+ * @brief Largest function (in instructions, not counting its prologue and
+ * epilogues) that is inlined
+ */
+#define INLINE_MAX_SIZE 32
+
+/**
+ * @brief Largest size (in instructions) that a function may grow to through
+ * inlining
+ */
+#define INLINE_MAX_CALLER_SIZE 1024
+
+/**
+ * @brief Counts of changes made by @ref inline_functions
+ */
+typedef struct InlineStats
+{
+    int inlinable;          /**< @brief Functions that may be inlined */
+    int inlined;            /**< @brief Calls replaced by a copy of the callee */
+    int over_budget;        /**< @brief Calls not inlined because the caller grew too large */
+} InlineStats;
+
+/**
+ * @brief Inline calls to small functions
+ *
+ * @param program Program to rewrite in place
+ * @param stats Receives counts of the changes made (may be @c NULL)
+ */
+void inline_functions (InsnList* program, InlineStats* stats);
+
+#endif
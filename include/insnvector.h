@@ -0,0 +1,156 @@
+/**
+ * @file insnvector.h
+ * @brief Array-backed ILOC instruction sequences
+ *
+ * An instruction vector stores instruction pointers contiguously, so passes
+ * that need "instruction i" (e.g., to follow a branch or to record the
+ * predecessors of an instruction) can refer to instructions by integer index
+ * instead of rescanning an @ref InsnList.
+ *
+ * Indices are stable under deletion: @ref InsnVector_delete leaves an empty
+ * slot behind instead of shifting the rest of the vector, so a pass can delete
+ * any number of instructions while holding on to indices. Empty slots are
+ * squeezed out in a single linear pass by @ref InsnVector_compact (which can
+ * report where every instruction moved) or when converting back to a list.
+ * @ref InsnVector_insert shifts the later instructions and therefore changes
+ * their indices; passes that insert many instructions should instead build a
+ * new vector with @ref InsnVector_add.
+ *
+ * Instructions move between the two representations without being copied
+ * (see @ref InsnVector_from_list and @ref InsnVector_to_list), so existing
+ * list-based code such as @ref InsnList_print keeps working.
+ */
+#ifndef __INSNVECTOR_H
+#define __INSNVECTOR_H
+
+#include "iloc.h"
+
+/**
+ * @brief Initial number of slots in an instruction vector
+ */
+#define INSN_VECTOR_INITIAL_CAPACITY 16
+
+/**
+ * @brief Growable array of ILOC instructions with stable indices
+ */
+typedef struct InsnVector
+{
+    ILOCInsn** insns;   /**< @brief Instruction slots (@c NULL for deleted instructions) */
+    int size;           /**< @brief Number of slots in use (including deleted ones) */
+    int capacity;       /**< @brief Number of allocated slots */
+    int num_deleted;    /**< @brief Number of deleted (empty) slots */
+} InsnVector;
+
+/**
+ * @brief Allocate and initialize a new, empty instruction vector
+ */
+InsnVector* InsnVector_new ();
+
+/**
+ * @brief Move all instructions from a list into a new vector
+ *
+ * The instructions are not copied; the list is left empty (but must still be
+ * deallocated by the caller).
+ *
+ * @param list List of instructions to move
+ * @returns Vector containing the instructions in list order
+ */
+InsnVector* InsnVector_from_list (InsnList* list);
+
+/**
+ * @brief Move all instructions from a vector into a new list
+ *
+ * The instructions are not copied and deleted slots are dropped; the vector
+ * is left empty (but must still be deallocated by the caller).
+ *
+ * @param vector Vector of instructions to move
+ * @returns List containing the instructions in vector order
+ */
+InsnList* InsnVector_to_list (InsnVector* vector);
+
+/**
+ * @brief Add an instruction to the end of a vector (amortized constant time)
+ *
+ * @param vector Vector to add to
+ * @param insn Instruction to add (the vector takes ownership)
+ * @returns Index of the new instruction
+ */
+int InsnVector_add (InsnVector* vector, ILOCInsn* insn);
+
+/**
+ * @brief Insert an instruction before the given index
+ *
+ * All instructions at or after @c index move up by one slot.
+ *
+ * @param vector Vector to insert into
+ * @param index Index of the new instruction (between 0 and the size of the vector)
+ * @param insn Instruction to insert (the vector takes ownership)
+ */
+void InsnVector_insert (InsnVector* vector, int index, ILOCInsn* insn);
+
+/**
+ * @brief Look up the instruction at an index
+ *
+ * @param vector Vector to search
+ * @param index Index of the instruction
+ * @returns Instruction at the given index (or @c NULL if it was deleted)
+ */
+ILOCInsn* InsnVector_get (InsnVector* vector, int index);
+
+/**
+ * @brief Replace the instruction at an index
+ *
+ * @param vector Vector to modify
+ * @param index Index of the instruction to replace
+ * @param insn New instruction (the vector takes ownership)
+ * @returns Previous instruction at the given index (now owned by the caller,
+ * or @c NULL if the slot was empty)
+ */
+ILOCInsn* InsnVector_set (InsnVector* vector, int index, ILOCInsn* insn);
+
+/**
+ * @brief Delete and deallocate the instruction at an index (constant time)
+ *
+ * The slot is left empty, so the indices of all other instructions are
+ * unchanged. Deleting an empty slot has no effect.
+ *
+ * @param vector Vector to modify
+ * @param index Index of the instruction to delete
+ */
+void InsnVector_delete (InsnVector* vector, int index);
+
+/**
+ * @brief Remove all empty slots (linear time)
+ *
+ * @param vector Vector to compact
+ * @param new_index Array (with at least as many entries as the vector had
+ * slots) that receives the new index of every instruction, or -1 for deleted
+ * slots; may be @c NULL
+ */
+void InsnVector_compact (InsnVector* vector, int* new_index);
+
+/**
+ * @brief Look up the number of slots in a vector (including deleted ones)
+ */
+int InsnVector_size (InsnVector* vector);
+
+/**
+ * @brief Look up the number of (non-deleted) instructions in a vector
+ */
+int InsnVector_count (InsnVector* vector);
+
+/**
+ * @brief Print all instructions in a vector (in the format of
+ * @ref InsnList_print)
+ *
+ * @param vector Vector of instructions to print
+ * @param output File stream to print to
+ */
+void InsnVector_print (InsnVector* vector, FILE* output);
+
+/**
+ * @brief Deallocate a vector and all instructions it contains
+ */
+void InsnVector_free (InsnVector* vector);
+
+#endif
@@ -0,0 +1,37 @@
+/**
+ * @file jit.h
+ * @brief Native x86-64 execution of ILOC programs
+ *
+ * This module translates a decoded ILOC program into x86-64 machine code in an
+ * executable buffer and runs it. The generated code keeps the simulated
+ * register file and address space in ordinary memory (with the register file,
+ * memory, @c SP, and @c BP pinned in native callee-saved registers) and calls
+ * back into the runtime for @c PRINT. Output, return values, and (in checked
+ * mode) error messages are identical to those of the interpreter in iloc.c.
+ */
+#ifndef __JIT_H
+#define __JIT_H
+
+#include "iloc.h"
+
+/**
+ * @brief Test whether the JIT backend is supported on this platform
+ *
+ * @returns True if and only if @ref run_jit can generate native code
+ */
+bool jit_available ();
+
+/**
+ * @brief Compile an ILOC program to native code and run it
+ *
+ * The program must already have passed @ref DecodedProgram_verify. If
+ * @c options->unchecked is set, the generated code omits the memory range,
+ * stack, timeout, and uninitialized register checks.
+ *
+ * @param program Decoded (and verified) program
+ * @param options Simulator options (also receives run statistics)
+ * @returns Function return value of @c main
+ */
+int run_jit (DecodedProgram* program, SimulatorOptions* options);
+
+#endif
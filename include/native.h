@@ -0,0 +1,53 @@
+/**
+ * @file native.h
+ * @brief Native x86-64 assembly back end for ILOC programs
+ *
+ * This module lowers an ILOC program to GNU assembler text for x86-64 (System
+ * V ABI) and can assemble and link it into a stand-alone executable using the
+ * system toolchain. The most frequently used virtual registers are mapped to
+ * native registers and the rest live in statically-allocated spill slots; the
+ * simulated address space is a static array. A small runtime (emitted along
+ * with the program) implements @c PRINT on top of @c printf.
+ *
+ * The resulting executable prints the same output as the simulator (including
+ * the final "RETURN VALUE" line) but performs none of the simulator's runtime
+ * safety checks (memory range, stack overflow, timeout, or uninitialized
+ * register warnings).
+ */
+#ifndef __NATIVE_H
+#define __NATIVE_H
+
+#include "iloc.h"
+
+/**
+ * @brief Number of native registers available for virtual registers
+ */
+#define NUM_NATIVE_REGS 9
+
+/**
+ * @brief Write an ILOC program as x86-64 GNU assembler text
+ *
+ * The program is verified first (see @ref DecodedProgram_verify).
+ *
+ * @param program List of ILOC instructions
+ * @param mem_size Size of the simulated address space in bytes (see
+ * @c SimulatorOptions::mem_size)
+ * @param output File stream for the generated assembly
+ */
+void InsnList_print_native (InsnList* program, int mem_size, FILE* output);
+
+/**
+ * @brief Compile an ILOC program to a native executable
+ *
+ * The assembly is written to a file with the same name as the executable plus
+ * a ".s" suffix and then assembled and linked with the system C compiler
+ * driver (@c cc).
+ *
+ * @param program List of ILOC instructions
+ * @param mem_size Size of the simulated address space in bytes
+ * @param filename Name of the executable to create
+ * @returns True if and only if the executable was created successfully
+ */
+bool build_native_executable (InsnList* program, int mem_size, const char* filename);
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * @file objfile.h
+ * @brief Binary ILOC object files
+ *
+ * An object file holds a compiled ILOC program in a form that can be run
+ * without lexing, parsing, analyzing, or generating code again. The file
+ * consists of four sections, each starting at an 8-byte aligned offset given
+ * in the header:
+ *
+ *   1. a fixed-size header (@ref ObjectFileHeader) with a magic string, a
+ *      format version, and the sizes and offsets of the other sections
+ *   2. one fixed-size record (@ref ObjectInsn) per instruction
+ *   3. a label index (the index of the instruction defining each jump label,
+ *      by label ID) and a function index (@ref ObjectFunction)
+ *   4. a string table of NUL-terminated strings (call labels, string
+ *      constants, and comments), each stored once
+ *
+ * All values are stored in host byte order, so object files are only
+ * portable between machines of the same architecture. Because the indices
+ * are precomputed, loading maps the file into memory and decodes the records
+ * in a single pass, with strings used in place in the mapped string table.
+ */
+#ifndef __OBJFILE_H
+#define __OBJFILE_H
+
+#include "iloc.h"
+
+/**
+ * @brief Object file format version (incremented on incompatible changes)
+ */
+#define OBJECT_FORMAT_VERSION 1
+
+/**
+ * @brief Object file header
+ */
+typedef struct ObjectFileHeader
+{
+    char magic[8];              /**< @brief Always "ILOCOBJ" */
+    int32_t version;            /**< @brief @ref OBJECT_FORMAT_VERSION */
+    int32_t num_insns;          /**< @brief Number of instruction records */
+    int32_t num_regs;           /**< @brief Number of entries in the register file */
+    int32_t num_labels;         /**< @brief Number of entries in the label index */
+    int32_t num_functions;      /**< @brief Number of entries in the function index */
+    int32_t strings_size;       /**< @brief Size of the string table in bytes */
+    int64_t insns_offset;       /**< @brief File offset of the instruction records */
+    int64_t labels_offset;      /**< @brief File offset of the label index */
+    int64_t functions_offset;   /**< @brief File offset of the function index */
+    int64_t strings_offset;     /**< @brief File offset of the string table */
+} ObjectFileHeader;
+
+/**
+ * @brief Instruction record
+ *
+ * Register and jump label operands store their IDs, integer constants their
+ * values, and call labels and string constants the offset of their text in
+ * the string table.
+ */
+typedef struct ObjectInsn
+{
+    int32_t form;           /**< @brief Instruction form (@ref InsnForm) */
+    int32_t comment;        /**< @brief String table offset of the comment (or -1) */
+    int32_t type[3];        /**< @brief Operand types (@ref OperandType) */
+    int32_t reserved;       /**< @brief Padding (always zero) */
+    int64_t value[3];       /**< @brief Operand values */
+} ObjectInsn;
+
+/**
+ * @brief Function index entry
+ */
+typedef struct ObjectFunction
+{
+    int32_t name;           /**< @brief String table offset of the function name */
+    int32_t index;          /**< @brief Index of the function's call label instruction */
+} ObjectFunction;
+
+/**
+ * @brief Loaded object file (ready to run)
+ */
+typedef struct ObjectFile
+{
+    void* data;                 /**< @brief File contents (mapped into memory if possible) */
+    size_t data_size;           /**< @brief Size of the file contents in bytes */
+    ILOCInsn* insns;            /**< @brief Reconstructed instructions (linked as @c list) */
+    InsnList* list;             /**< @brief Reconstructed instructions as a list (e.g., for listings) */
+    DecodedProgram* program;    /**< @brief Decoded program (see @ref run_decoded_program) */
+} ObjectFile;
+
+/**
+ * @brief Write an ILOC program to an object file
+ *
+ * @param program List of ILOC instructions
+ * @param filename Name of the object file to write
+ * @returns True if and only if the file was written successfully
+ */
+bool ObjectFile_save (InsnList* program, const char* filename);
+
+/**
+ * @brief Load an object file
+ *
+ * The file is validated completely (so a corrupt file is rejected instead of
+ * crashing the simulator), but instructions are not checked beyond what
+ * @ref DecodedProgram_verify does before a run.
+ *
+ * @param filename Name of the object file to read
+ * @returns Loaded object file (or @c NULL if the file cannot be read or is not
+ * a compatible object file)
+ */
+ObjectFile* ObjectFile_load (const char* filename);
+
+/**
+ * @brief Deallocate a loaded object file (including its decoded program)
+ */
+void ObjectFile_free (ObjectFile* object);
+
+#endif
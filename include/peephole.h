@@ -0,0 +1,92 @@
+/**
+ * @file peephole.h
+ * @brief Peephole optimization
+ *
+ * Code generation and the other passes leave small, obviously wasteful
+ * instruction sequences behind: copies of a register to itself (e.g., after
+ * register allocation or SSA destruction), a @c jump to the label that
+ * immediately follows it (every @c return jumps to the epilogue), @c addI of
+ * zero (e.g., a function without locals reserving no stack space), and
+ * reloads of a value that was just stored or loaded.
+ *
+ * This pass slides a window of up to @ref PEEPHOLE_WINDOW instructions over
+ * the code and compares it to a table of rules (see @ref PEEPHOLE_RULES).
+ * Each rule lists the instruction forms it matches, a condition on their
+ * operands, and a replacement. Labels are ordinary instructions in the
+ * window, so no rule can match across a jump target; jump labels that are no
+ * longer targeted are removed, which lets more sequences match. Because one
+ * rewrite may enable another, passes are repeated until none of the rules
+ * applies.
+ *
+ * Replacement instructions keep the comment of the instruction they replace.
+ */
+#ifndef __PEEPHOLE_H
+#define __PEEPHOLE_H
+
+#include "iloc.h"
+
+/**
+ * @brief Maximum number of instructions matched by a rule
+ */
+#define PEEPHOLE_WINDOW 2
+
+/**
+ * @brief Peephole rules (identifier and name; see peephole.c for the
+ * patterns)
+ *
+ * Rules are tried in this order at every position.
+ */
+#define PEEPHOLE_RULES(X) \
+    X(SELF_COPY,     "self-copy")       \
+    X(ADD_ZERO,      "add-zero")        \
+    X(MULT_ONE,      "mult-one")        \
+    X(SAME_TARGETS,  "same-targets")    \
+    X(JUMP_TO_NEXT,  "jump-to-next")    \
+    X(UNUSED_LABEL,  "unused-label")    \
+    X(STORE_RELOAD,  "store-reload")    \
+    X(LOAD_RELOAD,   "load-reload")     \
+    X(LOAD_STORE,    "load-store")      \
+    X(COPY_BACK,     "copy-back")
+
+#ifndef SKIP_IN_DOXYGEN
+#define PEEPHOLE_RULE_ID(ID,NAME) PEEPHOLE_##ID,
+#endif
+
+/**
+ * @brief Index of a rule in the peephole table
+ */
+typedef enum PeepholeRuleID
+{
+#ifndef SKIP_IN_DOXYGEN
+    PEEPHOLE_RULES(PEEPHOLE_RULE_ID)
+#endif
+    NUM_PEEPHOLE_RULES      /**< @brief Number of rules */
+} PeepholeRuleID;
+
+/**
+ * @brief Counts of changes made by @ref optimize_peephole
+ */
+typedef struct PeepholeStats
+{
+    int applied[NUM_PEEPHOLE_RULES];    /**< @brief Number of times each rule applied */
+    int passes;                         /**< @brief Passes over the code (including the last one, which changes nothing) */
+    int removed;                        /**< @brief Instructions removed */
+} PeepholeStats;
+
+/**
+ * @brief Apply the peephole rules until none of them matches
+ *
+ * @param program Program to rewrite in place
+ * @param stats Receives counts of the changes made (may be @c NULL)
+ */
+void optimize_peephole (InsnList* program, PeepholeStats* stats);
+
+/**
+ * @brief Print how often each rule applied
+ *
+ * @param stats Counts from @ref optimize_peephole
+ * @param output File stream to print to
+ */
+void PeepholeStats_print (PeepholeStats* stats, FILE* output);
+
+#endif
@@ -0,0 +1,141 @@
+/**
+ * @file profile.h
+ * @brief Execution profiler for the ILOC simulator
+ *
+ * A profile counts executions per static instruction, per instruction form,
+ * and per function (call counts plus inclusive/exclusive instruction totals).
+ * Profiling is driven by the simulator's per-instruction hook, so runs without
+ * a profile pay nothing for it. Functions are identified by their call labels;
+ * every instruction belongs to the function whose label most recently precedes
+ * it.
+ */
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+#include "iloc.h"
+
+/**
+ * @brief Profile data for a single function
+ */
+typedef struct FunctionProfile
+{
+    char* name;         /**< @brief Function name (call label) */
+    long calls;         /**< @brief Number of times the function was called */
+    long inclusive;     /**< @brief Instructions executed in the function and its callees */
+    long exclusive;     /**< @brief Instructions executed in the function itself */
+    int active;         /**< @brief Number of activations currently on the call stack */
+} FunctionProfile;
+
+/**
+ * @brief Shadow call stack entry (used to compute inclusive totals)
+ */
+typedef struct ProfileFrame
+{
+    int function;       /**< @brief Index of the called function */
+    long entry;         /**< @brief Instruction total when the function was entered */
+} ProfileFrame;
+
+/**
+ * @brief Execution profile of a single simulator run
+ *
+ * Allocate with @ref ExecutionProfile_new and pass it to the simulator in
+ * @c SimulatorOptions::profile; the simulator fills it in.
+ */
+typedef struct ExecutionProfile
+{
+    /**
+     * @brief Number of instructions in the profiled program (zero until the
+     * simulator has started)
+     */
+    int size;
+
+    /**
+     * @brief Execution count of each static instruction
+     */
+    long* insn_counts;
+
+    /**
+     * @brief Original instruction for each index (points into the profiled
+     * @c InsnList, which must outlive any report)
+     */
+    ILOCInsn** source;
+
+    /**
+     * @brief Index of the function containing each instruction (-1 if none)
+     */
+    int* insn_function;
+
+    /**
+     * @brief Execution count of each instruction form
+     */
+    long form_counts[NUM_DECODED_FORMS];
+
+    FunctionProfile* functions;     /**< @brief Per-function data */
+    int num_functions;              /**< @brief Number of functions */
+
+    ProfileFrame* stack;            /**< @brief Shadow call stack */
+    int depth;                      /**< @brief Current call depth */
+    int stack_capacity;             /**< @brief Allocated shadow stack entries */
+
+    long executed;                  /**< @brief Total number of instructions executed */
+
+} ExecutionProfile;
+
+/**
+ * @brief Allocate and initialize an empty profile
+ */
+ExecutionProfile* ExecutionProfile_new ();
+
+/**
+ * @brief Prepare a profile for a program (called by the simulator)
+ *
+ * @param profile Profile to initialize
+ * @param program Program about to be run
+ * @param entry Index of the first instruction of @c main
+ */
+void ExecutionProfile_start (ExecutionProfile* profile, DecodedProgram* program, int entry);
+
+/**
+ * @brief Record the execution of one instruction (called by the simulator
+ * before the instruction executes)
+ *
+ * @param profile Profile to update
+ * @param program Program being run
+ * @param pc Index of the instruction
+ */
+void ExecutionProfile_record (ExecutionProfile* profile, DecodedProgram* program, int pc);
+
+/**
+ * @brief Close all functions still on the shadow call stack (called by the
+ * simulator when the program halts)
+ *
+ * @param profile Profile to update
+ */
+void ExecutionProfile_finish (ExecutionProfile* profile);
+
+/**
+ * @brief Print a hot-spot report: functions, instruction forms, and the most
+ * frequently executed instructions (all sorted by count)
+ *
+ * @param profile Profile to print
+ * @param output File stream to print to
+ * @param max_insns Maximum number of individual instructions to print
+ */
+void ExecutionProfile_print (ExecutionProfile* profile, FILE* output, int max_insns);
+
+/**
+ * @brief Print an ILOC listing (in the format of @ref InsnList_print) with
+ * execution counts in the comment column
+ *
+ * @param profile Profile of a run of @p program
+ * @param program List of ILOC instructions that was profiled
+ * @param output File stream to print to
+ */
+void ExecutionProfile_print_listing (ExecutionProfile* profile, InsnList* program, FILE* output);
+
+/**
+ * @brief Deallocate a profile
+ */
+void ExecutionProfile_free (ExecutionProfile* profile);
+
+#endif
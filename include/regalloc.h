@@ -0,0 +1,57 @@
+/**
+ * @file regalloc.h
+ * @brief Register allocation
+ *
+ * Code generation hands out a fresh virtual register for every temporary.
+ * The allocator maps the virtual registers of each function onto a fixed
+ * number of physical registers (numbered @c r0 and up) using linear scan
+ * (Poletto and Sarkar, "Linear Scan Register Allocation"):
+ *
+ *   1. Liveness is computed over the function's CFG (see dataflow.h), and
+ *      every virtual register gets a single live interval covering all
+ *      instructions where it is live.
+ *   2. Intervals are visited in order of increasing start; when no register
+ *      is free, the interval that ends last is spilled.
+ *   3. Spilled registers live in stack slots below the function's locals.
+ *      Every use is preceded by a @c loadAI from and every definition
+ *      followed by a @c storeAI to its slot (relative to BP), using scratch
+ *      registers that are reserved only in functions that spill.
+ *
+ * Calls do not preserve registers (caller and callee share the physical
+ * registers), so values that are live across a @c call are always spilled.
+ * The exception are virtual registers that several functions use to pass
+ * values through a call (see @ref CallGraph) and the registers that are live
+ * across a call in a recursive function (where the nested activation writes
+ * the same virtual registers): each of them keeps the same physical register
+ * in the whole program, taken from the top of the range and not used for
+ * anything else.
+ */
+#ifndef __REGALLOC_H
+#define __REGALLOC_H
+
+#include "iloc.h"
+
+/**
+ * @brief Smallest supported number of physical registers (enough for the
+ * scratch registers of an instruction with spilled operands plus one)
+ */
+#define MIN_PHYSICAL_REGS (MAX_INSN_USES + 1)
+
+/**
+ * @brief Allocate physical registers for all functions in a program
+ *
+ * Spilling needs a frame: the stack space for spill slots is reserved by
+ * extending the function's prologue (@c addI @c SP after @c i2i @c SP @c => @c BP,
+ * which is inserted if necessary).
+ *
+ * @param program Program to rewrite in place
+ * @param num_regs Number of physical registers (at least
+ * @ref MIN_PHYSICAL_REGS)
+ * @param error_msg Buffer (of at least @ref MAX_ERROR_LEN characters) that
+ * receives a description of the error, if any
+ * @returns True if and only if allocation succeeded (if not, the program may
+ * be partially rewritten and should not be run)
+ */
+bool allocate_registers (InsnList* program, int num_regs, char* error_msg);
+
+#endif
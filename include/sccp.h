@@ -0,0 +1,78 @@
+/**
+ * @file sccp.h
+ * @brief Global optimizations over SSA form
+ *
+ * Sparse conditional constant propagation (Wegman and Zadeck, "Constant
+ * Propagation with Conditional Branches") assigns every SSA register a value
+ * in the lattice
+ *
+ *     TOP (no value seen yet)  >  constant c  >  BOTTOM (varying)
+ *
+ * while simultaneously discovering which CFG edges can be taken. Two
+ * worklists drive the analysis: edges that just became executable, and
+ * registers whose value was just lowered (whose uses are re-evaluated via
+ * def-use chains). A @c cbr whose condition is constant makes only one
+ * successor executable, so constants also propagate through merges whose
+ * other inputs are never executed. Afterwards, instructions that compute a
+ * constant become @c loadI, resolved branches become @c jump, and blocks
+ * that can never execute are dropped.
+ *
+ * Dead code elimination then marks every instruction with side effects
+ * (stores, calls, branches, writes of non-virtual registers, ...) as live,
+ * followed by the definitions of all registers they read (transitively,
+ * through phi functions). Unmarked computations and phi functions are
+ * removed, including cycles of computations that only feed each other (which
+ * liveness-based removal cannot detect).
+ */
+#ifndef __SCCP_H
+#define __SCCP_H
+
+#include "ssa.h"
+
+/**
+ * @brief Counts of changes made by @ref optimize_ssa
+ */
+typedef struct SSAOptimizationStats
+{
+    int functions;          /**< @brief Functions converted to SSA form */
+    int promoted;           /**< @brief Stack slots promoted to registers */
+    int phis;               /**< @brief Phi functions placed */
+    int constants;          /**< @brief Computations replaced by @c loadI */
+    int branches;           /**< @brief Conditional branches resolved to jumps */
+    int unreachable;        /**< @brief Blocks removed because they never execute */
+    int removed;            /**< @brief Dead instructions and phi functions removed */
+    int copies;             /**< @brief Copies inserted by SSA destruction */
+} SSAOptimizationStats;
+
+/**
+ * @brief Propagate constants and find executable blocks and edges
+ *
+ * Updates @ref SSAFunction::executable and @ref SSAFunction::edge_executable
+ * and rewrites constant computations and branches in place.
+ */
+void propagate_constants (SSAFunction* ssa, SSAOptimizationStats* stats);
+
+/**
+ * @brief Remove computations and phi functions that do not contribute to any
+ * side effect
+ *
+ * @param ssa Function in SSA form (after @ref propagate_constants)
+ * @param code Instructions of the program (the CFG's instructions must be
+ * slots of this vector)
+ * @param stats Receives counts of the changes made
+ */
+void eliminate_dead_code (SSAFunction* ssa, InsnVector* code, SSAOptimizationStats* stats);
+
+/**
+ * @brief Convert a program to SSA form, propagate constants, remove dead
+ * code, and convert it back
+ *
+ * Functions that cannot be converted (see @ref find_ssa_functions) are left
+ * unchanged.
+ *
+ * @param program Program to rewrite in place
+ * @param stats Receives counts of the changes made (may be @c NULL)
+ */
+void optimize_ssa (InsnList* program, SSAOptimizationStats* stats);
+
+#endif
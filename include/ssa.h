@@ -0,0 +1,161 @@
+/**
+ * @file ssa.h
+ * @brief Static single assignment (SSA) form
+ *
+ * SSA construction follows Cytron et al., "Efficiently Computing Static
+ * Single Assignment Form and the Control Dependence Graph":
+ *
+ *   1. Local variables that live in the stack frame are promoted to virtual
+ *      registers if their addresses cannot escape (every access is a
+ *      @c loadAI or @c storeAI relative to BP at a fixed negative offset, BP
+ *      and SP are used only by the prologue and epilogue, and the function
+ *      makes no calls). Each access becomes a copy.
+ *   2. Dominance frontiers are computed from the dominator tree (see cfg.h).
+ *   3. Phi functions are placed at the iterated dominance frontiers of each
+ *      register's definitions, but only where the register is live (pruned
+ *      SSA; see @ref Liveness_new).
+ *   4. Registers are renamed in a preorder walk of the dominator tree, so
+ *      that every definition writes a fresh register.
+ *
+ * Phi functions are kept next to the code (see @ref Phi) rather than in it,
+ * because a block may have more than two predecessors but the @c phi
+ * instruction form has only two source operands. When printed, a phi
+ * function with more than two arguments becomes a chain of @c phi
+ * instructions that accumulate into the same destination, and one with a
+ * single argument (the others come from unreachable predecessors) repeats
+ * it.
+ *
+ * SSA destruction first coalesces the resources of each phi function into
+ * one register (see @ref SSAFunction_coalesce) and then replaces the
+ * remaining phi functions by copies at the end of each predecessor (Briggs
+ * et al., "Practical Improvements to the Construction and Destruction of
+ * Static Single Assignment Form"). The copies of one edge are sequentialized
+ * as a parallel copy (breaking cycles with a temporary register), and edges
+ * from blocks that end in a @c cbr get a new block of their own.
+ *
+ * Only functions that can be translated safely are converted. Calls do not
+ * save registers, so a function must not be recursive and must not share
+ * any register with another function (renaming would break values passed
+ * in registers), and it must not read a register before writing it (e.g., a
+ * value left over from its previous invocation). Its last reachable block
+ * must end in a branch or @c return, so that new blocks can be placed after
+ * it (unreachable blocks are dropped).
+ */
+#ifndef __SSA_H
+#define __SSA_H
+
+#include "dataflow.h"
+
+/**
+ * @brief Phi function at the start of a basic block
+ */
+typedef struct Phi
+{
+    Operand dest;           /**< @brief Register written */
+    Operand* args;          /**< @brief Register read from each predecessor (in CFG order; @c EMPTY for unreachable predecessors) */
+    int var;                /**< @brief Original register (dense index before renaming) */
+    bool live;              /**< @brief False if the phi function was removed */
+} Phi;
+
+/**
+ * @brief Function in SSA form
+ */
+typedef struct SSAFunction
+{
+    ControlFlowGraph* cfg;      /**< @brief CFG of the function (not owned; instructions are renamed in place) */
+    Phi** phis;                 /**< @brief Phi functions of every block */
+    int* num_phis;              /**< @brief Number of phi functions of every block */
+    bool* executable;           /**< @brief Blocks that may execute (initially the reachable blocks) */
+    bool* edge_executable;      /**< @brief Edges that may be taken (indexed like @ref ControlFlowGraph::edges) */
+    int first_name;             /**< @brief First register ID written in SSA form */
+    int num_names;              /**< @brief Number of register IDs written in SSA form */
+    int num_promoted;           /**< @brief Number of stack slots promoted to registers */
+} SSAFunction;
+
+/**
+ * @brief Allocate fresh register and label IDs above those used in a program
+ */
+typedef struct IDAllocator
+{
+    int next_reg;           /**< @brief Next unused virtual register ID */
+    int next_label;         /**< @brief Next unused jump label ID */
+} IDAllocator;
+
+/**
+ * @brief Find the first unused register and label IDs of a program
+ */
+IDAllocator IDAllocator_init (InsnVector* program);
+
+/**
+ * @brief Find the functions that can be converted to SSA form
+ *
+ * @param cfgs CFGs of all functions of a program
+ * @returns Newly allocated array with one flag per CFG (in list order)
+ */
+bool* find_ssa_functions (CFGList* cfgs);
+
+/**
+ * @brief Convert a function to SSA form
+ *
+ * @param cfg CFG of the function (see @ref find_ssa_functions); its
+ * instructions are rewritten in place
+ * @param ids Allocator for the new register IDs
+ * @returns Newly allocated SSA form
+ */
+SSAFunction* SSAFunction_new (ControlFlowGraph* cfg, IDAllocator* ids);
+
+/**
+ * @brief Look up the edge index (into @ref ControlFlowGraph::edges) of the
+ * edge between two blocks
+ *
+ * @returns Edge index (or -1 if there is no such edge)
+ */
+int SSAFunction_edge (SSAFunction* ssa, int from, int to);
+
+/**
+ * @brief Print a function in SSA form (with @c phi instructions)
+ */
+void SSAFunction_print (SSAFunction* ssa, FILE* output);
+
+/**
+ * @brief Let the resources of every phi function share one register
+ *
+ * Renaming registers (and propagating constants and removing dead code
+ * afterwards) produces conventional SSA form, in which the resources of a
+ * phi function (all versions of one original register) never have
+ * overlapping live ranges. Giving them a single register therefore makes the
+ * copies of @ref SSAFunction_destroy unnecessary. Passes that move code or
+ * propagate copies must not run between construction and this function.
+ *
+ * @returns Number of congruence classes merged
+ */
+int SSAFunction_coalesce (SSAFunction* ssa);
+
+/**
+ * @brief Convert a function out of SSA form
+ *
+ * Blocks that are not executable are dropped, phi functions are replaced by
+ * copies, and the resulting instructions are moved to the output (the CFG
+ * slots are cleared).
+ *
+ * @param ssa Function in SSA form
+ * @param output Vector that receives the instructions of the function
+ * @param ids Allocator for new registers and labels
+ * @returns Number of copies inserted
+ */
+int SSAFunction_destroy (SSAFunction* ssa, InsnVector* output, IDAllocator* ids);
+
+/**
+ * @brief Deallocate an SSA form (but not the CFG)
+ */
+void SSAFunction_free (SSAFunction* ssa);
+
+/**
+ * @brief Print all functions of a program in SSA form
+ *
+ * Functions that cannot be converted are printed unchanged. The program is
+ * renamed in place (and should not be run afterwards).
+ */
+void print_ssa (InsnVector* program, FILE* output);
+
+#endif
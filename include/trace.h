@@ -0,0 +1,174 @@
+/**
+ * @file trace.h
+ * @brief Binary execution traces for the ILOC simulator
+ *
+ * A trace buffer records one compact event per executed instruction into a
+ * fixed-size ring buffer, so only the most recent events are kept no matter
+ * how long the program runs. Each event holds the instruction index plus the
+ * register and memory word written by the instruction (with both the old and
+ * the new values) and the old stack pointer.
+ *
+ * When the program halts (or the simulator exits with an error), the buffer is
+ * written to a trace file together with the final machine state and a listing
+ * of the program, so the file can be decoded offline without the source code.
+ * Because every event can be undone, the decoder can reconstruct the full
+ * machine state before any recorded step by walking backwards from the final
+ * state.
+ */
+#ifndef __TRACE_H
+#define __TRACE_H
+
+#include "iloc.h"
+
+/**
+ * @brief Trace file format version (incremented on incompatible changes)
+ */
+#define TRACE_FORMAT_VERSION 2
+
+/**
+ * @brief Default number of events kept in a trace buffer
+ */
+#define DEFAULT_TRACE_SIZE 65536
+
+/**
+ * @brief Largest supported number of events in a trace buffer
+ */
+#define MAX_TRACE_SIZE (1 << 24)
+
+/**
+ * @brief Effects of a single executed instruction
+ */
+typedef struct TraceEvent
+{
+    int32_t pc;         /**< @brief Index of the instruction */
+    int32_t reg;        /**< @brief Register file index written (or -1 if none) */
+    int32_t address;    /**< @brief Memory address written (or -1 if none) */
+    int32_t sp;         /**< @brief Stack pointer before the instruction */
+    word_t old_reg;     /**< @brief Previous value of the written register */
+    word_t new_reg;     /**< @brief Value written to the register */
+    word_t old_mem;     /**< @brief Previous value of the written memory word */
+    word_t new_mem;     /**< @brief Value written to memory */
+} TraceEvent;
+
+/**
+ * @brief Ring buffer of trace events for a single simulator run
+ *
+ * Allocate with @ref TraceBuffer_new and pass it to the simulator in
+ * @c SimulatorOptions::trace; the simulator records into it and writes the
+ * trace file when the run ends.
+ */
+typedef struct TraceBuffer
+{
+    TraceEvent* events;     /**< @brief Event storage (@c capacity entries) */
+    int capacity;           /**< @brief Maximum number of events kept */
+    long count;             /**< @brief Total number of events recorded */
+    bool pending;           /**< @brief Most recent event still lacks its new values */
+    char* filename;         /**< @brief Name of the trace file to write */
+
+    DecodedProgram* program;    /**< @brief Program being traced */
+    word_t* reg;                /**< @brief Live register file of the simulator */
+    byte_t* mem;                /**< @brief Live address space of the simulator */
+    int mem_size;               /**< @brief Size of the address space in bytes */
+
+} TraceBuffer;
+
+/**
+ * @brief Allocate an empty trace buffer
+ *
+ * @param capacity Maximum number of events to keep (older events are dropped)
+ * @param filename Name of the trace file to write at the end of the run
+ */
+TraceBuffer* TraceBuffer_new (int capacity, const char* filename);
+
+/**
+ * @brief Attach a trace buffer to a machine (called by the simulator)
+ *
+ * Until @ref TraceBuffer_finish is called, the trace file is also written if
+ * the simulator exits with an error.
+ *
+ * @param trace Trace buffer
+ * @param program Program about to be run
+ * @param reg Register file of the machine
+ * @param mem Address space of the machine
+ * @param mem_size Size of the address space in bytes
+ */
+void TraceBuffer_start (TraceBuffer* trace, DecodedProgram* program, word_t* reg, byte_t* mem, int mem_size);
+
+/**
+ * @brief Record the execution of one instruction (called by the simulator
+ * before the instruction executes)
+ *
+ * @param trace Trace buffer
+ * @param program Program being run
+ * @param pc Index of the instruction
+ */
+void TraceBuffer_record (TraceBuffer* trace, DecodedProgram* program, int pc);
+
+/**
+ * @brief Complete the last event and write the trace file (called by the
+ * simulator when the program halts)
+ *
+ * @param trace Trace buffer
+ */
+void TraceBuffer_finish (TraceBuffer* trace);
+
+/**
+ * @brief Deallocate a trace buffer
+ */
+void TraceBuffer_free (TraceBuffer* trace);
+
+/**
+ * @brief Contents of a trace file
+ */
+typedef struct TraceFile
+{
+    long first_step;        /**< @brief Step number of the oldest recorded event */
+    long num_events;        /**< @brief Number of recorded events */
+    TraceEvent* events;     /**< @brief Recorded events (oldest first) */
+
+    word_t* reg;            /**< @brief Final register file */
+    int num_regs;           /**< @brief Number of entries in the register file */
+    byte_t* mem;            /**< @brief Final address space */
+    int mem_size;           /**< @brief Size of the address space in bytes */
+
+    int num_insns;          /**< @brief Number of instructions in the program */
+    char** listing;         /**< @brief Text of each instruction */
+
+} TraceFile;
+
+/**
+ * @brief Read a trace file
+ *
+ * @param filename Name of the trace file
+ * @returns Trace contents (or @c NULL if the file cannot be read or is not a
+ * compatible trace file)
+ */
+TraceFile* TraceFile_load (const char* filename);
+
+/**
+ * @brief Print the most recent steps of a trace with the values they wrote
+ *
+ * @param trace Trace to print
+ * @param max_steps Maximum number of steps to print
+ * @param output File stream to print to
+ */
+void TraceFile_print_steps (TraceFile* trace, long max_steps, FILE* output);
+
+/**
+ * @brief Print the full machine state before a step (in the format of the
+ * simulator's text trace)
+ *
+ * @param trace Trace to reconstruct the state from
+ * @param step Step number (the number of instructions executed before it)
+ * @param output File stream to print to
+ * @returns True if and only if the state could be reconstructed (i.e., the
+ * step is recorded in the trace or is the end of the run)
+ */
+bool TraceFile_print_state (TraceFile* trace, long step, FILE* output);
+
+/**
+ * @brief Deallocate trace contents
+ */
+void TraceFile_free (TraceFile* trace);
+
+#endif
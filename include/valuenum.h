@@ -0,0 +1,57 @@
+/**
+ * @file valuenum.h
+ * @brief Local value numbering
+ *
+ * Code generation reloads a variable from memory every time it is read
+ * (@c loadAI relative to BP), materializes the base address of a global
+ * variable (@c loadI) for every access, and recomputes repeated
+ * subexpressions. This pass assigns a value number to every value computed
+ * within a basic block, so that two instructions computing the same value
+ * get the same number (Cooper and Torczon, "Engineering a Compiler",
+ * section 8.4.1):
+ *
+ *   * operations are keyed by their form and the value numbers of their
+ *     operands (commutative operations and comparisons are normalized)
+ *   * constants are keyed by their value
+ *   * loads are keyed by their address (a value number plus a known offset);
+ *     a store records the stored value for its address, so reloading a value
+ *     that was just stored reuses the stored register
+ *
+ * An instruction that computes a value that is already held in a register
+ * becomes a copy from that register, and every register read is replaced by
+ * the first register that still holds the same value. The copies are then
+ * usually dead and are removed along with other dead computations (except in
+ * functions that share registers with others; see @ref CallGraph).
+ *
+ * A store forgets all loads that may overlap it: loads relative to the same
+ * base value at a different offset are kept, everything else is forgotten.
+ * A @c call forgets everything (the callee may write memory and the same
+ * virtual registers), and @c push and @c pop update SP.
+ */
+#ifndef __VALUENUM_H
+#define __VALUENUM_H
+
+#include "iloc.h"
+
+/**
+ * @brief Counts of changes made by @ref number_local_values
+ */
+typedef struct ValueNumberingStats
+{
+    int loads;              /**< @brief Loads of an address that was already loaded */
+    int forwarded;          /**< @brief Loads of an address whose value was just stored */
+    int expressions;        /**< @brief Operations that were already computed */
+    int constants;          /**< @brief Constants (e.g., base addresses) that were already loaded */
+    int propagated;         /**< @brief Register reads replaced by an earlier register */
+    int removed;            /**< @brief Dead instructions removed */
+} ValueNumberingStats;
+
+/**
+ * @brief Eliminate redundant loads and computations within basic blocks
+ *
+ * @param program Program to rewrite in place
+ * @param stats Receives counts of the changes made (may be @c NULL)
+ */
+void number_local_values (InsnList* program, ValueNumberingStats* stats);
+
+#endif
@@ -0,0 +1,95 @@
+#include "common.h"
+
+/**
+ * @brief Alignment of every arena allocation
+ */
+#define ARENA_ALIGN (_Alignof(max_align_t))
+
+/**
+ * @brief Round a size up to a multiple of @ref ARENA_ALIGN
+ */
+#define ARENA_ROUND(N) (((N) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+/**
+ * @brief Arena used by arena_calloc (or @c NULL for plain heap allocation)
+ */
+Arena* current_arena = NULL;
+
+Arena* Arena_new ()
+{
+    Arena* arena = (Arena*)calloc(1, sizeof(Arena));
+    CHECK_MALLOC_PTR(arena);
+    return arena;
+}
+
+void* Arena_alloc (Arena* arena, size_t size)
+{
+    size = ARENA_ROUND(size);
+    ArenaBlock* block = arena->blocks;
+    if (block == NULL || block->size - block->used < size) {
+
+        /* start a new block (the data follows the aligned header) */
+        size_t block_size = (size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE);
+        block = (ArenaBlock*)calloc(1, ARENA_ROUND(sizeof(ArenaBlock)) + block_size);
+        CHECK_MALLOC_PTR(block);
+        block->size = block_size;
+        block->used = 0;
+
+        /* an oversized block is filled immediately, so keep using the current one */
+        if (block_size == size && arena->blocks != NULL) {
+            block->next = arena->blocks->next;
+            arena->blocks->next = block;
+        } else {
+            block->next = arena->blocks;
+            arena->blocks = block;
+        }
+        arena->reserved += block_size;
+    }
+    void* ptr = (char*)block + ARENA_ROUND(sizeof(ArenaBlock)) + block->used;
+    block->used += size;
+    arena->allocated += size;
+    return ptr;
+}
+
+void Arena_free (Arena* arena)
+{
+    if (current_arena == arena) {
+        current_arena = NULL;
+    }
+    ArenaBlock* next = arena->blocks;
+    while (next != NULL) {
+        ArenaBlock* cur = next;
+        next = cur->next;
+        free(cur);
+    }
+    free(arena);
+}
+
+void set_current_arena (Arena* arena)
+{
+#ifndef ARENA_USE_MALLOC
+    current_arena = arena;
+#endif
+}
+
+bool arena_is_active ()
+{
+    return (current_arena != NULL);
+}
+
+void* arena_calloc (size_t size)
+{
+    if (current_arena != NULL) {
+        return Arena_alloc(current_arena, size);
+    }
+    void* ptr = calloc(1, size);
+    CHECK_MALLOC_PTR(ptr);
+    return ptr;
+}
+
+void arena_release (void* ptr)
+{
+    if (current_arena == NULL) {
+        free(ptr);
+    }
+}
@@ -0,0 +1,522 @@
+#include <limits.h>
+
+#include "assembler.h"
+
+/**
+ * @brief Scanner state
+ */
+typedef struct ILOCScanner
+{
+    const char* pos;        /**< @brief Next character to scan */
+    const char* end;        /**< @brief End of the text */
+    int line;               /**< @brief Current line number (starting at 1) */
+    char* error_msg;        /**< @brief Receives the first error message */
+    bool failed;            /**< @brief True once an error has been reported */
+    char* scratch;          /**< @brief Buffer for unescaped strings and comments */
+    size_t scratch_size;    /**< @brief Size of the scratch buffer */
+} ILOCScanner;
+
+/**
+ * @brief Instruction syntax (what follows the mnemonic)
+ */
+typedef enum ILOCSyntax
+{
+    SYNTAX_NONE,            /**< @brief No operands (e.g., @c return) */
+    SYNTAX_ONE,             /**< @brief @c op1 */
+    SYNTAX_ONE_TO_ONE,      /**< @brief @c op1 @c => @c op2 */
+    SYNTAX_TWO_TO_ONE,      /**< @brief @c op1, @c op2 @c => @c op3 */
+    SYNTAX_ONE_TO_TWO,      /**< @brief @c op1 @c => @c op2, @c op3 */
+    SYNTAX_LOAD,            /**< @brief @c [op1] @c => @c op2 */
+    SYNTAX_LOAD_OFFSET,     /**< @brief @c [op1+op2] @c => @c op3 */
+    SYNTAX_STORE,           /**< @brief @c op1 @c => @c [op2] */
+    SYNTAX_STORE_OFFSET,    /**< @brief @c op1 @c => @c [op2+op3] */
+    SYNTAX_CALL             /**< @brief Function name */
+} ILOCSyntax;
+
+/**
+ * @brief Mnemonic table entry
+ */
+typedef struct ILOCMnemonic
+{
+    const char* name;       /**< @brief Mnemonic as printed by @ref ILOCInsn_print */
+    InsnForm form;          /**< @brief Instruction form */
+    ILOCSyntax syntax;      /**< @brief Operand syntax */
+} ILOCMnemonic;
+
+const ILOCMnemonic iloc_mnemonics[] = {
+    { "add",     ADD,      SYNTAX_TWO_TO_ONE   },
+    { "sub",     SUB,      SYNTAX_TWO_TO_ONE   },
+    { "mult",    MULT,     SYNTAX_TWO_TO_ONE   },
+    { "div",     DIV,      SYNTAX_TWO_TO_ONE   },
+    { "addI",    ADD_I,    SYNTAX_TWO_TO_ONE   },
+    { "multI",   MULT_I,   SYNTAX_TWO_TO_ONE   },
+    { "and",     AND,      SYNTAX_TWO_TO_ONE   },
+    { "or",      OR,       SYNTAX_TWO_TO_ONE   },
+    { "not",     NOT,      SYNTAX_ONE_TO_ONE   },
+    { "neg",     NEG,      SYNTAX_ONE_TO_ONE   },
+    { "loadI",   LOAD_I,   SYNTAX_ONE_TO_ONE   },
+    { "load",    LOAD,     SYNTAX_LOAD         },
+    { "loadAI",  LOAD_AI,  SYNTAX_LOAD_OFFSET  },
+    { "loadAO",  LOAD_AO,  SYNTAX_LOAD_OFFSET  },
+    { "store",   STORE,    SYNTAX_STORE        },
+    { "storeAI", STORE_AI, SYNTAX_STORE_OFFSET },
+    { "storeAO", STORE_AO, SYNTAX_STORE_OFFSET },
+    { "i2i",     I2I,      SYNTAX_ONE_TO_ONE   },
+    { "push",    PUSH,     SYNTAX_ONE          },
+    { "pop",     POP,      SYNTAX_ONE          },
+    { "jump",    JUMP,     SYNTAX_ONE          },
+    { "call",    CALL,     SYNTAX_CALL         },
+    { "return",  RETURN,   SYNTAX_NONE         },
+    { "cbr",     CBR,      SYNTAX_ONE_TO_TWO   },
+    { "phi",     PHI,      SYNTAX_TWO_TO_ONE   },
+    { "cmp_LT",  CMP_LT,   SYNTAX_TWO_TO_ONE   },
+    { "cmp_LE",  CMP_LE,   SYNTAX_TWO_TO_ONE   },
+    { "cmp_EQ",  CMP_EQ,   SYNTAX_TWO_TO_ONE   },
+    { "cmp_GE",  CMP_GE,   SYNTAX_TWO_TO_ONE   },
+    { "cmp_GT",  CMP_GT,   SYNTAX_TWO_TO_ONE   },
+    { "cmp_NE",  CMP_NE,   SYNTAX_TWO_TO_ONE   },
+    { "nop",     NOP,      SYNTAX_NONE         },
+    { "print",   PRINT,    SYNTAX_ONE          },
+};
+
+#define NUM_ILOC_MNEMONICS ((int)(sizeof(iloc_mnemonics) / sizeof(iloc_mnemonics[0])))
+
+/**
+ * @brief Record a syntax error (only the first one is kept)
+ */
+void ILOCScanner_error (ILOCScanner* s, const char* message)
+{
+    if (!s->failed) {
+        snprintf(s->error_msg, MAX_ERROR_LEN, "ILOC syntax error on line %d: %s", s->line, message);
+        s->failed = true;
+    }
+}
+
+bool ILOCScanner_is_name_char (char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+bool ILOCScanner_is_digit (char c)
+{
+    return (c >= '0' && c <= '9');
+}
+
+/**
+ * @brief Skip spaces and tabs (but not line breaks)
+ */
+void ILOCScanner_skip_spaces (ILOCScanner* s)
+{
+    while (s->pos < s->end && (*s->pos == ' ' || *s->pos == '\t')) {
+        s->pos++;
+    }
+}
+
+/**
+ * @brief Consume a punctuation token (after optional spaces)
+ */
+bool ILOCScanner_expect (ILOCScanner* s, const char* token)
+{
+    ILOCScanner_skip_spaces(s);
+    size_t length = strlen(token);
+    if ((size_t)(s->end - s->pos) < length || memcmp(s->pos, token, length) != 0) {
+        char message[MAX_ERROR_LEN];
+        snprintf(message, MAX_ERROR_LEN, "expected '%s'", token);
+        ILOCScanner_error(s, message);
+        return false;
+    }
+    s->pos += length;
+    return true;
+}
+
+/**
+ * @brief Scan a name (identifier)
+ *
+ * @returns Length of the name (zero if there is none)
+ */
+size_t ILOCScanner_scan_name (ILOCScanner* s)
+{
+    const char* start = s->pos;
+    while (s->pos < s->end && ILOCScanner_is_name_char(*s->pos)) {
+        s->pos++;
+    }
+    return s->pos - start;
+}
+
+/**
+ * @brief Make sure the scratch buffer holds at least @c size bytes
+ */
+void ILOCScanner_reserve (ILOCScanner* s, size_t size)
+{
+    if (size > s->scratch_size) {
+        while (s->scratch_size < size) {
+            s->scratch_size *= 2;
+        }
+        s->scratch = (char*)realloc(s->scratch, s->scratch_size);
+        CHECK_MALLOC_PTR(s->scratch);
+    }
+}
+
+/**
+ * @brief Intern a piece of the text
+ */
+const char* ILOCScanner_intern (ILOCScanner* s, const char* start, size_t length)
+{
+    ILOCScanner_reserve(s, length + 1);
+    memcpy(s->scratch, start, length);
+    s->scratch[length] = '\0';
+    return intern_string(s->scratch);
+}
+
+/**
+ * @brief Parse a decimal number with an optional minus sign
+ */
+bool ILOCScanner_parse_integer (ILOCScanner* s, long* value)
+{
+    bool negative = false;
+    if (s->pos < s->end && *s->pos == '-') {
+        negative = true;
+        s->pos++;
+    }
+    if (s->pos >= s->end || !ILOCScanner_is_digit(*s->pos)) {
+        ILOCScanner_error(s, "expected a number");
+        return false;
+    }
+    unsigned long limit = (negative ? (unsigned long)LONG_MAX + 1 : (unsigned long)LONG_MAX);
+    unsigned long magnitude = 0;
+    while (s->pos < s->end && ILOCScanner_is_digit(*s->pos)) {
+        unsigned long digit = *s->pos++ - '0';
+        if (magnitude > (limit - digit) / 10) {
+            ILOCScanner_error(s, "number out of range");
+            return false;
+        }
+        magnitude = magnitude * 10 + digit;
+    }
+    *value = (negative ? (long)(0 - magnitude) : (long)magnitude);
+    return true;
+}
+
+/**
+ * @brief Parse the ID of a register or jump label (digits after the prefix)
+ */
+bool ILOCScanner_parse_id (ILOCScanner* s, const char* start, size_t length, int* id)
+{
+    long value = 0;
+    for (size_t i = 1; i < length; i++) {
+        if (!ILOCScanner_is_digit(start[i])) {
+            return false;
+        }
+        value = value * 10 + (start[i] - '0');
+        if (value >= MAX_VIRTUAL_REGS) {
+            ILOCScanner_error(s, "register or label ID out of range");
+            return false;
+        }
+    }
+    *id = (int)value;
+    return (length > 1);
+}
+
+/**
+ * @brief Parse a quoted string constant (undoing the escapes of
+ * @ref print_escaped_string)
+ */
+bool ILOCScanner_parse_string (ILOCScanner* s, Operand* op)
+{
+    s->pos++;
+    size_t length = 0;
+    while (true) {
+        if (s->pos >= s->end || *s->pos == '\n') {
+            ILOCScanner_error(s, "unterminated string");
+            return false;
+        }
+        char c = *s->pos++;
+        if (c == '"') {
+            break;
+        }
+        if (c == '\\') {
+            if (s->pos >= s->end) {
+                ILOCScanner_error(s, "unterminated string");
+                return false;
+            }
+            switch (*s->pos++) {
+                case 'n':   c = '\n'; break;
+                case 't':   c = '\t'; break;
+                case '"':   c = '"';  break;
+                case '\\':  c = '\\'; break;
+                default:
+                    ILOCScanner_error(s, "invalid escape sequence");
+                    return false;
+            }
+        }
+        ILOCScanner_reserve(s, length + 2);
+        s->scratch[length++] = c;
+    }
+    s->scratch[length] = '\0';
+    op->type = STR_CONST;
+    op->str = intern_string(s->scratch);
+    return true;
+}
+
+/**
+ * @brief Parse any operand (after optional spaces)
+ */
+bool ILOCScanner_parse_operand (ILOCScanner* s, Operand* op)
+{
+    ILOCScanner_skip_spaces(s);
+    if (s->pos >= s->end) {
+        ILOCScanner_error(s, "expected an operand");
+        return false;
+    }
+    char c = *s->pos;
+    if (c == '-' || ILOCScanner_is_digit(c)) {
+        op->type = INT_CONST;
+        return ILOCScanner_parse_integer(s, &op->imm);
+    }
+    if (c == '"') {
+        return ILOCScanner_parse_string(s, op);
+    }
+
+    const char* start = s->pos;
+    size_t length = ILOCScanner_scan_name(s);
+    if (length == 0) {
+        ILOCScanner_error(s, "expected an operand");
+        return false;
+    }
+    if (length == 2 && memcmp(start, "SP", 2) == 0) {
+        *op = stack_register();
+    } else if (length == 2 && memcmp(start, "BP", 2) == 0) {
+        *op = base_register();
+    } else if (length == 3 && memcmp(start, "RET", 3) == 0) {
+        *op = return_register();
+    } else if (start[0] == 'r' && ILOCScanner_parse_id(s, start, length, &op->id)) {
+        op->type = VIRTUAL_REG;
+    } else if (start[0] == 'l' && ILOCScanner_parse_id(s, start, length, &op->id)) {
+        op->type = JUMP_LABEL;
+    } else {
+        *op = call_label(ILOCScanner_intern(s, start, length));
+    }
+    return !s->failed;
+}
+
+/**
+ * @brief Parse a bracketed address with an offset (e.g., @c [BP-8] or
+ * @c [r1+r2])
+ */
+bool ILOCScanner_parse_address (ILOCScanner* s, Operand* base, Operand* offset)
+{
+    if (!ILOCScanner_expect(s, "[") || !ILOCScanner_parse_operand(s, base)) {
+        return false;
+    }
+    ILOCScanner_skip_spaces(s);
+    if (s->pos < s->end && *s->pos == '+') {
+        s->pos++;
+    }
+    return ILOCScanner_parse_operand(s, offset) && ILOCScanner_expect(s, "]");
+}
+
+/**
+ * @brief Parse the operands of an instruction
+ */
+bool ILOCScanner_parse_operands (ILOCScanner* s, ILOCSyntax syntax, Operand* op)
+{
+    switch (syntax) {
+        case SYNTAX_NONE:
+            return true;
+        case SYNTAX_ONE:
+            return ILOCScanner_parse_operand(s, &op[0]);
+        case SYNTAX_ONE_TO_ONE:
+            return ILOCScanner_parse_operand(s, &op[0]) && ILOCScanner_expect(s, "=>") &&
+                   ILOCScanner_parse_operand(s, &op[1]);
+        case SYNTAX_TWO_TO_ONE:
+            return ILOCScanner_parse_operand(s, &op[0]) && ILOCScanner_expect(s, ",") &&
+                   ILOCScanner_parse_operand(s, &op[1]) && ILOCScanner_expect(s, "=>") &&
+                   ILOCScanner_parse_operand(s, &op[2]);
+        case SYNTAX_ONE_TO_TWO:
+            return ILOCScanner_parse_operand(s, &op[0]) && ILOCScanner_expect(s, "=>") &&
+                   ILOCScanner_parse_operand(s, &op[1]) && ILOCScanner_expect(s, ",") &&
+                   ILOCScanner_parse_operand(s, &op[2]);
+        case SYNTAX_LOAD:
+            return ILOCScanner_expect(s, "[") && ILOCScanner_parse_operand(s, &op[0]) &&
+                   ILOCScanner_expect(s, "]") && ILOCScanner_expect(s, "=>") &&
+                   ILOCScanner_parse_operand(s, &op[1]);
+        case SYNTAX_LOAD_OFFSET:
+            return ILOCScanner_parse_address(s, &op[0], &op[1]) && ILOCScanner_expect(s, "=>") &&
+                   ILOCScanner_parse_operand(s, &op[2]);
+        case SYNTAX_STORE:
+            return ILOCScanner_parse_operand(s, &op[0]) && ILOCScanner_expect(s, "=>") &&
+                   ILOCScanner_expect(s, "[") && ILOCScanner_parse_operand(s, &op[1]) &&
+                   ILOCScanner_expect(s, "]");
+        case SYNTAX_STORE_OFFSET:
+            return ILOCScanner_parse_operand(s, &op[0]) && ILOCScanner_expect(s, "=>") &&
+                   ILOCScanner_parse_address(s, &op[1], &op[2]);
+        case SYNTAX_CALL: {
+            ILOCScanner_skip_spaces(s);
+            const char* start = s->pos;
+            size_t length = (s->pos < s->end && ILOCScanner_is_digit(*start) ? 0 : ILOCScanner_scan_name(s));
+            if (length == 0) {
+                ILOCScanner_error(s, "expected a function name");
+                return false;
+            }
+            op[0] = call_label(ILOCScanner_intern(s, start, length));
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Parse the rest of a line (an optional comment)
+ *
+ * @param s Scanner
+ * @param insn Instruction on this line (or @c NULL if there is none)
+ */
+bool ILOCScanner_parse_line_end (ILOCScanner* s, ILOCInsn* insn)
+{
+    ILOCScanner_skip_spaces(s);
+    if (s->pos < s->end && *s->pos == ';') {
+        s->pos++;
+        if (s->pos < s->end && *s->pos == ' ') {
+            s->pos++;
+        }
+        const char* start = s->pos;
+        const char* newline = memchr(start, '\n', s->end - start);
+        s->pos = (newline != NULL ? newline : s->end);
+        size_t length = s->pos - start;
+        if (length > 0 && start[length - 1] == '\r') {
+            length--;
+        }
+        if (insn != NULL) {
+            insn->comment = ILOCScanner_intern(s, start, length);
+        }
+    }
+    if (s->pos < s->end && *s->pos == '\r') {
+        s->pos++;
+    }
+    if (s->pos < s->end && *s->pos != '\n') {
+        ILOCScanner_error(s, "unexpected text at end of line");
+        return false;
+    }
+    if (s->pos < s->end) {
+        s->pos++;
+        s->line++;
+    }
+    return true;
+}
+
+/**
+ * @brief Parse a single (non-empty) line
+ *
+ * @returns Instruction on the line (or @c NULL on error)
+ */
+ILOCInsn* ILOCScanner_parse_insn (ILOCScanner* s)
+{
+    const char* start = s->pos;
+    size_t length = (ILOCScanner_is_digit(*start) ? 0 : ILOCScanner_scan_name(s));
+    if (length == 0) {
+        ILOCScanner_error(s, "expected an instruction or label");
+        return NULL;
+    }
+
+    /* label definition */
+    if (s->pos < s->end && *s->pos == ':') {
+        s->pos++;
+        Operand label;
+        if (start[0] == 'l' && ILOCScanner_parse_id(s, start, length, &label.id)) {
+            label.type = JUMP_LABEL;
+        } else if (s->failed) {
+            return NULL;
+        } else {
+            label = call_label(ILOCScanner_intern(s, start, length));
+        }
+        return ILOCInsn_new_1op(LABEL, label);
+    }
+
+    /* instruction */
+    const ILOCMnemonic* mnemonic = NULL;
+    for (int i = 0; i < NUM_ILOC_MNEMONICS; i++) {
+        if (iloc_mnemonics[i].name[0] == start[0] && strlen(iloc_mnemonics[i].name) == length &&
+                memcmp(iloc_mnemonics[i].name, start, length) == 0) {
+            mnemonic = &iloc_mnemonics[i];
+            break;
+        }
+    }
+    if (mnemonic == NULL) {
+        ILOCScanner_error(s, "unknown instruction");
+        return NULL;
+    }
+    Operand op[3] = { empty_operand(), empty_operand(), empty_operand() };
+    if (!ILOCScanner_parse_operands(s, mnemonic->syntax, op)) {
+        return NULL;
+    }
+    return ILOCInsn_new_3op(mnemonic->form, op[0], op[1], op[2]);
+}
+
+InsnList* assemble_iloc (const char* text, size_t size, char* error_msg)
+{
+    ILOCScanner s;
+    s.pos = text;
+    s.end = text + size;
+    s.line = 1;
+    s.error_msg = error_msg;
+    s.failed = false;
+    s.scratch_size = MAX_LINE_LEN;
+    s.scratch = (char*)malloc(s.scratch_size);
+    CHECK_MALLOC_PTR(s.scratch);
+    error_msg[0] = '\0';
+
+    InsnList* list = InsnList_new();
+    while (s.pos < s.end && !s.failed) {
+        ILOCScanner_skip_spaces(&s);
+        ILOCInsn* insn = NULL;
+        if (s.pos < s.end && *s.pos != ';' && *s.pos != '\n' && *s.pos != '\r') {
+            insn = ILOCScanner_parse_insn(&s);
+            if (insn == NULL) {
+                break;
+            }
+            InsnList_add(list, insn);
+        }
+        ILOCScanner_parse_line_end(&s, insn);
+    }
+    free(s.scratch);
+
+    if (s.failed) {
+        InsnList_free(list);
+        return NULL;
+    }
+    return list;
+}
+
+InsnList* assemble_iloc_file (const char* filename, char* error_msg)
+{
+    FILE* input = fopen(filename, "rb");
+    if (input == NULL) {
+        snprintf(error_msg, MAX_ERROR_LEN, "Could not read file: %s", filename);
+        return NULL;
+    }
+
+    /* read the whole file in large blocks */
+    size_t capacity = 1 << 16;
+    size_t size = 0;
+    char* text = (char*)malloc(capacity);
+    CHECK_MALLOC_PTR(text);
+    size_t count;
+    while ((count = fread(text + size, 1, capacity - size, input)) > 0) {
+        size += count;
+        if (size == capacity) {
+            capacity *= 2;
+            text = (char*)realloc(text, capacity);
+            CHECK_MALLOC_PTR(text);
+        }
+    }
+    bool failed = ferror(input);
+    fclose(input);
+    if (failed) {
+        snprintf(error_msg, MAX_ERROR_LEN, "Could not read file: %s", filename);
+        free(text);
+        return NULL;
+    }
+
+    InsnList* list = assemble_iloc(text, size, error_msg);
+    free(text);
+    return list;
+}
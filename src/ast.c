@@ -85,8 +85,7 @@ void ASTNode_set_printable_attribute (ASTNode* node, const char* key, void* valu
     }
 
     /* allocate new attribute */
-    Attribute* attr = (Attribute*)calloc(1, sizeof(Attribute));
-    CHECK_MALLOC_PTR(attr)
+    Attribute* attr = (Attribute*)arena_calloc(sizeof(Attribute));
     attr->key = key;
     attr->value = value;
     attr->dot_printer = dot_printer;
@@ -106,7 +105,7 @@ void ASTNode_set_printable_attribute (ASTNode* node, const char* key, void* valu
                 a->dtor(a->value);
                 a->value = value;
                 a->dtor = dtor;
-                free(attr);
+                arena_release(attr);
                 return;
             }
         }
@@ -159,7 +158,7 @@ void ASTNode_free (ASTNode* node)
         if (cur->dtor != NULL) {
             cur->dtor(cur->value);
         }
-        free(cur);
+        arena_release(cur);
     }
 
     /* clean up node-specific data */
@@ -0,0 +1,876 @@
+#include "cfg.h"
+#include "dataflow.h"
+
+bool ILOCInsn_is_jump_label (ILOCInsn* insn)
+{
+    return insn != NULL && insn->form == LABEL && insn->op[0].type == JUMP_LABEL;
+}
+
+bool ILOCInsn_is_call_label (ILOCInsn* insn)
+{
+    return insn != NULL && insn->form == LABEL && insn->op[0].type == CALL_LABEL;
+}
+
+/**
+ * @brief Split the instructions into blocks and record the block of every
+ * instruction
+ */
+void ControlFlowGraph_find_blocks (ControlFlowGraph* cfg)
+{
+    cfg->blocks = (BasicBlock*)calloc(cfg->num_insns + 1, sizeof(BasicBlock));
+    CHECK_MALLOC_PTR(cfg->blocks);
+    cfg->block_of_insn = (int*)malloc((cfg->num_insns + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(cfg->block_of_insn);
+
+    /* block 0 always exists (even for an empty function) */
+    int cur = 0;
+    bool split = false;         /* previous instruction ended the block */
+    bool empty = true;          /* current block has no instructions yet */
+    for (int i = 0; i < cfg->num_insns; i++) {
+        ILOCInsn* insn = cfg->insns[i];
+        if (insn != NULL) {
+            if (!empty && (split || ILOCInsn_is_jump_label(insn))) {
+                cfg->blocks[cur].end = i;
+                cur++;
+                cfg->blocks[cur].first = i;
+            }
+            empty = false;
+            split = (insn->form == JUMP || insn->form == CBR || insn->form == RETURN);
+        }
+        cfg->block_of_insn[i] = cur;
+    }
+    cfg->blocks[cur].end = cfg->num_insns;
+    cfg->num_blocks = cur + 1;
+}
+
+ILOCInsn* BasicBlock_last_insn (ControlFlowGraph* cfg, BasicBlock* block)
+{
+    for (int i = block->end - 1; i >= block->first; i--) {
+        if (cfg->insns[i] != NULL) {
+            return cfg->insns[i];
+        }
+    }
+    return NULL;
+}
+
+int BasicBlock_label (ControlFlowGraph* cfg, BasicBlock* block)
+{
+    for (int i = block->first; i < block->end; i++) {
+        if (cfg->insns[i] != NULL) {
+            return (ILOCInsn_is_jump_label(cfg->insns[i]) ? cfg->insns[i]->op[0].id : -1);
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Compute successor and predecessor edges
+ */
+void ControlFlowGraph_find_edges (ControlFlowGraph* cfg)
+{
+    int nb = cfg->num_blocks;
+
+    /* map jump labels defined in this function to their blocks */
+    int max_label = -1;
+    for (int i = 0; i < cfg->num_insns; i++) {
+        if (ILOCInsn_is_jump_label(cfg->insns[i]) && cfg->insns[i]->op[0].id > max_label) {
+            max_label = cfg->insns[i]->op[0].id;
+        }
+    }
+    int* label_block = (int*)malloc((max_label + 1) * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(label_block);
+    for (int l = 0; l <= max_label; l++) {
+        label_block[l] = -1;
+    }
+    for (int i = 0; i < cfg->num_insns; i++) {
+        if (ILOCInsn_is_jump_label(cfg->insns[i]) && cfg->insns[i]->op[0].id >= 0) {
+            label_block[cfg->insns[i]->op[0].id] = cfg->block_of_insn[i];
+        }
+    }
+
+    /* find up to two distinct successors per block */
+    int* succ = (int*)malloc(2 * nb * sizeof(int));
+    CHECK_MALLOC_PTR(succ);
+    int num_edges = 0;
+    for (int b = 0; b < nb; b++) {
+        BasicBlock* block = &cfg->blocks[b];
+        ILOCInsn* last = BasicBlock_last_insn(cfg, block);
+        int targets[2] = { -1, -1 };
+        if (last != NULL && last->form == JUMP) {
+            targets[0] = last->op[0].id;
+        } else if (last != NULL && last->form == CBR) {
+            targets[0] = last->op[1].id;
+            targets[1] = last->op[2].id;
+        }
+        block->num_succs = 0;
+        if (last != NULL && (last->form == JUMP || last->form == CBR)) {
+            for (int t = 0; t < 2; t++) {
+                int target = (targets[t] >= 0 && targets[t] <= max_label) ? label_block[targets[t]] : -1;
+                if (target >= 0 && (block->num_succs == 0 || succ[2*b] != target)) {
+                    succ[2*b + block->num_succs++] = target;
+                }
+            }
+        } else if ((last == NULL || last->form != RETURN) && b + 1 < nb) {
+            succ[2*b + block->num_succs++] = b + 1;
+        }
+        num_edges += block->num_succs;
+        for (int s = 0; s < block->num_succs; s++) {
+            cfg->blocks[succ[2*b + s]].num_preds++;
+        }
+    }
+
+    /* lay out successors, then predecessors, in one array */
+    cfg->edges = (int*)malloc(2 * num_edges * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(cfg->edges);
+    int next = 0;
+    for (int b = 0; b < nb; b++) {
+        cfg->blocks[b].succs = &cfg->edges[next];
+        for (int s = 0; s < cfg->blocks[b].num_succs; s++) {
+            cfg->edges[next++] = succ[2*b + s];
+        }
+    }
+    for (int b = 0; b < nb; b++) {
+        cfg->blocks[b].preds = &cfg->edges[next];
+        next += cfg->blocks[b].num_preds;
+        cfg->blocks[b].num_preds = 0;
+    }
+    for (int b = 0; b < nb; b++) {
+        for (int s = 0; s < cfg->blocks[b].num_succs; s++) {
+            BasicBlock* target = &cfg->blocks[cfg->blocks[b].succs[s]];
+            target->preds[target->num_preds++] = b;
+        }
+    }
+
+    free(succ);
+    free(label_block);
+}
+
+/**
+ * @brief Number the blocks reachable from the entry in reverse postorder
+ * (iterative depth-first search)
+ */
+void ControlFlowGraph_order_blocks (ControlFlowGraph* cfg)
+{
+    int nb = cfg->num_blocks;
+    int* stack = (int*)malloc(nb * sizeof(int));
+    int* next_succ = (int*)calloc(nb, sizeof(int));
+    int* postorder = (int*)malloc(nb * sizeof(int));
+    CHECK_MALLOC_PTR(stack);
+    CHECK_MALLOC_PTR(next_succ);
+    CHECK_MALLOC_PTR(postorder);
+    for (int b = 0; b < nb; b++) {
+        cfg->blocks[b].rpo = -1;
+    }
+
+    int depth = 0;
+    int count = 0;
+    stack[depth++] = 0;
+    cfg->blocks[0].rpo = 0;     /* marks the block as visited */
+    while (depth > 0) {
+        int b = stack[depth - 1];
+        if (next_succ[b] < cfg->blocks[b].num_succs) {
+            int s = cfg->blocks[b].succs[next_succ[b]++];
+            if (cfg->blocks[s].rpo < 0) {
+                cfg->blocks[s].rpo = 0;
+                stack[depth++] = s;
+            }
+        } else {
+            postorder[count++] = b;
+            depth--;
+        }
+    }
+
+    cfg->num_reachable = count;
+    cfg->rpo = (int*)malloc(count * sizeof(int));
+    CHECK_MALLOC_PTR(cfg->rpo);
+    for (int i = 0; i < count; i++) {
+        cfg->rpo[i] = postorder[count - 1 - i];
+        cfg->blocks[cfg->rpo[i]].rpo = i;
+    }
+
+    free(postorder);
+    free(next_succ);
+    free(stack);
+}
+
+/**
+ * @brief Compress the ancestor path of a vertex during dominator computation
+ * (iteratively, since paths can be as long as the function)
+ *
+ * All arrays are indexed by DFS preorder number.
+ */
+void dominator_compress (int v, int* ancestor, int* label, int* semi, int* path)
+{
+    int length = 0;
+    while (ancestor[ancestor[v]] >= 0) {
+        path[length++] = v;
+        v = ancestor[v];
+    }
+    while (length > 0) {
+        v = path[--length];
+        int a = ancestor[v];
+        if (semi[label[a]] < semi[label[v]]) {
+            label[v] = label[a];
+        }
+        ancestor[v] = ancestor[a];
+    }
+}
+
+/**
+ * @brief Compute immediate dominators and number the dominator tree
+ *
+ * Immediate dominators are computed with the Lengauer-Tarjan algorithm (with
+ * path compression but without balancing) over a depth-first spanning tree.
+ */
+void ControlFlowGraph_find_dominators (ControlFlowGraph* cfg)
+{
+    int nb = cfg->num_blocks;
+    for (int b = 0; b < nb; b++) {
+        cfg->blocks[b].idom = -1;
+        cfg->blocks[b].dom_pre = -1;
+        cfg->blocks[b].dom_post = -1;
+    }
+
+    /* number reachable blocks in DFS preorder (arrays below are indexed by
+     * preorder number unless noted otherwise) */
+    int n = cfg->num_reachable;
+    int* pre = (int*)malloc(nb * sizeof(int));          /* by block ID */
+    int* vertex = (int*)malloc(n * sizeof(int));
+    int* parent = (int*)malloc(n * sizeof(int));
+    int* semi = (int*)malloc(n * sizeof(int));
+    int* idom = (int*)malloc(n * sizeof(int));
+    int* ancestor = (int*)malloc(n * sizeof(int));
+    int* label = (int*)malloc(n * sizeof(int));
+    int* bucket = (int*)malloc(n * sizeof(int));
+    int* bucket_next = (int*)malloc(n * sizeof(int));
+    int* stack = (int*)malloc(n * sizeof(int));
+    int* next_succ = (int*)calloc(nb, sizeof(int));     /* by block ID */
+    CHECK_MALLOC_PTR(pre);
+    CHECK_MALLOC_PTR(vertex);
+    CHECK_MALLOC_PTR(parent);
+    CHECK_MALLOC_PTR(semi);
+    CHECK_MALLOC_PTR(idom);
+    CHECK_MALLOC_PTR(ancestor);
+    CHECK_MALLOC_PTR(label);
+    CHECK_MALLOC_PTR(bucket);
+    CHECK_MALLOC_PTR(bucket_next);
+    CHECK_MALLOC_PTR(stack);
+    CHECK_MALLOC_PTR(next_succ);
+    for (int b = 0; b < nb; b++) {
+        pre[b] = -1;
+    }
+    int count = 0;
+    int depth = 0;
+    pre[0] = count;
+    vertex[count] = 0;
+    parent[count++] = -1;
+    stack[depth++] = 0;
+    while (depth > 0) {
+        int b = stack[depth - 1];
+        if (next_succ[b] < cfg->blocks[b].num_succs) {
+            int s = cfg->blocks[b].succs[next_succ[b]++];
+            if (pre[s] < 0) {
+                pre[s] = count;
+                vertex[count] = s;
+                parent[count++] = pre[b];
+                stack[depth++] = s;
+            }
+        } else {
+            depth--;
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        semi[v] = v;
+        label[v] = v;
+        ancestor[v] = -1;
+        bucket[v] = -1;
+    }
+
+    /* semidominators in reverse preorder, deferring idoms via buckets */
+    for (int w = n - 1; w > 0; w--) {
+        BasicBlock* block = &cfg->blocks[vertex[w]];
+        for (int p = 0; p < block->num_preds; p++) {
+            int v = pre[block->preds[p]];
+            if (v < 0) {
+                continue;       /* unreachable predecessor */
+            }
+            int u = v;
+            if (ancestor[v] >= 0) {
+                dominator_compress(v, ancestor, label, semi, stack);
+                u = label[v];
+            }
+            if (semi[u] < semi[w]) {
+                semi[w] = semi[u];
+            }
+        }
+        bucket_next[w] = bucket[semi[w]];
+        bucket[semi[w]] = w;
+        ancestor[w] = parent[w];
+        for (int v = bucket[parent[w]]; v >= 0; v = bucket_next[v]) {
+            int u = v;
+            if (ancestor[v] >= 0) {
+                dominator_compress(v, ancestor, label, semi, stack);
+                u = label[v];
+            }
+            idom[v] = (semi[u] < semi[v] ? u : parent[w]);
+        }
+        bucket[parent[w]] = -1;
+    }
+    for (int w = 1; w < n; w++) {
+        if (idom[w] != semi[w]) {
+            idom[w] = idom[idom[w]];
+        }
+        cfg->blocks[vertex[w]].idom = vertex[idom[w]];
+    }
+
+    free(next_succ);
+    free(stack);
+    free(bucket_next);
+    free(bucket);
+    free(label);
+    free(ancestor);
+    free(idom);
+    free(semi);
+    free(parent);
+    free(vertex);
+    free(pre);
+}
+
+/**
+ * @brief Number the dominator tree in preorder and postorder (children are
+ * stored like the edge arrays)
+ */
+void ControlFlowGraph_number_dominator_tree (ControlFlowGraph* cfg)
+{
+    int nb = cfg->num_blocks;
+    int* child_start = (int*)calloc(nb + 1, sizeof(int));
+    int* children = (int*)malloc(nb * sizeof(int));
+    int* stack = (int*)malloc(nb * sizeof(int));
+    int* next_child = (int*)malloc(nb * sizeof(int));
+    CHECK_MALLOC_PTR(child_start);
+    CHECK_MALLOC_PTR(children);
+    CHECK_MALLOC_PTR(stack);
+    CHECK_MALLOC_PTR(next_child);
+    for (int b = 0; b < nb; b++) {
+        if (cfg->blocks[b].idom >= 0) {
+            child_start[cfg->blocks[b].idom + 1]++;
+        }
+    }
+    for (int b = 0; b < nb; b++) {
+        child_start[b + 1] += child_start[b];
+        next_child[b] = child_start[b];
+    }
+    for (int i = 0; i < cfg->num_reachable; i++) {
+        int b = cfg->rpo[i];
+        if (cfg->blocks[b].idom >= 0) {
+            children[next_child[cfg->blocks[b].idom]++] = b;
+        }
+    }
+    for (int b = 0; b < nb; b++) {
+        next_child[b] = child_start[b];
+    }
+
+    int depth = 0;
+    int pre = 0;
+    int post = 0;
+    stack[depth++] = 0;
+    cfg->blocks[0].dom_pre = pre++;
+    while (depth > 0) {
+        int b = stack[depth - 1];
+        if (next_child[b] < child_start[b + 1]) {
+            int c = children[next_child[b]++];
+            cfg->blocks[c].dom_pre = pre++;
+            stack[depth++] = c;
+        } else {
+            cfg->blocks[b].dom_post = post++;
+            depth--;
+        }
+    }
+
+    free(next_child);
+    free(stack);
+    free(children);
+    free(child_start);
+}
+
+bool ControlFlowGraph_dominates (ControlFlowGraph* cfg, int a, int b)
+{
+    BasicBlock* ba = &cfg->blocks[a];
+    BasicBlock* bb = &cfg->blocks[b];
+    return ba->dom_pre >= 0 && bb->dom_pre >= 0 &&
+           ba->dom_pre <= bb->dom_pre && bb->dom_post <= ba->dom_post;
+}
+
+/**
+ * @brief Find the outermost loop header found so far for a block (union-find
+ * with path compression)
+ */
+int loop_find (int* parent, int b)
+{
+    int root = b;
+    while (parent[root] != root) {
+        root = parent[root];
+    }
+    while (parent[b] != root) {
+        int next = parent[b];
+        parent[b] = root;
+        b = next;
+    }
+    return root;
+}
+
+/**
+ * @brief Find natural loops, their nesting, and the loop depth of each block
+ *
+ * Headers are visited in reverse RPO, so inner loops are found before the
+ * loops that contain them. The body of each loop is collected by walking
+ * backwards from its back edges; an inner loop that is reached is absorbed as
+ * a whole (by jumping to its header) instead of being walked again.
+ */
+void ControlFlowGraph_find_loops (ControlFlowGraph* cfg)
+{
+    int nb = cfg->num_blocks;
+    int num_edges = 0;
+    int* parent = (int*)malloc(nb * sizeof(int));
+    CHECK_MALLOC_PTR(parent);
+    for (int b = 0; b < nb; b++) {
+        cfg->blocks[b].loop = -1;
+        cfg->blocks[b].loop_parent = -1;
+        cfg->blocks[b].loop_depth = 0;
+        num_edges += cfg->blocks[b].num_preds;
+        parent[b] = b;
+    }
+    int* worklist = (int*)malloc((num_edges + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(worklist);
+
+    cfg->num_loops = 0;
+    for (int i = cfg->num_reachable - 1; i >= 0; i--) {
+        int h = cfg->rpo[i];
+        BasicBlock* header = &cfg->blocks[h];
+        int count = 0;
+        for (int p = 0; p < header->num_preds; p++) {
+            if (ControlFlowGraph_dominates(cfg, h, header->preds[p])) {
+                worklist[count++] = header->preds[p];
+            }
+        }
+        if (count == 0) {
+            continue;
+        }
+        cfg->num_loops++;
+        header->loop = h;
+        while (count > 0) {
+            int b = loop_find(parent, worklist[--count]);
+            if (b == h || !ControlFlowGraph_dominates(cfg, h, b)) {
+                continue;       /* already in this loop (or an irreducible entry) */
+            }
+            if (cfg->blocks[b].loop < 0) {
+                cfg->blocks[b].loop = h;
+            } else {
+                cfg->blocks[b].loop_parent = h;
+            }
+            parent[b] = h;
+            for (int p = 0; p < cfg->blocks[b].num_preds; p++) {
+                if (cfg->blocks[cfg->blocks[b].preds[p]].rpo >= 0) {
+                    worklist[count++] = cfg->blocks[b].preds[p];
+                }
+            }
+        }
+    }
+
+    /* headers dominate their loop bodies, so RPO visits outer loops first */
+    for (int i = 0; i < cfg->num_reachable; i++) {
+        BasicBlock* block = &cfg->blocks[cfg->rpo[i]];
+        if (block->loop == cfg->rpo[i]) {
+            block->loop_depth = 1 + (block->loop_parent >= 0 ? cfg->blocks[block->loop_parent].loop_depth : 0);
+        } else if (block->loop >= 0) {
+            block->loop_depth = cfg->blocks[block->loop].loop_depth;
+        }
+    }
+
+    free(worklist);
+    free(parent);
+}
+
+ControlFlowGraph* ControlFlowGraph_new (const char* name, ILOCInsn** insns, int num_insns)
+{
+    ControlFlowGraph* cfg = (ControlFlowGraph*)calloc(1, sizeof(ControlFlowGraph));
+    CHECK_MALLOC_PTR(cfg);
+    cfg->name = name;
+    cfg->insns = insns;
+    cfg->num_insns = num_insns;
+    ControlFlowGraph_find_blocks(cfg);
+    ControlFlowGraph_find_edges(cfg);
+    ControlFlowGraph_order_blocks(cfg);
+    ControlFlowGraph_find_dominators(cfg);
+    ControlFlowGraph_number_dominator_tree(cfg);
+    ControlFlowGraph_find_loops(cfg);
+    return cfg;
+}
+
+/**
+ * @brief Print an instruction with DOT string escapes
+ *
+ * The instruction is formatted by @ref ILOCInsn_print into a scratch file so
+ * that the label syntax stays the same as everywhere else.
+ */
+void ILOCInsn_print_dot (ILOCInsn* insn, FILE* scratch, FILE* output)
+{
+    if (scratch == NULL) {
+        fprintf(output, "%s", InsnForm_to_string(insn->form));
+        return;
+    }
+    rewind(scratch);
+    ILOCInsn_print(insn, scratch);
+    long length = ftell(scratch);
+    rewind(scratch);
+    for (long i = 0; i < length; i++) {
+        int c = fgetc(scratch);
+        if (c == '"' || c == '\\') {
+            fputc('\\', output);
+        }
+        fputc(c, output);
+    }
+}
+
+/**
+ * @brief Print the blocks and edges of a CFG (without the graph header)
+ *
+ * @param cfg CFG to print
+ * @param id Prefix for node names (unique per function)
+ * @param output File stream to print to
+ */
+void ControlFlowGraph_print_dot_body (ControlFlowGraph* cfg, int id, FILE* output)
+{
+    FILE* scratch = tmpfile();
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        BasicBlock* block = &cfg->blocks[b];
+        fprintf(output, "f%d_b%d [shape=box, label=\"B%d", id, b, b);
+        if (block->rpo < 0) {
+            fprintf(output, " (unreachable)");
+        } else {
+            if (block->idom >= 0) {
+                fprintf(output, " idom=B%d", block->idom);
+            }
+            if (block->loop_depth > 0) {
+                fprintf(output, " loop=B%d depth=%d", block->loop, block->loop_depth);
+            }
+        }
+        fprintf(output, "\\l");
+        for (int i = block->first; i < block->end; i++) {
+            if (cfg->insns[i] != NULL) {
+                fprintf(output, "%s", cfg->insns[i]->form == LABEL ? "" : "  ");
+                ILOCInsn_print_dot(cfg->insns[i], scratch, output);
+                fprintf(output, "\\l");
+            }
+        }
+        fprintf(output, "\"];\n");
+    }
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        for (int s = 0; s < cfg->blocks[b].num_succs; s++) {
+            int target = cfg->blocks[b].succs[s];
+            bool back = ControlFlowGraph_dominates(cfg, target, b);
+            fprintf(output, "f%d_b%d -> f%d_b%d%s;\n", id, b, id, target,
+                    back ? " [style=bold]" : "");
+        }
+    }
+    if (scratch != NULL) {
+        fclose(scratch);
+    }
+}
+
+void ControlFlowGraph_print_dot (ControlFlowGraph* cfg, FILE* output)
+{
+    fprintf(output, "digraph CFG {\n");
+    ControlFlowGraph_print_dot_body(cfg, 0, output);
+    fprintf(output, "}\n");
+}
+
+void ControlFlowGraph_free (ControlFlowGraph* cfg)
+{
+    free(cfg->blocks);
+    free(cfg->block_of_insn);
+    free(cfg->edges);
+    free(cfg->rpo);
+    free(cfg);
+}
+
+DEF_LIST_IMPL (CFG, ControlFlowGraph*, ControlFlowGraph_free)
+
+CFGList* build_cfgs (InsnVector* program)
+{
+    CFGList* cfgs = CFGList_new();
+    ILOCInsn** insns = program->insns;
+    int size = program->size;
+
+    /* code before the first function (if any) */
+    int start = 0;
+    bool has_code = false;
+    while (start < size && !ILOCInsn_is_call_label(insns[start])) {
+        has_code = has_code || (insns[start] != NULL);
+        start++;
+    }
+    if (has_code) {
+        CFGList_add(cfgs, ControlFlowGraph_new(NULL, insns, start));
+    }
+
+    while (start < size) {
+        int end = start + 1;
+        while (end < size && !ILOCInsn_is_call_label(insns[end])) {
+            end++;
+        }
+        CFGList_add(cfgs, ControlFlowGraph_new(insns[start]->op[0].str, &insns[start], end - start));
+        start = end;
+    }
+    return cfgs;
+}
+
+void CFGList_print_dot (CFGList* cfgs, FILE* output)
+{
+    fprintf(output, "digraph CFG {\n");
+    int id = 0;
+    FOR_EACH(ControlFlowGraph*, cfg, cfgs) {
+        fprintf(output, "subgraph cluster_%d {\n", id);
+        fprintf(output, "label=\"%s\";\n", cfg->name != NULL ? cfg->name : "(no function)");
+        ControlFlowGraph_print_dot_body(cfg, id, output);
+        fprintf(output, "}\n");
+        id++;
+    }
+    fprintf(output, "}\n");
+}
+
+/**
+ * @brief Mark the registers through which the activations of a recursive
+ * function can pass values (live at its entry or after one of its calls)
+ */
+void CallGraph_mark_recursive (CallGraph* graph, int func)
+{
+    ControlFlowGraph* cfg = graph->funcs[func];
+    RegisterIndex* regs = RegisterIndex_new(cfg);
+    DataflowProblem* liveness = Liveness_new(cfg, regs);
+    uint64_t* live = (uint64_t*)malloc(liveness->words * sizeof(uint64_t) + 1);
+    uint64_t* passed = (uint64_t*)calloc(liveness->words + 1, sizeof(uint64_t));
+    CHECK_MALLOC_PTR(live);
+    CHECK_MALLOC_PTR(passed);
+
+    /* walk every block backwards from its live-out set */
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        memcpy(live, DataflowProblem_set(liveness, liveness->out, b), liveness->words * sizeof(uint64_t));
+        for (int i = cfg->blocks[b].end - 1; i >= cfg->blocks[b].first; i--) {
+            if (cfg->insns[i] == NULL) {
+                continue;
+            }
+            if (cfg->insns[i]->form == CALL) {
+                for (int w = 0; w < liveness->words; w++) {
+                    passed[w] |= live[w];
+                }
+            }
+            int d = RegisterIndex_lookup(regs, ILOCInsn_get_def(cfg->insns[i]));
+            if (d >= 0) {
+                bitset_remove(live, d);
+            }
+            Operand* uses[MAX_INSN_USES];
+            int num_uses = ILOCInsn_get_uses(cfg->insns[i], uses);
+            for (int u = 0; u < num_uses; u++) {
+                int r = RegisterIndex_lookup(regs, uses[u]);
+                if (r >= 0) {
+                    bitset_add(live, r);
+                }
+            }
+        }
+    }
+    uint64_t* live_in = DataflowProblem_set(liveness, liveness->in, 0);
+    for (int w = 0; w < liveness->words; w++) {
+        passed[w] |= live_in[w];
+    }
+
+    for (int r = 0; r < regs->num_regs; r++) {
+        if (bitset_contains(passed, r)) {
+            graph->shared_regs[regs->regs[r]] = true;
+            graph->shares_registers[func] = true;
+        }
+    }
+    free(passed);
+    free(live);
+    DataflowProblem_free(liveness);
+    RegisterIndex_free(regs);
+}
+
+CallGraph* CallGraph_new (CFGList* cfgs)
+{
+    CallGraph* graph = (CallGraph*)malloc(sizeof(CallGraph));
+    CHECK_MALLOC_PTR(graph);
+    int n = CFGList_size(cfgs);
+    graph->num_funcs = n;
+    graph->funcs = (ControlFlowGraph**)malloc(n * sizeof(ControlFlowGraph*) + 1);
+    graph->callees = (int**)calloc(n + 1, sizeof(int*));
+    graph->num_callees = (int*)calloc(n + 1, sizeof(int));
+    graph->shares_registers = (bool*)calloc(n + 1, sizeof(bool));
+    CHECK_MALLOC_PTR(graph->funcs);
+    CHECK_MALLOC_PTR(graph->callees);
+    CHECK_MALLOC_PTR(graph->num_callees);
+    CHECK_MALLOC_PTR(graph->shares_registers);
+    int f = 0;
+    FOR_EACH(ControlFlowGraph*, cfg, cfgs) {
+        graph->funcs[f++] = cfg;
+    }
+
+    /* callees of every function */
+    for (f = 0; f < n; f++) {
+        ControlFlowGraph* cfg = graph->funcs[f];
+        graph->callees[f] = (int*)malloc(cfg->num_insns * sizeof(int) + 1);
+        CHECK_MALLOC_PTR(graph->callees[f]);
+        for (int i = 0; i < cfg->num_insns; i++) {
+            ILOCInsn* insn = cfg->insns[i];
+            if (insn == NULL || insn->form != CALL) {
+                continue;
+            }
+            int g = CallGraph_find(graph, insn->op[0].str);
+            if (g >= 0) {
+                graph->callees[f][graph->num_callees[f]++] = g;
+            }
+        }
+    }
+
+    /* registers shared between functions carry values across calls */
+    int max_reg = -1;
+    for (f = 0; f < n; f++) {
+        for (int i = 0; i < graph->funcs[f]->num_insns; i++) {
+            ILOCInsn* insn = graph->funcs[f]->insns[i];
+            for (int j = 0; insn != NULL && j < 3; j++) {
+                if (insn->op[j].type == VIRTUAL_REG && insn->op[j].id > max_reg) {
+                    max_reg = insn->op[j].id;
+                }
+            }
+        }
+    }
+    graph->max_reg = max_reg;
+    graph->shared_regs = (bool*)calloc(max_reg + 2, sizeof(bool));
+    int* owner = (int*)malloc((max_reg + 1) * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(graph->shared_regs);
+    CHECK_MALLOC_PTR(owner);
+    for (int r = 0; r <= max_reg; r++) {
+        owner[r] = -1;
+    }
+    for (f = 0; f < n; f++) {
+        for (int i = 0; i < graph->funcs[f]->num_insns; i++) {
+            ILOCInsn* insn = graph->funcs[f]->insns[i];
+            for (int j = 0; insn != NULL && j < 3; j++) {
+                if (insn->op[j].type != VIRTUAL_REG || insn->op[j].id < 0) {
+                    continue;
+                }
+                int id = insn->op[j].id;
+                if (owner[id] < 0) {
+                    owner[id] = f;
+                } else if (owner[id] != f) {
+                    graph->shared_regs[id] = true;
+                    graph->shares_registers[owner[id]] = true;
+                    graph->shares_registers[f] = true;
+                }
+            }
+        }
+    }
+    free(owner);
+
+    /* so do registers that are live across a recursive call (the nested
+     * activation writes the same virtual registers) */
+    for (f = 0; f < n; f++) {
+        if (CallGraph_is_recursive(graph, f)) {
+            CallGraph_mark_recursive(graph, f);
+        }
+    }
+    return graph;
+}
+
+int CallGraph_find (CallGraph* graph, const char* name)
+{
+    for (int f = 0; f < graph->num_funcs; f++) {
+        if (graph->funcs[f]->name != NULL && strcmp(graph->funcs[f]->name, name) == 0) {
+            return f;
+        }
+    }
+    return -1;
+}
+
+bool CallGraph_is_recursive (CallGraph* graph, int func)
+{
+    /* search from the callees (not the function itself) */
+    int n = graph->num_funcs;
+    bool* visited = (bool*)calloc(n + 1, sizeof(bool));
+    int* stack = (int*)malloc(n * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(visited);
+    CHECK_MALLOC_PTR(stack);
+    int top = 0;
+    for (int c = 0; c < graph->num_callees[func]; c++) {
+        if (!visited[graph->callees[func][c]]) {
+            visited[graph->callees[func][c]] = true;
+            stack[top++] = graph->callees[func][c];
+        }
+    }
+    while (top > 0 && !visited[func]) {
+        int g = stack[--top];
+        for (int c = 0; c < graph->num_callees[g]; c++) {
+            if (!visited[graph->callees[g][c]]) {
+                visited[graph->callees[g][c]] = true;
+                stack[top++] = graph->callees[g][c];
+            }
+        }
+    }
+    bool recursive = visited[func];
+    free(stack);
+    free(visited);
+    return recursive;
+}
+
+int* CallGraph_postorder (CallGraph* graph)
+{
+    int n = graph->num_funcs;
+    int* order = (int*)malloc(n * sizeof(int) + 1);
+    bool* visited = (bool*)calloc(n + 1, sizeof(bool));
+    int* stack = (int*)malloc(n * sizeof(int) + 1);
+    int* next = (int*)calloc(n + 1, sizeof(int));
+    CHECK_MALLOC_PTR(order);
+    CHECK_MALLOC_PTR(visited);
+    CHECK_MALLOC_PTR(stack);
+    CHECK_MALLOC_PTR(next);
+
+    /* iterative depth-first search (the call chains may be long) */
+    int count = 0;
+    for (int root = 0; root < n; root++) {
+        if (visited[root]) {
+            continue;
+        }
+        visited[root] = true;
+        int top = 0;
+        stack[top++] = root;
+        while (top > 0) {
+            int f = stack[top - 1];
+            if (next[f] < graph->num_callees[f]) {
+                int g = graph->callees[f][next[f]++];
+                if (!visited[g]) {
+                    visited[g] = true;
+                    stack[top++] = g;
+                }
+            } else {
+                order[count++] = f;
+                top--;
+            }
+        }
+    }
+    free(next);
+    free(stack);
+    free(visited);
+    return order;
+}
+
+void CallGraph_free (CallGraph* graph)
+{
+    for (int f = 0; f < graph->num_funcs; f++) {
+        free(graph->callees[f]);
+    }
+    free(graph->callees);
+    free(graph->num_callees);
+    free(graph->shares_registers);
+    free(graph->shared_regs);
+    free(graph->funcs);
+    free(graph);
+}
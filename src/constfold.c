@@ -0,0 +1,238 @@
+#include <limits.h>
+
+#include "constfold.h"
+#include "dataflow.h"
+
+/**
+ * @brief Registers with known values in the current block
+ *
+ * A register's value is known if it was last written by a @c loadI since
+ * the start of the block or the last call (the current epoch).
+ */
+typedef struct ConstantTable
+{
+    RegisterIndex* regs;    /**< @brief Register numbering of the function */
+    long* value;            /**< @brief Known value of every register */
+    int* stamp;             /**< @brief Epoch in which the value became known */
+    int epoch;              /**< @brief Current epoch */
+} ConstantTable;
+
+/**
+ * @brief Look up the value of a register operand
+ *
+ * @returns True if and only if the operand is a virtual register with a
+ * known value
+ */
+bool ConstantTable_lookup (ConstantTable* table, Operand* op, long* value)
+{
+    int r = RegisterIndex_lookup(table->regs, op);
+    if (r < 0 || table->stamp[r] != table->epoch) {
+        return false;
+    }
+    *value = table->value[r];
+    return true;
+}
+
+/**
+ * @brief Record the value written by an instruction (or forget it if unknown)
+ */
+void ConstantTable_update (ConstantTable* table, ILOCInsn* insn)
+{
+    int r = RegisterIndex_lookup(table->regs, ILOCInsn_get_def(insn));
+    if (r < 0) {
+        return;
+    }
+    if (insn->form == LOAD_I) {
+        table->value[r] = insn->op[0].imm;
+        table->stamp[r] = table->epoch;
+    } else {
+        table->stamp[r] = 0;
+    }
+}
+
+bool fold_operation (InsnForm form, long a, long b, long* result)
+{
+    unsigned long ua = (unsigned long)a;
+    unsigned long ub = (unsigned long)b;
+    switch (form) {
+        case ADD: case ADD_I:   *result = (long)(ua + ub); break;
+        case SUB:               *result = (long)(ua - ub); break;
+        case MULT: case MULT_I: *result = (long)(ua * ub); break;
+        case DIV:
+            if (b == 0 || (a == LONG_MIN && b == -1)) {
+                return false;
+            }
+            *result = a / b; break;
+        case AND:               *result = a & b;  break;
+        case OR:                *result = a | b;  break;
+        case CMP_LT:            *result = a <  b; break;
+        case CMP_LE:            *result = a <= b; break;
+        case CMP_EQ:            *result = a == b; break;
+        case CMP_GE:            *result = a >= b; break;
+        case CMP_GT:            *result = a >  b; break;
+        case CMP_NE:            *result = a != b; break;
+        case NOT:               *result = (~a) & 1; break;
+        case NEG:               *result = (long)(0 - ua); break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Rewrite an instruction in place (keeping its comment)
+ */
+void ILOCInsn_rewrite (ILOCInsn* insn, InsnForm form, Operand op1, Operand op2, Operand op3)
+{
+    insn->form = form;
+    insn->op[0] = op1;
+    insn->op[1] = op2;
+    insn->op[2] = op3;
+}
+
+/**
+ * @brief Fold or simplify one instruction using the known constants
+ */
+void fold_insn (ConstantTable* table, ILOCInsn* insn, ConstantFoldingStats* stats)
+{
+    long a, b, result;
+    bool known_a = ConstantTable_lookup(table, &insn->op[0], &a);
+    bool known_b = ConstantTable_lookup(table, &insn->op[1], &b);
+    switch (insn->form) {
+        case ADD: case SUB: case MULT: case DIV: case AND: case OR:
+        case CMP_LT: case CMP_LE: case CMP_EQ: case CMP_GE: case CMP_GT: case CMP_NE:
+            if (known_a && known_b) {
+                if (fold_operation(insn->form, a, b, &result)) {
+                    ILOCInsn_rewrite(insn, LOAD_I, int_const(result), insn->op[2], empty_operand());
+                    stats->folded++;
+                }
+            } else if (known_b && (insn->form == ADD || insn->form == SUB || insn->form == MULT)) {
+                InsnForm form = (insn->form == MULT ? MULT_I : ADD_I);
+                long imm = (insn->form == SUB ? (long)(0 - (unsigned long)b) : b);
+                ILOCInsn_rewrite(insn, form, insn->op[0], int_const(imm), insn->op[2]);
+                stats->immediates++;
+                fold_insn(table, insn, stats);
+            } else if (known_a && (insn->form == ADD || insn->form == MULT)) {
+                InsnForm form = (insn->form == MULT ? MULT_I : ADD_I);
+                ILOCInsn_rewrite(insn, form, insn->op[1], int_const(a), insn->op[2]);
+                stats->immediates++;
+                fold_insn(table, insn, stats);
+            }
+            break;
+
+        case ADD_I: case MULT_I:
+            if (known_a && fold_operation(insn->form, a, insn->op[1].imm, &result)) {
+                ILOCInsn_rewrite(insn, LOAD_I, int_const(result), insn->op[2], empty_operand());
+                stats->folded++;
+            } else if (insn->op[2].type == VIRTUAL_REG &&
+                    ((insn->form == ADD_I && insn->op[1].imm == 0) ||
+                     (insn->form == MULT_I && insn->op[1].imm == 1))) {
+                ILOCInsn_rewrite(insn, I2I, insn->op[0], insn->op[2], empty_operand());
+                stats->immediates++;
+            } else if (insn->op[2].type == VIRTUAL_REG && insn->form == MULT_I && insn->op[1].imm == 0) {
+                ILOCInsn_rewrite(insn, LOAD_I, int_const(0), insn->op[2], empty_operand());
+                stats->immediates++;
+            }
+            break;
+
+        case NOT: case NEG:
+            if (known_a && fold_operation(insn->form, a, 0, &result)) {
+                ILOCInsn_rewrite(insn, LOAD_I, int_const(result), insn->op[1], empty_operand());
+                stats->folded++;
+            }
+            break;
+
+        case I2I:
+            if (known_a && insn->op[1].type == VIRTUAL_REG) {
+                ILOCInsn_rewrite(insn, LOAD_I, int_const(a), insn->op[1], empty_operand());
+                stats->propagated++;
+            }
+            break;
+
+        case CBR:
+            if (known_a) {
+                ILOCInsn_rewrite(insn, JUMP, (a != 0 ? insn->op[1] : insn->op[2]),
+                        empty_operand(), empty_operand());
+                stats->branches++;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Fold constants within each block of a function
+ */
+void fold_function (ControlFlowGraph* cfg, ConstantFoldingStats* stats)
+{
+    ConstantTable table;
+    table.regs = RegisterIndex_new(cfg);
+    table.value = (long*)malloc((table.regs->num_regs + 1) * sizeof(long));
+    table.stamp = (int*)calloc(table.regs->num_regs + 1, sizeof(int));
+    CHECK_MALLOC_PTR(table.value);
+    CHECK_MALLOC_PTR(table.stamp);
+    table.epoch = 0;
+
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        table.epoch++;
+        for (int i = cfg->blocks[b].first; i < cfg->blocks[b].end; i++) {
+            ILOCInsn* insn = cfg->insns[i];
+            if (insn == NULL) {
+                continue;
+            }
+            if (insn->form == CALL) {
+                table.epoch++;
+                continue;
+            }
+            fold_insn(&table, insn, stats);
+            ConstantTable_update(&table, insn);
+        }
+    }
+
+    free(table.stamp);
+    free(table.value);
+    RegisterIndex_free(table.regs);
+}
+
+/**
+ * @brief Test whether an instruction loads a constant
+ */
+bool ILOCInsn_is_load_constant (ILOCInsn* insn)
+{
+    return insn->form == LOAD_I;
+}
+
+void fold_constants (InsnList* program, ConstantFoldingStats* stats)
+{
+    ConstantFoldingStats local_stats = { 0, 0, 0, 0, 0 };
+    if (stats == NULL) {
+        stats = &local_stats;
+    }
+    InsnVector* code = InsnVector_from_list(program);
+
+    CFGList* cfgs = build_cfgs(code);
+    FOR_EACH(ControlFlowGraph*, cfg, cfgs) {
+        fold_function(cfg, stats);
+    }
+    CFGList_free(cfgs);
+
+    /* resolved branches change the CFG, so liveness needs new ones; it only
+     * covers one function, so skip functions that pass values to others in
+     * registers */
+    cfgs = build_cfgs(code);
+    CallGraph* graph = CallGraph_new(cfgs);
+    for (int f = 0; f < graph->num_funcs; f++) {
+        if (!graph->shares_registers[f]) {
+            stats->removed += remove_dead_code(code, graph->funcs[f], ILOCInsn_is_load_constant);
+        }
+    }
+    CallGraph_free(graph);
+    CFGList_free(cfgs);
+
+    InsnList* result = InsnVector_to_list(code);
+    InsnList_splice(program, result);
+    InsnList_free(result);
+    InsnVector_free(code);
+}
@@ -0,0 +1,489 @@
+#include <limits.h>
+
+#include "dataflow.h"
+
+void bitset_add (uint64_t* set, int bit)
+{
+    set[bit / 64] |= (uint64_t)1 << (bit % 64);
+}
+
+void bitset_remove (uint64_t* set, int bit)
+{
+    set[bit / 64] &= ~((uint64_t)1 << (bit % 64));
+}
+
+bool bitset_contains (uint64_t* set, int bit)
+{
+    return (set[bit / 64] >> (bit % 64)) & 1;
+}
+
+/**
+ * @brief Allocate zeroed storage for one set per block
+ */
+uint64_t* DataflowProblem_alloc_sets (DataflowProblem* problem)
+{
+    uint64_t* sets = (uint64_t*)calloc((size_t)problem->cfg->num_blocks * problem->words + 1,
+            sizeof(uint64_t));
+    CHECK_MALLOC_PTR(sets);
+    return sets;
+}
+
+DataflowProblem* DataflowProblem_new (ControlFlowGraph* cfg, int num_bits,
+        DataflowDirection direction, DataflowMeet meet)
+{
+    DataflowProblem* problem = (DataflowProblem*)calloc(1, sizeof(DataflowProblem));
+    CHECK_MALLOC_PTR(problem);
+    problem->cfg = cfg;
+    problem->direction = direction;
+    problem->meet = meet;
+    problem->num_bits = num_bits;
+    problem->words = (num_bits + 63) / 64;
+    problem->gen = DataflowProblem_alloc_sets(problem);
+    problem->kill = DataflowProblem_alloc_sets(problem);
+    problem->in = DataflowProblem_alloc_sets(problem);
+    problem->out = DataflowProblem_alloc_sets(problem);
+    problem->boundary = (uint64_t*)calloc(problem->words + 1, sizeof(uint64_t));
+    CHECK_MALLOC_PTR(problem->boundary);
+    return problem;
+}
+
+uint64_t* DataflowProblem_set (DataflowProblem* problem, uint64_t* sets, int block)
+{
+    return &sets[(size_t)block * problem->words];
+}
+
+/**
+ * @brief Set every fact in a set
+ */
+void DataflowProblem_fill (DataflowProblem* problem, uint64_t* set)
+{
+    for (int w = 0; w < problem->words; w++) {
+        set[w] = ~(uint64_t)0;
+    }
+    if (problem->num_bits % 64 != 0) {
+        set[problem->words - 1] = ((uint64_t)1 << (problem->num_bits % 64)) - 1;
+    }
+}
+
+/**
+ * @brief Combine one incoming set into another
+ */
+void DataflowProblem_meet (DataflowProblem* problem, uint64_t* dest, uint64_t* src)
+{
+    for (int w = 0; w < problem->words; w++) {
+        dest[w] = (problem->meet == DATAFLOW_UNION ? dest[w] | src[w] : dest[w] & src[w]);
+    }
+}
+
+void DataflowProblem_solve (DataflowProblem* problem)
+{
+    ControlFlowGraph* cfg = problem->cfg;
+    int nb = cfg->num_blocks;
+    bool forward = (problem->direction == DATAFLOW_FORWARD);
+    uint64_t* inputs  = (forward ? problem->in  : problem->out);
+    uint64_t* outputs = (forward ? problem->out : problem->in);
+
+    /* visit order: RPO (reversed for backward problems), with unreachable
+     * blocks last */
+    int* order = (int*)malloc(nb * sizeof(int));
+    bool* pending = (bool*)malloc(nb * sizeof(bool));
+    CHECK_MALLOC_PTR(order);
+    CHECK_MALLOC_PTR(pending);
+    int count = 0;
+    for (int i = 0; i < cfg->num_reachable; i++) {
+        order[count++] = cfg->rpo[forward ? i : cfg->num_reachable - 1 - i];
+    }
+    for (int b = 0; b < nb; b++) {
+        if (cfg->blocks[b].rpo < 0) {
+            order[count++] = b;
+        }
+        pending[b] = true;
+    }
+
+    /* start from the top of the lattice */
+    for (int b = 0; b < nb; b++) {
+        uint64_t* output = DataflowProblem_set(problem, outputs, b);
+        if (problem->meet == DATAFLOW_INTERSECTION) {
+            DataflowProblem_fill(problem, output);
+        } else {
+            memcpy(output, DataflowProblem_set(problem, problem->gen, b), problem->words * sizeof(uint64_t));
+        }
+    }
+
+    uint64_t* value = (uint64_t*)malloc((problem->words + 1) * sizeof(uint64_t));
+    CHECK_MALLOC_PTR(value);
+    int num_pending = nb;
+    while (num_pending > 0) {
+        for (int i = 0; i < nb; i++) {
+            int b = order[i];
+            if (!pending[b]) {
+                continue;
+            }
+            pending[b] = false;
+            num_pending--;
+            problem->iterations++;
+
+            /* combine the facts flowing in */
+            BasicBlock* block = &cfg->blocks[b];
+            int num_sources = (forward ? block->num_preds : block->num_succs);
+            int* sources = (forward ? block->preds : block->succs);
+            bool boundary = (forward ? b == 0 : block->num_succs == 0);
+            uint64_t* input = DataflowProblem_set(problem, inputs, b);
+            if (boundary) {
+                memcpy(input, problem->boundary, problem->words * sizeof(uint64_t));
+            } else if (num_sources > 0 && problem->meet == DATAFLOW_INTERSECTION) {
+                DataflowProblem_fill(problem, input);
+            } else {
+                memset(input, 0, problem->words * sizeof(uint64_t));
+            }
+            for (int s = 0; s < num_sources; s++) {
+                DataflowProblem_meet(problem, input, DataflowProblem_set(problem, outputs, sources[s]));
+            }
+
+            /* apply the transfer function */
+            uint64_t* gen = DataflowProblem_set(problem, problem->gen, b);
+            uint64_t* kill = DataflowProblem_set(problem, problem->kill, b);
+            uint64_t* output = DataflowProblem_set(problem, outputs, b);
+            bool changed = false;
+            for (int w = 0; w < problem->words; w++) {
+                value[w] = gen[w] | (input[w] & ~kill[w]);
+                changed = changed || (value[w] != output[w]);
+            }
+            if (!changed) {
+                continue;
+            }
+            memcpy(output, value, problem->words * sizeof(uint64_t));
+            int num_targets = (forward ? block->num_succs : block->num_preds);
+            int* targets = (forward ? block->succs : block->preds);
+            for (int t = 0; t < num_targets; t++) {
+                if (!pending[targets[t]]) {
+                    pending[targets[t]] = true;
+                    num_pending++;
+                }
+            }
+        }
+    }
+
+    free(value);
+    free(pending);
+    free(order);
+}
+
+void DataflowProblem_free (DataflowProblem* problem)
+{
+    free(problem->gen);
+    free(problem->kill);
+    free(problem->in);
+    free(problem->out);
+    free(problem->boundary);
+    free(problem);
+}
+
+/**
+ * @brief Look up the registers read (@c uses) and written (last element of
+ * @c uses, or @c NULL) by an instruction
+ *
+ * @returns Number of registers read
+ */
+int ILOCInsn_get_operands (ILOCInsn* insn, Operand** uses)
+{
+    int num_uses = ILOCInsn_get_uses(insn, uses);
+    uses[num_uses] = ILOCInsn_get_def(insn);
+    return num_uses;
+}
+
+RegisterIndex* RegisterIndex_new (ControlFlowGraph* cfg)
+{
+    RegisterIndex* regs = (RegisterIndex*)calloc(1, sizeof(RegisterIndex));
+    CHECK_MALLOC_PTR(regs);
+    regs->min_id = INT_MAX;
+    regs->max_id = -1;
+    int num_refs = 0;
+    for (int i = 0; i < cfg->num_insns; i++) {
+        Operand* ops[MAX_INSN_USES + 1];
+        int num_uses = (cfg->insns[i] != NULL ? ILOCInsn_get_operands(cfg->insns[i], ops) : -1);
+        for (int o = 0; o <= num_uses; o++) {
+            if (ops[o] != NULL && ops[o]->type == VIRTUAL_REG) {
+                regs->min_id = (ops[o]->id < regs->min_id ? ops[o]->id : regs->min_id);
+                regs->max_id = (ops[o]->id > regs->max_id ? ops[o]->id : regs->max_id);
+                num_refs++;
+            }
+        }
+    }
+    if (regs->max_id < 0) {
+        regs->min_id = 0;
+    }
+
+    int range = regs->max_id - regs->min_id + 1;
+    regs->index = (int*)malloc((range + 1) * sizeof(int));
+    regs->regs = (int*)malloc((num_refs + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(regs->index);
+    CHECK_MALLOC_PTR(regs->regs);
+    for (int r = 0; r < range; r++) {
+        regs->index[r] = -1;
+    }
+    for (int i = 0; i < cfg->num_insns; i++) {
+        Operand* ops[MAX_INSN_USES + 1];
+        int num_uses = (cfg->insns[i] != NULL ? ILOCInsn_get_operands(cfg->insns[i], ops) : -1);
+        for (int o = 0; o <= num_uses; o++) {
+            if (ops[o] != NULL && ops[o]->type == VIRTUAL_REG &&
+                    regs->index[ops[o]->id - regs->min_id] < 0) {
+                regs->index[ops[o]->id - regs->min_id] = regs->num_regs;
+                regs->regs[regs->num_regs++] = ops[o]->id;
+            }
+        }
+    }
+    return regs;
+}
+
+int RegisterIndex_lookup (RegisterIndex* regs, Operand* op)
+{
+    if (op == NULL || op->type != VIRTUAL_REG || op->id < regs->min_id || op->id > regs->max_id) {
+        return -1;
+    }
+    return regs->index[op->id - regs->min_id];
+}
+
+void RegisterIndex_free (RegisterIndex* regs)
+{
+    free(regs->index);
+    free(regs->regs);
+    free(regs);
+}
+
+DataflowProblem* Liveness_new (ControlFlowGraph* cfg, RegisterIndex* regs)
+{
+    DataflowProblem* problem = DataflowProblem_new(cfg, regs->num_regs,
+            DATAFLOW_BACKWARD, DATAFLOW_UNION);
+
+    /* gen: upward-exposed reads; kill: writes */
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        uint64_t* gen = DataflowProblem_set(problem, problem->gen, b);
+        uint64_t* kill = DataflowProblem_set(problem, problem->kill, b);
+        for (int i = cfg->blocks[b].first; i < cfg->blocks[b].end; i++) {
+            if (cfg->insns[i] == NULL) {
+                continue;
+            }
+            Operand* ops[MAX_INSN_USES + 1];
+            int num_uses = ILOCInsn_get_operands(cfg->insns[i], ops);
+            for (int u = 0; u < num_uses; u++) {
+                int r = RegisterIndex_lookup(regs, ops[u]);
+                if (r >= 0 && !bitset_contains(kill, r)) {
+                    bitset_add(gen, r);
+                }
+            }
+            int d = RegisterIndex_lookup(regs, ops[num_uses]);
+            if (d >= 0) {
+                bitset_add(kill, d);
+            }
+        }
+    }
+
+    DataflowProblem_solve(problem);
+    return problem;
+}
+
+bool ControlFlowGraph_reads_undefined (ControlFlowGraph* cfg)
+{
+    RegisterIndex* regs = RegisterIndex_new(cfg);
+    DataflowProblem* liveness = Liveness_new(cfg, regs);
+    uint64_t* live_in = DataflowProblem_set(liveness, liveness->in, 0);
+    bool found = false;
+    for (int w = 0; w < liveness->words; w++) {
+        found = found || (live_in[w] != 0);
+    }
+    DataflowProblem_free(liveness);
+    RegisterIndex_free(regs);
+    return found;
+}
+
+bool ILOCInsn_is_pure (ILOCInsn* insn)
+{
+    switch (insn->form) {
+        case ADD: case SUB: case MULT: case AND: case OR:
+        case CMP_LT: case CMP_LE: case CMP_EQ: case CMP_GE: case CMP_GT: case CMP_NE:
+        case ADD_I: case MULT_I: case NOT: case NEG: case LOAD_I: case I2I:
+            return true;
+        case LOAD_AI:
+            return insn->op[0].type == BASE_REG;
+        default:
+            return false;
+    }
+}
+
+int remove_dead_code (InsnVector* code, ControlFlowGraph* cfg, bool (*is_removable)(ILOCInsn* insn))
+{
+    int num_removed = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        RegisterIndex* regs = RegisterIndex_new(cfg);
+        DataflowProblem* liveness = Liveness_new(cfg, regs);
+        uint64_t* live = (uint64_t*)malloc((liveness->words + 1) * sizeof(uint64_t));
+        CHECK_MALLOC_PTR(live);
+
+        for (int b = 0; b < cfg->num_blocks; b++) {
+            memcpy(live, DataflowProblem_set(liveness, liveness->out, b), liveness->words * sizeof(uint64_t));
+            for (int i = cfg->blocks[b].end - 1; i >= cfg->blocks[b].first; i--) {
+                ILOCInsn* insn = cfg->insns[i];
+                if (insn == NULL) {
+                    continue;
+                }
+                int def = RegisterIndex_lookup(regs, ILOCInsn_get_def(insn));
+                if (def >= 0 && !bitset_contains(live, def) && is_removable(insn)) {
+                    InsnVector_delete(code, (int)(&cfg->insns[i] - code->insns));
+                    num_removed++;
+                    changed = true;
+                    continue;
+                }
+                if (def >= 0) {
+                    bitset_remove(live, def);
+                }
+                Operand* uses[MAX_INSN_USES];
+                int num_uses = ILOCInsn_get_uses(insn, uses);
+                for (int u = 0; u < num_uses; u++) {
+                    int r = RegisterIndex_lookup(regs, uses[u]);
+                    if (r >= 0) {
+                        bitset_add(live, r);
+                    }
+                }
+            }
+        }
+
+        free(live);
+        DataflowProblem_free(liveness);
+        RegisterIndex_free(regs);
+    }
+    return num_removed;
+}
+
+ReachingDefs* ReachingDefs_new (ControlFlowGraph* cfg, RegisterIndex* regs)
+{
+    ReachingDefs* defs = (ReachingDefs*)calloc(1, sizeof(ReachingDefs));
+    CHECK_MALLOC_PTR(defs);
+    defs->regs = regs;
+
+    /* number definitions so that those of each register are adjacent */
+    defs->first_def = (int*)calloc(regs->num_regs + 1, sizeof(int));
+    defs->def_of_insn = (int*)malloc((cfg->num_insns + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(defs->first_def);
+    CHECK_MALLOC_PTR(defs->def_of_insn);
+    for (int i = 0; i < cfg->num_insns; i++) {
+        int r = (cfg->insns[i] != NULL ? RegisterIndex_lookup(regs, ILOCInsn_get_def(cfg->insns[i])) : -1);
+        if (r >= 0) {
+            defs->first_def[r + 1]++;
+            defs->num_defs++;
+        }
+    }
+    for (int r = 0; r < regs->num_regs; r++) {
+        defs->first_def[r + 1] += defs->first_def[r];
+    }
+    int* next_def = (int*)malloc((regs->num_regs + 1) * sizeof(int));
+    defs->def_insn = (int*)malloc((defs->num_defs + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(next_def);
+    CHECK_MALLOC_PTR(defs->def_insn);
+    memcpy(next_def, defs->first_def, regs->num_regs * sizeof(int));
+    for (int i = 0; i < cfg->num_insns; i++) {
+        int r = (cfg->insns[i] != NULL ? RegisterIndex_lookup(regs, ILOCInsn_get_def(cfg->insns[i])) : -1);
+        defs->def_of_insn[i] = (r >= 0 ? next_def[r]++ : -1);
+        if (r >= 0) {
+            defs->def_insn[defs->def_of_insn[i]] = i;
+        }
+    }
+    free(next_def);
+
+    DataflowProblem* problem = DataflowProblem_new(cfg, defs->num_defs + regs->num_regs,
+            DATAFLOW_FORWARD, DATAFLOW_UNION);
+    defs->problem = problem;
+    for (int r = 0; r < regs->num_regs; r++) {
+        bitset_add(problem->boundary, defs->num_defs + r);
+    }
+
+    /* gen: last definition of each register in the block; kill: every
+     * definition of each register written in the block */
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        uint64_t* gen = DataflowProblem_set(problem, problem->gen, b);
+        uint64_t* kill = DataflowProblem_set(problem, problem->kill, b);
+        for (int i = cfg->blocks[b].first; i < cfg->blocks[b].end; i++) {
+            if (defs->def_of_insn[i] < 0) {
+                continue;
+            }
+            int r = RegisterIndex_lookup(regs, ILOCInsn_get_def(cfg->insns[i]));
+            for (int d = defs->first_def[r]; d < defs->first_def[r + 1]; d++) {
+                bitset_add(kill, d);
+            }
+            bitset_add(kill, defs->num_defs + r);
+            ReachingDefs_step(defs, gen, i);
+        }
+    }
+
+    DataflowProblem_solve(problem);
+    return defs;
+}
+
+void ReachingDefs_step (ReachingDefs* defs, uint64_t* set, int index)
+{
+    int def = defs->def_of_insn[index];
+    if (def < 0) {
+        return;
+    }
+    int r = RegisterIndex_lookup(defs->regs, ILOCInsn_get_def(defs->problem->cfg->insns[index]));
+    for (int d = defs->first_def[r]; d < defs->first_def[r + 1]; d++) {
+        bitset_remove(set, d);
+    }
+    bitset_remove(set, defs->num_defs + r);
+    bitset_add(set, def);
+}
+
+void ReachingDefs_free (ReachingDefs* defs)
+{
+    DataflowProblem_free(defs->problem);
+    free(defs->def_insn);
+    free(defs->def_of_insn);
+    free(defs->first_def);
+    free(defs);
+}
+
+int check_uninitialized_reads (InsnVector* program, FILE* output)
+{
+    int num_warnings = 0;
+    CFGList* cfgs = build_cfgs(program);
+    FOR_EACH(ControlFlowGraph*, cfg, cfgs) {
+        RegisterIndex* regs = RegisterIndex_new(cfg);
+        ReachingDefs* defs = ReachingDefs_new(cfg, regs);
+        DataflowProblem* problem = defs->problem;
+        uint64_t* current = (uint64_t*)malloc((problem->words + 1) * sizeof(uint64_t));
+        CHECK_MALLOC_PTR(current);
+
+        /* unreachable code cannot read anything */
+        for (int k = 0; k < cfg->num_reachable; k++) {
+            int b = cfg->rpo[k];
+            memcpy(current, DataflowProblem_set(problem, problem->in, b), problem->words * sizeof(uint64_t));
+            for (int i = cfg->blocks[b].first; i < cfg->blocks[b].end; i++) {
+                if (cfg->insns[i] == NULL) {
+                    continue;
+                }
+                Operand* uses[MAX_INSN_USES];
+                int num_uses = ILOCInsn_get_uses(cfg->insns[i], uses);
+                for (int u = 0; u < num_uses; u++) {
+                    int r = RegisterIndex_lookup(regs, uses[u]);
+                    bool repeated = (u > 0 && uses[u - 1]->type == VIRTUAL_REG && uses[u - 1]->id == uses[u]->id);
+                    if (r >= 0 && !repeated && bitset_contains(current, defs->num_defs + r)) {
+                        fprintf(output, "WARNING: Potential uninitialized read from register r%d in %s: ",
+                                uses[u]->id, (cfg->name != NULL ? cfg->name : "(no function)"));
+                        ILOCInsn_print(cfg->insns[i], output);
+                        fprintf(output, "\n");
+                        num_warnings++;
+                    }
+                }
+                ReachingDefs_step(defs, current, i);
+            }
+        }
+
+        free(current);
+        ReachingDefs_free(defs);
+        RegisterIndex_free(regs);
+    }
+    CFGList_free(cfgs);
+    return num_warnings;
+}
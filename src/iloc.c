@@ -1,4 +1,76 @@
 #include "iloc.h"
+#include "jit.h"
+#include "profile.h"
+#include "trace.h"
+
+/**
+ * @brief Hash a string (32-bit FNV-1a)
+ */
+uint32_t hash_string (const char* string)
+{
+    uint32_t hash = 2166136261u;
+    for (const char* c = string; *c != '\0'; c++) {
+        hash ^= (uint8_t)*c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * string intern table (open addressing with a power-of-two capacity)
+ */
+
+typedef struct InternTable
+{
+    char** strings;     /**< @brief Slots (@c NULL if empty) */
+    uint32_t capacity;  /**< @brief Number of slots */
+    uint32_t size;      /**< @brief Number of strings */
+} InternTable;
+
+InternTable intern_table = { NULL, 0, 0 };
+
+/**
+ * @brief Find the slot for a string (either the one containing it or the
+ * empty slot where it belongs)
+ */
+char** InternTable_probe (char** strings, uint32_t capacity, const char* string)
+{
+    uint32_t mask = capacity - 1;
+    uint32_t slot = hash_string(string) & mask;
+    while (strings[slot] != NULL && strcmp(strings[slot], string) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return &strings[slot];
+}
+
+const char* intern_string (const char* string)
+{
+    InternTable* table = &intern_table;
+    if ((table->size + 1) * 2 > table->capacity) {
+        /* grow (load factor of at most 1/2) and re-insert everything */
+        uint32_t capacity = (table->capacity > 0 ? table->capacity * 2 : 256);
+        char** strings = (char**)calloc(capacity, sizeof(char*));
+        CHECK_MALLOC_PTR(strings);
+        for (uint32_t i = 0; i < table->capacity; i++) {
+            if (table->strings[i] != NULL) {
+                *InternTable_probe(strings, capacity, table->strings[i]) = table->strings[i];
+            }
+        }
+        free(table->strings);
+        table->strings = strings;
+        table->capacity = capacity;
+    }
+
+    char** slot = InternTable_probe(table->strings, table->capacity, string);
+    if (*slot == NULL) {
+        *slot = (char*)malloc(strlen(string) + 1);
+        CHECK_MALLOC_PTR(*slot);
+        strcpy(*slot, string);
+        table->size++;
+    }
+    return *slot;
+}
+
 
 /*
  * ILOC operands
@@ -50,9 +122,7 @@ Operand anonymous_label ()
 
 Operand call_label (const char* label)
 {
-    Operand op;
-    op.type = CALL_LABEL;
-    snprintf(op.str, MAX_LINE_LEN, "%s", label);
+    Operand op = { .type = CALL_LABEL, .str = intern_string(label) };
     return op;
 }
 
@@ -64,9 +134,7 @@ Operand int_const (long integer)
 
 Operand str_const (const char* string)
 {
-    Operand op;
-    op.type = STR_CONST;
-    snprintf(op.str, MAX_LINE_LEN, "%s", string);
+    Operand op = { .type = STR_CONST, .str = intern_string(string) };
     return op;
 }
 
@@ -96,14 +164,13 @@ void Operand_print (Operand op, FILE* output)
 
 ILOCInsn* ILOCInsn_new_3op (InsnForm form, Operand op1, Operand op2, Operand op3)
 {
-    ILOCInsn* insn = (ILOCInsn*)calloc(1, sizeof(ILOCInsn));
-    CHECK_MALLOC_PTR(insn)
+    ILOCInsn* insn = (ILOCInsn*)arena_calloc(sizeof(ILOCInsn));
     insn->form = form;
     insn->op[0] = op1;
     insn->op[1] = op2;
     insn->op[2] = op3;
     insn->next = NULL;          /* not strictly necessary b/c of the calloc */
-    insn->comment[0] = '\0';    /* not strictly necessary b/c of the calloc */
+    insn->comment = NULL;       /* not strictly necessary b/c of the calloc */
     return insn;
 }
 
@@ -124,13 +191,12 @@ ILOCInsn* ILOCInsn_new_0op (InsnForm form)
 
 void ILOCInsn_set_comment (ILOCInsn* insn, const char* comment)
 {
-    snprintf(insn->comment, MAX_LINE_LEN, "%s", comment);
+    insn->comment = intern_string(comment);
 }
 
 ILOCInsn* ILOCInsn_copy (ILOCInsn* insn)
 {
-    ILOCInsn* new_insn = (ILOCInsn*)calloc(1, sizeof(ILOCInsn));
-    CHECK_MALLOC_PTR(new_insn)
+    ILOCInsn* new_insn = (ILOCInsn*)arena_calloc(sizeof(ILOCInsn));
     new_insn->form = insn->form;
     new_insn->op[0] = insn->op[0];
     new_insn->op[1] = insn->op[1];
@@ -196,6 +262,48 @@ void ILOCInsn_print (ILOCInsn* insn, FILE* output)
     }
 }
 
+const char* InsnForm_to_string (InsnForm form)
+{
+    switch ((int)form) {
+        case ADD:       return "add";
+        case SUB:       return "sub";
+        case MULT:      return "mult";
+        case DIV:       return "div";
+        case AND:       return "and";
+        case OR:        return "or";
+        case LOAD_I:    return "loadI";
+        case LOAD:      return "load";
+        case LOAD_AI:   return "loadAI";
+        case LOAD_AO:   return "loadAO";
+        case STORE:     return "store";
+        case STORE_AI:  return "storeAI";
+        case STORE_AO:  return "storeAO";
+        case NOP:       return "nop";
+        case I2I:       return "i2i";
+        case JUMP:      return "jump";
+        case CBR:       return "cbr";
+        case CMP_LT:    return "cmp_LT";
+        case CMP_LE:    return "cmp_LE";
+        case CMP_EQ:    return "cmp_EQ";
+        case CMP_GE:    return "cmp_GE";
+        case CMP_GT:    return "cmp_GT";
+        case CMP_NE:    return "cmp_NE";
+        case ADD_I:     return "addI";
+        case MULT_I:    return "multI";
+        case NOT:       return "not";
+        case NEG:       return "neg";
+        case PUSH:      return "push";
+        case POP:       return "pop";
+        case LABEL:     return "label";
+        case CALL:      return "call";
+        case RETURN:    return "return";
+        case PRINT:     return "print";
+        case PHI:       return "phi";
+        case HALT:      return "halt";
+        default:        return "???";
+    }
+}
+
 int ILOCInsn_get_operand_count (ILOCInsn* insn)
 {
     int count = 0;
@@ -207,83 +315,130 @@ int ILOCInsn_get_operand_count (ILOCInsn* insn)
     return count;
 }
 
-ILOCInsn* ILOCInsn_get_read_registers (ILOCInsn* insn)
-{
-    ILOCInsn* ret = ILOCInsn_new_0op(NOP);
-    switch (insn->form)
-    {
-        case STORE_AO:
-            ret->op[0] = insn->op[0];
-            ret->op[1] = insn->op[1];
-            ret->op[2] = insn->op[2];
-            break;
+#define U OPERAND_USE
+#define D OPERAND_DEF
+#define C OPERAND_CONST
+#define T OPERAND_TARGET
 
-        case ADD: case SUB: case MULT: case DIV: case AND: case OR:
-        case CMP_LT: case CMP_LE: case CMP_EQ: case CMP_NE: case CMP_GE: case CMP_GT:
-        case LOAD_AO: case STORE: case STORE_AI:
-        case PHI:
-            ret->op[0] = insn->op[0];
-            ret->op[1] = insn->op[1];
-            break;
+/**
+ * @brief Operand roles for each instruction form (unlisted slots are unused)
+ */
+const OperandRole insn_operand_roles[PHI + 1][3] = {
+    [ADD]      = { U, U, D },  [SUB]      = { U, U, D },  [MULT]     = { U, U, D },
+    [DIV]      = { U, U, D },  [AND]      = { U, U, D },  [OR]       = { U, U, D },
+    [CMP_LT]   = { U, U, D },  [CMP_LE]   = { U, U, D },  [CMP_EQ]   = { U, U, D },
+    [CMP_GE]   = { U, U, D },  [CMP_GT]   = { U, U, D },  [CMP_NE]   = { U, U, D },
+    [ADD_I]    = { U, C, D },  [MULT_I]   = { U, C, D },  [PHI]      = { U, U, D },
+    [NOT]      = { U, D    },  [NEG]      = { U, D    },  [I2I]      = { U, D    },
+    [LOAD_I]   = { C, D    },  [LOAD]     = { U, D    },
+    [LOAD_AI]  = { U, C, D },  [LOAD_AO]  = { U, U, D },
+    [STORE]    = { U, U    },  [STORE_AI] = { U, U, C },  [STORE_AO] = { U, U, U },
+    [PUSH]     = { U       },  [POP]      = { D       },  [PRINT]    = { U       },
+    [JUMP]     = { T       },  [CBR]      = { U, T, T },  [CALL]     = { T       },
+    [LABEL]    = { OPERAND_LABEL },
+};
+
+#undef U
+#undef D
+#undef C
+#undef T
+
+OperandRole InsnForm_operand_role (InsnForm form, int index)
+{
+    if ((int)form < 0 || (int)form > PHI || index < 0 || index >= 3) {
+        return OPERAND_UNUSED;
+    }
+    return insn_operand_roles[form][index];
+}
 
-        case ADD_I: case MULT_I:
-        case LOAD: case LOAD_AI: case I2I:
-        case CBR: case NOT: case NEG: case PUSH:
-        case PRINT:
-            if (insn->op[0].type == VIRTUAL_REG ||
-                insn->op[0].type == STACK_REG ||
-                insn->op[0].type == BASE_REG ||
-                insn->op[0].type == RETURN_REG)
-            {
-                ret->op[0] = insn->op[0];
-            }
+/**
+ * @brief Test whether an operand is a register
+ */
+bool Operand_is_register (Operand op)
+{
+    return (op.type == VIRTUAL_REG || op.type == STACK_REG ||
+            op.type == BASE_REG    || op.type == RETURN_REG);
+}
 
-        default:
-            break;
+int ILOCInsn_get_uses (ILOCInsn* insn, Operand** uses)
+{
+    int count = 0;
+    if ((int)insn->form < 0 || (int)insn->form > PHI) {
+        return 0;
+    }
+    const OperandRole* roles = insn_operand_roles[insn->form];
+    for (int i = 0; i < 3; i++) {
+        if (roles[i] == OPERAND_USE && Operand_is_register(insn->op[i])) {
+            uses[count++] = &insn->op[i];
+        }
     }
+    return count;
+}
 
-    return ret;
+Operand* ILOCInsn_get_def (ILOCInsn* insn)
+{
+    if ((int)insn->form < 0 || (int)insn->form > PHI) {
+        return NULL;
+    }
+    const OperandRole* roles = insn_operand_roles[insn->form];
+    for (int i = 0; i < 3; i++) {
+        if (roles[i] == OPERAND_DEF) {
+            return &insn->op[i];
+        }
+    }
+    return NULL;
 }
 
-Operand ILOCInsn_get_write_register (ILOCInsn* insn)
+bool ILOCInsn_is_frame_setup (ILOCInsn* insn)
 {
-    switch (insn->form)
-    {
-        case ADD: case SUB: case MULT: case DIV: case AND: case OR:
-        case CMP_LT: case CMP_LE: case CMP_EQ: case CMP_NE: case CMP_GE: case CMP_GT:
-        case ADD_I: case MULT_I:
-        case LOAD_AI: case LOAD_AO:
-        case PHI:
-            return insn->op[2];
+    return insn != NULL && insn->form == I2I &&
+           insn->op[0].type == STACK_REG && insn->op[1].type == BASE_REG;
+}
 
-        case LOAD: case LOAD_I:
-        case NOT: case NEG:
-        case I2I:
-            return insn->op[1];
+bool ILOCInsn_is_frame_teardown (ILOCInsn* insn)
+{
+    return insn != NULL && insn->form == I2I &&
+           insn->op[0].type == BASE_REG && insn->op[1].type == STACK_REG;
+}
 
-        case POP:
-            return insn->op[0];
+bool ILOCInsn_is_stack_adjust (ILOCInsn* insn)
+{
+    return insn != NULL && insn->form == ADD_I && insn->op[0].type == STACK_REG &&
+           insn->op[1].type == INT_CONST && insn->op[2].type == STACK_REG;
+}
 
-        default:
-            return empty_operand();
+ILOCInsn* ILOCInsn_get_read_registers (ILOCInsn* insn)
+{
+    ILOCInsn* ret = ILOCInsn_new_0op(NOP);
+    Operand* uses[MAX_INSN_USES];
+    int count = ILOCInsn_get_uses(insn, uses);
+    for (int i = 0; i < count; i++) {
+        ret->op[i] = *uses[i];
     }
+    return ret;
+}
+
+Operand ILOCInsn_get_write_register (ILOCInsn* insn)
+{
+    Operand* def = ILOCInsn_get_def(insn);
+    return (def != NULL ? *def : empty_operand());
 }
 
 void ILOCInsn_free (ILOCInsn* insn)
 {
-    free(insn);
+    arena_release(insn);
 }
 
-DEF_LIST_IMPL(Insn, ILOCInsn*, ILOCInsn_free)
+DEF_ARENA_LIST_IMPL(Insn, ILOCInsn*, ILOCInsn_free)
 
 void InsnList_print (InsnList* list, FILE* output)
 {
     FOR_EACH(ILOCInsn*, i, list) {
         if (i->form != LABEL) {
-            printf("  ");
+            fprintf(output, "  ");
         }
         ILOCInsn_print(i, output);
-        if (i->comment[0] != '\0') {
+        if (i->comment != NULL) {
             fprintf(output, "  ; %s", i->comment);
         }
         fprintf(output, "\n");
@@ -430,10 +585,27 @@ void ASTNode_copy_code (ASTNode* dest, ASTNode* src)
     }
 }
 
+void ASTNode_move_code (ASTNode* dest, ASTNode* src)
+{
+    /* ensure there's a code attribute in the destination (create if absent) */
+    if (!ASTNode_has_attribute(dest, "code")) {
+        ASTNode_set_printable_attribute(dest, "code", InsnList_new(),
+                (AttributeValueDOTPrinter)insnlist_attr_print, (Destructor)InsnList_free);
+    }
+
+    /* make sure there's actually something to move */
+    if (!ASTNode_has_attribute(src, "code")) {
+        return;
+    }
+
+    /* relink the source instructions onto the end of the destination */
+    InsnList_splice(ASTNode_get_attribute(dest, "code"), ASTNode_get_attribute(src, "code"));
+}
+
 void ASTNode_emit_insn (ASTNode* dest, ILOCInsn* insn)
 {
     if (!ASTNode_has_attribute(dest, "code")) {
-        ASTNode_set_printable_attribute(dest, "code", (void*)NodeList_new(),
+        ASTNode_set_printable_attribute(dest, "code", (void*)InsnList_new(),
                 (AttributeValueDOTPrinter)insnlist_attr_print, (Destructor)InsnList_free);
     }
     InsnList* list = ASTNode_get_attribute(dest, "code");
@@ -474,63 +646,369 @@ Operand ASTNode_get_temp_reg (ASTNode* node)
  * ILOC machine simulator
  */
 
-#if WORD_SIZE == 4
-    typedef int32_t word_t;
-    #define PRIW "%" PRId32
-#else
-    typedef int64_t word_t;
-    #define PRIW "%" PRId64
-#endif
-typedef uint8_t byte_t;
+CallTargetTable* CallTargetTable_new (int num_targets)
+{
+    CallTargetTable* table = (CallTargetTable*)calloc(1, sizeof(CallTargetTable));
+    CHECK_MALLOC_PTR(table);
 
-#define UNINIT_REG       (-9999999)
+    /* power-of-two capacity with a load factor of at most 1/2 */
+    table->capacity = 4;
+    while (table->capacity < num_targets * 2) {
+        table->capacity *= 2;
+    }
+    table->entries = (CallTarget*)calloc(table->capacity, sizeof(CallTarget));
+    CHECK_MALLOC_PTR(table->entries);
+    table->size = 0;
+    return table;
+}
 
 /**
- * @brief Information about call targets (i.e., functions)
- * 
- * This information is prefetched with a single pass over the instruction
- * before it is simulated.
+ * @brief Find the slot for a name (either the one containing it or the empty
+ * slot where it belongs)
  */
-typedef struct CallTarget
+CallTarget* CallTargetTable_probe (CallTargetTable* table, const char* name)
 {
-    /**
-     * @brief Function name
-     */
-    char name[MAX_TOKEN_LEN];
+    uint32_t mask = table->capacity - 1;
+    uint32_t slot = hash_string(name) & mask;
+    while (table->entries[slot].name != NULL &&
+           !token_str_eq(table->entries[slot].name, name)) {
+        slot = (slot + 1) & mask;
+    }
+    return &table->entries[slot];
+}
 
-    /**
-     * @brief Pointer to corresponding label "instruction"
-     */
-    ILOCInsn* insn;
-    
-    /**
-     * @brief Next call target (if stored in a list)
-     */
-    struct CallTarget* next;
+void CallTargetTable_add (CallTargetTable* table, const char* name, int index)
+{
+    if ((table->size + 1) * 2 > table->capacity) {
+        /* grow and re-insert everything */
+        CallTargetTable* bigger = CallTargetTable_new(table->size + 1);
+        for (int i = 0; i < table->capacity; i++) {
+            if (table->entries[i].name != NULL) {
+                *CallTargetTable_probe(bigger, table->entries[i].name) = table->entries[i];
+            }
+        }
+        free(table->entries);
+        table->entries = bigger->entries;
+        table->capacity = bigger->capacity;
+        free(bigger);
+    }
+
+    /* if a function is defined more than once, the first definition wins */
+    CallTarget* target = CallTargetTable_probe(table, name);
+    if (target->name == NULL) {
+        target->name = name;
+        target->index = index;
+        table->size++;
+    }
+}
+
+int CallTargetTable_find (CallTargetTable* table, const char* name)
+{
+    CallTarget* target = CallTargetTable_probe(table, name);
+    return (target->name != NULL ? target->index : -1);
+}
+
+void CallTargetTable_free (CallTargetTable* table)
+{
+    free(table->entries);
+    free(table);
+}
+
+/**
+ * @brief Decode a register operand into a register file index
+ *
+ * @returns Register file index (or -1 if the operand is not a valid register)
+ */
+int decode_register (Operand op)
+{
+    switch (op.type) {
+        case STACK_REG:  return REG_SP;
+        case BASE_REG:   return REG_BP;
+        case RETURN_REG: return REG_RET;
+        case VIRTUAL_REG:
+            return (op.id >= 0 && op.id < MAX_VIRTUAL_REGS ? FIRST_VIRTUAL_REG + op.id : -1);
+        default:
+            return -1;
+    }
+}
+
+DecodedProgram* DecodedProgram_new (InsnList* program)
+{
+    DecodedProgram* decoded = (DecodedProgram*)calloc(1, sizeof(DecodedProgram));
+    CHECK_MALLOC_PTR(decoded);
+    decoded->size = InsnList_size(program);
+    decoded->code = (DecodedInsn*)calloc(decoded->size + 1, sizeof(DecodedInsn));
+    CHECK_MALLOC_PTR(decoded->code);
+    decoded->source = (ILOCInsn**)calloc(decoded->size + 1, sizeof(ILOCInsn*));
+    CHECK_MALLOC_PTR(decoded->source);
+
+    /* size the register file and jump target table from the highest IDs used */
+    int i = 0;
+    int num_functions = 0;
+    int num_labels = 0;
+    decoded->num_regs = FIRST_VIRTUAL_REG;
+    FOR_EACH (ILOCInsn*, insn, program) {
+        decoded->source[i++] = insn;
+        for (int j = 0; j < 3; j++) {
+            int reg = decode_register(insn->op[j]);
+            if (reg >= decoded->num_regs) {
+                decoded->num_regs = reg + 1;
+            }
+        }
+        if (insn->form == LABEL) {
+            if (insn->op[0].type == JUMP_LABEL) {
+                if (insn->op[0].id >= num_labels) {
+                    num_labels = insn->op[0].id + 1;
+                }
+            } else {
+                num_functions++;
+            }
+        }
+    }
+
+    /* build jump and call target indices */
+    int* jump_targets = (int*)malloc((num_labels + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(jump_targets);
+    for (i = 0; i < num_labels; i++) {
+        jump_targets[i] = -1;
+    }
+    for (i = 0; i < decoded->size; i++) {
+        ILOCInsn* insn = decoded->source[i];
+        if (insn->form == LABEL && insn->op[0].type == JUMP_LABEL && insn->op[0].id >= 0) {
+            jump_targets[insn->op[0].id] = i + 1;
+        }
+    }
+    decoded->call_targets = CallTargetTable_new(num_functions);
+    for (i = 0; i < decoded->size; i++) {
+        ILOCInsn* insn = decoded->source[i];
+        if (insn->form == LABEL && insn->op[0].type == CALL_LABEL) {
+            CallTargetTable_add(decoded->call_targets, insn->op[0].str, i);
+        }
+    }
+
+    DecodedProgram_decode(decoded, jump_targets, num_labels);
+    free(jump_targets);
+    return decoded;
+}
+
+void DecodedProgram_decode (DecodedProgram* decoded, int* jump_targets, int num_labels)
+{
+    /* decode operands */
+    int i;
+    for (i = 0; i < decoded->size; i++) {
+        ILOCInsn* insn = decoded->source[i];
+        DecodedInsn* d = &decoded->code[i];
+        d->form = insn->form;
+        d->imm = 0;
+        d->str = NULL;
+        for (int j = 0; j < 3; j++) {
+            Operand op = insn->op[j];
+            switch (op.type) {
+                case JUMP_LABEL:
+                    d->op[j] = (op.id >= 0 && op.id < num_labels ? jump_targets[op.id] : -1);
+                    break;
+                case INT_CONST:
+                    d->op[j] = -1;
+                    d->imm = op.imm;
+                    break;
+                case CALL_LABEL:
+                case STR_CONST:
+                    d->op[j] = -1;
+                    d->str = insn->op[j].str;
+                    break;
+                default:
+                    d->op[j] = decode_register(op);
+                    break;
+            }
+        }
+    }
+
+    /* resolve call targets (entry point is the instruction after the label) */
+    for (i = 0; i < decoded->size; i++) {
+        DecodedInsn* d = &decoded->code[i];
+        if (d->form == CALL && d->str != NULL) {
+            int target = CallTargetTable_find(decoded->call_targets, d->str);
+            d->op[0] = (target >= 0 ? target + 1 : -1);
+        }
+    }
+
+    /* sentinel instruction past the end of the program */
+    decoded->code[decoded->size].form = HALT;
+}
+
+void DecodedProgram_free (DecodedProgram* program)
+{
+    CallTargetTable_free(program->call_targets);
+    free(program->code);
+    free(program->source);
+    free(program);
+}
+
+/**
+ * @brief Entry in the superinstruction table
+ */
+typedef struct FusionRule
+{
+    InsnForm fused;         /**< @brief Superinstruction form */
+    int length;             /**< @brief Number of instructions in the sequence */
+    InsnForm forms[3];      /**< @brief Forms of the sequence */
+} FusionRule;
+
+#define FUSED_PAIR_RULE(A,B,END)     { (InsnForm)FUSED_##A##_##B,       2, { A, B, HALT } },
+#define FUSED_TRIPLE_RULE(A,B,C,END) { (InsnForm)FUSED_##A##_##B##_##C, 3, { A, B, C } },
+
+/* longer sequences first, so that the first match is the longest */
+const FusionRule fusion_rules[] = {
+    FUSED_TRIPLES(FUSED_TRIPLE_RULE)
+    FUSED_PAIRS(FUSED_PAIR_RULE)
+};
+
+#define NUM_FUSION_RULES ((int)(sizeof(fusion_rules) / sizeof(FusionRule)))
+
+InsnForm DecodedProgram_match_fusion (DecodedProgram* program, int index)
+{
+    for (int r = 0; r < NUM_FUSION_RULES; r++) {
+        const FusionRule* rule = &fusion_rules[r];
+        if (index + rule->length > program->size) {
+            continue;
+        }
+        bool match = true;
+        for (int j = 0; j < rule->length && match; j++) {
+            match = (program->code[index + j].form == rule->forms[j]);
+        }
+        if (match) {
+            return rule->fused;
+        }
+    }
+    return HALT;
+}
+
+int DecodedProgram_fuse (DecodedProgram* program)
+{
+    /* match against the original forms so that overlapping sequences are fused too */
+    InsnForm* fused = (InsnForm*)malloc(program->size * sizeof(InsnForm));
+    CHECK_MALLOC_PTR(fused);
+    for (int i = 0; i < program->size; i++) {
+        fused[i] = DecodedProgram_match_fusion(program, i);
+    }
+    int count = 0;
+    for (int i = 0; i < program->size; i++) {
+        if (fused[i] != HALT) {
+            program->code[i].form = fused[i];
+            count++;
+        }
+    }
+    free(fused);
+    return count;
+}
 
-} CallTarget;
+FusionProfile* FusionProfile_new ()
+{
+    FusionProfile* profile = (FusionProfile*)calloc(1, sizeof(FusionProfile));
+    CHECK_MALLOC_PTR(profile);
+    profile->pairs = (long*)calloc(NUM_DECODED_FORMS * NUM_DECODED_FORMS, sizeof(long));
+    CHECK_MALLOC_PTR(profile->pairs);
+    profile->triples = (long*)calloc(NUM_DECODED_FORMS * NUM_DECODED_FORMS * NUM_DECODED_FORMS,
+            sizeof(long));
+    CHECK_MALLOC_PTR(profile->triples);
+    return profile;
+}
 
-DECL_LIST_TYPE(CallTarget, CallTarget*)
-DEF_LIST_IMPL(CallTarget, CallTarget*, free)
+/**
+ * @brief Executed sequence (for sorting the fusion profile)
+ */
+typedef struct FusionProfileEntry
+{
+    long count;
+    int length;
+    InsnForm forms[3];
+} FusionProfileEntry;
 
-void CallTargetList_add_new (CallTargetList* list, const char* name, ILOCInsn* target)
+int FusionProfileEntry_compare (const void* a, const void* b)
 {
-    CallTarget* new_target = (CallTarget*)calloc(1, sizeof(CallTarget));
-    CHECK_MALLOC_PTR(new_target);
-    snprintf(new_target->name, MAX_TOKEN_LEN, "%s", name);
-    new_target->insn = target;
-    CallTargetList_add(list, new_target);
+    const FusionProfileEntry* x = (const FusionProfileEntry*)a;
+    const FusionProfileEntry* y = (const FusionProfileEntry*)b;
+    if (x->count != y->count) {
+        return (x->count < y->count ? 1 : -1);
+    }
+    if (x->length != y->length) {
+        return x->length - y->length;
+    }
+    for (int i = 0; i < x->length; i++) {
+        if (x->forms[i] != y->forms[i]) {
+            return (int)x->forms[i] - (int)y->forms[i];
+        }
+    }
+    return 0;
 }
 
-ILOCInsn* CallTargetList_find (CallTargetList* list, const char* name)
+void FusionProfile_print (FusionProfile* profile, FILE* output, int max_entries)
 {
-    FOR_EACH (CallTarget*, target, list) {
-        if (token_str_eq(target->name, name)) {
-            return target->insn;
+    const int N = NUM_DECODED_FORMS;
+
+    /* collect all executed sequences */
+    int num_entries = 0;
+    for (int i = 0; i < N * N; i++) {
+        num_entries += (profile->pairs[i] > 0 ? 1 : 0);
+    }
+    for (int i = 0; i < N * N * N; i++) {
+        num_entries += (profile->triples[i] > 0 ? 1 : 0);
+    }
+    FusionProfileEntry* entries = (FusionProfileEntry*)calloc(num_entries + 1,
+            sizeof(FusionProfileEntry));
+    CHECK_MALLOC_PTR(entries);
+    int n = 0;
+    for (int i = 0; i < N * N; i++) {
+        if (profile->pairs[i] > 0) {
+            FusionProfileEntry e = { profile->pairs[i], 2,
+                { (InsnForm)(i / N), (InsnForm)(i % N), HALT } };
+            entries[n++] = e;
+        }
+    }
+    for (int i = 0; i < N * N * N; i++) {
+        if (profile->triples[i] > 0) {
+            FusionProfileEntry e = { profile->triples[i], 3,
+                { (InsnForm)(i / (N * N)), (InsnForm)(i / N % N), (InsnForm)(i % N) } };
+            entries[n++] = e;
+        }
+    }
+    qsort(entries, num_entries, sizeof(FusionProfileEntry), FusionProfileEntry_compare);
+
+    /* print the most frequent ones along with the matching table entry (if any) */
+    fprintf(output, "FUSION PROFILE (%ld instructions executed)\n", profile->executed);
+    fprintf(output, "%12s  %-32s %s\n", "EXECUTED", "SEQUENCE", "FUSED (SITES)");
+    for (int i = 0; i < num_entries && i < max_entries; i++) {
+        char sequence[64] = "";
+        for (int j = 0; j < entries[i].length; j++) {
+            if (j > 0) {
+                strncat(sequence, " + ", sizeof(sequence) - strlen(sequence) - 1);
+            }
+            strncat(sequence, InsnForm_to_string(entries[i].forms[j]),
+                    sizeof(sequence) - strlen(sequence) - 1);
+        }
+        fprintf(output, "%12ld  %-32s ", entries[i].count, sequence);
+        const FusionRule* rule = NULL;
+        for (int r = 0; r < NUM_FUSION_RULES && rule == NULL; r++) {
+            if (fusion_rules[r].length == entries[i].length &&
+                    memcmp(fusion_rules[r].forms, entries[i].forms,
+                           entries[i].length * sizeof(InsnForm)) == 0) {
+                rule = &fusion_rules[r];
+            }
+        }
+        if (rule != NULL) {
+            fprintf(output, "yes (%d)\n", profile->sites[rule->fused]);
+        } else {
+            fprintf(output, "no\n");
         }
     }
-    printf("ERROR: No call target found for '%s'\n", name);
-    exit(EXIT_FAILURE);
+    free(entries);
+}
+
+void FusionProfile_free (FusionProfile* profile)
+{
+    free(profile->pairs);
+    free(profile->triples);
+    free(profile);
 }
 
 /**
@@ -539,118 +1017,75 @@ ILOCInsn* CallTargetList_find (CallTargetList* list, const char* name)
 typedef struct ILOCMachine
 {
     /**
-     * @brief Virtual/physical register values
+     * @brief Register values (SP, BP, and RET followed by the virtual/physical
+     * registers)
      */
-    word_t reg[MAX_VIRTUAL_REGS];
+    word_t* reg;
 
     /**
-     * @brief Program counter (pointer to next instruction to execute)
+     * @brief Number of registers (sized for the program)
      */
-    ILOCInsn* pc;
+    int num_regs;
 
     /**
-     * @brief Stack pointer value
-     */
-    word_t sp;
-    
-    /**
-     * @brief Base pointer value
+     * @brief Program counter (index of next instruction to execute)
      */
-    word_t bp;
+    int pc;
 
     /**
-     * @brief Function return value
+     * @brief Program address space (memory w/ global variables and stack)
      */
-    word_t ret;
+    byte_t* mem;
 
     /**
-     * @brief Program address space (memory w/ global variables and stack)
+     * @brief Size of the address space in bytes
      */
-    byte_t mem[MEM_SIZE];
+    int mem_size;
 
     /**
-     * @brief List of program instructions (i.e., code)
+     * @brief Decoded program instructions (i.e., code)
      * 
      * Note that instructions are NOT stored in the program's "address space."
      */
-    ILOCInsn* instructions[MAX_INSTRUCTIONS];
-
-    /**
-     * @brief Jump targets (instrution pointers indexed by jump label IDs)
-     */
-    ILOCInsn* jump_targets[MAX_INSTRUCTIONS];
-
-    /**
-     * @brief Call targets (list of string label and instruction pointer pairs)
-     */
-    CallTargetList* call_targets;
+    DecodedProgram* program;
 
 } ILOCMachine;
 
-ILOCMachine* ILOCMachine_new()
+ILOCMachine* ILOCMachine_new(DecodedProgram* program, int mem_size)
 {
     ILOCMachine* machine = (ILOCMachine*)calloc(1, sizeof(ILOCMachine));
     CHECK_MALLOC_PTR(machine);
+    machine->program = program;
 
     /* set all registers to special "uninitialized" value (helps find code gen bugs) */
-    for (int i = 0; i < MAX_VIRTUAL_REGS; i++) {
+    machine->num_regs = program->num_regs;
+    machine->reg = (word_t*)malloc(machine->num_regs * sizeof(word_t));
+    CHECK_MALLOC_PTR(machine->reg);
+    for (int i = 0; i < machine->num_regs; i++) {
         machine->reg[i] = UNINIT_REG;
     }
-    machine->sp = machine->bp = machine->ret = UNINIT_REG;
 
-    /* initialize call target list */
-    machine->call_targets = CallTargetList_new();
+    /* zero-filled memory is supplied by the allocator, so large address
+     * spaces are only paged in as they are used */
+    machine->mem_size = mem_size;
+    machine->mem = (byte_t*)calloc(mem_size, sizeof(byte_t));
+    CHECK_MALLOC_PTR(machine->mem);
 
     /* everything else can stay zero/NULL from the calloc */
     return machine;
 }
 
-void ILOCMachine_set_reg(ILOCMachine* machine, Operand op, word_t value)
+word_t ILOCMachine_get_reg(ILOCMachine* machine, int idx)
 {
-    switch (op.type) {
-        case STACK_REG:  machine->sp  = value; break;
-        case BASE_REG:   machine->bp  = value; break;
-        case RETURN_REG: machine->ret = value; break;
-        case VIRTUAL_REG:
-            if (op.id < 0 || op.id > MAX_VIRTUAL_REGS) {
-                printf("ERROR: Register r%d does not exist\n", op.id);
-                exit(EXIT_FAILURE);
-            }
-            machine->reg[op.id] = value;
-            break;
-        default:
-            printf("ERROR: Cannot write register using a non-register operand: ");
-            Operand_print(op, stdout);
-            printf("\n");
-            break;
-    }
-}
-
-word_t ILOCMachine_get_reg(ILOCMachine* machine, Operand op)
-{
-    switch (op.type) {
-        case STACK_REG:  return machine->sp;
-        case BASE_REG:   return machine->bp;
-        case RETURN_REG: return machine->ret;
-        case VIRTUAL_REG:
-            if (op.id < 0 || op.id > MAX_VIRTUAL_REGS) {
-                printf("ERROR: Register r%d does not exist\n", op.id);
-                exit(EXIT_FAILURE);
-            } else if (machine->reg[op.id] == UNINIT_REG) {
-                printf("WARNING: Potential uninitialized read from register r%d\n", op.id);
-            }
-            return machine->reg[op.id];
-        default:
-            printf("ERROR: Cannot read register using a non-register operand: ");
-            Operand_print(op, stdout);
-            printf("\n");
-            exit(EXIT_FAILURE);
+    if (idx >= FIRST_VIRTUAL_REG && machine->reg[idx] == UNINIT_REG) {
+        printf("WARNING: Potential uninitialized read from register r%d\n", idx - FIRST_VIRTUAL_REG);
     }
+    return machine->reg[idx];
 }
 
 void ILOCMachine_set_mem(ILOCMachine* machine, int address, word_t value)
 {
-    if (address < 0 || address > MEM_SIZE - WORD_SIZE) {
+    if (address < 0 || address > machine->mem_size - WORD_SIZE) {
         printf("ERROR: Address %d is invalid (out of range)\n", address);
         exit(EXIT_FAILURE);
     }
@@ -660,7 +1095,7 @@ void ILOCMachine_set_mem(ILOCMachine* machine, int address, word_t value)
 
 word_t ILOCMachine_get_mem(ILOCMachine* machine, int address)
 {
-    if (address < 0 || address > MEM_SIZE - WORD_SIZE) {
+    if (address < 0 || address > machine->mem_size - WORD_SIZE) {
         printf("ERROR: Address %d is invalid (out of range)\n", address);
         exit(EXIT_FAILURE);
     }
@@ -668,31 +1103,32 @@ word_t ILOCMachine_get_mem(ILOCMachine* machine, int address)
     return *(word_t*)(machine->mem + address);
 }
 
-void ILOCMachine_print(ILOCMachine* machine, FILE* output)
+void print_machine_state (word_t* reg, int num_regs, byte_t* mem, int mem_size, FILE* output)
 {
     fprintf(output, "==========================\n");
 
     /* registers (special and virtual) */
-    fprintf(output, "sp=" PRIW " bp=" PRIW " ret=" PRIW "\n", machine->sp, machine->bp, machine->ret);
+    fprintf(output, "sp=" PRIW " bp=" PRIW " ret=" PRIW "\n",
+            reg[REG_SP], reg[REG_BP], reg[REG_RET]);
     fprintf(output, "virtual regs: ");
-    for (int i = 0; i < MAX_VIRTUAL_REGS; i++) {
-        if (machine->reg[i] != UNINIT_REG) {
-            fprintf(output, " r%d=" PRIW, i, machine->reg[i]);
+    for (int i = FIRST_VIRTUAL_REG; i < num_regs; i++) {
+        if (reg[i] != UNINIT_REG) {
+            fprintf(output, " r%d=" PRIW, i - FIRST_VIRTUAL_REG, reg[i]);
         }
     }
     fprintf(output, "\n");
     
-    /* stack (memory from MEM_SIZE down to stack pointer) */
+    /* stack (memory from the top of the address space down to stack pointer) */
     fprintf(output, "stack:");
-    for (int addr = MEM_SIZE - WORD_SIZE; addr >= machine->sp; addr -= WORD_SIZE) {
-        fprintf(output, "  %d: " PRIW, addr, ILOCMachine_get_mem(machine, addr));
+    for (int addr = mem_size - WORD_SIZE; addr >= reg[REG_SP] && addr >= 0; addr -= WORD_SIZE) {
+        fprintf(output, "  %d: " PRIW, addr, *(word_t*)(mem + addr));
     }
     fprintf(output, "\n");
 
     /* other memory (any WORD_SIZE-aligned value that is non-zero) */
     fprintf(output, "other memory:");
-    for (int addr = STATIC_VAR_OFFSET; addr < machine->sp; addr += WORD_SIZE) {
-        word_t value = ILOCMachine_get_mem(machine, addr);
+    for (int addr = STATIC_VAR_OFFSET; addr < reg[REG_SP] && addr <= mem_size - WORD_SIZE; addr += WORD_SIZE) {
+        word_t value = *(word_t*)(mem + addr);
         if (value != 0) {
             fprintf(output, "  %d: " PRIW, addr, value);
         }
@@ -702,9 +1138,15 @@ void ILOCMachine_print(ILOCMachine* machine, FILE* output)
     fprintf(output, "==========================\n");
 }
 
+void ILOCMachine_print(ILOCMachine* machine, FILE* output)
+{
+    print_machine_state(machine->reg, machine->num_regs, machine->mem, machine->mem_size, output);
+}
+
 void ILOCMachine_free(ILOCMachine* machine)
 {
-    CallTargetList_free(machine->call_targets);
+    free(machine->reg);
+    free(machine->mem);
     free(machine);
 }
 
@@ -884,192 +1326,509 @@ void assert_valid_insn (ILOCInsn* insn)
     }
 }
 
+void InsnList_verify (InsnList* list)
+{
+    FOR_EACH(ILOCInsn*, insn, list) {
+        assert_valid_insn(insn);
+    }
+}
+
+void DecodedProgram_verify_insn (DecodedProgram* program, int index)
+{
+    ILOCInsn* insn = program->source[index];
+    DecodedInsn* d = &program->code[index];
+
+    /* operand shapes */
+    assert_valid_insn(insn);
+
+    /* register ranges, jump labels, and call targets */
+    for (int i = 0; i < 3; i++) {
+        Operand op = insn->op[i];
+        if (op.type == VIRTUAL_REG && d->op[i] < 0) {
+            printf("ERROR: Register r%d does not exist\n", op.id);
+            exit(EXIT_FAILURE);
+        } else if (op.type == JUMP_LABEL && insn->form != LABEL && d->op[i] < 0) {
+            printf("ERROR: No jump target found for 'l%d'\n", op.id);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (insn->form == CALL && d->op[0] < 0) {
+        printf("ERROR: No call target found for '%s'\n", d->str);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void DecodedProgram_verify (DecodedProgram* program)
+{
+    for (int i = 0; i < program->size; i++) {
+        DecodedProgram_verify_insn(program, i);
+    }
+}
+
+/*
+ * threaded dispatch relies on the GNU "labels as values" extension
+ */
+#if defined(__GNUC__) && !defined(ILOC_NO_THREADED_DISPATCH)
+#define HAVE_THREADED_DISPATCH
+#endif
+
+bool threaded_dispatch_available ()
+{
+#ifdef HAVE_THREADED_DISPATCH
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SimulatorOptions_init (SimulatorOptions* options)
+{
+    options->print_trace = false;
+    options->paranoid = false;
+    options->dispatch = (threaded_dispatch_available() ? THREADED_DISPATCH : SWITCH_DISPATCH);
+    options->jit = false;
+    options->unchecked = false;
+    options->fuse = true;
+    options->fusion_profile = NULL;
+    options->profile = NULL;
+    options->trace = NULL;
+    options->mem_size = MEM_SIZE;
+    options->num_executed = 0;
+}
+
 /*
  * shortcut macros to make the simulator code cleaner
  */
 
-#define OP0    (machine->pc->op[0])
-#define OP1    (machine->pc->op[1])
-#define OP2    (machine->pc->op[2])
-#define IMMOP0 (machine->pc->op[0].imm)
-#define IMMOP1 (machine->pc->op[1].imm)
-#define IMMOP2 (machine->pc->op[2].imm)
-#define STROP0 (machine->pc->op[0].str)
+#define INSN   (code[pc])
+#define IMM    (INSN.imm)
+#define STR    (INSN.str)
 
-#define SET_REG(OP,VAL)   ILOCMachine_set_reg(machine, (OP), (VAL))
-#define GET_REG(OP)       ILOCMachine_get_reg(machine, (OP))
+#define SET_REG(I,VAL)    machine->reg[INSN.op[I]] = (VAL)
+#define GET_REG(I)        ILOCMachine_get_reg(machine, INSN.op[I])
 #define SET_MEM(ADDR,VAL) ILOCMachine_set_mem(machine, (ADDR), (VAL))
 #define GET_MEM(ADDR)     ILOCMachine_get_mem(machine, (ADDR))
 
-#define PUSH(VAL)   machine->sp -= WORD_SIZE; \
-                    if (machine->sp <= STATIC_VAR_OFFSET) { \
+#define SP (machine->reg[REG_SP])
+
+#define PUSH(VAL)   SP -= WORD_SIZE; \
+                    if (SP <= STATIC_VAR_OFFSET) { \
                         printf("ERROR: Stack overflow\n"); \
                         exit(EXIT_FAILURE); \
                     } \
-                    ILOCMachine_set_mem(machine, machine->sp, (VAL));
+                    ILOCMachine_set_mem(machine, SP, (VAL));
 
-#define POP(LOC)    if (machine->sp > MEM_SIZE - WORD_SIZE) { \
+#define POP(LOC)    if (SP > machine->mem_size - WORD_SIZE) { \
                         printf("ERROR: Cannot pop from empty stack\n"); \
                         exit(EXIT_FAILURE); \
                     } \
-                    *(LOC) = ILOCMachine_get_mem(machine, machine->sp); \
-                    machine->sp += WORD_SIZE;
+                    *(LOC) = ILOCMachine_get_mem(machine, SP); \
+                    SP += WORD_SIZE;
 
-#define TIMEOUT_NUM_INSTRUCTIONS 100000000
+#define JUMP_TO(I)  pc = INSN.op[I];
 
-int run_simulator (InsnList* program, bool print_trace)
-{
-    /* initialize machine */
-    ILOCMachine* machine = ILOCMachine_new();
-    machine->sp = MEM_SIZE;
+/*
+ * The timeout is only checked on control transfers; any infinite loop has to
+ * pass through one, and straight-line code cannot run away.
+ */
+#define CHECK_TIMEOUT() \
+    if (executed > TIMEOUT_NUM_INSTRUCTIONS) { \
+        fprintf(stderr, "TIMEOUT: Program executed too many instructions (probably an infinite loop)"); \
+        exit(EXIT_FAILURE); \
+    }
 
-    /* build jump and call target indices */
-    int i = 0;
-    FOR_EACH (ILOCInsn*, insn, program) {
-        machine->instructions[i++] = insn;
-        if (insn->form == LABEL) {
-            if (insn->op[0].type == JUMP_LABEL) {
-                machine->jump_targets[insn->op[0].id] = insn;
-            } else {
-                CallTargetList_add_new(machine->call_targets, insn->op[0].str, insn);
-            }
-        }
+#define TRACE() \
+    if (INSN.form != HALT) { \
+        printf("\n"); \
+        ILOCMachine_print(machine, stdout); \
+        printf("\nExecuting: "); \
+        ILOCInsn_print(program->source[pc], stdout); \
+        printf("\n"); \
     }
 
-    /* search for main and begin there */
-    machine->pc = CallTargetList_find(machine->call_targets, "main")->next;
+/*
+ * in paranoid mode, the load-time verification is repeated for every executed
+ * instruction (including checking return addresses)
+ */
+#define CHECK_PC() \
+    if (pc < 0 || pc > program->size) { \
+        printf("ERROR: Invalid instruction index %d\n", pc); \
+        exit(EXIT_FAILURE); \
+    }
 
-    /* main program loop */
-    int num_instructions_executed = 0;
-    while (machine->pc != NULL) {
+#define VALIDATE() \
+    if (INSN.form != HALT) { \
+        DecodedProgram_verify_insn(program, pc); \
+    }
 
-        /* assumes no jumps; may be overwritten later */
-        ILOCInsn* next_insn = machine->pc->next;
+/*
+ * sequences are only counted if control falls through from one instruction to
+ * the next (i.e., if they could have been fused)
+ */
+#define PROFILE() \
+    if (INSN.form != HALT) { \
+        const int N = NUM_DECODED_FORMS; \
+        if (pc == prev_pc + 1 && !ends_block) { \
+            profile->pairs[prev_form * N + INSN.form]++; \
+            if (straight_line > 1) { \
+                profile->triples[(prev_prev_form * N + prev_form) * N + INSN.form]++; \
+            } \
+            straight_line++; \
+        } else { \
+            straight_line = 1; \
+        } \
+        ends_block = (INSN.form == JUMP || INSN.form == CBR || \
+                      INSN.form == CALL || INSN.form == RETURN); \
+        prev_prev_form = prev_form; \
+        prev_form = INSN.form; \
+        prev_pc = pc; \
+        profile->executed++; \
+    }
 
-        /* print trace debug info if desired */
-        if (print_trace) {
-            printf("\n");
-            ILOCMachine_print(machine, stdout);
-            printf("\nExecuting: ");
-            ILOCInsn_print(machine->pc, stdout);
-            printf("\n");
-        }
+#define HOOK() \
+    if (paranoid) { \
+        CHECK_PC(); \
+    } \
+    if (options->print_trace) { \
+        TRACE(); \
+    } \
+    if (paranoid) { \
+        VALIDATE(); \
+    } \
+    if (profile != NULL) { \
+        PROFILE(); \
+    } \
+    if (exec_profile != NULL && INSN.form != HALT) { \
+        ExecutionProfile_record(exec_profile, program, pc); \
+    } \
+    if (trace != NULL) { \
+        TraceBuffer_record(trace, program, pc); \
+    }
 
-        /* verify that current instruction is valid */
-        assert_valid_insn(machine->pc);
+/*
+ * Every handler is reachable both as a switch case and (if supported) as a
+ * label for threaded dispatch. Handlers end with NEXT (fall through to the
+ * next instruction) or DISPATCH (after explicitly setting the pc). In threaded
+ * mode, each handler has its own indirect jump to the next handler; otherwise
+ * control goes back to the central switch. Per-instruction debugging work
+ * (tracing and paranoid checks) is done in a separate hook so that it costs
+ * nothing when disabled; the program has already been verified at load time.
+ */
+#ifdef HAVE_THREADED_DISPATCH
+#define CASE(F)     case F: do_##F:
+#define DISPATCH()  if (threaded) { \
+                        goto *table[INSN.form]; \
+                    } \
+                    goto dispatch_switch
+#else
+#define CASE(F)     case F:
+#define DISPATCH()  goto dispatch_switch
+#endif
+
+#define NEXT        pc++; executed++; DISPATCH()
+#define TRANSFER    executed++; CHECK_TIMEOUT(); DISPATCH()
+
+/*
+ * Instruction semantics, shared by the regular and the fused handlers. A fused
+ * handler runs the bodies of its sequence back to back, stepping the pc (and
+ * instruction count) in between but skipping dispatch.
+ */
+#define BODY_LOAD_I     SET_REG(1, IMM)
+#define BODY_LOAD       SET_REG(1, GET_MEM(GET_REG(0)))
+#define BODY_LOAD_AI    SET_REG(2, GET_MEM(GET_REG(0) + IMM))
+#define BODY_LOAD_AO    SET_REG(2, GET_MEM(GET_REG(0) + GET_REG(1)))
+#define BODY_STORE      SET_MEM(GET_REG(1),              GET_REG(0))
+#define BODY_STORE_AI   SET_MEM(GET_REG(1) + IMM,        GET_REG(0))
+#define BODY_STORE_AO   SET_MEM(GET_REG(1) + GET_REG(2), GET_REG(0))
+
+#define BODY_ADD        SET_REG(2, GET_REG(0) +  GET_REG(1))
+#define BODY_SUB        SET_REG(2, GET_REG(0) -  GET_REG(1))
+#define BODY_MULT       SET_REG(2, GET_REG(0) *  GET_REG(1))
+#define BODY_DIV        SET_REG(2, GET_REG(0) /  GET_REG(1))
+#define BODY_AND        SET_REG(2, GET_REG(0) &  GET_REG(1))
+#define BODY_OR         SET_REG(2, GET_REG(0) |  GET_REG(1))
+#define BODY_CMP_LT     SET_REG(2, GET_REG(0) <  GET_REG(1))
+#define BODY_CMP_LE     SET_REG(2, GET_REG(0) <= GET_REG(1))
+#define BODY_CMP_EQ     SET_REG(2, GET_REG(0) == GET_REG(1))
+#define BODY_CMP_NE     SET_REG(2, GET_REG(0) != GET_REG(1))
+#define BODY_CMP_GE     SET_REG(2, GET_REG(0) >= GET_REG(1))
+#define BODY_CMP_GT     SET_REG(2, GET_REG(0) >  GET_REG(1))
+
+#define BODY_ADD_I      SET_REG(2, GET_REG(0) + IMM)
+#define BODY_MULT_I     SET_REG(2, GET_REG(0) * IMM)
+
+#define BODY_I2I        SET_REG(1,    GET_REG(0) )
+#define BODY_NOT        SET_REG(1, ((~GET_REG(0))&1))
+#define BODY_NEG        SET_REG(1,  -(GET_REG(0)))
+
+#define BODY_PUSH       PUSH(GET_REG(0))
+
+#define BODY_JUMP       JUMP_TO(0)
+#define BODY_CBR        if ((bool)GET_REG(0)) { \
+                            JUMP_TO(1); \
+                        } else { \
+                            JUMP_TO(2); \
+                        }
+
+#define STEP            pc++; executed++
+
+#define FUSED_PAIR_HANDLER(A,B,END) \
+    CASE(FUSED_##A##_##B) \
+        BODY_##A; STEP; BODY_##B; END;
+
+#define FUSED_TRIPLE_HANDLER(A,B,C,END) \
+    CASE(FUSED_##A##_##B##_##C) \
+        BODY_##A; STEP; BODY_##B; STEP; BODY_##C; END;
+
+#define FUSED_PAIR_ENTRY(A,B,END) \
+    [FUSED_##A##_##B] = &&do_FUSED_##A##_##B,
+
+#define FUSED_TRIPLE_ENTRY(A,B,C,END) \
+    [FUSED_##A##_##B##_##C] = &&do_FUSED_##A##_##B##_##C,
+
+#ifdef HAVE_THREADED_DISPATCH
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+/**
+ * @brief Run a machine (with a loaded program) until it halts
+ *
+ * @param machine Machine to run (pc must be set to the first instruction)
+ * @param options Simulator options
+ * @returns Number of instructions executed
+ */
+long ILOCMachine_run (ILOCMachine* machine, SimulatorOptions* options)
+{
+    DecodedProgram* program = machine->program;
+    DecodedInsn* code = program->code;
+    int pc = machine->pc;
+    long executed = 0;
+    bool paranoid = options->paranoid;
+    FusionProfile* profile = options->fusion_profile;
+    ExecutionProfile* exec_profile = options->profile;
+    TraceBuffer* trace = options->trace;
+    bool hooked = options->print_trace || paranoid || profile != NULL ||
+                  exec_profile != NULL || trace != NULL;
+
+    /* fusion profile state */
+    int prev_pc = -2;
+    bool ends_block = false;
+    InsnForm prev_form = NOP, prev_prev_form = NOP;
+    int straight_line = 0;
+
+#ifdef HAVE_THREADED_DISPATCH
+    static void* const handlers[NUM_DISPATCH_FORMS] = {
+        [ADD]      = &&do_ADD,      [SUB]      = &&do_SUB,      [MULT]     = &&do_MULT,
+        [DIV]      = &&do_DIV,      [AND]      = &&do_AND,      [OR]       = &&do_OR,
+        [LOAD_I]   = &&do_LOAD_I,   [LOAD]     = &&do_LOAD,     [LOAD_AI]  = &&do_LOAD_AI,
+        [LOAD_AO]  = &&do_LOAD_AO,  [STORE]    = &&do_STORE,    [STORE_AI] = &&do_STORE_AI,
+        [STORE_AO] = &&do_STORE_AO, [NOP]      = &&do_NOP,      [I2I]      = &&do_I2I,
+        [JUMP]     = &&do_JUMP,     [CBR]      = &&do_CBR,      [CMP_LT]   = &&do_CMP_LT,
+        [CMP_LE]   = &&do_CMP_LE,   [CMP_EQ]   = &&do_CMP_EQ,   [CMP_GE]   = &&do_CMP_GE,
+        [CMP_GT]   = &&do_CMP_GT,   [CMP_NE]   = &&do_CMP_NE,   [ADD_I]    = &&do_ADD_I,
+        [MULT_I]   = &&do_MULT_I,   [NOT]      = &&do_NOT,      [NEG]      = &&do_NEG,
+        [PUSH]     = &&do_PUSH,     [POP]      = &&do_POP,      [LABEL]    = &&do_LABEL,
+        [CALL]     = &&do_CALL,     [RETURN]   = &&do_RETURN,   [PRINT]    = &&do_PRINT,
+        [PHI]      = &&do_PHI,      [HALT]     = &&do_HALT,
+        FUSED_PAIRS(FUSED_PAIR_ENTRY)
+        FUSED_TRIPLES(FUSED_TRIPLE_ENTRY)
+    };
+    void* hook_table[NUM_DISPATCH_FORMS];
+    for (int i = 0; i < NUM_DISPATCH_FORMS; i++) {
+        hook_table[i] = &&hook;
+    }
+    void* const* table = (hooked ? hook_table : handlers);
+    bool threaded = (options->dispatch == THREADED_DISPATCH);
+    DISPATCH();
+
+hook:
+    HOOK();
+    goto *handlers[INSN.form];
+#else
+    DISPATCH();
+#endif
 
-        /* handle current instruction */
-        switch (machine->pc->form)
+dispatch_switch:
+    if (hooked) {
+        HOOK();
+    }
+    switch ((int)INSN.form)
+    {
+        CASE(LOAD_I)   BODY_LOAD_I;   NEXT;
+        CASE(LOAD)     BODY_LOAD;     NEXT;
+        CASE(LOAD_AI)  BODY_LOAD_AI;  NEXT;
+        CASE(LOAD_AO)  BODY_LOAD_AO;  NEXT;
+        CASE(STORE)    BODY_STORE;    NEXT;
+        CASE(STORE_AI) BODY_STORE_AI; NEXT;
+        CASE(STORE_AO) BODY_STORE_AO; NEXT;
+
+        CASE(ADD)    BODY_ADD;    NEXT;
+        CASE(SUB)    BODY_SUB;    NEXT;
+        CASE(MULT)   BODY_MULT;   NEXT;
+        CASE(DIV)    BODY_DIV;    NEXT;
+        CASE(AND)    BODY_AND;    NEXT;
+        CASE(OR)     BODY_OR;     NEXT;
+        CASE(CMP_LT) BODY_CMP_LT; NEXT;
+        CASE(CMP_LE) BODY_CMP_LE; NEXT;
+        CASE(CMP_EQ) BODY_CMP_EQ; NEXT;
+        CASE(CMP_NE) BODY_CMP_NE; NEXT;
+        CASE(CMP_GE) BODY_CMP_GE; NEXT;
+        CASE(CMP_GT) BODY_CMP_GT; NEXT;
+
+        CASE(ADD_I)  BODY_ADD_I;  NEXT;
+        CASE(MULT_I) BODY_MULT_I; NEXT;
+
+        CASE(I2I)    BODY_I2I;    NEXT;
+        CASE(NOT)    BODY_NOT;    NEXT;
+        CASE(NEG)    BODY_NEG;    NEXT;
+
+        CASE(PUSH)   BODY_PUSH;   NEXT;
+
+        CASE(POP)
         {
-            case LOAD_I:   SET_REG(OP1, IMMOP0);                               break;
-            case LOAD:     SET_REG(OP1, GET_MEM(GET_REG(OP0)));                break;
-            case LOAD_AI:  SET_REG(OP2, GET_MEM(GET_REG(OP0) + IMMOP1));       break;
-            case LOAD_AO:  SET_REG(OP2, GET_MEM(GET_REG(OP0) + GET_REG(OP1))); break;
-            case STORE:    SET_MEM(GET_REG(OP1),                GET_REG(OP0)); break;
-            case STORE_AI: SET_MEM(GET_REG(OP1) + IMMOP2,       GET_REG(OP0)); break;
-            case STORE_AO: SET_MEM(GET_REG(OP1) + GET_REG(OP2), GET_REG(OP0)); break;
-
-            case ADD:    SET_REG(OP2, GET_REG(OP0) +  GET_REG(OP1)); break;
-            case SUB:    SET_REG(OP2, GET_REG(OP0) -  GET_REG(OP1)); break;
-            case MULT:   SET_REG(OP2, GET_REG(OP0) *  GET_REG(OP1)); break;
-            case DIV:    SET_REG(OP2, GET_REG(OP0) /  GET_REG(OP1)); break;
-            case AND:    SET_REG(OP2, GET_REG(OP0) &  GET_REG(OP1)); break;
-            case OR:     SET_REG(OP2, GET_REG(OP0) |  GET_REG(OP1)); break;
-            case CMP_LT: SET_REG(OP2, GET_REG(OP0) <  GET_REG(OP1)); break;
-            case CMP_LE: SET_REG(OP2, GET_REG(OP0) <= GET_REG(OP1)); break;
-            case CMP_EQ: SET_REG(OP2, GET_REG(OP0) == GET_REG(OP1)); break;
-            case CMP_NE: SET_REG(OP2, GET_REG(OP0) != GET_REG(OP1)); break;
-            case CMP_GE: SET_REG(OP2, GET_REG(OP0) >= GET_REG(OP1)); break;
-            case CMP_GT: SET_REG(OP2, GET_REG(OP0) >  GET_REG(OP1)); break;
-
-            case ADD_I:  SET_REG(OP2, GET_REG(OP0) + IMMOP1); break;
-            case MULT_I: SET_REG(OP2, GET_REG(OP0) * IMMOP1); break;
-
-            case I2I:    SET_REG(OP1,    GET_REG(OP0) );    break;
-            case NOT:    SET_REG(OP1, ((~GET_REG(OP0))&1)); break;
-            case NEG:    SET_REG(OP1,  -(GET_REG(OP0)));    break;
-
-            case PUSH:
-                PUSH(GET_REG(OP0));
-                break;
-
-            case POP:
-            {
-                word_t tmp;
-                POP(&tmp);
-                SET_REG(OP0, tmp);
-                break;
-            }
+            word_t tmp;
+            POP(&tmp);
+            SET_REG(0, tmp);
+            NEXT;
+        }
 
-            case JUMP:
-                next_insn = machine->jump_targets[OP0.id]->next;
-                break;
+        CASE(JUMP)   BODY_JUMP;   TRANSFER;
+        CASE(CBR)    BODY_CBR;    TRANSFER;
 
-            case CBR:
-                if ((bool)GET_REG(OP0)) {
-                    next_insn = machine->jump_targets[OP1.id]->next;
-                } else {
-                    next_insn = machine->jump_targets[OP2.id]->next;
-                }
-                break;
+        CASE(CALL)
+            /* return address is simply the index of the next instruction */
+            PUSH((word_t)(pc + 1));
+            pc = INSN.op[0];
+            TRANSFER;
 
-            case CALL:
-            {
-                /* calculate index of next instruction */
-                int idx = 0;
-                for (next_insn = program->head;
-                     next_insn != NULL && next_insn != machine->pc->next;
-                     next_insn = next_insn->next) {
-                    idx++;
-                }
-                PUSH((word_t)idx);
-                next_insn = CallTargetList_find(machine->call_targets, STROP0)->next;
-                break;
+        CASE(RETURN)
+        {
+            if (SP == machine->mem_size) {
+                /* stack is empty, so this must be the return from main() */
+                pc = program->size;
+                TRANSFER;
             }
+            word_t tmp;
+            POP(&tmp);
+            pc = (int)tmp;
+            TRANSFER;
+        }
 
-            case RETURN:
-            {
-                if (machine->sp == MEM_SIZE) {
-                    /* stack is empty, so this must be the return from main() */
-                    next_insn = NULL;
-                    break;
-                }
-                word_t tmp;
-                POP(&tmp);
-                next_insn = machine->instructions[tmp];
-                break;
+        CASE(PRINT)
+            if (STR != NULL) {
+                printf("%s", STR);
+            } else if (INSN.op[0] < 0) {  /* integer constant */
+                printf(PRIW, (word_t)IMM);
+            } else {  /* register */
+                printf(PRIW, GET_REG(0));
             }
+            NEXT;
 
-            case PRINT:
-                if (OP0.type == STR_CONST) {
-                    printf("%s", STROP0);
-                } else {  /* virtual register */
-                    printf(PRIW, GET_REG(OP0));
-                }
-                break;
+        CASE(LABEL)
+        CASE(NOP)
+        CASE(PHI)
+            /* nothing to do */
+            NEXT;
 
-            case LABEL:
-            case NOP:
-            case PHI:
-                /* nothing to do */
-                break;
-        }
+        /* superinstructions (see DecodedProgram_fuse) */
+        FUSED_PAIRS(FUSED_PAIR_HANDLER)
+        FUSED_TRIPLES(FUSED_TRIPLE_HANDLER)
 
-        /* update pc */
-        machine->pc = next_insn;
+        CASE(HALT)
+            break;
+    }
 
-        /* check timeout */
-        num_instructions_executed++;
-        if (num_instructions_executed > TIMEOUT_NUM_INSTRUCTIONS) {
-            fprintf(stderr, "TIMEOUT: Program executed too many instructions (probably an infinite loop)");
-            exit(EXIT_FAILURE);
+    machine->pc = pc;
+    return executed;
+}
+
+#ifdef HAVE_THREADED_DISPATCH
+#pragma GCC diagnostic pop
+#endif
+
+int run_simulator_with_options (InsnList* program, SimulatorOptions* options)
+{
+    DecodedProgram* decoded = DecodedProgram_new(program);
+    int return_value = run_decoded_program(decoded, options);
+    DecodedProgram_free(decoded);
+    return return_value;
+}
+
+void assert_valid_mem_size (int mem_size)
+{
+    if (mem_size % WORD_SIZE != 0 || mem_size <= STATIC_VAR_OFFSET + WORD_SIZE || mem_size > MAX_MEM_SIZE) {
+        printf("ERROR: Invalid memory size %d (must be a multiple of %d between %d and %d)\n",
+                mem_size, WORD_SIZE, STATIC_VAR_OFFSET + 2 * WORD_SIZE, MAX_MEM_SIZE);
+        exit(EXIT_FAILURE);
+    }
+}
+
+int run_decoded_program (DecodedProgram* decoded, SimulatorOptions* options)
+{
+    assert_valid_mem_size(options->mem_size);
+
+    /* verify program and initialize machine */
+    if (!options->paranoid) {
+        DecodedProgram_verify(decoded);
+    }
+
+    /* native execution (debugging and profiling always use the interpreter) */
+    bool hooked = options->print_trace || options->paranoid || options->fusion_profile != NULL ||
+                  options->profile != NULL || options->trace != NULL;
+    if (options->jit && !hooked && jit_available()) {
+        return run_jit(decoded, options);
+    }
+
+    /* superinstructions (debugging and profiling need the original forms) */
+    if (options->fusion_profile != NULL) {
+        for (int i = 0; i < decoded->size; i++) {
+            InsnForm fused = DecodedProgram_match_fusion(decoded, i);
+            if (fused != HALT) {
+                options->fusion_profile->sites[fused]++;
+            }
         }
+    } else if (options->fuse && !hooked) {
+        DecodedProgram_fuse(decoded);
+    }
+
+    ILOCMachine* machine = ILOCMachine_new(decoded, options->mem_size);
+    SP = options->mem_size;
+
+    /* search for main and begin there */
+    int main_index = CallTargetTable_find(decoded->call_targets, "main");
+    if (main_index < 0) {
+        printf("ERROR: No call target found for 'main'\n");
+        exit(EXIT_FAILURE);
+    }
+    machine->pc = main_index + 1;
+
+    /* main program loop */
+    if (options->profile != NULL) {
+        ExecutionProfile_start(options->profile, decoded, machine->pc);
+    }
+    if (options->trace != NULL) {
+        TraceBuffer_start(options->trace, decoded, machine->reg, machine->mem, machine->mem_size);
+    }
+    options->num_executed = ILOCMachine_run(machine, options);
+    if (options->profile != NULL) {
+        ExecutionProfile_finish(options->profile);
+    }
+    if (options->trace != NULL) {
+        TraceBuffer_finish(options->trace);
     }
 
     /* clean up */
-    word_t return_value = machine->ret;
-    CallTargetList_free(machine->call_targets);
-    free(machine);
+    word_t return_value = machine->reg[REG_RET];
+    ILOCMachine_free(machine);
 
     return return_value;
 }
+
+int run_simulator (InsnList* program, bool print_trace)
+{
+    SimulatorOptions options;
+    SimulatorOptions_init(&options);
+    options.print_trace = print_trace;
+    return run_simulator_with_options(program, &options);
+}
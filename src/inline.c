@@ -0,0 +1,640 @@
+#include <limits.h>
+
+#include "inline.h"
+#include "ssa.h"
+
+/**
+ * @brief Stack frame layout of a function
+ */
+typedef struct StackFrame
+{
+    int size;           /**< @brief Bytes of local variables below BP */
+    int alloc;          /**< @brief Index of the prologue's <tt>addI SP</tt> (or -1 if there is none) */
+    int body;           /**< @brief Index of the first instruction after the prologue */
+    int* sp_offset;     /**< @brief SP minus BP before every instruction (or @c INT_MIN if unknown) */
+    bool uses_params;   /**< @brief True if the function accesses its parameters */
+    bool stores_params; /**< @brief True if the function writes its parameters */
+} StackFrame;
+
+/**
+ * @brief Register or label IDs of one copy of a function
+ *
+ * Every copy of a callee is one epoch; IDs first seen in the current epoch
+ * get a fresh ID, so no two copies share registers or labels.
+ */
+typedef struct RenameMap
+{
+    int* ids;           /**< @brief New ID of every original ID */
+    int* stamp;         /**< @brief Epoch in which the new ID was assigned */
+    int capacity;       /**< @brief Number of entries */
+    int epoch;          /**< @brief Current epoch */
+} RenameMap;
+
+/**
+ * @brief Look up the new ID for an original ID (allocating one from
+ * @p next_id if necessary)
+ */
+int RenameMap_lookup (RenameMap* map, int id, int* next_id)
+{
+    if (id >= map->capacity) {
+        int capacity = (id + 1 > 2 * map->capacity ? id + 1 : 2 * map->capacity);
+        map->ids = (int*)realloc(map->ids, capacity * sizeof(int));
+        map->stamp = (int*)realloc(map->stamp, capacity * sizeof(int));
+        CHECK_MALLOC_PTR(map->ids);
+        CHECK_MALLOC_PTR(map->stamp);
+        for (int i = map->capacity; i < capacity; i++) {
+            map->stamp[i] = 0;
+        }
+        map->capacity = capacity;
+    }
+    if (map->stamp[id] != map->epoch) {
+        map->stamp[id] = map->epoch;
+        map->ids[id] = (*next_id)++;
+    }
+    return map->ids[id];
+}
+
+/**
+ * @brief Find the next instruction after index @p i (or @p size if there is
+ * none)
+ */
+int next_insn (ILOCInsn** insns, int size, int i)
+{
+    i++;
+    while (i < size && insns[i] == NULL) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Test whether an epilogue (<tt>i2i BP => SP</tt>, <tt>pop BP</tt>,
+ * @c return) starts at index @p i
+ *
+ * @param end Receives the index of the @c return
+ */
+bool is_epilogue (ILOCInsn** insns, int size, int i, int* end)
+{
+    if (!ILOCInsn_is_frame_teardown(insns[i])) {
+        return false;
+    }
+    int j = next_insn(insns, size, i);
+    if (j >= size || insns[j]->form != POP || insns[j]->op[0].type != BASE_REG) {
+        return false;
+    }
+    *end = next_insn(insns, size, j);
+    return *end < size && insns[*end]->form == RETURN;
+}
+
+/**
+ * @brief Index of the operand that holds the base register of a
+ * @c loadAI or @c storeAI (the offset follows it)
+ */
+int ILOCInsn_base_index (ILOCInsn* insn)
+{
+    return (insn->form == LOAD_AI ? 0 : 1);
+}
+
+/**
+ * @brief Track SP through a function
+ *
+ * @returns False if SP may differ between paths to the same instruction
+ */
+bool StackFrame_track_sp (StackFrame* frame, ControlFlowGraph* cfg)
+{
+    int* entry = (int*)malloc(cfg->num_blocks * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(entry);
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        entry[b] = INT_MIN;
+    }
+    for (int i = 0; i < cfg->num_insns; i++) {
+        frame->sp_offset[i] = INT_MIN;
+    }
+
+    /* the call pushed the return address just above the future BP; every
+     * reachable block but the entry has a predecessor earlier in RPO */
+    entry[0] = WORD_SIZE;
+    bool consistent = true;
+    for (int r = 0; r < cfg->num_reachable && consistent; r++) {
+        BasicBlock* block = &cfg->blocks[cfg->rpo[r]];
+        int offset = entry[cfg->rpo[r]];
+        for (int i = block->first; i < block->end; i++) {
+            ILOCInsn* insn = cfg->insns[i];
+            if (insn == NULL) {
+                continue;
+            }
+            frame->sp_offset[i] = offset;
+            if (insn->form == PUSH) {
+                offset -= WORD_SIZE;
+            } else if (insn->form == POP) {
+                offset += WORD_SIZE;
+            } else if (ILOCInsn_is_stack_adjust(insn)) {
+                offset += (int)insn->op[1].imm;
+            } else if (insn->form == I2I && insn->op[1].type == STACK_REG) {
+                offset = 0;
+            }
+        }
+        for (int s = 0; s < block->num_succs; s++) {
+            int succ = block->succs[s];
+            if (entry[succ] == INT_MIN) {
+                entry[succ] = offset;
+            } else if (entry[succ] != offset) {
+                consistent = false;
+            }
+        }
+    }
+    free(entry);
+    return consistent;
+}
+
+/**
+ * @brief Check that a function follows the standard frame layout and find
+ * its prologue and SP offsets
+ *
+ * @returns True if and only if the frame layout is standard (if so,
+ * @ref StackFrame::sp_offset must be deallocated by the caller)
+ */
+bool StackFrame_analyze (StackFrame* frame, InsnVector* code, const char* name)
+{
+    ILOCInsn** insns = code->insns;
+    int size = code->size;
+    frame->sp_offset = NULL;
+
+    /* label; push BP; i2i SP => BP; optionally addI SP, -size => SP */
+    int i = next_insn(insns, size, -1);
+    if (i >= size || !ILOCInsn_is_call_label(insns[i])) {
+        return false;
+    }
+    i = next_insn(insns, size, i);
+    if (i >= size || insns[i]->form != PUSH || insns[i]->op[0].type != BASE_REG) {
+        return false;
+    }
+    i = next_insn(insns, size, i);
+    if (i >= size || !ILOCInsn_is_frame_setup(insns[i])) {
+        return false;
+    }
+    i = next_insn(insns, size, i);
+    frame->alloc = -1;
+    frame->size = 0;
+    if (i < size && ILOCInsn_is_stack_adjust(insns[i]) && insns[i]->op[1].imm <= 0) {
+        frame->alloc = i;
+        frame->size = (int)-insns[i]->op[1].imm;
+        i = next_insn(insns, size, i);
+    }
+    frame->body = i;
+
+    /* BP only addresses locals and parameters; SP only moves by constants
+     * (or is copied, e.g., to address the parameters of an inlined call) */
+    frame->uses_params = false;
+    frame->stores_params = false;
+    for (; i < size; i = next_insn(insns, size, i)) {
+        ILOCInsn* insn = insns[i];
+        int end;
+        if (is_epilogue(insns, size, i, &end)) {
+            i = end;
+            continue;
+        }
+        if (insn->form == RETURN) {
+            return false;
+        }
+        for (int j = 0; j < 3; j++) {
+            if (insn->op[j].type == BASE_REG) {
+                if ((insn->form != LOAD_AI && insn->form != STORE_AI) || j != ILOCInsn_base_index(insn)) {
+                    return false;
+                }
+                long offset = insn->op[j + 1].imm;
+                if (offset >= PARAM_BP_OFFSET) {
+                    frame->uses_params = true;
+                    frame->stores_params = frame->stores_params || insn->form == STORE_AI;
+                } else if (offset > -WORD_SIZE || offset < -frame->size) {
+                    return false;
+                }
+            } else if (insn->op[j].type == STACK_REG && !ILOCInsn_is_stack_adjust(insn) &&
+                    !(insn->form == I2I && j == 0 && insn->op[1].type == VIRTUAL_REG)) {
+                return false;
+            }
+        }
+    }
+
+    ControlFlowGraph* cfg = ControlFlowGraph_new(name, insns, size);
+    frame->sp_offset = (int*)malloc(size * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(frame->sp_offset);
+    bool consistent = StackFrame_track_sp(frame, cfg);
+    ControlFlowGraph_free(cfg);
+    if (!consistent) {
+        free(frame->sp_offset);
+        frame->sp_offset = NULL;
+    }
+    return consistent;
+}
+
+/**
+ * @brief Functions of the program being inlined
+ */
+typedef struct Inliner
+{
+    InsnVector** code;      /**< @brief Instructions of every function */
+    const char** names;     /**< @brief Name of every function (or @c NULL) */
+    StackFrame* frames;     /**< @brief Frame layout of every function */
+    bool* standard;         /**< @brief Functions with a standard frame layout */
+    bool* inlinable;        /**< @brief Functions that may be inlined */
+    int* body_size;         /**< @brief Instructions of every inlinable function (without prologue and epilogues) */
+    int num_funcs;          /**< @brief Number of functions */
+    IDAllocator ids;        /**< @brief Allocator for registers and labels of the copies */
+    RenameMap regs;         /**< @brief Registers of the current copy */
+    RenameMap labels;       /**< @brief Jump labels of the current copy */
+} Inliner;
+
+/**
+ * @brief Find the argument that a parameter load reads (if the load can be
+ * replaced by a copy of the pushed operand)
+ *
+ * @param frame Frame of the callee
+ * @param insn Instruction of the callee
+ * @param args Operands pushed for each parameter (@c EMPTY if unknown)
+ * @param num_args Number of entries in @p args
+ * @returns Pushed operand (or @c EMPTY if the load must read memory)
+ */
+Operand StackFrame_forwarded_arg (StackFrame* frame, ILOCInsn* insn, Operand* args, int num_args)
+{
+    if (insn->form != LOAD_AI || insn->op[0].type != BASE_REG || frame->stores_params) {
+        return empty_operand();
+    }
+    long offset = insn->op[1].imm - PARAM_BP_OFFSET;
+    if (offset < 0 || offset % WORD_SIZE != 0 || offset / WORD_SIZE >= num_args) {
+        return empty_operand();
+    }
+    return args[offset / WORD_SIZE];
+}
+
+/**
+ * @brief Append a copy of a function's body in place of a call
+ *
+ * @param inliner Inliner state
+ * @param callee Index of the function to copy
+ * @param frame_base Size of the caller's local area (the callee's locals
+ * are placed below it)
+ * @param args Operands pushed for each parameter (@c EMPTY if unknown)
+ * @param num_args Number of entries in @p args
+ * @param output Caller instructions
+ */
+void Inliner_expand (Inliner* inliner, int callee, int frame_base, Operand* args, int num_args,
+        InsnVector* output)
+{
+    InsnVector* code = inliner->code[callee];
+    StackFrame* frame = &inliner->frames[callee];
+    inliner->regs.epoch++;
+    inliner->labels.epoch++;
+    int first = output->size;
+
+    /* the arguments are still pushed, so parameters that are not copied
+     * from the pushed registers are addressed relative to SP */
+    Operand params = empty_operand();
+    for (int i = frame->body; i < code->size && frame->uses_params && params.type == EMPTY; i++) {
+        ILOCInsn* insn = code->insns[i];
+        if (insn != NULL && (insn->form == LOAD_AI || insn->form == STORE_AI) &&
+                insn->op[ILOCInsn_base_index(insn)].type == BASE_REG &&
+                insn->op[ILOCInsn_base_index(insn) + 1].imm >= PARAM_BP_OFFSET &&
+                StackFrame_forwarded_arg(frame, insn, args, num_args).type == EMPTY) {
+            params = register_with_id(inliner->ids.next_reg++);
+            InsnVector_add(output, ILOCInsn_new_2op(I2I, stack_register(), params));
+        }
+    }
+
+    int last = code->size - 1;
+    while (last >= 0 && code->insns[last] == NULL) {
+        last--;
+    }
+    Operand done = empty_operand();
+    for (int i = frame->body; i < code->size; i = next_insn(code->insns, code->size, i)) {
+        ILOCInsn* insn = code->insns[i];
+        int end;
+        if (is_epilogue(code->insns, code->size, i, &end)) {
+            /* pop whatever the body left on the stack, then leave the copy */
+            int offset = frame->sp_offset[i];
+            if (offset != INT_MIN && offset != -frame->size) {
+                InsnVector_add(output, ILOCInsn_new_3op(ADD_I, stack_register(),
+                            int_const(-frame->size - offset), stack_register()));
+            }
+            if (end != last) {
+                if (done.type == EMPTY) {
+                    done.type = JUMP_LABEL;
+                    done.id = inliner->ids.next_label++;
+                }
+                InsnVector_add(output, ILOCInsn_new_1op(JUMP, done));
+            }
+            i = end;
+            continue;
+        }
+
+        ILOCInsn* copy = ILOCInsn_copy(insn);
+        copy->comment = insn->comment;
+        for (int j = 0; j < 3; j++) {
+            if (copy->op[j].type == VIRTUAL_REG) {
+                copy->op[j].id = RenameMap_lookup(&inliner->regs, copy->op[j].id,
+                        &inliner->ids.next_reg);
+            } else if (copy->op[j].type == JUMP_LABEL) {
+                copy->op[j].id = RenameMap_lookup(&inliner->labels, copy->op[j].id,
+                        &inliner->ids.next_label);
+            } else if (copy->op[j].type == BASE_REG) {
+                if (copy->op[j + 1].imm >= PARAM_BP_OFFSET) {
+                    copy->op[j] = params;
+                    copy->op[j + 1].imm -= PARAM_BP_OFFSET;
+                } else {
+                    copy->op[j + 1].imm -= frame_base;
+                }
+            }
+        }
+        Operand arg = StackFrame_forwarded_arg(frame, insn, args, num_args);
+        if (arg.type != EMPTY) {
+            copy->form = (arg.type == INT_CONST ? LOAD_I : I2I);
+            copy->op[0] = arg;
+            copy->op[1] = copy->op[2];
+            copy->op[2] = empty_operand();
+        }
+        InsnVector_add(output, copy);
+    }
+    if (done.type != EMPTY) {
+        InsnVector_add(output, ILOCInsn_new_1op(LABEL, done));
+    }
+
+    if (output->size > first && output->insns[first]->comment == NULL) {
+        char comment[MAX_ID_LEN + 8];
+        snprintf(comment, sizeof(comment), "inlined %s", inliner->names[callee]);
+        ILOCInsn_set_comment(output->insns[first], comment);
+    }
+}
+
+/**
+ * @brief Look up a function by name
+ *
+ * @returns Function index (or -1 if there is no such function)
+ */
+int Inliner_find (Inliner* inliner, const char* name)
+{
+    for (int f = 0; f < inliner->num_funcs; f++) {
+        if (inliner->names[f] != NULL && strcmp(inliner->names[f], name) == 0) {
+            return f;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Find the operands pushed as arguments right before a call
+ *
+ * Pushes are followed backwards from the call as long as the instructions in
+ * between leave SP and the stack alone. An argument whose register is
+ * overwritten before the call (or that is not a register or constant) is
+ * @c EMPTY.
+ *
+ * @param code Instructions of the caller
+ * @param call Index of the call (or of the end of @p code)
+ * @param args Receives the pushed operands (first parameter first)
+ * @returns Number of arguments found
+ */
+int find_pushed_args (InsnVector* code, int call, Operand* args)
+{
+    /* registers written between a push and the call */
+    Operand* written = (Operand*)malloc(call * sizeof(Operand) + 1);
+    CHECK_MALLOC_PTR(written);
+    int num_written = 0;
+    int num_args = 0;
+    for (int i = call - 1; i >= 0; i--) {
+        ILOCInsn* insn = code->insns[i];
+        if (insn == NULL) {
+            continue;
+        }
+        if (insn->form == PUSH) {
+            Operand op = insn->op[0];
+            bool valid = op.type == VIRTUAL_REG || op.type == BASE_REG || op.type == INT_CONST;
+            for (int w = 0; w < num_written && valid; w++) {
+                valid = !(op.type == VIRTUAL_REG && written[w].id == op.id);
+            }
+            args[num_args++] = (valid ? op : empty_operand());
+            continue;
+        }
+        bool local_store = insn->form == STORE_AI && insn->op[1].type == BASE_REG && insn->op[2].imm < 0;
+        if (insn->form == LABEL || insn->form == JUMP || insn->form == CBR || insn->form == CALL ||
+                insn->form == RETURN || insn->form == POP || insn->form == STORE ||
+                insn->form == STORE_AO || (insn->form == STORE_AI && !local_store)) {
+            break;
+        }
+        Operand def = ILOCInsn_get_write_register(insn);
+        if (def.type == STACK_REG || def.type == BASE_REG) {
+            break;
+        } else if (def.type == VIRTUAL_REG) {
+            written[num_written++] = def;
+        }
+    }
+    free(written);
+    return num_args;
+}
+
+/**
+ * @brief Inline the calls of one function (whose callees are final)
+ *
+ * @returns True if any call was inlined
+ */
+bool Inliner_process (Inliner* inliner, int func, InlineStats* stats)
+{
+    InsnVector* code = inliner->code[func];
+    StackFrame* frame = &inliner->frames[func];
+    if (!inliner->standard[func]) {
+        return false;
+    }
+
+    /* pick the calls (SP must be below the locals, so that the callee's
+     * locals fit between them) */
+    int* callee_of = (int*)malloc(code->size * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(callee_of);
+    int size = InsnVector_count(code);
+    int extra = 0;
+    bool found = false;
+    for (int i = 0; i < code->size; i++) {
+        ILOCInsn* insn = code->insns[i];
+        callee_of[i] = -1;
+        if (insn == NULL || insn->form != CALL || frame->sp_offset[i] == INT_MIN ||
+                frame->sp_offset[i] > -frame->size) {
+            continue;
+        }
+        int callee = Inliner_find(inliner, insn->op[0].str);
+        if (callee < 0 || !inliner->inlinable[callee]) {
+            continue;
+        }
+        int callee_size = inliner->body_size[callee];
+        if (size + callee_size > INLINE_MAX_CALLER_SIZE) {
+            stats->over_budget++;
+            continue;
+        }
+        size += callee_size;
+        callee_of[i] = callee;
+        found = true;
+        if (inliner->frames[callee].size > extra) {
+            extra = inliner->frames[callee].size;
+        }
+    }
+    if (!found) {
+        free(callee_of);
+        return false;
+    }
+
+    /* rebuild the function, growing its frame for the callees' locals */
+    InsnVector* output = InsnVector_new();
+    Operand* args = (Operand*)malloc(code->size * sizeof(Operand) + 1);
+    CHECK_MALLOC_PTR(args);
+    for (int i = 0; i < code->size; i++) {
+        ILOCInsn* insn = code->insns[i];
+        if (insn == NULL) {
+            continue;
+        }
+        if (callee_of[i] >= 0) {
+            int num_args = find_pushed_args(output, output->size, args);
+            Inliner_expand(inliner, callee_of[i], frame->size, args, num_args, output);
+            InsnVector_delete(code, i);
+            stats->inlined++;
+            continue;
+        }
+        if (i == frame->alloc) {
+            insn->op[1].imm -= extra;
+        }
+        InsnVector_add(output, insn);
+        code->insns[i] = NULL;
+        if (frame->alloc < 0 && extra > 0 && ILOCInsn_is_frame_setup(insn)) {
+            InsnVector_add(output, ILOCInsn_new_3op(ADD_I, stack_register(), int_const(-extra),
+                        stack_register()));
+        }
+    }
+    InsnVector_free(code);
+    inliner->code[func] = output;
+    free(args);
+    free(callee_of);
+    return true;
+}
+
+/**
+ * @brief Test whether a function can be inlined (after its own calls were)
+ */
+bool Inliner_can_inline (Inliner* inliner, int func)
+{
+    InsnVector* code = inliner->code[func];
+    if (!inliner->standard[func]) {
+        return false;
+    }
+    int size = 0;
+    for (int i = inliner->frames[func].body; i < code->size; i = next_insn(code->insns, code->size, i)) {
+        int end;
+        if (is_epilogue(code->insns, code->size, i, &end)) {
+            i = end;
+        } else {
+            size++;
+        }
+    }
+    inliner->body_size[func] = size;
+    if (size > INLINE_MAX_SIZE) {
+        return false;
+    }
+
+    /* the copy must not fall through past its end */
+    int last = code->size - 1;
+    while (last >= 0 && code->insns[last] == NULL) {
+        last--;
+    }
+    InsnForm form = code->insns[last]->form;
+    if (form != RETURN && form != JUMP && form != CBR) {
+        return false;
+    }
+
+    ControlFlowGraph* cfg = ControlFlowGraph_new(inliner->names[func], code->insns, code->size);
+    bool reads_undefined = ControlFlowGraph_reads_undefined(cfg);
+    ControlFlowGraph_free(cfg);
+    return !reads_undefined;
+}
+
+void inline_functions (InsnList* program, InlineStats* stats)
+{
+    InlineStats local_stats = { 0, 0, 0 };
+    if (stats == NULL) {
+        stats = &local_stats;
+    }
+    InsnVector* program_code = InsnVector_from_list(program);
+    CFGList* cfgs = build_cfgs(program_code);
+    CallGraph* graph = CallGraph_new(cfgs);
+    int n = graph->num_funcs;
+
+    Inliner inliner;
+    inliner.num_funcs = n;
+    inliner.code = (InsnVector**)malloc(n * sizeof(InsnVector*) + 1);
+    inliner.names = (const char**)malloc(n * sizeof(const char*) + 1);
+    inliner.frames = (StackFrame*)calloc(n + 1, sizeof(StackFrame));
+    inliner.standard = (bool*)calloc(n + 1, sizeof(bool));
+    inliner.inlinable = (bool*)calloc(n + 1, sizeof(bool));
+    inliner.body_size = (int*)calloc(n + 1, sizeof(int));
+    bool* candidate = (bool*)calloc(n + 1, sizeof(bool));
+    CHECK_MALLOC_PTR(inliner.code);
+    CHECK_MALLOC_PTR(inliner.names);
+    CHECK_MALLOC_PTR(inliner.frames);
+    CHECK_MALLOC_PTR(inliner.standard);
+    CHECK_MALLOC_PTR(inliner.inlinable);
+    CHECK_MALLOC_PTR(inliner.body_size);
+    CHECK_MALLOC_PTR(candidate);
+    inliner.ids = IDAllocator_init(program_code);
+    RenameMap empty_map = { NULL, NULL, 0, 0 };
+    inliner.regs = empty_map;
+    inliner.labels = empty_map;
+
+    /* move every function into a vector of its own */
+    int* order = CallGraph_postorder(graph);
+    for (int f = 0; f < n; f++) {
+        ControlFlowGraph* cfg = graph->funcs[f];
+        inliner.names[f] = cfg->name;
+        candidate[f] = cfg->name != NULL && !graph->shares_registers[f] && !CallGraph_is_recursive(graph, f);
+        inliner.code[f] = InsnVector_new();
+        for (int i = 0; i < cfg->num_insns; i++) {
+            if (cfg->insns[i] != NULL) {
+                InsnVector_add(inliner.code[f], cfg->insns[i]);
+                cfg->insns[i] = NULL;
+            }
+        }
+    }
+    CallGraph_free(graph);
+    CFGList_free(cfgs);
+    InsnVector_free(program_code);
+
+    /* callees first, so that they are final when they are copied */
+    for (int k = 0; k < n; k++) {
+        int f = order[k];
+        StackFrame* frame = &inliner.frames[f];
+        inliner.standard[f] = inliner.names[f] != NULL &&
+            StackFrame_analyze(frame, inliner.code[f], inliner.names[f]);
+        if (Inliner_process(&inliner, f, stats)) {
+            free(frame->sp_offset);
+            inliner.standard[f] = StackFrame_analyze(frame, inliner.code[f], inliner.names[f]);
+        }
+        inliner.inlinable[f] = candidate[f] && Inliner_can_inline(&inliner, f);
+        if (inliner.inlinable[f]) {
+            stats->inlinable++;
+        }
+    }
+
+    /* reassemble the program in its original order */
+    for (int f = 0; f < n; f++) {
+        InsnList* result = InsnVector_to_list(inliner.code[f]);
+        InsnList_splice(program, result);
+        InsnList_free(result);
+        InsnVector_free(inliner.code[f]);
+        free(inliner.frames[f].sp_offset);
+    }
+    free(inliner.regs.ids);
+    free(inliner.regs.stamp);
+    free(inliner.labels.ids);
+    free(inliner.labels.stamp);
+    free(order);
+    free(candidate);
+    free(inliner.body_size);
+    free(inliner.inlinable);
+    free(inliner.standard);
+    free(inliner.frames);
+    free(inliner.names);
+    free(inliner.code);
+}
@@ -0,0 +1,177 @@
+#include "insnvector.h"
+
+InsnVector* InsnVector_new ()
+{
+    InsnVector* vector = (InsnVector*)calloc(1, sizeof(InsnVector));
+    CHECK_MALLOC_PTR(vector);
+    vector->capacity = INSN_VECTOR_INITIAL_CAPACITY;
+    vector->insns = (ILOCInsn**)malloc(vector->capacity * sizeof(ILOCInsn*));
+    CHECK_MALLOC_PTR(vector->insns);
+    return vector;
+}
+
+/**
+ * @brief Make room for at least @c needed slots
+ */
+void InsnVector_reserve (InsnVector* vector, int needed)
+{
+    if (needed <= vector->capacity) {
+        return;
+    }
+    while (vector->capacity < needed) {
+        vector->capacity *= 2;
+    }
+    vector->insns = (ILOCInsn**)realloc(vector->insns, vector->capacity * sizeof(ILOCInsn*));
+    CHECK_MALLOC_PTR(vector->insns);
+}
+
+InsnVector* InsnVector_from_list (InsnList* list)
+{
+    InsnVector* vector = InsnVector_new();
+    InsnVector_reserve(vector, InsnList_size(list));
+    ILOCInsn* next = list->head;
+    while (next != NULL) {
+        ILOCInsn* insn = next;
+        next = insn->next;
+        insn->next = NULL;
+        vector->insns[vector->size++] = insn;
+    }
+    list->head = NULL;
+    list->tail = NULL;
+    list->size = 0;
+    return vector;
+}
+
+InsnList* InsnVector_to_list (InsnVector* vector)
+{
+    InsnList* list = InsnList_new();
+    for (int i = 0; i < vector->size; i++) {
+        if (vector->insns[i] != NULL) {
+            vector->insns[i]->next = NULL;
+            InsnList_add(list, vector->insns[i]);
+        }
+    }
+    vector->size = 0;
+    vector->num_deleted = 0;
+    return list;
+}
+
+int InsnVector_add (InsnVector* vector, ILOCInsn* insn)
+{
+    InsnVector_reserve(vector, vector->size + 1);
+    insn->next = NULL;
+    vector->insns[vector->size] = insn;
+    return vector->size++;
+}
+
+void InsnVector_insert (InsnVector* vector, int index, ILOCInsn* insn)
+{
+    if (index < 0 || index > vector->size) {
+        fprintf(stderr, "Invalid instruction index: %d\n", index);
+        exit(EXIT_FAILURE);
+    }
+    InsnVector_reserve(vector, vector->size + 1);
+    memmove(&vector->insns[index + 1], &vector->insns[index],
+            (vector->size - index) * sizeof(ILOCInsn*));
+    insn->next = NULL;
+    vector->insns[index] = insn;
+    vector->size++;
+}
+
+/**
+ * @brief Check that an index refers to an existing slot
+ */
+void InsnVector_check_index (InsnVector* vector, int index)
+{
+    if (index < 0 || index >= vector->size) {
+        fprintf(stderr, "Invalid instruction index: %d\n", index);
+        exit(EXIT_FAILURE);
+    }
+}
+
+ILOCInsn* InsnVector_get (InsnVector* vector, int index)
+{
+    InsnVector_check_index(vector, index);
+    return vector->insns[index];
+}
+
+ILOCInsn* InsnVector_set (InsnVector* vector, int index, ILOCInsn* insn)
+{
+    InsnVector_check_index(vector, index);
+    ILOCInsn* old = vector->insns[index];
+    if (old == NULL && insn != NULL) {
+        vector->num_deleted--;
+    } else if (old != NULL && insn == NULL) {
+        vector->num_deleted++;
+    }
+    if (insn != NULL) {
+        insn->next = NULL;
+    }
+    vector->insns[index] = insn;
+    return old;
+}
+
+void InsnVector_delete (InsnVector* vector, int index)
+{
+    ILOCInsn* old = InsnVector_set(vector, index, NULL);
+    if (old != NULL) {
+        ILOCInsn_free(old);
+    }
+}
+
+void InsnVector_compact (InsnVector* vector, int* new_index)
+{
+    int size = 0;
+    for (int i = 0; i < vector->size; i++) {
+        if (vector->insns[i] != NULL) {
+            vector->insns[size] = vector->insns[i];
+            if (new_index != NULL) {
+                new_index[i] = size;
+            }
+            size++;
+        } else if (new_index != NULL) {
+            new_index[i] = -1;
+        }
+    }
+    vector->size = size;
+    vector->num_deleted = 0;
+}
+
+int InsnVector_size (InsnVector* vector)
+{
+    return vector->size;
+}
+
+int InsnVector_count (InsnVector* vector)
+{
+    return vector->size - vector->num_deleted;
+}
+
+void InsnVector_print (InsnVector* vector, FILE* output)
+{
+    for (int i = 0; i < vector->size; i++) {
+        ILOCInsn* insn = vector->insns[i];
+        if (insn == NULL) {
+            continue;
+        }
+        if (insn->form != LABEL) {
+            fprintf(output, "  ");
+        }
+        ILOCInsn_print(insn, output);
+        if (insn->comment != NULL) {
+            fprintf(output, "  ; %s", insn->comment);
+        }
+        fprintf(output, "\n");
+    }
+}
+
+void InsnVector_free (InsnVector* vector)
+{
+    for (int i = 0; i < vector->size; i++) {
+        if (vector->insns[i] != NULL) {
+            ILOCInsn_free(vector->insns[i]);
+        }
+    }
+    free(vector->insns);
+    free(vector);
+}
@@ -0,0 +1,772 @@
+/*
+ * mmap/mprotect are not part of strict C11
+ */
+#define _DEFAULT_SOURCE
+
+#include "jit.h"
+
+#if defined(__x86_64__) && defined(__unix__)
+#define HAVE_X86_64_JIT
+#include <sys/mman.h>
+#endif
+
+bool jit_available ()
+{
+#ifdef HAVE_X86_64_JIT
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef HAVE_X86_64_JIT
+
+/*
+ * Native register assignment (all callee-saved, so they survive calls into
+ * the runtime):
+ *
+ *   rbx   base of the simulated register file
+ *   r12   base of the simulated address space
+ *   r13   ILOC stack pointer (SP)
+ *   r14   ILOC base pointer (BP)
+ *   r15   number of instructions executed
+ *
+ * rax, rcx, and rdx are used as scratch registers.
+ */
+
+#define RAX 0
+#define RCX 1
+#define RDX 2
+
+/*
+ * runtime callbacks (messages must match the interpreter exactly)
+ */
+
+void jit_warn_uninit (int reg)
+{
+    printf("WARNING: Potential uninitialized read from register r%d\n", reg - FIRST_VIRTUAL_REG);
+}
+
+void jit_bad_address (int address)
+{
+    printf("ERROR: Address %d is invalid (out of range)\n", address);
+    exit(EXIT_FAILURE);
+}
+
+void jit_stack_overflow ()
+{
+    printf("ERROR: Stack overflow\n");
+    exit(EXIT_FAILURE);
+}
+
+void jit_empty_stack ()
+{
+    printf("ERROR: Cannot pop from empty stack\n");
+    exit(EXIT_FAILURE);
+}
+
+void jit_timeout ()
+{
+    fprintf(stderr, "TIMEOUT: Program executed too many instructions (probably an infinite loop)");
+    exit(EXIT_FAILURE);
+}
+
+void jit_bad_return (int index)
+{
+    printf("ERROR: Invalid instruction index %d\n", index);
+    exit(EXIT_FAILURE);
+}
+
+void jit_print_word (word_t value)
+{
+    printf(PRIW, value);
+}
+
+void jit_print_str (const char* str)
+{
+    printf("%s", str);
+}
+
+/**
+ * @brief Generic runtime callback type (cast to the actual type when called)
+ */
+typedef void (*JITCallback)(void);
+
+/**
+ * @brief Shared out-of-line code sequences that instructions can branch to
+ */
+typedef enum JITStub
+{
+    EXIT_STUB,
+    BAD_ADDRESS_STUB,
+    STACK_OVERFLOW_STUB,
+    EMPTY_STACK_STUB,
+    TIMEOUT_STUB,
+    BAD_RETURN_STUB,
+    NUM_STUBS
+} JITStub;
+
+/**
+ * @brief Branch target for a stub (instruction indices are non-negative)
+ */
+#define STUB_TARGET(S) (-1 - (int)(S))
+
+/**
+ * @brief Unresolved 32-bit relative branch
+ */
+typedef struct JITFixup
+{
+    int offset;     /**< @brief Code offset of the rel32 field */
+    int target;     /**< @brief Instruction index (or stub target) */
+} JITFixup;
+
+/**
+ * @brief State for translating one program
+ */
+typedef struct JITCompiler
+{
+    DecodedProgram* program;    /**< @brief Program being translated */
+    bool checked;               /**< @brief Emit runtime checks? */
+    int mem_size;               /**< @brief Size of the simulated address space */
+
+    byte_t* code;               /**< @brief Generated code (position-independent) */
+    int size;                   /**< @brief Number of code bytes */
+    int capacity;               /**< @brief Allocated code bytes */
+
+    int* insn_offsets;          /**< @brief Code offset of each instruction */
+    int stub_offsets[NUM_STUBS];/**< @brief Code offset of each stub */
+
+    JITFixup* fixups;           /**< @brief Branches to resolve */
+    int num_fixups;             /**< @brief Number of branches to resolve */
+    int fixup_capacity;         /**< @brief Allocated fixups */
+
+    uint64_t* return_table;     /**< @brief Native address of each instruction (for RETURN) */
+} JITCompiler;
+
+/*
+ * low-level emission
+ */
+
+void jit_emit_u8 (JITCompiler* c, int byte)
+{
+    if (c->size == c->capacity) {
+        c->capacity *= 2;
+        c->code = (byte_t*)realloc(c->code, c->capacity);
+        CHECK_MALLOC_PTR(c->code);
+    }
+    c->code[c->size++] = (byte_t)byte;
+}
+
+void jit_emit_u32 (JITCompiler* c, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) {
+        jit_emit_u8(c, (value >> (8 * i)) & 0xff);
+    }
+}
+
+void jit_emit_u64 (JITCompiler* c, uint64_t value)
+{
+    for (int i = 0; i < 8; i++) {
+        jit_emit_u8(c, (value >> (8 * i)) & 0xff);
+    }
+}
+
+void jit_emit_bytes (JITCompiler* c, int count, const byte_t* bytes)
+{
+    for (int i = 0; i < count; i++) {
+        jit_emit_u8(c, bytes[i]);
+    }
+}
+
+#define EMIT(...) do { \
+        const byte_t bytes[] = { __VA_ARGS__ }; \
+        jit_emit_bytes(c, sizeof(bytes), bytes); \
+    } while (0)
+
+void jit_patch_u32 (JITCompiler* c, int offset, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) {
+        c->code[offset + i] = (value >> (8 * i)) & 0xff;
+    }
+}
+
+/**
+ * @brief Emit a rel32 field for a branch to an instruction or stub
+ */
+void jit_emit_branch_target (JITCompiler* c, int target)
+{
+    if (c->num_fixups == c->fixup_capacity) {
+        c->fixup_capacity *= 2;
+        c->fixups = (JITFixup*)realloc(c->fixups, c->fixup_capacity * sizeof(JITFixup));
+        CHECK_MALLOC_PTR(c->fixups);
+    }
+    c->fixups[c->num_fixups].offset = c->size;
+    c->fixups[c->num_fixups].target = target;
+    c->num_fixups++;
+    jit_emit_u32(c, 0);
+}
+
+/* jmp rel32 */
+void jit_emit_jmp (JITCompiler* c, int target)
+{
+    EMIT(0xe9);
+    jit_emit_branch_target(c, target);
+}
+
+/* jcc rel32 (cc is the low nibble of the 0x0f 0x8? opcode) */
+void jit_emit_jcc (JITCompiler* c, int cc, int target)
+{
+    EMIT(0x0f, 0x80 | cc);
+    jit_emit_branch_target(c, target);
+}
+
+#define CC_E  0x4
+#define CC_NE 0x5
+#define CC_A  0x7
+#define CC_L  0xc
+#define CC_GE 0xd
+#define CC_LE 0xe
+#define CC_G  0xf
+
+/* mov rax, imm64; call rax */
+void jit_emit_call (JITCompiler* c, JITCallback fn)
+{
+    uint64_t address;
+    memcpy(&address, &fn, sizeof(address));
+    EMIT(0x48, 0xb8);
+    jit_emit_u64(c, address);
+    EMIT(0xff, 0xd0);
+}
+
+/* mov reg, imm64 */
+void jit_emit_load_imm (JITCompiler* c, int reg, uint64_t value)
+{
+    EMIT(0x48, 0xb8 | reg);
+    jit_emit_u64(c, value);
+}
+
+/*
+ * simulated register access
+ */
+
+void jit_emit_read_reg (JITCompiler* c, int reg, int idx)
+{
+    if (idx == REG_SP) {
+        EMIT(0x4c, 0x89, 0xe8 | reg);               /* mov reg, r13 */
+    } else if (idx == REG_BP) {
+        EMIT(0x4c, 0x89, 0xf0 | reg);               /* mov reg, r14 */
+    } else {
+        EMIT(0x48, 0x8b, 0x83 | (reg << 3));        /* mov reg, [rbx+disp32] */
+        jit_emit_u32(c, idx * WORD_SIZE);
+    }
+}
+
+void jit_emit_write_reg (JITCompiler* c, int idx, int reg)
+{
+    if (idx == REG_SP) {
+        EMIT(0x49, 0x89, 0xc5 | (reg << 3));        /* mov r13, reg */
+    } else if (idx == REG_BP) {
+        EMIT(0x49, 0x89, 0xc6 | (reg << 3));        /* mov r14, reg */
+    } else {
+        EMIT(0x48, 0x89, 0x83 | (reg << 3));        /* mov [rbx+disp32], reg */
+        jit_emit_u32(c, idx * WORD_SIZE);
+    }
+}
+
+/**
+ * @brief Emit an uninitialized read warning check (clobbers scratch registers,
+ * so it must precede any loads for the instruction)
+ */
+void jit_emit_uninit_check (JITCompiler* c, int idx)
+{
+    if (!c->checked || idx < FIRST_VIRTUAL_REG) {
+        return;
+    }
+    EMIT(0x48, 0x81, 0xbb);                         /* cmp qword [rbx+disp32], imm32 */
+    jit_emit_u32(c, idx * WORD_SIZE);
+    jit_emit_u32(c, (uint32_t)UNINIT_REG);
+    EMIT(0x75, 17);                                 /* jne (over the next 17 bytes) */
+    EMIT(0xbf);                                     /* mov edi, imm32 */
+    jit_emit_u32(c, idx);
+    jit_emit_call(c, (JITCallback)jit_warn_uninit);
+}
+
+/*
+ * simulated memory access (address in rax)
+ */
+
+void jit_emit_address_check (JITCompiler* c)
+{
+    /* addresses are truncated to int, just like in the interpreter */
+    EMIT(0x48, 0x63, 0xc0);                         /* movsxd rax, eax */
+    if (c->checked) {
+        EMIT(0x48, 0x3d);                           /* cmp rax, imm32 */
+        jit_emit_u32(c, c->mem_size - WORD_SIZE);
+        jit_emit_jcc(c, CC_A, STUB_TARGET(BAD_ADDRESS_STUB));
+    }
+}
+
+/* rax = mem[rax] */
+void jit_emit_load_mem (JITCompiler* c)
+{
+    jit_emit_address_check(c);
+    EMIT(0x49, 0x8b, 0x04, 0x04);                   /* mov rax, [r12+rax] */
+}
+
+/* mem[rax] = rcx */
+void jit_emit_store_mem (JITCompiler* c)
+{
+    jit_emit_address_check(c);
+    EMIT(0x49, 0x89, 0x0c, 0x04);                   /* mov [r12+rax], rcx */
+}
+
+/* push rcx onto the simulated stack */
+void jit_emit_push (JITCompiler* c)
+{
+    EMIT(0x49, 0x83, 0xed, WORD_SIZE);              /* sub r13, WORD_SIZE */
+    if (c->checked) {
+        EMIT(0x49, 0x81, 0xfd);                     /* cmp r13, imm32 */
+        jit_emit_u32(c, STATIC_VAR_OFFSET);
+        jit_emit_jcc(c, CC_LE, STUB_TARGET(STACK_OVERFLOW_STUB));
+    }
+}
+
+/* pop the simulated stack into rax */
+void jit_emit_pop (JITCompiler* c)
+{
+    if (c->checked) {
+        EMIT(0x49, 0x81, 0xfd);                     /* cmp r13, imm32 */
+        jit_emit_u32(c, c->mem_size - WORD_SIZE);
+        jit_emit_jcc(c, CC_G, STUB_TARGET(EMPTY_STACK_STUB));
+    }
+    EMIT(0x4c, 0x89, 0xe8);                         /* mov rax, r13 */
+    jit_emit_load_mem(c);
+    EMIT(0x49, 0x83, 0xc5, WORD_SIZE);              /* add r13, WORD_SIZE */
+}
+
+void jit_emit_timeout_check (JITCompiler* c)
+{
+    if (c->checked) {
+        EMIT(0x49, 0x81, 0xff);                     /* cmp r15, imm32 */
+        jit_emit_u32(c, TIMEOUT_NUM_INSTRUCTIONS);
+        jit_emit_jcc(c, CC_G, STUB_TARGET(TIMEOUT_STUB));
+    }
+}
+
+/*
+ * instruction translation
+ */
+
+/* rax = op0 (op) op1 */
+void jit_emit_binary_operands (JITCompiler* c, DecodedInsn* insn)
+{
+    jit_emit_uninit_check(c, insn->op[0]);
+    jit_emit_uninit_check(c, insn->op[1]);
+    jit_emit_read_reg(c, RAX, insn->op[0]);
+    jit_emit_read_reg(c, RCX, insn->op[1]);
+}
+
+void jit_emit_compare (JITCompiler* c, DecodedInsn* insn, int setcc)
+{
+    jit_emit_binary_operands(c, insn);
+    EMIT(0x48, 0x39, 0xc8);                         /* cmp rax, rcx */
+    EMIT(0x0f, setcc, 0xc0);                        /* setcc al */
+    EMIT(0x0f, 0xb6, 0xc0);                         /* movzx eax, al */
+    jit_emit_write_reg(c, insn->op[2], RAX);
+}
+
+void jit_emit_insn (JITCompiler* c, int index)
+{
+    DecodedInsn* insn = &c->program->code[index];
+
+    if (insn->form == HALT) {
+        jit_emit_jmp(c, STUB_TARGET(EXIT_STUB));
+        return;
+    }
+
+    EMIT(0x49, 0xff, 0xc7);                         /* inc r15 */
+
+    switch (insn->form)
+    {
+        case LOAD_I:
+            jit_emit_load_imm(c, RAX, insn->imm);
+            jit_emit_write_reg(c, insn->op[1], RAX);
+            break;
+
+        case LOAD:
+            jit_emit_uninit_check(c, insn->op[0]);
+            jit_emit_read_reg(c, RAX, insn->op[0]);
+            jit_emit_load_mem(c);
+            jit_emit_write_reg(c, insn->op[1], RAX);
+            break;
+
+        case LOAD_AI:
+            jit_emit_uninit_check(c, insn->op[0]);
+            jit_emit_read_reg(c, RAX, insn->op[0]);
+            jit_emit_load_imm(c, RCX, insn->imm);
+            EMIT(0x48, 0x01, 0xc8);                 /* add rax, rcx */
+            jit_emit_load_mem(c);
+            jit_emit_write_reg(c, insn->op[2], RAX);
+            break;
+
+        case LOAD_AO:
+            jit_emit_binary_operands(c, insn);
+            EMIT(0x48, 0x01, 0xc8);                 /* add rax, rcx */
+            jit_emit_load_mem(c);
+            jit_emit_write_reg(c, insn->op[2], RAX);
+            break;
+
+        case STORE:
+            jit_emit_uninit_check(c, insn->op[0]);
+            jit_emit_uninit_check(c, insn->op[1]);
+            jit_emit_read_reg(c, RAX, insn->op[1]);
+            jit_emit_read_reg(c, RCX, insn->op[0]);
+            jit_emit_store_mem(c);
+            break;
+
+        case STORE_AI:
+            jit_emit_uninit_check(c, insn->op[0]);
+            jit_emit_uninit_check(c, insn->op[1]);
+            jit_emit_read_reg(c, RAX, insn->op[1]);
+            jit_emit_load_imm(c, RCX, insn->imm);
+            EMIT(0x48, 0x01, 0xc8);                 /* add rax, rcx */
+            jit_emit_read_reg(c, RCX, insn->op[0]);
+            jit_emit_store_mem(c);
+            break;
+
+        case STORE_AO:
+            jit_emit_uninit_check(c, insn->op[0]);
+            jit_emit_uninit_check(c, insn->op[1]);
+            jit_emit_uninit_check(c, insn->op[2]);
+            jit_emit_read_reg(c, RAX, insn->op[1]);
+            jit_emit_read_reg(c, RDX, insn->op[2]);
+            EMIT(0x48, 0x01, 0xd0);                 /* add rax, rdx */
+            jit_emit_read_reg(c, RCX, insn->op[0]);
+            jit_emit_store_mem(c);
+            break;
+
+        case ADD:
+            jit_emit_binary_operands(c, insn);
+            EMIT(0x48, 0x01, 0xc8);                 /* add rax, rcx */
+            jit_emit_write_reg(c, insn->op[2], RAX);
+            break;
+        case SUB:
+            jit_emit_binary_operands(c, insn);
+            EMIT(0x48, 0x29, 0xc8);                 /* sub rax, rcx */
+            jit_emit_write_reg(c, insn->op[2], RAX);
+            break;
+        case MULT:
+            jit_emit_binary_operands(c, insn);
+            EMIT(0x48, 0x0f, 0xaf, 0xc1);           /* imul rax, rcx */
+            jit_emit_write_reg(c, insn->op[2], RAX);
+            break;
+        case DIV:
+            jit_emit_binary_operands(c, insn);
+            EMIT(0x48, 0x99);                       /* cqo */
+            EMIT(0x48, 0xf7, 0xf9);                 /* idiv rcx */
+            jit_emit_write_reg(c, insn->op[2], RAX);
+            break;
+        case AND:
+            jit_emit_binary_operands(c, insn);
+            EMIT(0x48, 0x21, 0xc8);                 /* and rax, rcx */
+            jit_emit_write_reg(c, insn->op[2], RAX);
+            break;
+        case OR:
+            jit_emit_binary_operands(c, insn);
+            EMIT(0x48, 0x09, 0xc8);                 /* or rax, rcx */
+            jit_emit_write_reg(c, insn->op[2], RAX);
+            break;
+
+        case CMP_LT: jit_emit_compare(c, insn, 0x9c); break;     /* setl */
+        case CMP_LE: jit_emit_compare(c, insn, 0x9e); break;     /* setle */
+        case CMP_EQ: jit_emit_compare(c, insn, 0x94); break;     /* sete */
+        case CMP_NE: jit_emit_compare(c, insn, 0x95); break;     /* setne */
+        case CMP_GE: jit_emit_compare(c, insn, 0x9d); break;     /* setge */
+        case CMP_GT: jit_emit_compare(c, insn, 0x9f); break;     /* setg */
+
+        case ADD_I:
+        case MULT_I:
+            jit_emit_uninit_check(c, insn->op[0]);
+            jit_emit_read_reg(c, RAX, insn->op[0]);
+            jit_emit_load_imm(c, RCX, insn->imm);
+            if (insn->form == ADD_I) {
+                EMIT(0x48, 0x01, 0xc8);             /* add rax, rcx */
+            } else {
+                EMIT(0x48, 0x0f, 0xaf, 0xc1);       /* imul rax, rcx */
+            }
+            jit_emit_write_reg(c, insn->op[2], RAX);
+            break;
+
+        case I2I:
+            jit_emit_uninit_check(c, insn->op[0]);
+            jit_emit_read_reg(c, RAX, insn->op[0]);
+            jit_emit_write_reg(c, insn->op[1], RAX);
+            break;
+        case NOT:
+            jit_emit_uninit_check(c, insn->op[0]);
+            jit_emit_read_reg(c, RAX, insn->op[0]);
+            EMIT(0x48, 0xf7, 0xd0);                 /* not rax */
+            EMIT(0x83, 0xe0, 0x01);                 /* and eax, 1 */
+            jit_emit_write_reg(c, insn->op[1], RAX);
+            break;
+        case NEG:
+            jit_emit_uninit_check(c, insn->op[0]);
+            jit_emit_read_reg(c, RAX, insn->op[0]);
+            EMIT(0x48, 0xf7, 0xd8);                 /* neg rax */
+            jit_emit_write_reg(c, insn->op[1], RAX);
+            break;
+
+        case PUSH:
+            /* the pushed value is read after SP is decremented */
+            jit_emit_push(c);
+            jit_emit_uninit_check(c, insn->op[0]);
+            jit_emit_read_reg(c, RCX, insn->op[0]);
+            EMIT(0x4c, 0x89, 0xe8);                 /* mov rax, r13 */
+            jit_emit_store_mem(c);
+            break;
+
+        case POP:
+            jit_emit_pop(c);
+            jit_emit_write_reg(c, insn->op[0], RAX);
+            break;
+
+        case JUMP:
+            jit_emit_timeout_check(c);
+            jit_emit_jmp(c, insn->op[0]);
+            break;
+
+        case CBR:
+            jit_emit_uninit_check(c, insn->op[0]);
+            jit_emit_read_reg(c, RAX, insn->op[0]);
+            jit_emit_timeout_check(c);
+            EMIT(0x48, 0x85, 0xc0);                 /* test rax, rax */
+            jit_emit_jcc(c, CC_NE, insn->op[1]);
+            jit_emit_jmp(c, insn->op[2]);
+            break;
+
+        case CALL:
+            jit_emit_push(c);
+            EMIT(0xb9);                             /* mov ecx, imm32 */
+            jit_emit_u32(c, index + 1);
+            EMIT(0x4c, 0x89, 0xe8);                 /* mov rax, r13 */
+            jit_emit_store_mem(c);
+            jit_emit_timeout_check(c);
+            jit_emit_jmp(c, insn->op[0]);
+            break;
+
+        case RETURN:
+        {
+            /* empty stack means this is the return from main() */
+            EMIT(0x49, 0x81, 0xfd);                 /* cmp r13, imm32 */
+            jit_emit_u32(c, c->mem_size);
+            EMIT(0x0f, 0x85);                       /* jne (local, patched below) */
+            int not_main = c->size;
+            jit_emit_u32(c, 0);
+            jit_emit_timeout_check(c);
+            jit_emit_jmp(c, STUB_TARGET(EXIT_STUB));
+            jit_patch_u32(c, not_main, c->size - (not_main + 4));
+
+            jit_emit_pop(c);
+            jit_emit_timeout_check(c);
+            EMIT(0x48, 0x63, 0xc0);                 /* movsxd rax, eax */
+            if (c->checked) {
+                EMIT(0x48, 0x3d);                   /* cmp rax, imm32 */
+                jit_emit_u32(c, c->program->size);
+                jit_emit_jcc(c, CC_A, STUB_TARGET(BAD_RETURN_STUB));
+            }
+            uint64_t table;
+            memcpy(&table, &c->return_table, sizeof(table));
+            jit_emit_load_imm(c, RCX, table);
+            EMIT(0xff, 0x24, 0xc1);                 /* jmp [rcx+rax*8] */
+            break;
+        }
+
+        case PRINT:
+            if (insn->str != NULL) {
+                uint64_t str;
+                memcpy(&str, &insn->str, sizeof(str));
+                EMIT(0x48, 0xbf);                   /* mov rdi, imm64 */
+                jit_emit_u64(c, str);
+                jit_emit_call(c, (JITCallback)jit_print_str);
+            } else if (insn->op[0] < 0) {
+                jit_emit_load_imm(c, RAX, insn->imm);
+                EMIT(0x48, 0x89, 0xc7);             /* mov rdi, rax */
+                jit_emit_call(c, (JITCallback)jit_print_word);
+            } else {
+                jit_emit_uninit_check(c, insn->op[0]);
+                jit_emit_read_reg(c, RAX, insn->op[0]);
+                EMIT(0x48, 0x89, 0xc7);             /* mov rdi, rax */
+                jit_emit_call(c, (JITCallback)jit_print_word);
+            }
+            break;
+
+        case LABEL:
+        case NOP:
+        case PHI:
+        default:
+            /* nothing to do */
+            break;
+    }
+}
+
+void jit_emit_prologue (JITCompiler* c, int entry)
+{
+    EMIT(0x53);                                     /* push rbx */
+    EMIT(0x55);                                     /* push rbp */
+    EMIT(0x41, 0x54);                               /* push r12 */
+    EMIT(0x41, 0x55);                               /* push r13 */
+    EMIT(0x41, 0x56);                               /* push r14 */
+    EMIT(0x41, 0x57);                               /* push r15 */
+    EMIT(0x48, 0x83, 0xec, 0x08);                   /* sub rsp, 8 (16-byte alignment for calls) */
+    EMIT(0x48, 0x89, 0xfb);                         /* mov rbx, rdi */
+    EMIT(0x49, 0x89, 0xf4);                         /* mov r12, rsi */
+    EMIT(0x4c, 0x8b, 0xab);                         /* mov r13, [rbx+disp32] */
+    jit_emit_u32(c, REG_SP * WORD_SIZE);
+    EMIT(0x4c, 0x8b, 0xb3);                         /* mov r14, [rbx+disp32] */
+    jit_emit_u32(c, REG_BP * WORD_SIZE);
+    EMIT(0x45, 0x31, 0xff);                         /* xor r15d, r15d */
+    jit_emit_jmp(c, entry);
+}
+
+void jit_emit_stubs (JITCompiler* c)
+{
+    c->stub_offsets[EXIT_STUB] = c->size;
+    EMIT(0x4c, 0x89, 0xab);                         /* mov [rbx+disp32], r13 */
+    jit_emit_u32(c, REG_SP * WORD_SIZE);
+    EMIT(0x4c, 0x89, 0xb3);                         /* mov [rbx+disp32], r14 */
+    jit_emit_u32(c, REG_BP * WORD_SIZE);
+    EMIT(0x4c, 0x89, 0xf8);                         /* mov rax, r15 */
+    EMIT(0x48, 0x83, 0xc4, 0x08);                   /* add rsp, 8 */
+    EMIT(0x41, 0x5f);                               /* pop r15 */
+    EMIT(0x41, 0x5e);                               /* pop r14 */
+    EMIT(0x41, 0x5d);                               /* pop r13 */
+    EMIT(0x41, 0x5c);                               /* pop r12 */
+    EMIT(0x5d);                                     /* pop rbp */
+    EMIT(0x5b);                                     /* pop rbx */
+    EMIT(0xc3);                                     /* ret */
+
+    /* error stubs never return */
+    c->stub_offsets[BAD_ADDRESS_STUB] = c->size;
+    EMIT(0x89, 0xc7);                               /* mov edi, eax */
+    jit_emit_call(c, (JITCallback)jit_bad_address);
+    EMIT(0x0f, 0x0b);                               /* ud2 */
+
+    c->stub_offsets[STACK_OVERFLOW_STUB] = c->size;
+    jit_emit_call(c, (JITCallback)jit_stack_overflow);
+    EMIT(0x0f, 0x0b);
+
+    c->stub_offsets[EMPTY_STACK_STUB] = c->size;
+    jit_emit_call(c, (JITCallback)jit_empty_stack);
+    EMIT(0x0f, 0x0b);
+
+    c->stub_offsets[TIMEOUT_STUB] = c->size;
+    jit_emit_call(c, (JITCallback)jit_timeout);
+    EMIT(0x0f, 0x0b);
+
+    c->stub_offsets[BAD_RETURN_STUB] = c->size;
+    EMIT(0x89, 0xc7);                               /* mov edi, eax */
+    jit_emit_call(c, (JITCallback)jit_bad_return);
+    EMIT(0x0f, 0x0b);
+}
+
+/**
+ * @brief Signature of the generated code
+ *
+ * @returns Number of instructions executed
+ */
+typedef long (*JITFunction)(word_t* reg, byte_t* mem);
+
+int run_jit (DecodedProgram* program, SimulatorOptions* options)
+{
+    int main_index = CallTargetTable_find(program->call_targets, "main");
+    if (main_index < 0) {
+        printf("ERROR: No call target found for 'main'\n");
+        exit(EXIT_FAILURE);
+    }
+
+    /* translate every instruction (plus the HALT sentinel) */
+    JITCompiler compiler;
+    JITCompiler* c = &compiler;
+    c->program = program;
+    c->checked = !options->unchecked;
+    c->mem_size = options->mem_size;
+    c->capacity = 64 * (program->size + 1) + 1024;
+    c->size = 0;
+    c->code = (byte_t*)malloc(c->capacity);
+    CHECK_MALLOC_PTR(c->code);
+    c->insn_offsets = (int*)calloc(program->size + 1, sizeof(int));
+    CHECK_MALLOC_PTR(c->insn_offsets);
+    c->fixup_capacity = 2 * (program->size + 1) + NUM_STUBS;
+    c->num_fixups = 0;
+    c->fixups = (JITFixup*)malloc(c->fixup_capacity * sizeof(JITFixup));
+    CHECK_MALLOC_PTR(c->fixups);
+    c->return_table = (uint64_t*)calloc(program->size + 1, sizeof(uint64_t));
+    CHECK_MALLOC_PTR(c->return_table);
+
+    jit_emit_prologue(c, main_index + 1);
+    for (int i = 0; i <= program->size; i++) {
+        c->insn_offsets[i] = c->size;
+        jit_emit_insn(c, i);
+    }
+    jit_emit_stubs(c);
+
+    /* resolve branches */
+    for (int i = 0; i < c->num_fixups; i++) {
+        int target = c->fixups[i].target;
+        int target_offset = (target >= 0 ? c->insn_offsets[target]
+                                         : c->stub_offsets[-1 - target]);
+        jit_patch_u32(c, c->fixups[i].offset, target_offset - (c->fixups[i].offset + 4));
+    }
+
+    /* copy to executable memory */
+    byte_t* buffer = (byte_t*)mmap(NULL, c->size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED) {
+        printf("ERROR: Could not allocate memory for native code\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(buffer, c->code, c->size);
+    if (mprotect(buffer, c->size, PROT_READ | PROT_EXEC) != 0) {
+        printf("ERROR: Could not make native code executable\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i <= program->size; i++) {
+        c->return_table[i] = (uint64_t)(uintptr_t)(buffer + c->insn_offsets[i]);
+    }
+
+    /* initialize machine state (same as the interpreter) */
+    word_t* reg = (word_t*)malloc(program->num_regs * sizeof(word_t));
+    CHECK_MALLOC_PTR(reg);
+    for (int i = 0; i < program->num_regs; i++) {
+        reg[i] = UNINIT_REG;
+    }
+    reg[REG_SP] = options->mem_size;
+    byte_t* mem = (byte_t*)calloc(options->mem_size, sizeof(byte_t));
+    CHECK_MALLOC_PTR(mem);
+
+    /* run */
+    JITFunction fn;
+    memcpy(&fn, &buffer, sizeof(fn));
+    options->num_executed = fn(reg, mem);
+    word_t return_value = reg[REG_RET];
+
+    /* clean up */
+    munmap(buffer, c->size);
+    free(reg);
+    free(mem);
+    free(c->code);
+    free(c->insn_offsets);
+    free(c->fixups);
+    free(c->return_table);
+    return return_value;
+}
+
+#else
+
+int run_jit (DecodedProgram* program, SimulatorOptions* options)
+{
+    printf("ERROR: Native code generation is not supported on this platform\n");
+    exit(EXIT_FAILURE);
+}
+
+#endif
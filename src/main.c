@@ -7,6 +7,19 @@
 #include "p2-parser.h"
 #include "p3-analysis.h"
 #include "p4-codegen.h"
+#include "assembler.h"
+#include "constfold.h"
+#include "dataflow.h"
+#include "jit.h"
+#include "native.h"
+#include "objfile.h"
+#include "profile.h"
+#include "regalloc.h"
+#include "sccp.h"
+#include "peephole.h"
+#include "inline.h"
+#include "trace.h"
+#include "valuenum.h"
 
 /**
  * @brief Enables debug output (intermediate ILOC and trace output)
@@ -69,22 +82,305 @@ bool read_file (const char* filename, char* text)
 }
 
 /**
- * @brief Compiler entry point
+ * @brief Driver settings that are not simulator options
+ */
+typedef struct DriverOptions
+{
+    const char* input;          /**< @brief Name of the Decaf source file (or @c NULL) */
+    const char* native_output;  /**< @brief Native executable to build instead of simulating (or @c NULL) */
+    const char* object_output;  /**< @brief Object file to write instead of simulating (or @c NULL) */
+    const char* iloc_output;    /**< @brief ILOC text file to write instead of simulating (or @c NULL) */
+    const char* cfg_output;     /**< @brief Control-flow graph (DOT) to write instead of simulating (or @c NULL) */
+    const char* ssa_output;     /**< @brief SSA form to write instead of simulating (or @c NULL) */
+    const char* object_input;   /**< @brief Object file to run instead of compiling (or @c NULL) */
+    const char* listing_output; /**< @brief Annotated listing to write when profiling (or @c NULL) */
+    const char* trace_output;   /**< @brief Binary trace file to write (or @c NULL) */
+    const char* trace_input;    /**< @brief Binary trace file to decode instead of compiling (or @c NULL) */
+    long trace_size;            /**< @brief Number of events kept in the trace buffer */
+    long trace_last;            /**< @brief Number of trace steps to print (or -1) */
+    long trace_state;           /**< @brief Step to print the full state for (or -1) */
+    long num_regs;              /**< @brief Number of physical registers to allocate (or 0 to keep virtual registers) */
+    bool assemble;              /**< @brief Input is ILOC text instead of Decaf source */
+    bool warn_uninit;           /**< @brief Report possibly uninitialized register reads at compile time */
+    bool inline_calls;          /**< @brief Inline calls to small functions before running */
+    bool optimize_ssa;          /**< @brief Run global optimizations in SSA form before running */
+    bool fold;                  /**< @brief Fold and propagate constants before running */
+    bool number_values;         /**< @brief Eliminate redundant loads and computations before running */
+    bool peephole;              /**< @brief Apply peephole rules after all other optimizations */
+    bool peephole_stats;        /**< @brief Report how often each peephole rule applied */
+} DriverOptions;
+
+/**
+ * @brief Print command-line usage information
+ *
+ * @param exe Name of the compiler executable
+ */
+void print_usage (const char* exe)
+{
+    fprintf(stderr, "Usage: %s [options] <decaf-filename>\n", exe);
+    fprintf(stderr, "       %s [options] --run-iloc <iloc-filename>\n", exe);
+    fprintf(stderr, "       %s [options] --run-object=<file>\n", exe);
+    fprintf(stderr, "       %s --decode-trace=<file> [--trace-last=<n> | --trace-state=<k>]\n", exe);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --dispatch=switch|threaded  simulator instruction dispatch strategy\n");
+    fprintf(stderr, "  --paranoid                  check every instruction as it is simulated\n");
+    fprintf(stderr, "  --jit                       translate ILOC to native code instead of simulating it\n");
+    fprintf(stderr, "  --jit-unchecked             same as --jit but without runtime safety checks\n");
+    fprintf(stderr, "  --native=<exe>              compile to a native executable instead of simulating\n");
+    fprintf(stderr, "  --run-iloc                  the input file is ILOC text (as printed with debug output)\n");
+    fprintf(stderr, "  --iloc=<file>               write the ILOC code as text instead of simulating\n");
+    fprintf(stderr, "  --cfg=<file>                write the control-flow graphs (DOT) instead of simulating\n");
+    fprintf(stderr, "  --ssa=<file>                write the code in SSA form instead of simulating\n");
+    fprintf(stderr, "  --object=<file>             compile to an ILOC object file instead of simulating\n");
+    fprintf(stderr, "  --run-object=<file>         run an ILOC object file instead of compiling\n");
+    fprintf(stderr, "  --warn-uninit               report possibly uninitialized register reads before running\n");
+    fprintf(stderr, "  --inline                    replace calls to small functions by copies of their bodies\n");
+    fprintf(stderr, "  --sccp                      propagate constants and remove dead code globally (in SSA form)\n");
+    fprintf(stderr, "  --fold-constants            fold and propagate constants before running\n");
+    fprintf(stderr, "  --lvn                       eliminate redundant loads and computations in basic blocks\n");
+    fprintf(stderr, "  --peephole                  remove wasteful instruction sequences (after all other optimizations)\n");
+    fprintf(stderr, "  --peephole-stats            same as --peephole but also report how often each rule applied\n");
+    fprintf(stderr, "  --regalloc=<k>              allocate k physical registers (at least %d) before running\n", MIN_PHYSICAL_REGS);
+    fprintf(stderr, "  --no-fuse                   do not execute instruction sequences as superinstructions\n");
+    fprintf(stderr, "  --fusion-profile            report the most frequently executed instruction sequences\n");
+    fprintf(stderr, "  --profile                   report execution counts per function, form, and instruction\n");
+    fprintf(stderr, "  --profile-listing=<file>    also write the ILOC code annotated with execution counts\n");
+    fprintf(stderr, "  --mem-size=<bytes>          size of the simulated address space (default %d)\n", MEM_SIZE);
+    fprintf(stderr, "  --trace-file=<file>         record the last executed steps to a binary trace file\n");
+    fprintf(stderr, "  --trace-size=<n>            number of steps kept in the trace (default %d)\n", DEFAULT_TRACE_SIZE);
+    fprintf(stderr, "  --decode-trace=<file>       print a binary trace file instead of compiling\n");
+    fprintf(stderr, "  --trace-last=<n>            print the last n steps of the trace (default 20)\n");
+    fprintf(stderr, "  --trace-state=<k>           print the full machine state before step k\n");
+}
+
+/**
+ * @brief Parse a non-negative integer option value
+ *
+ * @param text Option value
+ * @param value Receives the parsed value
+ * @returns True if and only if the whole value is a non-negative integer
+ */
+bool parse_count (const char* text, long* value)
+{
+    char* end;
+    *value = strtol(text, &end, 10);
+    return (*text != '\0' && *end == '\0' && *value >= 0);
+}
+
+/**
+ * @brief Parse command-line options
  *
  * @param argc Number of command-line arguments
  * @param argv Array of command-line argument strings
- * @returns @c EXIT_SUCCESS if the compilation succeeds and @c EXIT_FAILURE
- * otherwise
+ * @param options Simulator options to update
+ * @param driver Driver settings to update
+ * @returns True if and only if the arguments are valid
  */
-int main(int argc, char** argv)
+bool parse_options (int argc, char** argv, SimulatorOptions* options, DriverOptions* driver)
 {
-    /* check for filename */
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <decaf-filename>\n", argv[0]);
-        return EXIT_FAILURE;
+    for (int i = 1; i < argc; i++) {
+        char* arg = argv[i];
+        if (strcmp(arg, "--dispatch=switch") == 0) {
+            options->dispatch = SWITCH_DISPATCH;
+        } else if (strcmp(arg, "--dispatch=threaded") == 0) {
+            if (!threaded_dispatch_available()) {
+                fprintf(stderr, "Threaded dispatch is not supported by this build\n");
+                return false;
+            }
+            options->dispatch = THREADED_DISPATCH;
+        } else if (strcmp(arg, "--paranoid") == 0) {
+            options->paranoid = true;
+        } else if (strcmp(arg, "--jit") == 0 || strcmp(arg, "--jit-unchecked") == 0) {
+            if (!jit_available()) {
+                fprintf(stderr, "Native code generation is not supported on this platform\n");
+                return false;
+            }
+            options->jit = true;
+            options->unchecked = (strcmp(arg, "--jit-unchecked") == 0);
+        } else if (strcmp(arg, "--no-fuse") == 0) {
+            options->fuse = false;
+        } else if (strcmp(arg, "--fusion-profile") == 0) {
+            if (options->fusion_profile == NULL) {
+                options->fusion_profile = FusionProfile_new();
+            }
+        } else if (strcmp(arg, "--profile") == 0 ||
+                   (strncmp(arg, "--profile-listing=", 18) == 0 && arg[18] != '\0')) {
+            if (options->profile == NULL) {
+                options->profile = ExecutionProfile_new();
+            }
+            if (arg[9] == '-') {
+                driver->listing_output = arg + 18;
+            }
+        } else if (strncmp(arg, "--native=", 9) == 0 && arg[9] != '\0') {
+            driver->native_output = arg + 9;
+        } else if (strcmp(arg, "--run-iloc") == 0) {
+            driver->assemble = true;
+        } else if (strncmp(arg, "--iloc=", 7) == 0 && arg[7] != '\0') {
+            driver->iloc_output = arg + 7;
+        } else if (strncmp(arg, "--cfg=", 6) == 0 && arg[6] != '\0') {
+            driver->cfg_output = arg + 6;
+        } else if (strncmp(arg, "--ssa=", 6) == 0 && arg[6] != '\0') {
+            driver->ssa_output = arg + 6;
+        } else if (strncmp(arg, "--object=", 9) == 0 && arg[9] != '\0') {
+            driver->object_output = arg + 9;
+        } else if (strncmp(arg, "--run-object=", 13) == 0 && arg[13] != '\0') {
+            driver->object_input = arg + 13;
+        } else if (strcmp(arg, "--warn-uninit") == 0) {
+            driver->warn_uninit = true;
+        } else if (strcmp(arg, "--inline") == 0) {
+            driver->inline_calls = true;
+        } else if (strcmp(arg, "--sccp") == 0) {
+            driver->optimize_ssa = true;
+        } else if (strcmp(arg, "--fold-constants") == 0) {
+            driver->fold = true;
+        } else if (strcmp(arg, "--lvn") == 0) {
+            driver->number_values = true;
+        } else if (strcmp(arg, "--peephole") == 0 || strcmp(arg, "--peephole-stats") == 0) {
+            driver->peephole = true;
+            driver->peephole_stats = driver->peephole_stats || (strcmp(arg, "--peephole-stats") == 0);
+        } else if (strncmp(arg, "--regalloc=", 11) == 0) {
+            if (!parse_count(arg + 11, &driver->num_regs) || driver->num_regs < MIN_PHYSICAL_REGS ||
+                    driver->num_regs > MAX_VIRTUAL_REGS) {
+                return false;
+            }
+        } else if (strncmp(arg, "--mem-size=", 11) == 0) {
+            long mem_size;
+            if (!parse_count(arg + 11, &mem_size) || mem_size > MAX_MEM_SIZE) {
+                return false;
+            }
+            options->mem_size = (int)mem_size;
+        } else if (strncmp(arg, "--trace-file=", 13) == 0 && arg[13] != '\0') {
+            driver->trace_output = arg + 13;
+        } else if (strncmp(arg, "--decode-trace=", 15) == 0 && arg[15] != '\0') {
+            driver->trace_input = arg + 15;
+        } else if (strncmp(arg, "--trace-size=", 13) == 0) {
+            if (!parse_count(arg + 13, &driver->trace_size) || driver->trace_size == 0 ||
+                    driver->trace_size > MAX_TRACE_SIZE) {
+                return false;
+            }
+        } else if (strncmp(arg, "--trace-last=", 13) == 0) {
+            if (!parse_count(arg + 13, &driver->trace_last)) {
+                return false;
+            }
+        } else if (strncmp(arg, "--trace-state=", 14) == 0) {
+            if (!parse_count(arg + 14, &driver->trace_state)) {
+                return false;
+            }
+        } else if (arg[0] == '-' || driver->input != NULL) {
+            return false;
+        } else {
+            driver->input = arg;
+        }
     }
-    char* filename = argv[argc-1];
 
+    /* either compile a file, run an object file, or decode a trace */
+    return (driver->input != NULL) + (driver->object_input != NULL) + (driver->trace_input != NULL) == 1;
+}
+
+/**
+ * @brief Print the requested parts of a binary trace file
+ *
+ * @param filename Name of the trace file
+ * @param driver Driver settings (which steps or state to print)
+ * @returns True if and only if the trace could be printed
+ */
+bool decode_trace (const char* filename, DriverOptions* driver)
+{
+    TraceFile* trace = TraceFile_load(filename);
+    if (trace == NULL) {
+        fprintf(stderr, "Could not read trace file: %s\n", filename);
+        return false;
+    }
+    bool success = true;
+    if (driver->trace_state >= 0) {
+        success = TraceFile_print_state(trace, driver->trace_state, stdout);
+        if (!success) {
+            fprintf(stderr, "Step %ld is not recorded in the trace\n", driver->trace_state);
+        }
+    }
+    if (driver->trace_last >= 0 || driver->trace_state < 0) {
+        TraceFile_print_steps(trace, (driver->trace_last >= 0 ? driver->trace_last : 20), stdout);
+    }
+    TraceFile_free(trace);
+    return success;
+}
+
+/**
+ * @brief Deallocate the profiles and trace requested on the command line
+ * when the program is not run (@ref run_program deallocates them otherwise)
+ *
+ * @param sim_options Simulator options
+ */
+void free_unused_profiles (SimulatorOptions* sim_options)
+{
+    if (sim_options->fusion_profile != NULL) {
+        FusionProfile_free(sim_options->fusion_profile);
+    }
+    if (sim_options->profile != NULL) {
+        ExecutionProfile_free(sim_options->profile);
+    }
+    if (sim_options->trace != NULL) {
+        TraceBuffer_free(sim_options->trace);
+    }
+}
+
+/**
+ * @brief Run a decoded program and print the results (including any requested
+ * profiles and traces)
+ *
+ * @param decoded Program to run
+ * @param iloc Instructions of the program (for listings)
+ * @param sim_options Simulator options
+ * @param driver Driver settings
+ */
+void run_program (DecodedProgram* decoded, InsnList* iloc, SimulatorOptions* sim_options, DriverOptions* driver)
+{
+    /* run program (printing a text trace in debug mode and recording a binary
+     * trace if --trace-file was given) */
+    if (driver->trace_output != NULL) {
+        sim_options->trace = TraceBuffer_new((int)driver->trace_size, driver->trace_output);
+    }
+    int return_value = run_decoded_program(decoded, sim_options);
+    printf("RETURN VALUE = %d\n", return_value);
+
+    /* print and clean up profiling results */
+    if (sim_options->fusion_profile != NULL) {
+        printf("\n");
+        FusionProfile_print(sim_options->fusion_profile, stdout, 20);
+        FusionProfile_free(sim_options->fusion_profile);
+    }
+    if (sim_options->profile != NULL) {
+        printf("\n");
+        ExecutionProfile_print(sim_options->profile, stdout, 20);
+        if (driver->listing_output != NULL) {
+            FILE* listing_file = fopen(driver->listing_output, "w");
+            if (listing_file != NULL) {
+                ExecutionProfile_print_listing(sim_options->profile, iloc, listing_file);
+                fclose(listing_file);
+            } else {
+                fprintf(stderr, "Could not write file: %s\n", driver->listing_output);
+            }
+        }
+        ExecutionProfile_free(sim_options->profile);
+    }
+    if (sim_options->trace != NULL) {
+        TraceBuffer_free(sim_options->trace);
+        if (driver->trace_last >= 0 || driver->trace_state >= 0) {
+            printf("\n");
+            decode_trace(driver->trace_output, driver);
+        }
+    }
+}
+
+/**
+ * @brief Compile a Decaf source file to ILOC (exits with an error message if
+ * the program is invalid)
+ *
+ * @param filename Name of the Decaf source file
+ * @returns Generated ILOC code
+ */
+InsnList* compile_decaf (const char* filename)
+{
     /* read file */
     char text[MAX_FILE_SIZE];
     if (!read_file(filename, text)) {
@@ -165,20 +461,230 @@ int main(int argc, char** argv)
 
     /* clean up syntax tree (no longer needed) */
     ASTNode_free(tree);
-    tree = NULL;
+
+    return iloc;
+}
+
+/**
+ * @brief Compiler entry point
+ *
+ * @param argc Number of command-line arguments
+ * @param argv Array of command-line argument strings
+ * @returns @c EXIT_SUCCESS if the compilation succeeds and @c EXIT_FAILURE
+ * otherwise
+ */
+int main(int argc, char** argv)
+{
+    /* check for options and filename */
+    SimulatorOptions sim_options;
+    SimulatorOptions_init(&sim_options);
+    sim_options.print_trace = debug_mode;
+    DriverOptions driver = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, DEFAULT_TRACE_SIZE, -1, -1, 0, false, false, false, false, false, false, false, false };
+    if (!parse_options(argc, argv, &sim_options, &driver)) {
+        print_usage(argv[0]);
+        free_unused_profiles(&sim_options);
+        return EXIT_FAILURE;
+    }
+    const char* filename = driver.input;
+
+    /* decode a trace from an earlier run (no compilation necessary) */
+    if (driver.trace_input != NULL) {
+        free_unused_profiles(&sim_options);
+        return (decode_trace(driver.trace_input, &driver) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    /* run a previously compiled object file (no compilation necessary) */
+    if (driver.object_input != NULL) {
+        ObjectFile* object = ObjectFile_load(driver.object_input);
+        if (object == NULL) {
+            fprintf(stderr, "Could not read object file: %s\n", driver.object_input);
+            free_unused_profiles(&sim_options);
+            return EXIT_FAILURE;
+        }
+        run_program(object->program, object->list, &sim_options, &driver);
+        ObjectFile_free(object);
+        return EXIT_SUCCESS;
+    }
+
+    /* allocate long-lived compiler data (AST attributes and ILOC) from an
+     * arena that is released all at once at the end */
+    Arena* arena = Arena_new();
+    set_current_arena(arena);
+
+    /* compile Decaf (or assemble ILOC text) */
+    InsnList* iloc = NULL;
+    if (driver.assemble) {
+        char error_msg[MAX_ERROR_LEN];
+        iloc = assemble_iloc_file(filename, error_msg);
+        if (iloc == NULL) {
+            fprintf(stderr, "%s\n", error_msg);
+            Arena_free(arena);
+            free_unused_profiles(&sim_options);
+            return EXIT_FAILURE;
+        }
+        InsnList_verify(iloc);
+    } else {
+        iloc = compile_decaf(filename);
+    }
+
+    /* report uninitialized reads (before registers are shared) */
+    if (driver.warn_uninit) {
+        InsnVector* code = InsnVector_from_list(iloc);
+        check_uninitialized_reads(code, stdout);
+        InsnList* checked = InsnVector_to_list(code);
+        InsnList_splice(iloc, checked);
+        InsnList_free(checked);
+        InsnVector_free(code);
+    }
+
+    /* inline small functions (first, so that the other passes see the copies) */
+    if (driver.inline_calls) {
+        InlineStats stats = { 0, 0, 0 };
+        inline_functions(iloc, &stats);
+        if (debug_mode) {
+            printf("Inlining: %d inlinable functions, %d calls inlined, %d over budget\n",
+                    stats.inlinable, stats.inlined, stats.over_budget);
+        }
+    }
+
+    /* optimize globally in SSA form (before registers are shared) */
+    if (driver.optimize_ssa) {
+        SSAOptimizationStats stats = { 0, 0, 0, 0, 0, 0, 0, 0 };
+        optimize_ssa(iloc, &stats);
+        if (debug_mode) {
+            printf("SSA optimization: %d functions, %d promoted, %d phis, %d constants, %d branches, "
+                    "%d unreachable, %d removed, %d copies\n", stats.functions, stats.promoted, stats.phis,
+                    stats.constants, stats.branches, stats.unreachable, stats.removed, stats.copies);
+        }
+    }
+
+    /* optimize constant expressions (before registers are shared) */
+    if (driver.fold) {
+        ConstantFoldingStats stats = { 0, 0, 0, 0, 0 };
+        fold_constants(iloc, &stats);
+        if (debug_mode) {
+            printf("Constant folding: %d folded, %d propagated, %d immediates, %d branches, %d removed\n",
+                    stats.folded, stats.propagated, stats.immediates, stats.branches, stats.removed);
+        }
+    }
+
+    /* remove redundant loads and computations */
+    if (driver.number_values) {
+        ValueNumberingStats stats = { 0, 0, 0, 0, 0, 0 };
+        number_local_values(iloc, &stats);
+        if (debug_mode) {
+            printf("Value numbering: %d loads, %d forwarded, %d expressions, %d constants, %d propagated, %d removed\n",
+                    stats.loads, stats.forwarded, stats.expressions, stats.constants, stats.propagated, stats.removed);
+        }
+    }
+
+    /* map virtual registers to physical registers if requested */
+    if (driver.num_regs > 0) {
+        char error_msg[MAX_ERROR_LEN];
+        if (!allocate_registers(iloc, (int)driver.num_regs, error_msg)) {
+            fprintf(stderr, "%s\n", error_msg);
+            InsnList_free(iloc);
+            Arena_free(arena);
+            free_unused_profiles(&sim_options);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* clean up what the other passes (and code generation) left behind */
+    if (driver.peephole) {
+        PeepholeStats stats;
+        optimize_peephole(iloc, &stats);
+        if (driver.peephole_stats || debug_mode) {
+            PeepholeStats_print(&stats, stdout);
+        }
+    }
 
     /* print ILOC if debug mode is enabled */
     if (debug_mode) {
         InsnList_print(iloc, stdout);
     }
 
-    /* run program (w/ trace output enabled if debug mode is enabled) */
-    int return_value = run_simulator(iloc, debug_mode);
-    printf("RETURN VALUE = %d\n", return_value);
+    /* compile to a native executable instead of simulating if requested */
+    if (driver.native_output != NULL) {
+        bool success = build_native_executable(iloc, sim_options.mem_size, driver.native_output);
+        InsnList_free(iloc);
+        Arena_free(arena);
+        free_unused_profiles(&sim_options);
+        return (success ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    /* write ILOC text instead of simulating if requested */
+    if (driver.iloc_output != NULL) {
+        FILE* iloc_file = fopen(driver.iloc_output, "w");
+        if (iloc_file != NULL) {
+            InsnList_print(iloc, iloc_file);
+            fclose(iloc_file);
+        } else {
+            fprintf(stderr, "Could not write file: %s\n", driver.iloc_output);
+        }
+        InsnList_free(iloc);
+        Arena_free(arena);
+        free_unused_profiles(&sim_options);
+        return (iloc_file != NULL ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    /* write control-flow graphs instead of simulating if requested */
+    if (driver.cfg_output != NULL) {
+        FILE* cfg_file = fopen(driver.cfg_output, "w");
+        if (cfg_file != NULL) {
+            InsnVector* code = InsnVector_from_list(iloc);
+            CFGList* cfgs = build_cfgs(code);
+            CFGList_print_dot(cfgs, cfg_file);
+            CFGList_free(cfgs);
+            InsnVector_free(code);
+            fclose(cfg_file);
+        } else {
+            fprintf(stderr, "Could not write file: %s\n", driver.cfg_output);
+        }
+        InsnList_free(iloc);
+        Arena_free(arena);
+        free_unused_profiles(&sim_options);
+        return (cfg_file != NULL ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    /* write SSA form instead of simulating if requested */
+    if (driver.ssa_output != NULL) {
+        FILE* ssa_file = fopen(driver.ssa_output, "w");
+        if (ssa_file != NULL) {
+            InsnVector* code = InsnVector_from_list(iloc);
+            print_ssa(code, ssa_file);
+            InsnVector_free(code);
+            fclose(ssa_file);
+        } else {
+            fprintf(stderr, "Could not write file: %s\n", driver.ssa_output);
+        }
+        InsnList_free(iloc);
+        Arena_free(arena);
+        free_unused_profiles(&sim_options);
+        return (ssa_file != NULL ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    /* write an object file instead of simulating if requested */
+    if (driver.object_output != NULL) {
+        bool success = ObjectFile_save(iloc, driver.object_output);
+        if (!success) {
+            fprintf(stderr, "Could not write object file: %s\n", driver.object_output);
+        }
+        InsnList_free(iloc);
+        Arena_free(arena);
+        free_unused_profiles(&sim_options);
+        return (success ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    /* run program */
+    DecodedProgram* decoded = DecodedProgram_new(iloc);
+    run_program(decoded, iloc, &sim_options, &driver);
+    DecodedProgram_free(decoded);
 
     /* clean up ILOC code (no longer needed) */
     InsnList_free(iloc);
     iloc = NULL;
+    Arena_free(arena);
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,524 @@
+#include "native.h"
+
+/**
+ * @brief Native registers available for virtual registers (in order of
+ * preference)
+ *
+ * Fixed assignments: r13 is the ILOC stack pointer, r14 is the ILOC base
+ * pointer, r15 is the base of the simulated address space, and rax, rcx, and
+ * rdx are scratch registers. The print runtime preserves every register except
+ * the scratch registers.
+ */
+const char* native_reg_names[NUM_NATIVE_REGS] = {
+    "%rbx", "%r12", "%rbp", "%rsi", "%rdi", "%r8", "%r9", "%r10", "%r11"
+};
+
+/**
+ * @brief State for lowering one program
+ */
+typedef struct NativeEmitter
+{
+    DecodedProgram* program;        /**< @brief Program being lowered */
+    int mem_size;                   /**< @brief Size of the simulated address space */
+    FILE* output;                   /**< @brief Assembly output stream */
+
+    /**
+     * @brief Location of each machine register: a native register index
+     * (>= 0), a spill slot (-1 - slot), or @c NO_LOCATION if unused
+     */
+    int* location;
+
+    int num_spills;                 /**< @brief Number of spill slots */
+    bool* is_target;                /**< @brief Does each instruction need a label? */
+    bool* is_return_site;           /**< @brief Can each instruction be returned to? */
+} NativeEmitter;
+
+#define NO_LOCATION (-1 - FIRST_VIRTUAL_REG - MAX_VIRTUAL_REGS)
+
+/**
+ * @brief Assign locations to all registers used by the program
+ *
+ * The most frequently referenced registers get native registers; the rest are
+ * spilled. ILOC registers are global (they are not saved across calls), so the
+ * mapping is the same for the whole program and spill slots are static.
+ */
+void NativeEmitter_map_registers (NativeEmitter* e)
+{
+    DecodedProgram* program = e->program;
+    int* counts = (int*)calloc(program->num_regs, sizeof(int));
+    CHECK_MALLOC_PTR(counts);
+    for (int i = 0; i < program->size; i++) {
+        DecodedInsn* insn = &program->code[i];
+        if (insn->form == LABEL || insn->form == JUMP || insn->form == CBR || insn->form == CALL) {
+            if (insn->form == CBR) {
+                counts[insn->op[0]]++;
+            }
+            continue;
+        }
+        for (int j = 0; j < 3; j++) {
+            if (insn->op[j] >= 0) {
+                counts[insn->op[j]]++;
+            }
+        }
+    }
+    counts[REG_SP] = 0;     /* SP and BP have fixed native registers */
+    counts[REG_BP] = 0;
+    counts[REG_RET]++;      /* read on exit */
+
+    e->location = (int*)malloc(program->num_regs * sizeof(int));
+    CHECK_MALLOC_PTR(e->location);
+    for (int r = 0; r < program->num_regs; r++) {
+        e->location[r] = NO_LOCATION;
+    }
+    for (int n = 0; n < NUM_NATIVE_REGS; n++) {
+        int best = -1;
+        for (int r = 0; r < program->num_regs; r++) {
+            if (counts[r] > 0 && e->location[r] == NO_LOCATION &&
+                    (best < 0 || counts[r] > counts[best])) {
+                best = r;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        e->location[best] = n;
+    }
+    e->num_spills = 0;
+    for (int r = 0; r < program->num_regs; r++) {
+        if (counts[r] > 0 && e->location[r] == NO_LOCATION) {
+            e->location[r] = -1 - e->num_spills++;
+        }
+    }
+    free(counts);
+}
+
+/**
+ * @brief Print the assembly operand for a machine register
+ */
+void NativeEmitter_print_reg (NativeEmitter* e, int reg)
+{
+    if (reg == REG_SP) {
+        fprintf(e->output, "%%r13");
+    } else if (reg == REG_BP) {
+        fprintf(e->output, "%%r14");
+    } else if (e->location[reg] >= 0) {
+        fprintf(e->output, "%s", native_reg_names[e->location[reg]]);
+    } else {
+        fprintf(e->output, ".Lspill+%d(%%rip)", (-1 - e->location[reg]) * WORD_SIZE);
+    }
+}
+
+/* OP <reg>, SCRATCH (e.g., "movq r3, %rax" or "addq r3, %rax") */
+void NativeEmitter_read (NativeEmitter* e, const char* op, int reg, const char* scratch)
+{
+    fprintf(e->output, "\t%s\t", op);
+    NativeEmitter_print_reg(e, reg);
+    fprintf(e->output, ", %s\n", scratch);
+}
+
+/* movq SCRATCH, <reg> */
+void NativeEmitter_write (NativeEmitter* e, int reg, const char* scratch)
+{
+    fprintf(e->output, "\tmovq\t%s, ", scratch);
+    NativeEmitter_print_reg(e, reg);
+    fprintf(e->output, "\n");
+}
+
+bool fits_int32 (long value)
+{
+    return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+/* OP $imm, SCRATCH (via rcx if the immediate does not fit in 32 bits) */
+void NativeEmitter_imm_op (NativeEmitter* e, const char* op, long imm, const char* scratch)
+{
+    if (fits_int32(imm)) {
+        fprintf(e->output, "\t%s\t$%ld, %s\n", op, imm, scratch);
+    } else {
+        fprintf(e->output, "\tmovabsq\t$%ld, %%rcx\n", imm);
+        fprintf(e->output, "\t%s\t%%rcx, %s\n", op, scratch);
+    }
+}
+
+/* addresses are truncated to int, just like in the simulator */
+#define ADDRESS_RAX "\tmovslq\t%%eax, %%rax\n"
+
+void NativeEmitter_insn (NativeEmitter* e, int index)
+{
+    DecodedInsn* insn = &e->program->code[index];
+    FILE* output = e->output;
+
+    fprintf(output, "\t# ");
+    ILOCInsn_print(e->program->source[index], output);
+    fprintf(output, "\n");
+
+    switch (insn->form)
+    {
+        case LOAD_I:
+            NativeEmitter_imm_op(e, "movq", insn->imm, "%rax");
+            NativeEmitter_write(e, insn->op[1], "%rax");
+            break;
+
+        case LOAD:
+            NativeEmitter_read(e, "movq", insn->op[0], "%rax");
+            fprintf(output, ADDRESS_RAX "\tmovq\t(%%r15,%%rax), %%rax\n");
+            NativeEmitter_write(e, insn->op[1], "%rax");
+            break;
+        case LOAD_AI:
+            NativeEmitter_read(e, "movq", insn->op[0], "%rax");
+            NativeEmitter_imm_op(e, "addq", insn->imm, "%rax");
+            fprintf(output, ADDRESS_RAX "\tmovq\t(%%r15,%%rax), %%rax\n");
+            NativeEmitter_write(e, insn->op[2], "%rax");
+            break;
+        case LOAD_AO:
+            NativeEmitter_read(e, "movq", insn->op[0], "%rax");
+            NativeEmitter_read(e, "addq", insn->op[1], "%rax");
+            fprintf(output, ADDRESS_RAX "\tmovq\t(%%r15,%%rax), %%rax\n");
+            NativeEmitter_write(e, insn->op[2], "%rax");
+            break;
+
+        case STORE:
+            NativeEmitter_read(e, "movq", insn->op[1], "%rax");
+            NativeEmitter_read(e, "movq", insn->op[0], "%rcx");
+            fprintf(output, ADDRESS_RAX "\tmovq\t%%rcx, (%%r15,%%rax)\n");
+            break;
+        case STORE_AI:
+            NativeEmitter_read(e, "movq", insn->op[1], "%rax");
+            NativeEmitter_imm_op(e, "addq", insn->imm, "%rax");
+            NativeEmitter_read(e, "movq", insn->op[0], "%rcx");
+            fprintf(output, ADDRESS_RAX "\tmovq\t%%rcx, (%%r15,%%rax)\n");
+            break;
+        case STORE_AO:
+            NativeEmitter_read(e, "movq", insn->op[1], "%rax");
+            NativeEmitter_read(e, "addq", insn->op[2], "%rax");
+            NativeEmitter_read(e, "movq", insn->op[0], "%rcx");
+            fprintf(output, ADDRESS_RAX "\tmovq\t%%rcx, (%%r15,%%rax)\n");
+            break;
+
+        case ADD:
+        case SUB:
+        case MULT:
+        case AND:
+        case OR:
+        {
+            const char* op = (insn->form == ADD ? "addq" : insn->form == SUB ? "subq" :
+                              insn->form == MULT ? "imulq" : insn->form == AND ? "andq" : "orq");
+            NativeEmitter_read(e, "movq", insn->op[0], "%rax");
+            NativeEmitter_read(e, op, insn->op[1], "%rax");
+            NativeEmitter_write(e, insn->op[2], "%rax");
+            break;
+        }
+        case DIV:
+            NativeEmitter_read(e, "movq", insn->op[0], "%rax");
+            NativeEmitter_read(e, "movq", insn->op[1], "%rcx");
+            fprintf(output, "\tcqto\n\tidivq\t%%rcx\n");
+            NativeEmitter_write(e, insn->op[2], "%rax");
+            break;
+
+        case CMP_LT:
+        case CMP_LE:
+        case CMP_EQ:
+        case CMP_NE:
+        case CMP_GE:
+        case CMP_GT:
+        {
+            const char* set = (insn->form == CMP_LT ? "setl" : insn->form == CMP_LE ? "setle" :
+                               insn->form == CMP_EQ ? "sete" : insn->form == CMP_NE ? "setne" :
+                               insn->form == CMP_GE ? "setge" : "setg");
+            NativeEmitter_read(e, "movq", insn->op[0], "%rax");
+            NativeEmitter_read(e, "cmpq", insn->op[1], "%rax");
+            fprintf(output, "\t%s\t%%al\n\tmovzbl\t%%al, %%eax\n", set);
+            NativeEmitter_write(e, insn->op[2], "%rax");
+            break;
+        }
+
+        case ADD_I:
+            NativeEmitter_read(e, "movq", insn->op[0], "%rax");
+            NativeEmitter_imm_op(e, "addq", insn->imm, "%rax");
+            NativeEmitter_write(e, insn->op[2], "%rax");
+            break;
+        case MULT_I:
+            NativeEmitter_read(e, "movq", insn->op[0], "%rax");
+            NativeEmitter_imm_op(e, "imulq", insn->imm, "%rax");
+            NativeEmitter_write(e, insn->op[2], "%rax");
+            break;
+
+        case I2I:
+            NativeEmitter_read(e, "movq", insn->op[0], "%rax");
+            NativeEmitter_write(e, insn->op[1], "%rax");
+            break;
+        case NOT:
+            NativeEmitter_read(e, "movq", insn->op[0], "%rax");
+            fprintf(output, "\tnotq\t%%rax\n\tandl\t$1, %%eax\n");
+            NativeEmitter_write(e, insn->op[1], "%rax");
+            break;
+        case NEG:
+            NativeEmitter_read(e, "movq", insn->op[0], "%rax");
+            fprintf(output, "\tnegq\t%%rax\n");
+            NativeEmitter_write(e, insn->op[1], "%rax");
+            break;
+
+        case PUSH:
+            /* the pushed value is read after SP is decremented */
+            fprintf(output, "\tsubq\t$%d, %%r13\n", WORD_SIZE);
+            NativeEmitter_read(e, "movq", insn->op[0], "%rax");
+            fprintf(output, "\tmovq\t%%rax, (%%r15,%%r13)\n");
+            break;
+        case POP:
+            fprintf(output, "\tmovq\t(%%r15,%%r13), %%rax\n");
+            fprintf(output, "\taddq\t$%d, %%r13\n", WORD_SIZE);
+            NativeEmitter_write(e, insn->op[0], "%rax");
+            break;
+
+        case JUMP:
+            fprintf(output, "\tjmp\t.Li%d\n", insn->op[0]);
+            break;
+        case CBR:
+            NativeEmitter_read(e, "movq", insn->op[0], "%rax");
+            fprintf(output, "\ttestq\t%%rax, %%rax\n");
+            fprintf(output, "\tjne\t.Li%d\n", insn->op[1]);
+            fprintf(output, "\tjmp\t.Li%d\n", insn->op[2]);
+            break;
+
+        case CALL:
+            /* return address is the index of the next instruction (as in the simulator) */
+            fprintf(output, "\tsubq\t$%d, %%r13\n", WORD_SIZE);
+            fprintf(output, "\tmovq\t$%d, (%%r15,%%r13)\n", index + 1);
+            fprintf(output, "\tjmp\t.Li%d\n", insn->op[0]);
+            break;
+        case RETURN:
+            fprintf(output, "\tcmpq\t$%d, %%r13\n", e->mem_size);
+            fprintf(output, "\tje\t.Lexit\n");
+            fprintf(output, "\tmovq\t(%%r15,%%r13), %%rax\n");
+            fprintf(output, "\taddq\t$%d, %%r13\n", WORD_SIZE);
+            fprintf(output, "\tleaq\t.Lreturn_table(%%rip), %%rcx\n");
+            fprintf(output, "\tmovslq\t(%%rcx,%%rax,4), %%rax\n");
+            fprintf(output, "\taddq\t%%rcx, %%rax\n");
+            fprintf(output, "\tjmp\t*%%rax\n");
+            break;
+
+        case PRINT:
+            if (insn->str != NULL) {
+                fprintf(output, "\tleaq\t.Lstr%d(%%rip), %%rax\n", index);
+                fprintf(output, "\tcall\t.Lprint_str\n");
+            } else if (insn->op[0] < 0) {
+                NativeEmitter_imm_op(e, "movq", insn->imm, "%rax");
+                fprintf(output, "\tcall\t.Lprint_int\n");
+            } else {
+                NativeEmitter_read(e, "movq", insn->op[0], "%rax");
+                fprintf(output, "\tcall\t.Lprint_int\n");
+            }
+            break;
+
+        case LABEL:
+        case NOP:
+        case PHI:
+        default:
+            /* nothing to do */
+            break;
+    }
+}
+
+/**
+ * @brief Emit the C entry point, which sets up the machine state, runs @c main
+ * and prints its return value
+ */
+void NativeEmitter_entry (NativeEmitter* e, int main_index)
+{
+    FILE* output = e->output;
+    fprintf(output, "\t.text\n");
+    fprintf(output, "\t.globl\tmain\n");
+    fprintf(output, "\t.type\tmain, @function\n");
+    fprintf(output, "main:\n");
+    fprintf(output, "\tpushq\t%%rbx\n\tpushq\t%%rbp\n\tpushq\t%%r12\n");
+    fprintf(output, "\tpushq\t%%r13\n\tpushq\t%%r14\n\tpushq\t%%r15\n");
+    fprintf(output, "\tsubq\t$8, %%rsp\n");
+    fprintf(output, "\tleaq\t.Lmem(%%rip), %%r15\n");
+    fprintf(output, "\tmovq\t$%d, %%r13\n", e->mem_size);
+    fprintf(output, "\tmovq\t$%d, %%r14\n", UNINIT_REG);
+    for (int r = 0; r < e->program->num_regs; r++) {
+        if (e->location[r] >= 0) {
+            fprintf(output, "\tmovq\t$%d, %s\n", UNINIT_REG, native_reg_names[e->location[r]]);
+        }
+    }
+    fprintf(output, "\tjmp\t.Li%d\n", main_index + 1);
+}
+
+/**
+ * @brief Emit the exit sequence and the print runtime
+ */
+void NativeEmitter_runtime (NativeEmitter* e)
+{
+    FILE* output = e->output;
+
+    fprintf(output, ".Lexit:\n");
+    NativeEmitter_read(e, "movq", REG_RET, "%rax");
+    fprintf(output, "\tmovl\t%%eax, %%esi\n");
+    fprintf(output, "\tleaq\t.Lfmt_return(%%rip), %%rdi\n");
+    fprintf(output, "\txorl\t%%eax, %%eax\n");
+    fprintf(output, "\tcall\tprintf@PLT\n");
+    fprintf(output, "\taddq\t$8, %%rsp\n");
+    fprintf(output, "\tpopq\t%%r15\n\tpopq\t%%r14\n\tpopq\t%%r13\n");
+    fprintf(output, "\tpopq\t%%r12\n\tpopq\t%%rbp\n\tpopq\t%%rbx\n");
+    fprintf(output, "\txorl\t%%eax, %%eax\n");
+    fprintf(output, "\tret\n");
+    fprintf(output, "\t.size\tmain, .-main\n");
+
+    /* returning to anything but a call site (impossible in verified code) */
+    fprintf(output, ".Lbad_return:\n\tud2\n");
+
+    /* print routines (argument in rax; preserve all non-scratch registers) */
+    const char* routines[][2] = { { "print_int", "fmt_int" }, { "print_str", "fmt_str" } };
+    for (int i = 0; i < 2; i++) {
+        fprintf(output, ".L%s:\n", routines[i][0]);
+        fprintf(output, "\tpushq\t%%rsi\n\tpushq\t%%rdi\n\tpushq\t%%r8\n");
+        fprintf(output, "\tpushq\t%%r9\n\tpushq\t%%r10\n\tpushq\t%%r11\n");
+        fprintf(output, "\tsubq\t$8, %%rsp\n");
+        fprintf(output, "\tmovq\t%%rax, %%rsi\n");
+        fprintf(output, "\tleaq\t.L%s(%%rip), %%rdi\n", routines[i][1]);
+        fprintf(output, "\txorl\t%%eax, %%eax\n");
+        fprintf(output, "\tcall\tprintf@PLT\n");
+        fprintf(output, "\taddq\t$8, %%rsp\n");
+        fprintf(output, "\tpopq\t%%r11\n\tpopq\t%%r10\n\tpopq\t%%r9\n");
+        fprintf(output, "\tpopq\t%%r8\n\tpopq\t%%rdi\n\tpopq\t%%rsi\n");
+        fprintf(output, "\tret\n");
+    }
+}
+
+/**
+ * @brief Emit read-only data (format strings, string constants, and the
+ * return address table) and writable data (spill slots and memory)
+ */
+void NativeEmitter_data (NativeEmitter* e)
+{
+    DecodedProgram* program = e->program;
+    FILE* output = e->output;
+
+    fprintf(output, "\t.section\t.rodata\n");
+    fprintf(output, ".Lfmt_int:\n\t.string\t\"%s\"\n", PRIW);
+    fprintf(output, ".Lfmt_str:\n\t.string\t\"%%s\"\n");
+    fprintf(output, ".Lfmt_return:\n\t.string\t\"RETURN VALUE = %%d\\n\"\n");
+    for (int i = 0; i < program->size; i++) {
+        if (program->code[i].form == PRINT && program->code[i].str != NULL) {
+            fprintf(output, ".Lstr%d:\n\t.byte\t", i);
+            for (const char* c = program->code[i].str; *c != '\0'; c++) {
+                fprintf(output, "%d,", (unsigned char)*c);
+            }
+            fprintf(output, "0\n");
+        }
+    }
+
+    fprintf(output, "\t.p2align\t2\n");
+    fprintf(output, ".Lreturn_table:\n");
+    for (int i = 0; i <= program->size; i++) {
+        if (e->is_return_site[i]) {
+            fprintf(output, "\t.long\t.Li%d-.Lreturn_table\n", i);
+        } else {
+            fprintf(output, "\t.long\t.Lbad_return-.Lreturn_table\n");
+        }
+    }
+
+    if (e->num_spills > 0) {
+        fprintf(output, "\t.data\n");
+        fprintf(output, "\t.p2align\t3\n");
+        /* .fill only repeats a 4-byte value, so write whole words */
+        fprintf(output, ".Lspill:\n\t.rept\t%d\n\t.quad\t%d\n\t.endr\n", e->num_spills, UNINIT_REG);
+    }
+
+    fprintf(output, "\t.bss\n");
+    fprintf(output, "\t.p2align\t4\n");
+    fprintf(output, ".Lmem:\n\t.zero\t%d\n", e->mem_size);
+    fprintf(output, "\t.section\t.note.GNU-stack,\"\",@progbits\n");
+}
+
+void InsnList_print_native (InsnList* list, int mem_size, FILE* output)
+{
+    assert_valid_mem_size(mem_size);
+    DecodedProgram* program = DecodedProgram_new(list);
+    DecodedProgram_verify(program);
+    int main_index = CallTargetTable_find(program->call_targets, "main");
+    if (main_index < 0) {
+        printf("ERROR: No call target found for 'main'\n");
+        exit(EXIT_FAILURE);
+    }
+
+    NativeEmitter emitter;
+    NativeEmitter* e = &emitter;
+    e->program = program;
+    e->mem_size = mem_size;
+    e->output = output;
+    NativeEmitter_map_registers(e);
+
+    /* find instructions that need labels */
+    e->is_target = (bool*)calloc(program->size + 1, sizeof(bool));
+    CHECK_MALLOC_PTR(e->is_target);
+    e->is_return_site = (bool*)calloc(program->size + 1, sizeof(bool));
+    CHECK_MALLOC_PTR(e->is_return_site);
+    e->is_target[main_index + 1] = true;
+    for (int i = 0; i < program->size; i++) {
+        DecodedInsn* insn = &program->code[i];
+        if (insn->form == JUMP || insn->form == CALL) {
+            e->is_target[insn->op[0]] = true;
+        } else if (insn->form == CBR) {
+            e->is_target[insn->op[1]] = true;
+            e->is_target[insn->op[2]] = true;
+        }
+        if (insn->form == CALL) {
+            e->is_target[i + 1] = true;
+            e->is_return_site[i + 1] = true;
+        }
+    }
+
+    fprintf(output, "# generated by decaf (%d native registers, %d spill slots)\n",
+            NUM_NATIVE_REGS, e->num_spills);
+    NativeEmitter_entry(e, main_index);
+    for (int i = 0; i < program->size; i++) {
+        if (e->is_target[i]) {
+            fprintf(output, ".Li%d:\n", i);
+        }
+        NativeEmitter_insn(e, i);
+    }
+
+    /* falling off the end of the program halts (as in the simulator) */
+    fprintf(output, ".Li%d:\n", program->size);
+    fprintf(output, "\tjmp\t.Lexit\n");
+
+    NativeEmitter_runtime(e);
+    NativeEmitter_data(e);
+
+    free(e->location);
+    free(e->is_target);
+    free(e->is_return_site);
+    DecodedProgram_free(program);
+}
+
+bool build_native_executable (InsnList* program, int mem_size, const char* filename)
+{
+    /* write assembly */
+    size_t length = strlen(filename);
+    char* asm_filename = (char*)malloc(length + 3);
+    CHECK_MALLOC_PTR(asm_filename);
+    snprintf(asm_filename, length + 3, "%s.s", filename);
+    FILE* output = fopen(asm_filename, "w");
+    if (output == NULL) {
+        fprintf(stderr, "Could not write file: %s\n", asm_filename);
+        free(asm_filename);
+        return false;
+    }
+    InsnList_print_native(program, mem_size, output);
+    fclose(output);
+
+    /* assemble and link */
+    size_t command_size = 2 * length + 32;
+    char* command = (char*)malloc(command_size);
+    CHECK_MALLOC_PTR(command);
+    snprintf(command, command_size, "cc -o '%s' '%s'", filename, asm_filename);
+    int status = system(command);
+    if (status != 0) {
+        fprintf(stderr, "Could not assemble and link: %s\n", asm_filename);
+    }
+
+    free(command);
+    free(asm_filename);
+    return status == 0;
+}
@@ -0,0 +1,405 @@
+/*
+ * mmap/fstat are not part of strict C11
+ */
+#define _DEFAULT_SOURCE
+
+#include "objfile.h"
+
+#ifdef __unix__
+#define HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const char object_magic[8] = "ILOCOBJ";
+
+/**
+ * @brief Round a file offset up to the alignment of the 64-bit fields
+ */
+#define OBJECT_ALIGN(N) (((N) + 7) & ~((int64_t)7))
+
+/**
+ * @brief String table under construction (interned strings are keyed by
+ * address, so every distinct string is stored once)
+ */
+typedef struct ObjectStrings
+{
+    const char** keys;      /**< @brief Hash table slots (@c NULL if empty) */
+    int32_t* offsets;       /**< @brief String table offset for each slot */
+    int capacity;           /**< @brief Number of slots (a power of two) */
+    char* text;             /**< @brief String table contents */
+    int32_t size;           /**< @brief Size of the string table in bytes */
+    size_t text_capacity;   /**< @brief Allocated size of @c text */
+} ObjectStrings;
+
+/**
+ * @brief Look up (adding if necessary) the string table offset of a string
+ */
+int32_t ObjectStrings_add (ObjectStrings* strings, const char* string)
+{
+    if (string == NULL) {
+        return -1;
+    }
+    uint32_t mask = strings->capacity - 1;
+    uint32_t hash = (uint32_t)((uintptr_t)string >> 3) * 2654435761u;
+    uint32_t slot = (hash ^ (hash >> 16)) & mask;
+    while (strings->keys[slot] != NULL && strings->keys[slot] != string) {
+        slot = (slot + 1) & mask;
+    }
+    if (strings->keys[slot] == NULL) {
+        size_t length = strlen(string) + 1;
+        if (strings->size + length > strings->text_capacity) {
+            strings->text_capacity = 2 * (strings->size + length);
+            strings->text = (char*)realloc(strings->text, strings->text_capacity);
+            CHECK_MALLOC_PTR(strings->text);
+        }
+        memcpy(strings->text + strings->size, string, length);
+        strings->keys[slot] = string;
+        strings->offsets[slot] = strings->size;
+        strings->size += length;
+    }
+    return strings->offsets[slot];
+}
+
+/**
+ * @brief Convert an operand to the value stored in an instruction record
+ */
+int64_t ObjectStrings_operand_value (ObjectStrings* strings, Operand op)
+{
+    switch (op.type) {
+        case VIRTUAL_REG:
+        case JUMP_LABEL:    return op.id;
+        case INT_CONST:     return op.imm;
+        case CALL_LABEL:
+        case STR_CONST:     return ObjectStrings_add(strings, op.str);
+        default:            return 0;
+    }
+}
+
+bool ObjectFile_save (InsnList* program, const char* filename)
+{
+    ObjectFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, object_magic, sizeof(header.magic));
+    header.version = OBJECT_FORMAT_VERSION;
+    header.num_insns = InsnList_size(program);
+    header.num_regs = FIRST_VIRTUAL_REG;
+
+    /* every instruction has at most four strings (three operands and a comment) */
+    ObjectStrings strings;
+    memset(&strings, 0, sizeof(strings));
+    strings.capacity = 16;
+    while (strings.capacity < 8 * (header.num_insns + 1)) {
+        strings.capacity *= 2;
+    }
+    strings.keys = (const char**)calloc(strings.capacity, sizeof(const char*));
+    CHECK_MALLOC_PTR(strings.keys);
+    strings.offsets = (int32_t*)calloc(strings.capacity, sizeof(int32_t));
+    CHECK_MALLOC_PTR(strings.offsets);
+
+    /* build instruction records and find the sizes of the indices */
+    ObjectInsn* records = (ObjectInsn*)calloc(header.num_insns + 1, sizeof(ObjectInsn));
+    CHECK_MALLOC_PTR(records);
+    int i = 0;
+    FOR_EACH (ILOCInsn*, insn, program) {
+        ObjectInsn* record = &records[i++];
+        record->form = insn->form;
+        record->comment = ObjectStrings_add(&strings, insn->comment);
+        for (int j = 0; j < 3; j++) {
+            record->type[j] = insn->op[j].type;
+            record->value[j] = ObjectStrings_operand_value(&strings, insn->op[j]);
+            if (insn->op[j].type == VIRTUAL_REG && FIRST_VIRTUAL_REG + insn->op[j].id >= header.num_regs) {
+                header.num_regs = FIRST_VIRTUAL_REG + insn->op[j].id + 1;
+            }
+        }
+        if (insn->form == LABEL && insn->op[0].type == JUMP_LABEL) {
+            if (insn->op[0].id >= header.num_labels) {
+                header.num_labels = insn->op[0].id + 1;
+            }
+        } else if (insn->form == LABEL && insn->op[0].type == CALL_LABEL) {
+            header.num_functions++;
+        }
+    }
+
+    /* build label and function indices */
+    int32_t* labels = (int32_t*)malloc((header.num_labels + 1) * sizeof(int32_t));
+    CHECK_MALLOC_PTR(labels);
+    for (i = 0; i < header.num_labels; i++) {
+        labels[i] = -1;
+    }
+    ObjectFunction* functions = (ObjectFunction*)calloc(header.num_functions + 1, sizeof(ObjectFunction));
+    CHECK_MALLOC_PTR(functions);
+    int num_functions = 0;
+    i = 0;
+    FOR_EACH (ILOCInsn*, insn, program) {
+        if (insn->form == LABEL && insn->op[0].type == JUMP_LABEL && insn->op[0].id >= 0) {
+            labels[insn->op[0].id] = i;
+        } else if (insn->form == LABEL && insn->op[0].type == CALL_LABEL) {
+            functions[num_functions].name = (int32_t)records[i].value[0];
+            functions[num_functions].index = i;
+            num_functions++;
+        }
+        i++;
+    }
+
+    /* lay out sections */
+    header.strings_size = strings.size;
+    header.insns_offset = OBJECT_ALIGN((int64_t)sizeof(header));
+    header.labels_offset = header.insns_offset + header.num_insns * (int64_t)sizeof(ObjectInsn);
+    header.functions_offset = OBJECT_ALIGN(header.labels_offset + header.num_labels * (int64_t)sizeof(int32_t));
+    header.strings_offset = header.functions_offset + header.num_functions * (int64_t)sizeof(ObjectFunction);
+
+    /* write file */
+    bool success = false;
+    FILE* output = fopen(filename, "wb");
+    if (output != NULL) {
+        static const char padding[8] = { 0 };
+        success = fwrite(&header, sizeof(header), 1, output) == 1 &&
+                  fwrite(padding, 1, header.insns_offset - sizeof(header), output) == (size_t)(header.insns_offset - sizeof(header)) &&
+                  fwrite(records, sizeof(ObjectInsn), header.num_insns, output) == (size_t)header.num_insns &&
+                  fwrite(labels, sizeof(int32_t), header.num_labels, output) == (size_t)header.num_labels &&
+                  fwrite(padding, 1, header.functions_offset - header.labels_offset - header.num_labels * sizeof(int32_t), output) ==
+                        (size_t)(header.functions_offset - header.labels_offset - header.num_labels * sizeof(int32_t)) &&
+                  fwrite(functions, sizeof(ObjectFunction), header.num_functions, output) == (size_t)header.num_functions &&
+                  fwrite(strings.text, 1, strings.size, output) == (size_t)strings.size;
+        success = (fclose(output) == 0) && success;
+    }
+
+    free(strings.keys);
+    free(strings.offsets);
+    free(strings.text);
+    free(records);
+    free(labels);
+    free(functions);
+    return success;
+}
+
+/**
+ * @brief Read a whole file into memory (mapping it if possible)
+ */
+bool ObjectFile_read (ObjectFile* object, const char* filename)
+{
+#ifdef HAVE_MMAP
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    object->data = data;
+    object->data_size = info.st_size;
+    return true;
+#else
+    FILE* input = fopen(filename, "rb");
+    if (input == NULL) {
+        return false;
+    }
+    size_t capacity = 4096;
+    object->data = malloc(capacity);
+    CHECK_MALLOC_PTR(object->data);
+    size_t count;
+    while ((count = fread((char*)object->data + object->data_size, 1,
+                    capacity - object->data_size, input)) > 0) {
+        object->data_size += count;
+        if (object->data_size == capacity) {
+            capacity *= 2;
+            object->data = realloc(object->data, capacity);
+            CHECK_MALLOC_PTR(object->data);
+        }
+    }
+    fclose(input);
+    return true;
+#endif
+}
+
+/**
+ * @brief Test whether a file section lies entirely within the file and is
+ * suitably aligned
+ */
+bool ObjectFile_has_section (ObjectFile* object, int64_t offset, int64_t count, int64_t size)
+{
+    return offset >= (int64_t)sizeof(ObjectFileHeader) && offset % 8 == 0 &&
+           count >= 0 && offset + count * size <= (int64_t)object->data_size;
+}
+
+/**
+ * @brief Look up a string in the string table (or @c NULL if the offset is
+ * invalid)
+ */
+const char* ObjectFile_string (ObjectFileHeader* header, const char* strings, int64_t offset)
+{
+    if (offset < 0 || offset >= header->strings_size) {
+        return NULL;
+    }
+    return strings + offset;
+}
+
+/**
+ * @brief Rebuild an instruction from its record
+ *
+ * @returns True if and only if the record is valid
+ */
+bool ObjectFile_decode_insn (ObjectFileHeader* header, const char* strings, ObjectInsn* record, ILOCInsn* insn)
+{
+    if (record->form < 0 || record->form > PHI) {
+        return false;
+    }
+    insn->form = (InsnForm)record->form;
+    insn->comment = NULL;
+    if (record->comment != -1) {
+        insn->comment = ObjectFile_string(header, strings, record->comment);
+        if (insn->comment == NULL) {
+            return false;
+        }
+    }
+    for (int j = 0; j < 3; j++) {
+        Operand* op = &insn->op[j];
+        int64_t value = record->value[j];
+        if (record->type[j] < EMPTY || record->type[j] > STR_CONST) {
+            return false;
+        }
+        op->type = (OperandType)record->type[j];
+        switch (op->type) {
+            case VIRTUAL_REG:
+                if (value < 0 || value >= header->num_regs - FIRST_VIRTUAL_REG) {
+                    return false;
+                }
+                op->id = (int)value;
+                break;
+            case JUMP_LABEL:
+                if (value < 0 || value >= header->num_labels) {
+                    return false;
+                }
+                op->id = (int)value;
+                break;
+            case INT_CONST:
+                op->imm = (long)value;
+                break;
+            case CALL_LABEL:
+            case STR_CONST:
+                op->str = ObjectFile_string(header, strings, value);
+                if (op->str == NULL) {
+                    return false;
+                }
+                break;
+            default:
+                op->id = 0;
+                break;
+        }
+    }
+    return true;
+}
+
+ObjectFile* ObjectFile_load (const char* filename)
+{
+    ObjectFile* object = (ObjectFile*)calloc(1, sizeof(ObjectFile));
+    CHECK_MALLOC_PTR(object);
+    if (!ObjectFile_read(object, filename)) {
+        free(object);
+        return NULL;
+    }
+
+    /* check the header and the section bounds */
+    ObjectFileHeader* header = (ObjectFileHeader*)object->data;
+    if (object->data_size < sizeof(ObjectFileHeader) ||
+            memcmp(header->magic, object_magic, sizeof(header->magic)) != 0 ||
+            header->version != OBJECT_FORMAT_VERSION || header->num_insns < 0 ||
+            header->num_regs < FIRST_VIRTUAL_REG || header->num_regs > FIRST_VIRTUAL_REG + MAX_VIRTUAL_REGS ||
+            header->num_labels < 0 || header->num_functions < 0 || header->strings_size < 0 ||
+            !ObjectFile_has_section(object, header->insns_offset, header->num_insns, sizeof(ObjectInsn)) ||
+            !ObjectFile_has_section(object, header->labels_offset, header->num_labels, sizeof(int32_t)) ||
+            !ObjectFile_has_section(object, header->functions_offset, header->num_functions, sizeof(ObjectFunction)) ||
+            header->strings_offset < (int64_t)sizeof(ObjectFileHeader) ||
+            header->strings_offset + header->strings_size > (int64_t)object->data_size) {
+        ObjectFile_free(object);
+        return NULL;
+    }
+    ObjectInsn* records = (ObjectInsn*)((char*)object->data + header->insns_offset);
+    int32_t* labels = (int32_t*)((char*)object->data + header->labels_offset);
+    ObjectFunction* functions = (ObjectFunction*)((char*)object->data + header->functions_offset);
+    const char* strings = (char*)object->data + header->strings_offset;
+    if (header->strings_size > 0 && strings[header->strings_size - 1] != '\0') {
+        ObjectFile_free(object);
+        return NULL;
+    }
+
+    /* rebuild the instructions (strings stay in the string table) */
+    int size = header->num_insns;
+    object->insns = (ILOCInsn*)calloc(size + 1, sizeof(ILOCInsn));
+    CHECK_MALLOC_PTR(object->insns);
+    object->list = (InsnList*)calloc(1, sizeof(InsnList));
+    CHECK_MALLOC_PTR(object->list);
+    DecodedProgram* decoded = (DecodedProgram*)calloc(1, sizeof(DecodedProgram));
+    CHECK_MALLOC_PTR(decoded);
+    decoded->size = size;
+    decoded->num_regs = header->num_regs;
+    decoded->code = (DecodedInsn*)calloc(size + 1, sizeof(DecodedInsn));
+    CHECK_MALLOC_PTR(decoded->code);
+    decoded->source = (ILOCInsn**)calloc(size + 1, sizeof(ILOCInsn*));
+    CHECK_MALLOC_PTR(decoded->source);
+    decoded->call_targets = CallTargetTable_new(header->num_functions);
+    object->program = decoded;
+
+    bool valid = true;
+    for (int i = 0; valid && i < size; i++) {
+        ILOCInsn* insn = &object->insns[i];
+        valid = ObjectFile_decode_insn(header, strings, &records[i], insn);
+        insn->next = (i + 1 < size ? &object->insns[i + 1] : NULL);
+        decoded->source[i] = insn;
+    }
+    object->list->head = (size > 0 ? &object->insns[0] : NULL);
+    object->list->tail = (size > 0 ? &object->insns[size - 1] : NULL);
+    object->list->size = size;
+
+    /* use the precomputed indices instead of scanning for labels */
+    int* jump_targets = (int*)malloc((header->num_labels + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(jump_targets);
+    for (int i = 0; valid && i < header->num_labels; i++) {
+        valid = (labels[i] >= -1 && labels[i] < size);
+        jump_targets[i] = (labels[i] >= 0 ? labels[i] + 1 : -1);
+    }
+    for (int i = 0; valid && i < header->num_functions; i++) {
+        const char* name = ObjectFile_string(header, strings, functions[i].name);
+        valid = (name != NULL && functions[i].index >= 0 && functions[i].index < size);
+        if (valid) {
+            CallTargetTable_add(decoded->call_targets, name, functions[i].index);
+        }
+    }
+    if (valid) {
+        DecodedProgram_decode(decoded, jump_targets, header->num_labels);
+    }
+    free(jump_targets);
+
+    if (!valid) {
+        ObjectFile_free(object);
+        return NULL;
+    }
+    return object;
+}
+
+void ObjectFile_free (ObjectFile* object)
+{
+    if (object->program != NULL) {
+        DecodedProgram_free(object->program);
+    }
+    free(object->list);
+    free(object->insns);
+    if (object->data != NULL) {
+#ifdef HAVE_MMAP
+        munmap(object->data, object->data_size);
+#else
+        free(object->data);
+#endif
+    }
+    free(object);
+}
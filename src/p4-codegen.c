@@ -125,9 +125,9 @@ void CodeGenVisitor_gen_program (NodeVisitor* visitor, ASTNode* node)
      * really any need to re-print all the functions in the program node *
      */
     ASTNode_set_attribute(node, "code", InsnList_new(), (Destructor)InsnList_free);
-    /* copy code from each function */
+    /* move code from each function */
     FOR_EACH(ASTNode*, func, node->program.functions) {
-        ASTNode_copy_code(node, func);
+        ASTNode_move_code(node, func);
     }
 }
 void CodeGenVisitor_gen_literal (NodeVisitor* visitor, ASTNode* node) {
@@ -155,9 +155,9 @@ void CodeGenVisitor_gen_funcCall(NodeVisitor* visitor, ASTNode* node) {
 }
 void CodeGenVisitor_gen_assignment(NodeVisitor* visitor, ASTNode* node) 
 {
-    //Copies over code from both sides of the equals sign
-    ASTNode_copy_code(node, node->assignment.value);
-    ASTNode_copy_code(node, node->assignment.location);
+    //Moves over code from both sides of the equals sign
+    ASTNode_move_code(node, node->assignment.value);
+    ASTNode_move_code(node, node->assignment.location);
     // Calculates the base and offset for storing
     Operand base    = var_base  (node, lookup_symbol(node, node->assignment.location->location.name));
     Operand offset  = var_offset(node, lookup_symbol(node, node->assignment.location->location.name));
@@ -193,8 +193,8 @@ void CodeGenVisitor_previsit_funcdecl (NodeVisitor* visitor, ASTNode* node)
 
 void CodeGenVisitor_gen_return (NodeVisitor* visitor, ASTNode* node) 
 {
-    // Copies code from function return, gets the return register and returns it
-    ASTNode_copy_code(node, node->funcreturn.value);
+    // Moves code from function return, gets the return register and returns it
+    ASTNode_move_code(node, node->funcreturn.value);
     Operand return_reg = ASTNode_get_temp_reg(node->funcreturn.value);
     EMIT2OP(I2I, return_reg, return_register());
 }
@@ -202,7 +202,7 @@ void CodeGenVisitor_gen_return (NodeVisitor* visitor, ASTNode* node)
 void CodeGenVisitor_gen_block (NodeVisitor* visitor, ASTNode* node) 
 {
     FOR_EACH(ASTNode*, n, node->block.statements) {
-        ASTNode_copy_code(node, n);
+        ASTNode_move_code(node, n);
     }
     EMIT1OP(JUMP, DATA->current_epilogue_jump_label);
 }
@@ -216,8 +216,8 @@ void CodeGenVisitor_gen_funcdecl (NodeVisitor* visitor, ASTNode* node)
     EMIT2OP(I2I, DATA->sp, DATA->bp);
     // Figure out the offset of the current function
     EMIT3OP(ADD_I, DATA->sp, int_const(ASTNode_get_int_attribute(node, "stackpointer_offset_size") *  WORD_SIZE), DATA->sp);
-    /* copy code from body */
-    ASTNode_copy_code(node, node->funcdecl.body);
+    /* move code from body */
+    ASTNode_move_code(node, node->funcdecl.body);
     EMIT1OP(LABEL, DATA->current_epilogue_jump_label);
     /* BOILERPLATE: TODO: implement epilogue */
     EMIT2OP(I2I, DATA->bp, DATA->sp);
@@ -226,9 +226,9 @@ void CodeGenVisitor_gen_funcdecl (NodeVisitor* visitor, ASTNode* node)
 }
 void CodeGenVisitor_gen_binaryop (NodeVisitor* visitor, ASTNode* node) 
 {
-    // Copies code from left and right sides
-    ASTNode_copy_code(node, node->binaryop.left);
-    ASTNode_copy_code(node, node->binaryop.right);
+    // Moves code from left and right sides
+    ASTNode_move_code(node, node->binaryop.left);
+    ASTNode_move_code(node, node->binaryop.right);
     // Sets up registers from left and right nodes as well as creating one for storage
     Operand left_reg    = ASTNode_get_temp_reg(node->binaryop.left);
     Operand right_reg   = ASTNode_get_temp_reg(node->binaryop.right);
@@ -271,8 +271,8 @@ void CodeGenVisitor_gen_binaryop (NodeVisitor* visitor, ASTNode* node)
 }
 void CodeGenVisitor_gen_unaryop (NodeVisitor* visitor, ASTNode* node) 
 {
-    // Copies code from the child of unary op
-    ASTNode_copy_code(node, node->unaryop.child);
+    // Moves code from the child of unary op
+    ASTNode_move_code(node, node->unaryop.child);
     Operand child_reg = ASTNode_get_temp_reg(node->unaryop.child);
     Operand store_reg = virtual_register();
     ASTNode_set_temp_reg(node, store_reg);
@@ -320,10 +320,8 @@ InsnList* generate_code (ASTNode* tree)
     /* generate code into AST attributes */
     NodeVisitor_traverse_and_free(v, tree);
 
-    /* copy generated code into new list (the AST may be deallocated before
+    /* move generated code into new list (the AST may be deallocated before
      * the ILOC code is needed) */
-    FOR_EACH(ILOCInsn*, i, (InsnList*)ASTNode_get_attribute(tree, "code")) {
-        InsnList_add(iloc, ILOCInsn_copy(i));
-    }
+    InsnList_splice(iloc, ASTNode_get_attribute(tree, "code"));
     return iloc;
 }
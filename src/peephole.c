@@ -0,0 +1,319 @@
+#include "peephole.h"
+#include "insnvector.h"
+
+/**
+ * @brief Instructions currently under the peephole window
+ */
+typedef struct PeepholeWindow
+{
+    InsnVector* code;                   /**< @brief Code being rewritten */
+    ILOCInsn* insn[PEEPHOLE_WINDOW];    /**< @brief Consecutive instructions (skipping deleted slots) */
+    int slot[PEEPHOLE_WINDOW];          /**< @brief Vector index of every instruction */
+    int length;                         /**< @brief Number of instructions (fewer at the end of the code) */
+    int* label_uses;                    /**< @brief Number of branches to every jump label */
+    int removed;                        /**< @brief Instructions removed so far */
+} PeepholeWindow;
+
+/**
+ * @brief Entry in the peephole table
+ */
+typedef struct PeepholeRule
+{
+    int length;                                 /**< @brief Number of instructions matched */
+    InsnForm forms[PEEPHOLE_WINDOW];            /**< @brief Forms of the instructions */
+    bool (*matches) (PeepholeWindow* w);        /**< @brief Condition on the operands */
+    void (*rewrite) (PeepholeWindow* w);        /**< @brief Replacement */
+} PeepholeRule;
+
+/**
+ * @brief Test whether two operands are the same register, label, or constant
+ */
+bool Operand_equals (Operand a, Operand b)
+{
+    if (a.type != b.type) {
+        return false;
+    }
+    switch (a.type) {
+        case VIRTUAL_REG: case JUMP_LABEL:  return a.id == b.id;
+        case INT_CONST:                     return a.imm == b.imm;
+        case CALL_LABEL:  case STR_CONST:   return a.str == b.str;
+        default:                            return true;
+    }
+}
+
+/**
+ * @brief Add @p delta to the use counts of all labels an instruction branches to
+ */
+void PeepholeWindow_count_targets (PeepholeWindow* w, ILOCInsn* insn, int delta)
+{
+    if (insn->form != JUMP && insn->form != CBR) {
+        return;
+    }
+    for (int i = 0; i < 3; i++) {
+        if (insn->op[i].type == JUMP_LABEL) {
+            w->label_uses[insn->op[i].id] += delta;
+        }
+    }
+}
+
+/**
+ * @brief Delete the i-th instruction of the window
+ */
+void PeepholeWindow_remove (PeepholeWindow* w, int i)
+{
+    PeepholeWindow_count_targets(w, w->insn[i], -1);
+    InsnVector_delete(w->code, w->slot[i]);
+    w->insn[i] = NULL;
+    w->removed++;
+}
+
+/**
+ * @brief Turn the i-th instruction of the window into a copy (or delete it if
+ * it would copy a register to itself)
+ */
+void PeepholeWindow_copy (PeepholeWindow* w, int i, Operand src, Operand dest)
+{
+    if (Operand_equals(src, dest)) {
+        PeepholeWindow_remove(w, i);
+        return;
+    }
+    ILOCInsn* insn = w->insn[i];
+    insn->form = I2I;
+    insn->op[0] = src;
+    insn->op[1] = dest;
+    insn->op[2] = empty_operand();
+}
+
+/* i2i rX => rX */
+bool is_self_copy (PeepholeWindow* w)
+{
+    return Operand_equals(w->insn[0]->op[0], w->insn[0]->op[1]);
+}
+
+void remove_first (PeepholeWindow* w)
+{
+    PeepholeWindow_remove(w, 0);
+}
+
+void remove_second (PeepholeWindow* w)
+{
+    PeepholeWindow_remove(w, 1);
+}
+
+/* addI rX, 0 => rY and multI rX, 1 => rY */
+bool adds_zero (PeepholeWindow* w)
+{
+    return w->insn[0]->op[1].imm == 0;
+}
+
+bool multiplies_by_one (PeepholeWindow* w)
+{
+    return w->insn[0]->op[1].imm == 1;
+}
+
+void copy_first_operand (PeepholeWindow* w)
+{
+    PeepholeWindow_copy(w, 0, w->insn[0]->op[0], w->insn[0]->op[2]);
+}
+
+/* cbr rX => lN, lN */
+bool has_same_targets (PeepholeWindow* w)
+{
+    return Operand_equals(w->insn[0]->op[1], w->insn[0]->op[2]);
+}
+
+void jump_to_target (PeepholeWindow* w)
+{
+    ILOCInsn* insn = w->insn[0];
+    PeepholeWindow_count_targets(w, insn, -1);
+    insn->form = JUMP;
+    insn->op[0] = insn->op[1];
+    insn->op[1] = empty_operand();
+    insn->op[2] = empty_operand();
+    PeepholeWindow_count_targets(w, insn, 1);
+}
+
+/* jump lN; lN: */
+bool jumps_to_next (PeepholeWindow* w)
+{
+    return Operand_equals(w->insn[0]->op[0], w->insn[1]->op[0]);
+}
+
+/* lN: (with no branches to it) */
+bool is_unused_label (PeepholeWindow* w)
+{
+    Operand label = w->insn[0]->op[0];
+    return label.type == JUMP_LABEL && w->label_uses[label.id] == 0;
+}
+
+/* storeAI rX => [rB+c]; loadAI [rB+c] => rY */
+bool reloads_stored (PeepholeWindow* w)
+{
+    ILOCInsn* store = w->insn[0];
+    ILOCInsn* load = w->insn[1];
+    return Operand_equals(store->op[1], load->op[0]) && store->op[2].imm == load->op[1].imm;
+}
+
+void copy_stored (PeepholeWindow* w)
+{
+    PeepholeWindow_copy(w, 1, w->insn[0]->op[0], w->insn[1]->op[2]);
+}
+
+/* loadAI [rB+c] => rX; loadAI [rB+c] => rY (where rX is not rB) */
+bool reloads_loaded (PeepholeWindow* w)
+{
+    ILOCInsn* first = w->insn[0];
+    ILOCInsn* second = w->insn[1];
+    return Operand_equals(first->op[0], second->op[0]) && first->op[1].imm == second->op[1].imm &&
+        !Operand_equals(first->op[2], first->op[0]);
+}
+
+void copy_loaded (PeepholeWindow* w)
+{
+    PeepholeWindow_copy(w, 1, w->insn[0]->op[2], w->insn[1]->op[2]);
+}
+
+/* loadAI [rB+c] => rX; storeAI rX => [rB+c] (where rX is not rB) */
+bool stores_loaded (PeepholeWindow* w)
+{
+    ILOCInsn* load = w->insn[0];
+    ILOCInsn* store = w->insn[1];
+    return Operand_equals(load->op[2], store->op[0]) && Operand_equals(load->op[0], store->op[1]) &&
+        load->op[1].imm == store->op[2].imm && !Operand_equals(load->op[2], load->op[0]);
+}
+
+/* i2i rX => rY; i2i rY => rX */
+bool copies_back (PeepholeWindow* w)
+{
+    return Operand_equals(w->insn[0]->op[0], w->insn[1]->op[1]) &&
+        Operand_equals(w->insn[0]->op[1], w->insn[1]->op[0]);
+}
+
+/* indexed by PeepholeRuleID */
+const PeepholeRule peephole_rules[NUM_PEEPHOLE_RULES] = {
+    [PEEPHOLE_SELF_COPY]    = { 1, { I2I },                 is_self_copy,       remove_first },
+    [PEEPHOLE_ADD_ZERO]     = { 1, { ADD_I },               adds_zero,          copy_first_operand },
+    [PEEPHOLE_MULT_ONE]     = { 1, { MULT_I },              multiplies_by_one,  copy_first_operand },
+    [PEEPHOLE_SAME_TARGETS] = { 1, { CBR },                 has_same_targets,   jump_to_target },
+    [PEEPHOLE_JUMP_TO_NEXT] = { 2, { JUMP, LABEL },         jumps_to_next,      remove_first },
+    [PEEPHOLE_UNUSED_LABEL] = { 1, { LABEL },               is_unused_label,    remove_first },
+    [PEEPHOLE_STORE_RELOAD] = { 2, { STORE_AI, LOAD_AI },   reloads_stored,     copy_stored },
+    [PEEPHOLE_LOAD_RELOAD]  = { 2, { LOAD_AI, LOAD_AI },    reloads_loaded,     copy_loaded },
+    [PEEPHOLE_LOAD_STORE]   = { 2, { LOAD_AI, STORE_AI },   stores_loaded,      remove_second },
+    [PEEPHOLE_COPY_BACK]    = { 2, { I2I, I2I },            copies_back,        remove_second },
+};
+
+#define PEEPHOLE_RULE_NAME(ID,NAME) NAME,
+
+const char* peephole_rule_names[NUM_PEEPHOLE_RULES] = {
+    PEEPHOLE_RULES(PEEPHOLE_RULE_NAME)
+};
+
+/**
+ * @brief Fill the window with the instructions starting at slot @p start
+ */
+void PeepholeWindow_fill (PeepholeWindow* w, int start)
+{
+    w->length = 0;
+    for (int i = start; i < w->code->size && w->length < PEEPHOLE_WINDOW; i++) {
+        if (w->code->insns[i] != NULL) {
+            w->insn[w->length] = w->code->insns[i];
+            w->slot[w->length] = i;
+            w->length++;
+        }
+    }
+}
+
+/**
+ * @brief Find the first rule that matches the window
+ *
+ * @returns Rule index (or -1 if no rule matches)
+ */
+int PeepholeWindow_match (PeepholeWindow* w)
+{
+    for (int r = 0; r < NUM_PEEPHOLE_RULES; r++) {
+        const PeepholeRule* rule = &peephole_rules[r];
+        if (rule->length > w->length) {
+            continue;
+        }
+        bool match = true;
+        for (int j = 0; j < rule->length && match; j++) {
+            match = (w->insn[j]->form == rule->forms[j]);
+        }
+        if (match && rule->matches(w)) {
+            return r;
+        }
+    }
+    return -1;
+}
+
+void optimize_peephole (InsnList* program, PeepholeStats* stats)
+{
+    PeepholeStats local_stats;
+    if (stats == NULL) {
+        stats = &local_stats;
+    }
+    for (int r = 0; r < NUM_PEEPHOLE_RULES; r++) {
+        stats->applied[r] = 0;
+    }
+    stats->passes = 0;
+
+    InsnVector* code = InsnVector_from_list(program);
+    int num_labels = 0;
+    for (int i = 0; i < code->size; i++) {
+        ILOCInsn* insn = code->insns[i];
+        for (int j = 0; j < 3; j++) {
+            if (insn->op[j].type == JUMP_LABEL && insn->op[j].id >= num_labels) {
+                num_labels = insn->op[j].id + 1;
+            }
+        }
+    }
+    PeepholeWindow w = { code, { NULL }, { 0 }, 0, (int*)calloc(num_labels + 1, sizeof(int)), 0 };
+    CHECK_MALLOC_PTR(w.label_uses);
+    for (int i = 0; i < code->size; i++) {
+        PeepholeWindow_count_targets(&w, code->insns[i], 1);
+    }
+
+    /* a rewrite may enable rules at earlier positions, so repeat whole passes */
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        stats->passes++;
+        for (int i = 0; i < code->size; i++) {
+            if (code->insns[i] == NULL) {
+                continue;
+            }
+            PeepholeWindow_fill(&w, i);
+            int r = PeepholeWindow_match(&w);
+            if (r >= 0) {
+                peephole_rules[r].rewrite(&w);
+                stats->applied[r]++;
+                changed = true;
+            }
+        }
+    }
+    stats->removed = w.removed;
+    free(w.label_uses);
+
+    InsnList* result = InsnVector_to_list(code);
+    InsnList_splice(program, result);
+    InsnList_free(result);
+    InsnVector_free(code);
+}
+
+void PeepholeStats_print (PeepholeStats* stats, FILE* output)
+{
+    fprintf(output, "PEEPHOLE (%d passes, %d instructions removed)\n", stats->passes, stats->removed);
+    fprintf(output, "%12s  %-16s %s\n", "APPLIED", "RULE", "PATTERN");
+    for (int r = 0; r < NUM_PEEPHOLE_RULES; r++) {
+        char pattern[64] = "";
+        for (int j = 0; j < peephole_rules[r].length; j++) {
+            if (j > 0) {
+                strncat(pattern, " + ", sizeof(pattern) - strlen(pattern) - 1);
+            }
+            strncat(pattern, InsnForm_to_string(peephole_rules[r].forms[j]),
+                    sizeof(pattern) - strlen(pattern) - 1);
+        }
+        fprintf(output, "%12d  %-16s %s\n", stats->applied[r], peephole_rule_names[r], pattern);
+    }
+}
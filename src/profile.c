@@ -0,0 +1,225 @@
+#include "profile.h"
+
+ExecutionProfile* ExecutionProfile_new ()
+{
+    ExecutionProfile* profile = (ExecutionProfile*)calloc(1, sizeof(ExecutionProfile));
+    CHECK_MALLOC_PTR(profile);
+    return profile;
+}
+
+void ExecutionProfile_start (ExecutionProfile* profile, DecodedProgram* program, int entry)
+{
+    profile->size = program->size;
+    profile->insn_counts = (long*)calloc(program->size + 1, sizeof(long));
+    CHECK_MALLOC_PTR(profile->insn_counts);
+    profile->source = (ILOCInsn**)calloc(program->size + 1, sizeof(ILOCInsn*));
+    CHECK_MALLOC_PTR(profile->source);
+    memcpy(profile->source, program->source, program->size * sizeof(ILOCInsn*));
+    profile->insn_function = (int*)malloc((program->size + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(profile->insn_function);
+
+    /* each function extends from its call label to the next one */
+    int num_labels = 0;
+    for (int i = 0; i < program->size; i++) {
+        if (program->source[i]->form == LABEL && program->source[i]->op[0].type == CALL_LABEL) {
+            num_labels++;
+        }
+    }
+    profile->functions = (FunctionProfile*)calloc(num_labels + 1, sizeof(FunctionProfile));
+    CHECK_MALLOC_PTR(profile->functions);
+    profile->num_functions = 0;
+    int current = -1;
+    for (int i = 0; i < program->size; i++) {
+        ILOCInsn* insn = program->source[i];
+        if (insn->form == LABEL && insn->op[0].type == CALL_LABEL) {
+            current = profile->num_functions++;
+            FunctionProfile* function = &profile->functions[current];
+            function->name = (char*)malloc(strlen(insn->op[0].str) + 1);
+            CHECK_MALLOC_PTR(function->name);
+            strcpy(function->name, insn->op[0].str);
+        }
+        profile->insn_function[i] = current;
+    }
+    profile->insn_function[program->size] = current;
+
+    profile->stack_capacity = 64;
+    profile->stack = (ProfileFrame*)malloc(profile->stack_capacity * sizeof(ProfileFrame));
+    CHECK_MALLOC_PTR(profile->stack);
+    profile->depth = 0;
+
+    /* main is called by the simulator itself */
+    int main_function = profile->insn_function[entry];
+    if (main_function >= 0) {
+        profile->functions[main_function].calls++;
+        profile->functions[main_function].active++;
+        profile->stack[profile->depth].function = main_function;
+        profile->stack[profile->depth].entry = 0;
+        profile->depth++;
+    }
+}
+
+/**
+ * @brief Pop the top frame of the shadow call stack
+ *
+ * Inclusive totals are only accumulated for the outermost activation of a
+ * function, so recursion does not count the same instructions more than once.
+ */
+void ExecutionProfile_pop (ExecutionProfile* profile)
+{
+    ProfileFrame* frame = &profile->stack[--profile->depth];
+    FunctionProfile* function = &profile->functions[frame->function];
+    if (--function->active == 0) {
+        function->inclusive += profile->executed - frame->entry;
+    }
+}
+
+void ExecutionProfile_record (ExecutionProfile* profile, DecodedProgram* program, int pc)
+{
+    DecodedInsn* insn = &program->code[pc];
+    profile->executed++;
+    profile->insn_counts[pc]++;
+    profile->form_counts[insn->form]++;
+    if (profile->insn_function[pc] >= 0) {
+        profile->functions[profile->insn_function[pc]].exclusive++;
+    }
+
+    if (insn->form == CALL) {
+        int callee = profile->insn_function[insn->op[0]];
+        if (callee < 0) {
+            return;
+        }
+        if (profile->depth == profile->stack_capacity) {
+            profile->stack_capacity *= 2;
+            profile->stack = (ProfileFrame*)realloc(profile->stack,
+                    profile->stack_capacity * sizeof(ProfileFrame));
+            CHECK_MALLOC_PTR(profile->stack);
+        }
+        profile->functions[callee].calls++;
+        profile->functions[callee].active++;
+        profile->stack[profile->depth].function = callee;
+        profile->stack[profile->depth].entry = profile->executed;
+        profile->depth++;
+    } else if (insn->form == RETURN && profile->depth > 0) {
+        ExecutionProfile_pop(profile);
+    }
+}
+
+void ExecutionProfile_finish (ExecutionProfile* profile)
+{
+    while (profile->depth > 0) {
+        ExecutionProfile_pop(profile);
+    }
+}
+
+/*
+ * sorting helpers (indices sorted by decreasing count; ties keep program order)
+ */
+
+long* profile_sort_counts;
+
+int profile_compare_by_count (const void* a, const void* b)
+{
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    if (profile_sort_counts[x] != profile_sort_counts[y]) {
+        return (profile_sort_counts[x] < profile_sort_counts[y] ? 1 : -1);
+    }
+    return x - y;
+}
+
+int* profile_sorted_indices (long* counts, int n)
+{
+    int* indices = (int*)malloc((n + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(indices);
+    for (int i = 0; i < n; i++) {
+        indices[i] = i;
+    }
+    profile_sort_counts = counts;
+    qsort(indices, n, sizeof(int), profile_compare_by_count);
+    return indices;
+}
+
+double profile_percent (long count, long total)
+{
+    return (total > 0 ? 100.0 * count / total : 0.0);
+}
+
+void ExecutionProfile_print (ExecutionProfile* profile, FILE* output, int max_insns)
+{
+    long total = profile->executed;
+    fprintf(output, "PROFILE (%ld instructions executed)\n", total);
+
+    /* functions (by exclusive total) */
+    long* exclusive = (long*)calloc(profile->num_functions + 1, sizeof(long));
+    CHECK_MALLOC_PTR(exclusive);
+    for (int f = 0; f < profile->num_functions; f++) {
+        exclusive[f] = profile->functions[f].exclusive;
+    }
+    int* order = profile_sorted_indices(exclusive, profile->num_functions);
+    fprintf(output, "\n%-20s %10s %12s %7s %12s %7s\n", "FUNCTION", "CALLS",
+            "INCLUSIVE", "%", "EXCLUSIVE", "%");
+    for (int i = 0; i < profile->num_functions; i++) {
+        FunctionProfile* function = &profile->functions[order[i]];
+        if (function->calls == 0 && function->exclusive == 0) {
+            continue;
+        }
+        fprintf(output, "%-20s %10ld %12ld %6.2f%% %12ld %6.2f%%\n", function->name,
+                function->calls, function->inclusive, profile_percent(function->inclusive, total),
+                function->exclusive, profile_percent(function->exclusive, total));
+    }
+    free(order);
+    free(exclusive);
+
+    /* instruction forms */
+    order = profile_sorted_indices(profile->form_counts, NUM_DECODED_FORMS);
+    fprintf(output, "\n%-20s %10s %7s\n", "FORM", "COUNT", "%");
+    for (int i = 0; i < NUM_DECODED_FORMS && profile->form_counts[order[i]] > 0; i++) {
+        fprintf(output, "%-20s %10ld %6.2f%%\n", InsnForm_to_string((InsnForm)order[i]),
+                profile->form_counts[order[i]], profile_percent(profile->form_counts[order[i]], total));
+    }
+    free(order);
+
+    /* hot spots */
+    order = profile_sorted_indices(profile->insn_counts, profile->size);
+    fprintf(output, "\n%10s %7s %7s  %-20s %s\n", "COUNT", "%", "INDEX", "FUNCTION", "INSTRUCTION");
+    for (int i = 0; i < profile->size && i < max_insns && profile->insn_counts[order[i]] > 0; i++) {
+        int index = order[i];
+        int function = profile->insn_function[index];
+        fprintf(output, "%10ld %6.2f%% %7d  %-20s ", profile->insn_counts[index],
+                profile_percent(profile->insn_counts[index], total), index,
+                (function >= 0 ? profile->functions[function].name : "-"));
+        ILOCInsn_print(profile->source[index], output);
+        fprintf(output, "\n");
+    }
+    free(order);
+}
+
+void ExecutionProfile_print_listing (ExecutionProfile* profile, InsnList* program, FILE* output)
+{
+    int index = 0;
+    FOR_EACH(ILOCInsn*, i, program) {
+        if (i->form != LABEL) {
+            fprintf(output, "  ");
+        }
+        ILOCInsn_print(i, output);
+        fprintf(output, "  ; %ld", (index < profile->size ? profile->insn_counts[index] : 0));
+        if (i->comment != NULL) {
+            fprintf(output, " %s", i->comment);
+        }
+        fprintf(output, "\n");
+        index++;
+    }
+}
+
+void ExecutionProfile_free (ExecutionProfile* profile)
+{
+    for (int f = 0; f < profile->num_functions; f++) {
+        free(profile->functions[f].name);
+    }
+    free(profile->functions);
+    free(profile->insn_counts);
+    free(profile->source);
+    free(profile->insn_function);
+    free(profile->stack);
+    free(profile);
+}
@@ -0,0 +1,418 @@
+#include <limits.h>
+
+#include "regalloc.h"
+#include "dataflow.h"
+
+/**
+ * @brief Live interval of a virtual register within one function
+ *
+ * Positions are numbered so that an instruction's uses (at twice its index)
+ * come before its definition (one later); an interval that ends at a use can
+ * therefore share its register with one that starts at the same instruction.
+ */
+typedef struct LiveInterval
+{
+    int reg;            /**< @brief Virtual register ID */
+    int start;          /**< @brief First position where the register is live */
+    int end;            /**< @brief Last position where the register is live */
+    int phys;           /**< @brief Physical register (or -1 if spilled) */
+    int slot;           /**< @brief Spill slot (or -1 if not spilled) */
+    bool crosses_call;  /**< @brief Register is live across a @c call */
+} LiveInterval;
+
+/**
+ * @brief State of the allocator for the function being processed
+ */
+typedef struct RegAllocState
+{
+    int num_regs;               /**< @brief Number of physical registers */
+    int available;              /**< @brief Physical registers that are not pinned */
+    int* pinned;                /**< @brief Physical register of every shared virtual register (or -1; indexed by ID) */
+    RegisterIndex* regs;        /**< @brief Register numbering of the current function (also used for intervals) */
+    LiveInterval* intervals;    /**< @brief Intervals of the current function */
+    int num_intervals;          /**< @brief Number of intervals */
+    int* order;                 /**< @brief Interval indices sorted by start */
+    InsnVector* output;         /**< @brief Rewritten program */
+} RegAllocState;
+
+/**
+ * @brief Test whether an operand is a virtual register
+ */
+bool Operand_is_virtual (Operand* op)
+{
+    return op != NULL && op->type == VIRTUAL_REG;
+}
+
+/**
+ * @brief Number the virtual registers of a function (one interval each)
+ */
+void RegAllocState_number_registers (RegAllocState* state, ControlFlowGraph* cfg)
+{
+    state->regs = RegisterIndex_new(cfg);
+    state->num_intervals = state->regs->num_regs;
+    state->intervals = (LiveInterval*)malloc((state->num_intervals + 1) * sizeof(LiveInterval));
+    CHECK_MALLOC_PTR(state->intervals);
+    for (int r = 0; r < state->num_intervals; r++) {
+        state->intervals[r].reg = state->regs->regs[r];
+        state->intervals[r].start = INT_MAX;
+        state->intervals[r].end = -1;
+        state->intervals[r].crosses_call = false;
+    }
+}
+
+/**
+ * @brief Extend an interval to include a position
+ */
+void LiveInterval_extend (LiveInterval* interval, int position)
+{
+    if (position < interval->start) {
+        interval->start = position;
+    }
+    if (position > interval->end) {
+        interval->end = position;
+    }
+}
+
+/**
+ * @brief Compute live intervals from block-level liveness
+ */
+void RegAllocState_build_intervals (RegAllocState* state, ControlFlowGraph* cfg)
+{
+    DataflowProblem* liveness = Liveness_new(cfg, state->regs);
+    int words = liveness->words;
+
+    /* intervals cover block boundaries where live plus all references */
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        BasicBlock* block = &cfg->blocks[b];
+        uint64_t* in = DataflowProblem_set(liveness, liveness->in, b);
+        uint64_t* out = DataflowProblem_set(liveness, liveness->out, b);
+        if (block->first == block->end) {
+            continue;
+        }
+        for (int w = 0; w < words; w++) {
+            if ((in[w] | out[w]) == 0) {
+                continue;
+            }
+            for (int r = w * 64; r < state->num_intervals && r < (w + 1) * 64; r++) {
+                if (bitset_contains(in, r)) {
+                    LiveInterval_extend(&state->intervals[r], 2 * block->first);
+                }
+                if (bitset_contains(out, r)) {
+                    LiveInterval_extend(&state->intervals[r], 2 * (block->end - 1) + 1);
+                }
+            }
+        }
+    }
+    for (int i = 0; i < cfg->num_insns; i++) {
+        ILOCInsn* insn = cfg->insns[i];
+        if (insn == NULL) {
+            continue;
+        }
+        Operand* uses[MAX_INSN_USES];
+        int num_uses = ILOCInsn_get_uses(insn, uses);
+        for (int u = 0; u < num_uses; u++) {
+            if (Operand_is_virtual(uses[u])) {
+                LiveInterval_extend(&state->intervals[RegisterIndex_lookup(state->regs, uses[u])], 2 * i);
+            }
+        }
+        Operand* def = ILOCInsn_get_def(insn);
+        if (Operand_is_virtual(def)) {
+            LiveInterval_extend(&state->intervals[RegisterIndex_lookup(state->regs, def)], 2 * i + 1);
+        }
+    }
+
+    /* calls clobber every physical register; calls_before[i] counts the
+     * calls before instruction i */
+    int* calls_before = (int*)malloc((cfg->num_insns + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(calls_before);
+    calls_before[0] = 0;
+    for (int i = 0; i < cfg->num_insns; i++) {
+        calls_before[i + 1] = calls_before[i] +
+            (cfg->insns[i] != NULL && cfg->insns[i]->form == CALL ? 1 : 0);
+    }
+    for (int r = 0; r < state->num_intervals; r++) {
+        /* live across call i if defined before it (2i > start) and used
+         * after it (2i + 1 < end) */
+        LiveInterval* interval = &state->intervals[r];
+        int lo = interval->start / 2 + 1;
+        int hi = (interval->end - 2) / 2;
+        interval->crosses_call = (interval->end >= 2 && lo <= hi &&
+                calls_before[hi + 1] > calls_before[lo]);
+    }
+    free(calls_before);
+
+    DataflowProblem_free(liveness);
+}
+
+/**
+ * @brief Current function's intervals (for sorting)
+ */
+static LiveInterval* sort_intervals;
+
+/**
+ * @brief Order interval indices by start (ties broken by index for
+ * deterministic output)
+ */
+int LiveInterval_compare_start (const void* a, const void* b)
+{
+    LiveInterval* x = &sort_intervals[*(const int*)a];
+    LiveInterval* y = &sort_intervals[*(const int*)b];
+    if (x->start != y->start) {
+        return (x->start < y->start ? -1 : 1);
+    }
+    return *(const int*)a - *(const int*)b;
+}
+
+/**
+ * @brief Run linear scan with the given number of registers
+ *
+ * @returns Number of spilled intervals
+ */
+int RegAllocState_linear_scan (RegAllocState* state, int available)
+{
+    int* active = (int*)malloc((available + 1) * sizeof(int));
+    int* free_regs = (int*)malloc((available + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(active);
+    CHECK_MALLOC_PTR(free_regs);
+    int num_active = 0;
+    int num_free = 0;
+    for (int p = available - 1; p >= 0; p--) {
+        free_regs[num_free++] = p;
+    }
+
+    int num_spilled = 0;
+    for (int i = 0; i < state->num_intervals; i++) {
+        LiveInterval* cur = &state->intervals[state->order[i]];
+        cur->phys = state->pinned[cur->reg];
+        if (cur->phys >= 0) {
+            continue;
+        }
+        if (cur->crosses_call) {
+            num_spilled++;
+            continue;
+        }
+
+        /* expire intervals that ended before this one starts (active is
+         * sorted by end) */
+        int expired = 0;
+        while (expired < num_active && state->intervals[active[expired]].end < cur->start) {
+            free_regs[num_free++] = state->intervals[active[expired]].phys;
+            expired++;
+        }
+        memmove(active, &active[expired], (num_active - expired) * sizeof(int));
+        num_active -= expired;
+
+        if (num_free == 0) {
+            /* spill whichever of this interval and the active ones ends last */
+            LiveInterval* last = (num_active > 0 ? &state->intervals[active[num_active - 1]] : NULL);
+            num_spilled++;
+            if (last == NULL || last->end <= cur->end) {
+                continue;
+            }
+            free_regs[num_free++] = last->phys;
+            last->phys = -1;
+            num_active--;
+        }
+        cur->phys = free_regs[--num_free];
+        int pos = num_active;
+        while (pos > 0 && state->intervals[active[pos - 1]].end > cur->end) {
+            active[pos] = active[pos - 1];
+            pos--;
+        }
+        active[pos] = state->order[i];
+        num_active++;
+    }
+
+    free(free_regs);
+    free(active);
+    return num_spilled;
+}
+
+/**
+ * @brief Allocate registers for one function and append the rewritten code
+ * to the output
+ */
+bool RegAllocState_allocate_function (RegAllocState* state, ControlFlowGraph* cfg, char* error_msg)
+{
+    RegAllocState_number_registers(state, cfg);
+    RegAllocState_build_intervals(state, cfg);
+
+    state->order = (int*)malloc((state->num_intervals + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(state->order);
+    for (int r = 0; r < state->num_intervals; r++) {
+        state->order[r] = r;
+    }
+    sort_intervals = state->intervals;
+    qsort(state->order, state->num_intervals, sizeof(int), LiveInterval_compare_start);
+
+    /* reserve scratch registers for spill code only if something spills */
+    int scratch = state->available;
+    int num_slots = RegAllocState_linear_scan(state, state->available);
+    if (num_slots > 0) {
+        scratch = state->available - MAX_INSN_USES;
+        num_slots = RegAllocState_linear_scan(state, scratch);
+    }
+
+    /* find the frame (only needed for spill slots) */
+    int frame_setup = -1;
+    long local_size = 0;
+    if (num_slots > 0) {
+        BasicBlock* entry = &cfg->blocks[0];
+        for (int i = entry->first; i < entry->end && frame_setup < 0; i++) {
+            if (ILOCInsn_is_frame_setup(cfg->insns[i])) {
+                frame_setup = i;
+            }
+        }
+        if (frame_setup < 0) {
+            snprintf(error_msg, MAX_ERROR_LEN,
+                    "Register allocation failed: function %s spills registers but does not set up BP",
+                    (cfg->name != NULL ? cfg->name : "(no function)"));
+            RegisterIndex_free(state->regs);
+            free(state->order);
+            free(state->intervals);
+            return false;
+        }
+        int next = frame_setup + 1;
+        while (next < cfg->num_insns && cfg->insns[next] == NULL) {
+            next++;
+        }
+        if (next < cfg->num_insns && ILOCInsn_is_stack_adjust(cfg->insns[next]) &&
+                cfg->insns[next]->op[1].imm < 0) {
+            local_size = -cfg->insns[next]->op[1].imm;
+        }
+        int slot = 0;
+        for (int r = 0; r < state->num_intervals; r++) {
+            state->intervals[r].slot = (state->intervals[r].phys < 0 ? slot++ : -1);
+        }
+    }
+
+    for (int i = 0; i < cfg->num_insns; i++) {
+        ILOCInsn* insn = cfg->insns[i];
+        if (insn == NULL) {
+            continue;
+        }
+        cfg->insns[i] = NULL;
+
+        /* load spilled uses into scratch registers (once per register) */
+        int loaded[MAX_INSN_USES];
+        int num_loaded = 0;
+        Operand* uses[MAX_INSN_USES];
+        int num_uses = ILOCInsn_get_uses(insn, uses);
+        for (int u = 0; u < num_uses; u++) {
+            if (!Operand_is_virtual(uses[u])) {
+                continue;
+            }
+            LiveInterval* interval = &state->intervals[RegisterIndex_lookup(state->regs, uses[u])];
+            if (interval->phys >= 0) {
+                uses[u]->id = interval->phys;
+                continue;
+            }
+            int s = 0;
+            while (s < num_loaded && loaded[s] != interval->reg) {
+                s++;
+            }
+            if (s == num_loaded) {
+                loaded[num_loaded++] = interval->reg;
+                InsnVector_add(state->output, ILOCInsn_new_3op(LOAD_AI, base_register(),
+                            int_const(-local_size - WORD_SIZE * (interval->slot + 1)),
+                            register_with_id(scratch + s)));
+            }
+            uses[u]->id = scratch + s;
+        }
+
+        /* definitions of spilled registers go through a scratch register */
+        ILOCInsn* store = NULL;
+        Operand* def = ILOCInsn_get_def(insn);
+        if (Operand_is_virtual(def)) {
+            LiveInterval* interval = &state->intervals[RegisterIndex_lookup(state->regs, def)];
+            if (interval->phys >= 0) {
+                def->id = interval->phys;
+            } else {
+                def->id = scratch;
+                store = ILOCInsn_new_3op(STORE_AI, register_with_id(scratch), base_register(),
+                        int_const(-local_size - WORD_SIZE * (interval->slot + 1)));
+            }
+        }
+
+        InsnVector_add(state->output, insn);
+        if (store != NULL) {
+            InsnVector_add(state->output, store);
+        }
+
+        /* reserve the spill slots below the locals */
+        if (i == frame_setup) {
+            int next = i + 1;
+            while (next < cfg->num_insns && cfg->insns[next] == NULL) {
+                next++;
+            }
+            if (next < cfg->num_insns && ILOCInsn_is_stack_adjust(cfg->insns[next])) {
+                cfg->insns[next]->op[1].imm -= WORD_SIZE * num_slots;
+            } else {
+                InsnVector_add(state->output, ILOCInsn_new_3op(ADD_I, stack_register(),
+                            int_const(-WORD_SIZE * num_slots), stack_register()));
+            }
+        }
+    }
+
+    RegisterIndex_free(state->regs);
+    free(state->order);
+    free(state->intervals);
+    return true;
+}
+
+bool allocate_registers (InsnList* program, int num_regs, char* error_msg)
+{
+    if (num_regs < MIN_PHYSICAL_REGS) {
+        snprintf(error_msg, MAX_ERROR_LEN,
+                "Register allocation failed: at least %d registers are required", MIN_PHYSICAL_REGS);
+        return false;
+    }
+
+    RegAllocState state;
+    state.num_regs = num_regs;
+    state.output = InsnVector_new();
+    InsnVector* code = InsnVector_from_list(program);
+    CFGList* cfgs = build_cfgs(code);
+
+    /* registers shared between functions (or between the activations of a
+     * recursive function) keep one physical register in the whole program
+     * (taken from the top of the range) */
+    CallGraph* graph = CallGraph_new(cfgs);
+    state.pinned = (int*)malloc((graph->max_reg + 1) * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(state.pinned);
+    state.available = num_regs;
+    for (int r = graph->max_reg; r >= 0; r--) {
+        state.pinned[r] = (graph->shared_regs[r] ? --state.available : -1);
+    }
+    CallGraph_free(graph);
+
+    bool success = true;
+    if (state.available < MIN_PHYSICAL_REGS) {
+        snprintf(error_msg, MAX_ERROR_LEN,
+                "Register allocation failed: %d registers are shared between functions or activations "
+                "(at most %d of %d can be reserved for them)", num_regs - state.available,
+                num_regs - MIN_PHYSICAL_REGS, num_regs);
+        success = false;
+    }
+    FOR_EACH(ControlFlowGraph*, cfg, cfgs) {
+        if (success) {
+            success = RegAllocState_allocate_function(&state, cfg, error_msg);
+        }
+    }
+    CFGList_free(cfgs);
+    free(state.pinned);
+
+    /* instructions that were not moved (after an error) stay in the program */
+    for (int i = 0; i < code->size; i++) {
+        if (code->insns[i] != NULL) {
+            InsnVector_add(state.output, code->insns[i]);
+        }
+    }
+    code->size = 0;
+    InsnVector_free(code);
+    InsnList* result = InsnVector_to_list(state.output);
+    InsnList_splice(program, result);
+    InsnList_free(result);
+    InsnVector_free(state.output);
+    return success;
+}
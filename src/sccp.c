@@ -0,0 +1,585 @@
+#include <limits.h>
+
+#include "sccp.h"
+#include "constfold.h"
+
+/**
+ * @brief Level of a value in the constant propagation lattice
+ */
+typedef enum LatticeLevel
+{
+    LATTICE_TOP,        /**< @brief No value seen yet */
+    LATTICE_CONST,      /**< @brief Always the same constant */
+    LATTICE_BOTTOM      /**< @brief Varying (or unknown) */
+} LatticeLevel;
+
+/**
+ * @brief Value in the constant propagation lattice
+ */
+typedef struct LatticeValue
+{
+    LatticeLevel level;     /**< @brief Level */
+    long value;             /**< @brief Constant (if the level is @c LATTICE_CONST) */
+} LatticeValue;
+
+/**
+ * @brief Def-use chains of the SSA registers of a function
+ *
+ * A site is either an instruction index (>= 0) or a phi function (@c -k-1,
+ * where phi functions are numbered consecutively in block order).
+ */
+typedef struct SSAChains
+{
+    int* def;           /**< @brief Defining site of every SSA register (or @c INT_MIN) */
+    int* use_start;     /**< @brief Start of every register's uses (with an end sentinel) */
+    int* uses;          /**< @brief Use sites */
+    int* phi_start;     /**< @brief Number of the first phi function of every block (with an end sentinel) */
+    int* phi_block;     /**< @brief Block of every phi function */
+} SSAChains;
+
+/**
+ * @brief Look up the SSA name of a register operand
+ *
+ * @returns Index relative to @ref SSAFunction::first_name (or -1 if the
+ * operand was not written in SSA form)
+ */
+int SSAFunction_name (SSAFunction* ssa, Operand* op)
+{
+    if (op == NULL || op->type != VIRTUAL_REG || op->id < ssa->first_name ||
+            op->id >= ssa->first_name + ssa->num_names) {
+        return -1;
+    }
+    return op->id - ssa->first_name;
+}
+
+/**
+ * @brief Look up a phi function by its number
+ */
+Phi* SSAChains_phi (SSAChains* chains, SSAFunction* ssa, int k)
+{
+    int b = chains->phi_block[k];
+    return &ssa->phis[b][k - chains->phi_start[b]];
+}
+
+/**
+ * @brief Visit every use in the function (first to count, then to record)
+ */
+void SSAChains_scan_uses (SSAChains* chains, SSAFunction* ssa, int* fill)
+{
+    ControlFlowGraph* cfg = ssa->cfg;
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        if (cfg->blocks[b].rpo < 0) {
+            continue;
+        }
+        for (int p = 0; p < ssa->num_phis[b]; p++) {
+            Phi* phi = &ssa->phis[b][p];
+            for (int a = 0; a < cfg->blocks[b].num_preds; a++) {
+                int n = SSAFunction_name(ssa, &phi->args[a]);
+                if (n >= 0 && chains->uses != NULL) {
+                    chains->uses[fill[n]++] = -(chains->phi_start[b] + p) - 1;
+                } else if (n >= 0) {
+                    fill[n]++;
+                }
+            }
+        }
+        for (int i = cfg->blocks[b].first; i < cfg->blocks[b].end; i++) {
+            if (cfg->insns[i] == NULL) {
+                continue;
+            }
+            Operand* uses[MAX_INSN_USES];
+            int num_uses = ILOCInsn_get_uses(cfg->insns[i], uses);
+            for (int u = 0; u < num_uses; u++) {
+                int n = SSAFunction_name(ssa, uses[u]);
+                if (n >= 0 && chains->uses != NULL) {
+                    chains->uses[fill[n]++] = i;
+                } else if (n >= 0) {
+                    fill[n]++;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Build the def-use chains of a function in SSA form
+ */
+SSAChains* SSAChains_new (SSAFunction* ssa)
+{
+    ControlFlowGraph* cfg = ssa->cfg;
+    int nn = ssa->num_names;
+    SSAChains* chains = (SSAChains*)calloc(1, sizeof(SSAChains));
+    CHECK_MALLOC_PTR(chains);
+    chains->phi_start = (int*)malloc((cfg->num_blocks + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(chains->phi_start);
+    chains->phi_start[0] = 0;
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        chains->phi_start[b + 1] = chains->phi_start[b] + ssa->num_phis[b];
+    }
+    chains->phi_block = (int*)malloc(chains->phi_start[cfg->num_blocks] * sizeof(int) + 1);
+    chains->def = (int*)malloc(nn * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(chains->phi_block);
+    CHECK_MALLOC_PTR(chains->def);
+    for (int n = 0; n < nn; n++) {
+        chains->def[n] = INT_MIN;
+    }
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        for (int p = 0; p < ssa->num_phis[b]; p++) {
+            int k = chains->phi_start[b] + p;
+            int n = SSAFunction_name(ssa, &ssa->phis[b][p].dest);
+            chains->phi_block[k] = b;
+            if (n >= 0) {
+                chains->def[n] = -k - 1;
+            }
+        }
+    }
+    for (int i = 0; i < cfg->num_insns; i++) {
+        int n = (cfg->insns[i] != NULL ? SSAFunction_name(ssa, ILOCInsn_get_def(cfg->insns[i])) : -1);
+        if (n >= 0) {
+            chains->def[n] = i;
+        }
+    }
+
+    int* fill = (int*)calloc(nn + 1, sizeof(int));
+    CHECK_MALLOC_PTR(fill);
+    SSAChains_scan_uses(chains, ssa, fill);
+    chains->use_start = (int*)malloc((nn + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(chains->use_start);
+    chains->use_start[0] = 0;
+    for (int n = 0; n < nn; n++) {
+        chains->use_start[n + 1] = chains->use_start[n] + fill[n];
+        fill[n] = chains->use_start[n];
+    }
+    chains->uses = (int*)malloc(chains->use_start[nn] * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(chains->uses);
+    SSAChains_scan_uses(chains, ssa, fill);
+    free(fill);
+    return chains;
+}
+
+/**
+ * @brief Deallocate def-use chains
+ */
+void SSAChains_free (SSAChains* chains)
+{
+    free(chains->uses);
+    free(chains->use_start);
+    free(chains->def);
+    free(chains->phi_block);
+    free(chains->phi_start);
+    free(chains);
+}
+
+/**
+ * @brief State of sparse conditional constant propagation
+ */
+typedef struct SCCPState
+{
+    SSAFunction* ssa;           /**< @brief Function being analyzed */
+    SSAChains* chains;          /**< @brief Def-use chains */
+    LatticeValue* values;       /**< @brief Value of every SSA register */
+    int* edge_from;             /**< @brief Flow worklist: sources of newly executable edges */
+    int* edge_to;               /**< @brief Flow worklist: targets of newly executable edges */
+    int num_edges;              /**< @brief Number of edges in the flow worklist */
+    int* names;                 /**< @brief SSA worklist: registers whose value was lowered */
+    int num_names;              /**< @brief Number of registers in the SSA worklist */
+} SCCPState;
+
+/**
+ * @brief Look up the lattice value of a register operand
+ */
+LatticeValue SCCPState_operand (SCCPState* state, Operand* op)
+{
+    int n = SSAFunction_name(state->ssa, op);
+    if (n < 0) {
+        LatticeValue bottom = { LATTICE_BOTTOM, 0 };
+        return bottom;
+    }
+    return state->values[n];
+}
+
+/**
+ * @brief Lower the value of an SSA register (queueing its uses if it changed)
+ */
+void SCCPState_lower (SCCPState* state, int n, LatticeValue value)
+{
+    LatticeValue* old = &state->values[n];
+    if (value.level == LATTICE_TOP || old->level == LATTICE_BOTTOM ||
+            (old->level == LATTICE_CONST && value.level == LATTICE_CONST && old->value == value.value)) {
+        return;
+    }
+    if (old->level == LATTICE_CONST) {
+        value.level = LATTICE_BOTTOM;
+    }
+    *old = value;
+    state->names[state->num_names++] = n;
+}
+
+/**
+ * @brief Mark an edge as executable (queueing it if it was not)
+ */
+void SCCPState_mark_edge (SCCPState* state, int from, int to)
+{
+    int e = SSAFunction_edge(state->ssa, from, to);
+    if (e < 0 || state->ssa->edge_executable[e]) {
+        return;
+    }
+    state->ssa->edge_executable[e] = true;
+    state->edge_from[state->num_edges] = from;
+    state->edge_to[state->num_edges] = to;
+    state->num_edges++;
+}
+
+/**
+ * @brief Evaluate the value computed by an instruction
+ */
+LatticeValue SCCPState_evaluate (SCCPState* state, ILOCInsn* insn)
+{
+    LatticeValue result = { LATTICE_BOTTOM, 0 };
+    LatticeValue a, b;
+    b.level = LATTICE_CONST;
+    b.value = 0;
+    switch (insn->form) {
+        case LOAD_I:
+            result.level = LATTICE_CONST;
+            result.value = insn->op[0].imm;
+            return result;
+        case I2I:
+            return SCCPState_operand(state, &insn->op[0]);
+        case ADD: case SUB: case MULT: case DIV: case AND: case OR:
+        case CMP_LT: case CMP_LE: case CMP_EQ: case CMP_GE: case CMP_GT: case CMP_NE:
+            a = SCCPState_operand(state, &insn->op[0]);
+            b = SCCPState_operand(state, &insn->op[1]);
+            break;
+        case ADD_I: case MULT_I:
+            a = SCCPState_operand(state, &insn->op[0]);
+            b.value = insn->op[1].imm;
+            break;
+        case NOT: case NEG:
+            a = SCCPState_operand(state, &insn->op[0]);
+            break;
+        default:
+            return result;
+    }
+    if (a.level == LATTICE_BOTTOM || b.level == LATTICE_BOTTOM) {
+        return result;
+    }
+    if (a.level == LATTICE_TOP || b.level == LATTICE_TOP) {
+        result.level = LATTICE_TOP;
+        return result;
+    }
+    if (fold_operation(insn->form, a.value, b.value, &result.value)) {
+        result.level = LATTICE_CONST;
+    }
+    return result;
+}
+
+/**
+ * @brief Evaluate an instruction in an executable block
+ */
+void SCCPState_visit_insn (SCCPState* state, int i)
+{
+    ControlFlowGraph* cfg = state->ssa->cfg;
+    ILOCInsn* insn = cfg->insns[i];
+    int b = cfg->block_of_insn[i];
+    if (insn == NULL || !state->ssa->executable[b]) {
+        return;
+    }
+    BasicBlock* block = &cfg->blocks[b];
+    if (insn->form == CBR) {
+        LatticeValue cond = SCCPState_operand(state, &insn->op[0]);
+        int target = (cond.value != 0 ? insn->op[1].id : insn->op[2].id);
+        for (int s = 0; s < block->num_succs; s++) {
+            if (cond.level == LATTICE_BOTTOM || (cond.level == LATTICE_CONST &&
+                    BasicBlock_label(cfg, &cfg->blocks[block->succs[s]]) == target)) {
+                SCCPState_mark_edge(state, b, block->succs[s]);
+            }
+        }
+        return;
+    }
+    int n = SSAFunction_name(state->ssa, ILOCInsn_get_def(insn));
+    if (n >= 0) {
+        SCCPState_lower(state, n, SCCPState_evaluate(state, insn));
+    }
+}
+
+/**
+ * @brief Evaluate a phi function over the executable incoming edges
+ */
+void SCCPState_visit_phi (SCCPState* state, int k)
+{
+    SSAFunction* ssa = state->ssa;
+    int b = state->chains->phi_block[k];
+    if (!ssa->executable[b]) {
+        return;
+    }
+    Phi* phi = SSAChains_phi(state->chains, ssa, k);
+    BasicBlock* block = &ssa->cfg->blocks[b];
+    LatticeValue result = { LATTICE_TOP, 0 };
+    for (int p = 0; p < block->num_preds && result.level != LATTICE_BOTTOM; p++) {
+        if (!ssa->edge_executable[SSAFunction_edge(ssa, block->preds[p], b)]) {
+            continue;
+        }
+        LatticeValue arg = SCCPState_operand(state, &phi->args[p]);
+        if (arg.level == LATTICE_TOP) {
+            continue;
+        } else if (result.level == LATTICE_TOP) {
+            result = arg;
+        } else if (arg.level == LATTICE_BOTTOM || arg.value != result.value) {
+            result.level = LATTICE_BOTTOM;
+        }
+    }
+    int n = SSAFunction_name(ssa, &phi->dest);
+    if (n >= 0) {
+        SCCPState_lower(state, n, result);
+    }
+}
+
+/**
+ * @brief Evaluate a block that just became executable
+ */
+void SCCPState_visit_block (SCCPState* state, int b)
+{
+    ControlFlowGraph* cfg = state->ssa->cfg;
+    BasicBlock* block = &cfg->blocks[b];
+    state->ssa->executable[b] = true;
+    for (int k = state->chains->phi_start[b]; k < state->chains->phi_start[b + 1]; k++) {
+        SCCPState_visit_phi(state, k);
+    }
+    for (int i = block->first; i < block->end; i++) {
+        SCCPState_visit_insn(state, i);
+    }
+    ILOCInsn* last = BasicBlock_last_insn(cfg, block);
+    if (last == NULL || last->form != CBR) {
+        for (int s = 0; s < block->num_succs; s++) {
+            SCCPState_mark_edge(state, b, block->succs[s]);
+        }
+    }
+}
+
+void propagate_constants (SSAFunction* ssa, SSAOptimizationStats* stats)
+{
+    ControlFlowGraph* cfg = ssa->cfg;
+    int num_edges = 0;
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        num_edges += cfg->blocks[b].num_succs;
+        ssa->executable[b] = false;
+    }
+    for (int e = 0; e < num_edges; e++) {
+        ssa->edge_executable[e] = false;
+    }
+
+    SCCPState state;
+    state.ssa = ssa;
+    state.chains = SSAChains_new(ssa);
+    state.values = (LatticeValue*)calloc(ssa->num_names + 1, sizeof(LatticeValue));
+    state.edge_from = (int*)malloc(num_edges * sizeof(int) + 1);
+    state.edge_to = (int*)malloc(num_edges * sizeof(int) + 1);
+    state.names = (int*)malloc(2 * ssa->num_names * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(state.values);
+    CHECK_MALLOC_PTR(state.edge_from);
+    CHECK_MALLOC_PTR(state.edge_to);
+    CHECK_MALLOC_PTR(state.names);
+    state.num_edges = 0;
+    state.num_names = 0;
+
+    /* iterate until both worklists are empty */
+    SCCPState_visit_block(&state, 0);
+    while (state.num_edges > 0 || state.num_names > 0) {
+        while (state.num_edges > 0) {
+            state.num_edges--;
+            int to = state.edge_to[state.num_edges];
+            if (!ssa->executable[to]) {
+                SCCPState_visit_block(&state, to);
+            } else {
+                for (int k = state.chains->phi_start[to]; k < state.chains->phi_start[to + 1]; k++) {
+                    SCCPState_visit_phi(&state, k);
+                }
+            }
+        }
+        while (state.num_names > 0) {
+            int n = state.names[--state.num_names];
+            for (int u = state.chains->use_start[n]; u < state.chains->use_start[n + 1]; u++) {
+                int site = state.chains->uses[u];
+                if (site >= 0) {
+                    SCCPState_visit_insn(&state, site);
+                } else {
+                    SCCPState_visit_phi(&state, -site - 1);
+                }
+            }
+        }
+    }
+
+    /* rewrite constant computations and resolved branches */
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        if (!ssa->executable[b]) {
+            stats->unreachable += (BasicBlock_last_insn(cfg, &cfg->blocks[b]) != NULL ? 1 : 0);
+            continue;
+        }
+        for (int i = cfg->blocks[b].first; i < cfg->blocks[b].end; i++) {
+            ILOCInsn* insn = cfg->insns[i];
+            if (insn == NULL) {
+                continue;
+            }
+            if (insn->form == CBR) {
+                LatticeValue cond = SCCPState_operand(&state, &insn->op[0]);
+                if (cond.level == LATTICE_CONST) {
+                    insn->op[0] = (cond.value != 0 ? insn->op[1] : insn->op[2]);
+                    insn->op[1] = empty_operand();
+                    insn->op[2] = empty_operand();
+                    insn->form = JUMP;
+                    stats->branches++;
+                }
+                continue;
+            }
+            Operand* def = ILOCInsn_get_def(insn);
+            int n = SSAFunction_name(ssa, def);
+            if (n >= 0 && insn->form != LOAD_I && state.values[n].level == LATTICE_CONST) {
+                Operand dest = *def;
+                insn->form = LOAD_I;
+                insn->op[0] = int_const(state.values[n].value);
+                insn->op[1] = dest;
+                insn->op[2] = empty_operand();
+                stats->constants++;
+            }
+        }
+    }
+
+    free(state.names);
+    free(state.edge_to);
+    free(state.edge_from);
+    free(state.values);
+    SSAChains_free(state.chains);
+}
+
+void eliminate_dead_code (SSAFunction* ssa, InsnVector* code, SSAOptimizationStats* stats)
+{
+    ControlFlowGraph* cfg = ssa->cfg;
+    SSAChains* chains = SSAChains_new(ssa);
+    bool* marked = (bool*)calloc(ssa->num_names + 1, sizeof(bool));
+    int* worklist = (int*)malloc(ssa->num_names * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(marked);
+    CHECK_MALLOC_PTR(worklist);
+    int size = 0;
+
+#define MARK_OPERAND(op) do { \
+        int n_ = SSAFunction_name(ssa, (op)); \
+        if (n_ >= 0 && !marked[n_]) { \
+            marked[n_] = true; \
+            worklist[size++] = n_; \
+        } \
+    } while (0)
+
+    /* instructions with side effects are live */
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        if (!ssa->executable[b]) {
+            continue;
+        }
+        for (int i = cfg->blocks[b].first; i < cfg->blocks[b].end; i++) {
+            ILOCInsn* insn = cfg->insns[i];
+            if (insn == NULL || (ILOCInsn_is_pure(insn) && SSAFunction_name(ssa, ILOCInsn_get_def(insn)) >= 0)) {
+                continue;
+            }
+            Operand* uses[MAX_INSN_USES];
+            int num_uses = ILOCInsn_get_uses(insn, uses);
+            for (int u = 0; u < num_uses; u++) {
+                MARK_OPERAND(uses[u]);
+            }
+        }
+    }
+
+    /* so are the definitions of the registers they read */
+    while (size > 0) {
+        int site = chains->def[worklist[--size]];
+        if (site >= 0) {
+            Operand* uses[MAX_INSN_USES];
+            int num_uses = ILOCInsn_get_uses(cfg->insns[site], uses);
+            for (int u = 0; u < num_uses; u++) {
+                MARK_OPERAND(uses[u]);
+            }
+        } else if (site != INT_MIN) {
+            int k = -site - 1;
+            int b = chains->phi_block[k];
+            Phi* phi = SSAChains_phi(chains, ssa, k);
+            for (int p = 0; p < cfg->blocks[b].num_preds; p++) {
+                if (ssa->edge_executable[SSAFunction_edge(ssa, cfg->blocks[b].preds[p], b)]) {
+                    MARK_OPERAND(&phi->args[p]);
+                }
+            }
+        }
+    }
+
+#undef MARK_OPERAND
+
+    /* everything else is dead */
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        if (!ssa->executable[b]) {
+            continue;
+        }
+        for (int p = 0; p < ssa->num_phis[b]; p++) {
+            Phi* phi = &ssa->phis[b][p];
+            int n = SSAFunction_name(ssa, &phi->dest);
+            if (phi->live && n >= 0 && !marked[n]) {
+                phi->live = false;
+                stats->removed++;
+            }
+        }
+        for (int i = cfg->blocks[b].first; i < cfg->blocks[b].end; i++) {
+            ILOCInsn* insn = cfg->insns[i];
+            int n = (insn != NULL ? SSAFunction_name(ssa, ILOCInsn_get_def(insn)) : -1);
+            if (n >= 0 && !marked[n] && ILOCInsn_is_pure(insn)) {
+                InsnVector_delete(code, (int)(&cfg->insns[i] - code->insns));
+                stats->removed++;
+            }
+        }
+    }
+
+    free(worklist);
+    free(marked);
+    SSAChains_free(chains);
+}
+
+void optimize_ssa (InsnList* program, SSAOptimizationStats* stats)
+{
+    SSAOptimizationStats local_stats = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    if (stats == NULL) {
+        stats = &local_stats;
+    }
+    InsnVector* code = InsnVector_from_list(program);
+    InsnVector* output = InsnVector_new();
+    IDAllocator ids = IDAllocator_init(code);
+
+    CFGList* cfgs = build_cfgs(code);
+    bool* supported = find_ssa_functions(cfgs);
+    int f = 0;
+    FOR_EACH(ControlFlowGraph*, cfg, cfgs) {
+        if (!supported[f++]) {
+            for (int i = 0; i < cfg->num_insns; i++) {
+                if (cfg->insns[i] != NULL) {
+                    InsnVector_add(output, cfg->insns[i]);
+                    cfg->insns[i] = NULL;
+                }
+            }
+            continue;
+        }
+        SSAFunction* ssa = SSAFunction_new(cfg, &ids);
+        stats->functions++;
+        stats->promoted += ssa->num_promoted;
+        for (int b = 0; b < cfg->num_blocks; b++) {
+            stats->phis += ssa->num_phis[b];
+        }
+        propagate_constants(ssa, stats);
+        eliminate_dead_code(ssa, code, stats);
+        SSAFunction_coalesce(ssa);
+        stats->copies += SSAFunction_destroy(ssa, output, &ids);
+        SSAFunction_free(ssa);
+    }
+    free(supported);
+    CFGList_free(cfgs);
+
+    /* instructions left behind belong to blocks that never execute */
+    InsnVector_free(code);
+    InsnList* result = InsnVector_to_list(output);
+    InsnList_splice(program, result);
+    InsnList_free(result);
+    InsnVector_free(output);
+}
@@ -0,0 +1,986 @@
+#include "ssa.h"
+
+IDAllocator IDAllocator_init (InsnVector* program)
+{
+    IDAllocator ids = { 0, 0 };
+    for (int i = 0; i < program->size; i++) {
+        ILOCInsn* insn = program->insns[i];
+        if (insn == NULL) {
+            continue;
+        }
+        for (int j = 0; j < 3; j++) {
+            if (insn->op[j].type == VIRTUAL_REG && insn->op[j].id >= ids.next_reg) {
+                ids.next_reg = insn->op[j].id + 1;
+            } else if (insn->op[j].type == JUMP_LABEL && insn->op[j].id >= ids.next_label) {
+                ids.next_label = insn->op[j].id + 1;
+            }
+        }
+    }
+    return ids;
+}
+
+/**
+ * @brief Test whether the last reachable block of a function ends in a
+ * branch or return (so that new blocks can be placed after it)
+ */
+bool ControlFlowGraph_ends_in_branch (ControlFlowGraph* cfg)
+{
+    for (int b = cfg->num_blocks - 1; b >= 0; b--) {
+        if (cfg->blocks[b].rpo >= 0) {
+            ILOCInsn* last = BasicBlock_last_insn(cfg, &cfg->blocks[b]);
+            return last != NULL && (last->form == RETURN || last->form == JUMP || last->form == CBR);
+        }
+    }
+    return false;
+}
+
+bool* find_ssa_functions (CFGList* cfgs)
+{
+    CallGraph* graph = CallGraph_new(cfgs);
+    bool* supported = (bool*)calloc(graph->num_funcs + 1, sizeof(bool));
+    CHECK_MALLOC_PTR(supported);
+    for (int f = 0; f < graph->num_funcs; f++) {
+        ControlFlowGraph* cfg = graph->funcs[f];
+        supported[f] = cfg->name != NULL && ControlFlowGraph_ends_in_branch(cfg) &&
+            !graph->shares_registers[f] && !ControlFlowGraph_reads_undefined(cfg) &&
+            !CallGraph_is_recursive(graph, f);
+    }
+    CallGraph_free(graph);
+    return supported;
+}
+
+/**
+ * @brief Test whether an operand is BP or SP
+ */
+bool Operand_is_frame_register (Operand* op)
+{
+    return op->type == BASE_REG || op->type == STACK_REG;
+}
+
+/**
+ * @brief Test whether an instruction uses BP or SP only as part of the
+ * prologue, the epilogue, or a BP-relative @c loadAI or @c storeAI
+ */
+bool ILOCInsn_keeps_frame_private (ILOCInsn* insn)
+{
+    switch (insn->form) {
+        case LOAD_AI:
+            return !Operand_is_frame_register(&insn->op[2]) &&
+                (insn->op[0].type == BASE_REG || !Operand_is_frame_register(&insn->op[0]));
+        case STORE_AI:
+            return !Operand_is_frame_register(&insn->op[0]) &&
+                (insn->op[1].type == BASE_REG || !Operand_is_frame_register(&insn->op[1]));
+        case I2I:
+            return ILOCInsn_is_frame_setup(insn) || ILOCInsn_is_frame_teardown(insn) ||
+                   (!Operand_is_frame_register(&insn->op[0]) && !Operand_is_frame_register(&insn->op[1]));
+        case ADD_I:
+            return ILOCInsn_is_stack_adjust(insn) ||
+                   (!Operand_is_frame_register(&insn->op[0]) && !Operand_is_frame_register(&insn->op[2]));
+        case PUSH: case POP:
+            return insn->op[0].type == BASE_REG;
+        case CALL:
+            return false;
+        default:
+            for (int j = 0; j < 3; j++) {
+                if (Operand_is_frame_register(&insn->op[j])) {
+                    return false;
+                }
+            }
+            return true;
+    }
+}
+
+/**
+ * @brief Stack slot accessed by a BP-relative @c loadAI or @c storeAI
+ *
+ * @returns True if and only if the instruction accesses a slot (stored in
+ * @p offset)
+ */
+bool ILOCInsn_frame_slot (ILOCInsn* insn, long* offset)
+{
+    if (insn->form == LOAD_AI && insn->op[0].type == BASE_REG) {
+        *offset = insn->op[1].imm;
+        return true;
+    } else if (insn->form == STORE_AI && insn->op[1].type == BASE_REG) {
+        *offset = insn->op[2].imm;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Compare offsets (for qsort)
+ */
+int compare_offsets (const void* a, const void* b)
+{
+    long x = *(const long*)a;
+    long y = *(const long*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Promote the function's private stack slots to virtual registers
+ *
+ * Slots that may be read before they are written keep their memory (the
+ * initial contents are unknown).
+ *
+ * @returns Number of promoted slots
+ */
+int promote_stack_slots (ControlFlowGraph* cfg, IDAllocator* ids)
+{
+    int n = cfg->num_insns;
+    long* offsets = (long*)malloc(n * sizeof(long) + 1);
+    CHECK_MALLOC_PTR(offsets);
+    int num_offsets = 0;
+    for (int i = 0; i < n; i++) {
+        ILOCInsn* insn = cfg->insns[i];
+        if (insn == NULL) {
+            continue;
+        }
+        if (!ILOCInsn_keeps_frame_private(insn)) {
+            free(offsets);
+            return 0;
+        }
+        long offset;
+        if (ILOCInsn_frame_slot(insn, &offset)) {
+            offsets[num_offsets++] = offset;
+        }
+    }
+
+    /* distinct local slots that do not overlap any other slot */
+    qsort(offsets, num_offsets, sizeof(long), compare_offsets);
+    int num_slots = 0;
+    for (int k = 0; k < num_offsets; k++) {
+        if (k > 0 && offsets[k] == offsets[k - 1]) {
+            continue;
+        }
+        int prev = k - 1;
+        while (prev >= 0 && offsets[prev] == offsets[k]) {
+            prev--;
+        }
+        int next = k + 1;
+        while (next < num_offsets && offsets[next] == offsets[k]) {
+            next++;
+        }
+        bool overlaps = (prev >= 0 && offsets[k] - offsets[prev] < WORD_SIZE) ||
+                        (next < num_offsets && offsets[next] - offsets[k] < WORD_SIZE);
+        if (offsets[k] < 0 && offsets[k] > -MAX_MEM_SIZE && !overlaps) {
+            offsets[num_slots++] = offsets[k];
+        }
+    }
+    if (num_slots == 0) {
+        free(offsets);
+        return 0;
+    }
+
+    /* replace every access by a copy from or to the slot's register */
+    int first_reg = ids->next_reg;
+    ids->next_reg += num_slots;
+    ILOCInsn* original = (ILOCInsn*)malloc(n * sizeof(ILOCInsn));
+    int* slot_of = (int*)malloc(n * sizeof(int));
+    CHECK_MALLOC_PTR(original);
+    CHECK_MALLOC_PTR(slot_of);
+    for (int i = 0; i < n; i++) {
+        ILOCInsn* insn = cfg->insns[i];
+        long offset;
+        slot_of[i] = -1;
+        if (insn == NULL || !ILOCInsn_frame_slot(insn, &offset)) {
+            continue;
+        }
+        long* found = (long*)bsearch(&offset, offsets, num_slots, sizeof(long), compare_offsets);
+        if (found == NULL) {
+            continue;
+        }
+        slot_of[i] = (int)(found - offsets);
+        original[i] = *insn;
+        Operand reg = register_with_id(first_reg + slot_of[i]);
+        if (insn->form == LOAD_AI) {
+            insn->op[1] = insn->op[2];
+            insn->op[0] = reg;
+        } else {
+            insn->op[1] = reg;
+        }
+        insn->form = I2I;
+        insn->op[2] = empty_operand();
+    }
+
+    /* only promote slots that are not live at the entry (others stay in
+     * memory) */
+    RegisterIndex* regs = RegisterIndex_new(cfg);
+    DataflowProblem* liveness = Liveness_new(cfg, regs);
+    uint64_t* live_in = DataflowProblem_set(liveness, liveness->in, 0);
+    bool* promotable = (bool*)malloc(num_slots * sizeof(bool));
+    CHECK_MALLOC_PTR(promotable);
+    int num_promoted = 0;
+    for (int s = 0; s < num_slots; s++) {
+        Operand reg = register_with_id(first_reg + s);
+        int r = RegisterIndex_lookup(regs, &reg);
+        promotable[s] = (r < 0 || !bitset_contains(live_in, r));
+        num_promoted += (promotable[s] ? 1 : 0);
+    }
+    for (int i = 0; i < n; i++) {
+        if (slot_of[i] >= 0 && !promotable[slot_of[i]]) {
+            *cfg->insns[i] = original[i];
+        }
+    }
+
+    free(promotable);
+    DataflowProblem_free(liveness);
+    RegisterIndex_free(regs);
+    free(slot_of);
+    free(original);
+    free(offsets);
+    return num_promoted;
+}
+
+/**
+ * @brief Dominance frontiers of all blocks (compressed storage)
+ */
+typedef struct DominanceFrontiers
+{
+    int* start;         /**< @brief Start of every block's frontier (with an end sentinel) */
+    int* blocks;        /**< @brief Frontier blocks */
+} DominanceFrontiers;
+
+/**
+ * @brief Walk up the dominator tree from the predecessors of every join block
+ * (Cooper, Harvey, and Kennedy, "A Simple, Fast Dominance Algorithm")
+ *
+ * @param cfg CFG with dominators
+ * @param frontiers Frontiers to fill in (or @c NULL to only count)
+ * @param counts Receives (or provides) the number of frontier blocks of
+ * every block
+ * @param last Scratch array (one entry per block)
+ */
+void DominanceFrontiers_walk (ControlFlowGraph* cfg, DominanceFrontiers* frontiers, int* counts, int* last)
+{
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        last[b] = -1;
+    }
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        BasicBlock* block = &cfg->blocks[b];
+        if (block->rpo < 0 || block->num_preds < 2) {
+            continue;
+        }
+        for (int p = 0; p < block->num_preds; p++) {
+            int runner = block->preds[p];
+            if (cfg->blocks[runner].rpo < 0) {
+                continue;
+            }
+            while (runner >= 0 && runner != block->idom && last[runner] != b) {
+                last[runner] = b;
+                if (frontiers != NULL) {
+                    frontiers->blocks[frontiers->start[runner] + counts[runner]] = b;
+                }
+                counts[runner]++;
+                runner = cfg->blocks[runner].idom;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Compute dominance frontiers
+ */
+DominanceFrontiers DominanceFrontiers_new (ControlFlowGraph* cfg)
+{
+    int nb = cfg->num_blocks;
+    DominanceFrontiers frontiers;
+    int* counts = (int*)calloc(nb + 1, sizeof(int));
+    int* last = (int*)malloc(nb * sizeof(int) + 1);
+    frontiers.start = (int*)malloc((nb + 1) * sizeof(int));
+    CHECK_MALLOC_PTR(counts);
+    CHECK_MALLOC_PTR(last);
+    CHECK_MALLOC_PTR(frontiers.start);
+    DominanceFrontiers_walk(cfg, NULL, counts, last);
+    frontiers.start[0] = 0;
+    for (int b = 0; b < nb; b++) {
+        frontiers.start[b + 1] = frontiers.start[b] + counts[b];
+        counts[b] = 0;
+    }
+    frontiers.blocks = (int*)malloc(frontiers.start[nb] * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(frontiers.blocks);
+    DominanceFrontiers_walk(cfg, &frontiers, counts, last);
+    free(last);
+    free(counts);
+    return frontiers;
+}
+
+/**
+ * @brief Add a phi function for a register to a block
+ */
+void SSAFunction_add_phi (SSAFunction* ssa, int block, int var, int* capacity)
+{
+    if (ssa->num_phis[block] == capacity[block]) {
+        capacity[block] = (capacity[block] == 0 ? 4 : capacity[block] * 2);
+        ssa->phis[block] = (Phi*)realloc(ssa->phis[block], capacity[block] * sizeof(Phi));
+        CHECK_MALLOC_PTR(ssa->phis[block]);
+    }
+    int num_preds = ssa->cfg->blocks[block].num_preds;
+    Phi* phi = &ssa->phis[block][ssa->num_phis[block]++];
+    phi->dest = empty_operand();
+    phi->args = (Operand*)malloc(num_preds * sizeof(Operand) + 1);
+    CHECK_MALLOC_PTR(phi->args);
+    for (int p = 0; p < num_preds; p++) {
+        phi->args[p] = empty_operand();
+    }
+    phi->var = var;
+    phi->live = true;
+}
+
+/**
+ * @brief Place phi functions at the iterated dominance frontiers of every
+ * register's definitions (where the register is live)
+ */
+void SSAFunction_place_phis (SSAFunction* ssa, RegisterIndex* regs)
+{
+    ControlFlowGraph* cfg = ssa->cfg;
+    int nb = cfg->num_blocks;
+    int nv = regs->num_regs;
+    DominanceFrontiers frontiers = DominanceFrontiers_new(cfg);
+    DataflowProblem* liveness = Liveness_new(cfg, regs);
+
+    /* blocks defining every register (compressed storage) */
+    int* def_start = (int*)calloc(nv + 1, sizeof(int));
+    int* last_block = (int*)malloc(nv * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(def_start);
+    CHECK_MALLOC_PTR(last_block);
+    for (int v = 0; v < nv; v++) {
+        last_block[v] = -1;
+    }
+    for (int b = 0; b < nb; b++) {
+        if (cfg->blocks[b].rpo < 0) {
+            continue;
+        }
+        for (int i = cfg->blocks[b].first; i < cfg->blocks[b].end; i++) {
+            int v = (cfg->insns[i] != NULL ? RegisterIndex_lookup(regs, ILOCInsn_get_def(cfg->insns[i])) : -1);
+            if (v >= 0 && last_block[v] != b) {
+                last_block[v] = b;
+                def_start[v + 1]++;
+            }
+        }
+    }
+    for (int v = 0; v < nv; v++) {
+        def_start[v + 1] += def_start[v];
+    }
+    int* def_blocks = (int*)malloc(def_start[nv] * sizeof(int) + 1);
+    int* fill = (int*)malloc(nv * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(def_blocks);
+    CHECK_MALLOC_PTR(fill);
+    for (int v = 0; v < nv; v++) {
+        fill[v] = def_start[v];
+        last_block[v] = -1;
+    }
+    for (int b = 0; b < nb; b++) {
+        if (cfg->blocks[b].rpo < 0) {
+            continue;
+        }
+        for (int i = cfg->blocks[b].first; i < cfg->blocks[b].end; i++) {
+            int v = (cfg->insns[i] != NULL ? RegisterIndex_lookup(regs, ILOCInsn_get_def(cfg->insns[i])) : -1);
+            if (v >= 0 && last_block[v] != b) {
+                last_block[v] = b;
+                def_blocks[fill[v]++] = b;
+            }
+        }
+    }
+
+    /* iterated dominance frontiers (pruned by liveness) */
+    int* capacity = (int*)calloc(nb + 1, sizeof(int));
+    int* has_phi = (int*)malloc(nb * sizeof(int) + 1);
+    int* queued = (int*)malloc(nb * sizeof(int) + 1);
+    int* worklist = (int*)malloc(nb * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(capacity);
+    CHECK_MALLOC_PTR(has_phi);
+    CHECK_MALLOC_PTR(queued);
+    CHECK_MALLOC_PTR(worklist);
+    for (int b = 0; b < nb; b++) {
+        has_phi[b] = -1;
+        queued[b] = -1;
+    }
+    for (int v = 0; v < nv; v++) {
+        int size = 0;
+        for (int d = def_start[v]; d < def_start[v + 1]; d++) {
+            queued[def_blocks[d]] = v;
+            worklist[size++] = def_blocks[d];
+        }
+        while (size > 0) {
+            int d = worklist[--size];
+            for (int f = frontiers.start[d]; f < frontiers.start[d + 1]; f++) {
+                int y = frontiers.blocks[f];
+                if (has_phi[y] == v || !bitset_contains(DataflowProblem_set(liveness, liveness->in, y), v)) {
+                    continue;
+                }
+                has_phi[y] = v;
+                SSAFunction_add_phi(ssa, y, v, capacity);
+                if (queued[y] != v) {
+                    queued[y] = v;
+                    worklist[size++] = y;
+                }
+            }
+        }
+    }
+
+    free(worklist);
+    free(queued);
+    free(has_phi);
+    free(capacity);
+    free(fill);
+    free(def_blocks);
+    free(last_block);
+    free(def_start);
+    DataflowProblem_free(liveness);
+    free(frontiers.blocks);
+    free(frontiers.start);
+}
+
+/**
+ * @brief Rename registers in a preorder walk of the dominator tree
+ */
+void SSAFunction_rename (SSAFunction* ssa, RegisterIndex* regs, IDAllocator* ids)
+{
+    ControlFlowGraph* cfg = ssa->cfg;
+    int nb = cfg->num_blocks;
+
+    /* dominator tree children (compressed storage) */
+    int* child_start = (int*)calloc(nb + 2, sizeof(int));
+    int* children = (int*)malloc(nb * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(child_start);
+    CHECK_MALLOC_PTR(children);
+    for (int b = 0; b < nb; b++) {
+        if (cfg->blocks[b].idom >= 0) {
+            child_start[cfg->blocks[b].idom + 2]++;
+        }
+    }
+    for (int b = 0; b < nb; b++) {
+        child_start[b + 2] += child_start[b + 1];
+    }
+    for (int b = 0; b < nb; b++) {
+        if (cfg->blocks[b].idom >= 0) {
+            children[child_start[cfg->blocks[b].idom + 1]++] = b;
+        }
+    }
+
+    /* stack of current names per register, with an undo log */
+    int* top = (int*)malloc(regs->num_regs * sizeof(int) + 1);
+    int log_capacity = 64;
+    int log_size = 0;
+    int* log_name = (int*)malloc(log_capacity * sizeof(int));
+    int* log_prev = (int*)malloc(log_capacity * sizeof(int));
+    int* log_var = (int*)malloc(log_capacity * sizeof(int));
+    int* mark = (int*)malloc(nb * sizeof(int) + 1);
+    int* stack = (int*)malloc(2 * nb * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(top);
+    CHECK_MALLOC_PTR(log_name);
+    CHECK_MALLOC_PTR(log_prev);
+    CHECK_MALLOC_PTR(log_var);
+    CHECK_MALLOC_PTR(mark);
+    CHECK_MALLOC_PTR(stack);
+    for (int v = 0; v < regs->num_regs; v++) {
+        top[v] = -1;
+    }
+
+#define CURRENT_NAME(v) (top[v] >= 0 ? log_name[top[v]] : regs->regs[v])
+#define PUSH_NAME(v, operand) do { \
+        if (log_size == log_capacity) { \
+            log_capacity *= 2; \
+            log_name = (int*)realloc(log_name, log_capacity * sizeof(int)); \
+            log_prev = (int*)realloc(log_prev, log_capacity * sizeof(int)); \
+            log_var = (int*)realloc(log_var, log_capacity * sizeof(int)); \
+            CHECK_MALLOC_PTR(log_name); \
+            CHECK_MALLOC_PTR(log_prev); \
+            CHECK_MALLOC_PTR(log_var); \
+        } \
+        log_name[log_size] = ids->next_reg++; \
+        log_prev[log_size] = top[v]; \
+        log_var[log_size] = (v); \
+        top[v] = log_size++; \
+        (operand) = register_with_id(log_name[top[v]]); \
+    } while (0)
+
+    ssa->first_name = ids->next_reg;
+    int size = 0;
+    if (nb > 0) {
+        stack[size++] = 0;
+    }
+    while (size > 0) {
+        int entry = stack[--size];
+        if (entry < 0) {
+            /* leaving a block: restore the names of its dominator */
+            int b = -entry - 1;
+            while (log_size > mark[b]) {
+                log_size--;
+                top[log_var[log_size]] = log_prev[log_size];
+            }
+            continue;
+        }
+        int b = entry;
+        BasicBlock* block = &cfg->blocks[b];
+        mark[b] = log_size;
+
+        for (int p = 0; p < ssa->num_phis[b]; p++) {
+            Phi* phi = &ssa->phis[b][p];
+            PUSH_NAME(phi->var, phi->dest);
+        }
+        for (int i = block->first; i < block->end; i++) {
+            ILOCInsn* insn = cfg->insns[i];
+            if (insn == NULL) {
+                continue;
+            }
+            Operand* uses[MAX_INSN_USES];
+            int num_uses = ILOCInsn_get_uses(insn, uses);
+            for (int u = 0; u < num_uses; u++) {
+                int v = RegisterIndex_lookup(regs, uses[u]);
+                if (v >= 0) {
+                    *uses[u] = register_with_id(CURRENT_NAME(v));
+                }
+            }
+            Operand* def = ILOCInsn_get_def(insn);
+            int v = RegisterIndex_lookup(regs, def);
+            if (v >= 0) {
+                PUSH_NAME(v, *def);
+            }
+        }
+        for (int s = 0; s < block->num_succs; s++) {
+            BasicBlock* succ = &cfg->blocks[block->succs[s]];
+            for (int p = 0; p < succ->num_preds; p++) {
+                if (succ->preds[p] != b) {
+                    continue;
+                }
+                for (int k = 0; k < ssa->num_phis[block->succs[s]]; k++) {
+                    Phi* phi = &ssa->phis[block->succs[s]][k];
+                    phi->args[p] = register_with_id(CURRENT_NAME(phi->var));
+                }
+            }
+        }
+
+        stack[size++] = -b - 1;
+        for (int c = child_start[b]; c < child_start[b + 1]; c++) {
+            stack[size++] = children[c];
+        }
+    }
+    ssa->num_names = ids->next_reg - ssa->first_name;
+
+#undef PUSH_NAME
+#undef CURRENT_NAME
+
+    free(stack);
+    free(mark);
+    free(log_var);
+    free(log_prev);
+    free(log_name);
+    free(top);
+    free(children);
+    free(child_start);
+}
+
+SSAFunction* SSAFunction_new (ControlFlowGraph* cfg, IDAllocator* ids)
+{
+    SSAFunction* ssa = (SSAFunction*)calloc(1, sizeof(SSAFunction));
+    CHECK_MALLOC_PTR(ssa);
+    int nb = cfg->num_blocks;
+    ssa->cfg = cfg;
+    ssa->phis = (Phi**)calloc(nb + 1, sizeof(Phi*));
+    ssa->num_phis = (int*)calloc(nb + 1, sizeof(int));
+    ssa->executable = (bool*)calloc(nb + 1, sizeof(bool));
+    CHECK_MALLOC_PTR(ssa->phis);
+    CHECK_MALLOC_PTR(ssa->num_phis);
+    CHECK_MALLOC_PTR(ssa->executable);
+    int num_edges = 0;
+    for (int b = 0; b < nb; b++) {
+        num_edges += cfg->blocks[b].num_succs;
+        ssa->executable[b] = (cfg->blocks[b].rpo >= 0);
+    }
+    ssa->edge_executable = (bool*)calloc(num_edges + 1, sizeof(bool));
+    CHECK_MALLOC_PTR(ssa->edge_executable);
+    for (int b = 0; b < nb; b++) {
+        for (int s = 0; s < cfg->blocks[b].num_succs; s++) {
+            ssa->edge_executable[&cfg->blocks[b].succs[s] - cfg->edges] = ssa->executable[b];
+        }
+    }
+
+    ssa->num_promoted = promote_stack_slots(cfg, ids);
+    RegisterIndex* regs = RegisterIndex_new(cfg);
+    SSAFunction_place_phis(ssa, regs);
+    SSAFunction_rename(ssa, regs, ids);
+    RegisterIndex_free(regs);
+    return ssa;
+}
+
+int SSAFunction_edge (SSAFunction* ssa, int from, int to)
+{
+    BasicBlock* block = &ssa->cfg->blocks[from];
+    for (int s = 0; s < block->num_succs; s++) {
+        if (block->succs[s] == to) {
+            return (int)(&block->succs[s] - ssa->cfg->edges);
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Print an instruction like @ref InsnList_print
+ */
+void ILOCInsn_print_line (ILOCInsn* insn, FILE* output)
+{
+    if (insn->form != LABEL) {
+        fprintf(output, "  ");
+    }
+    ILOCInsn_print(insn, output);
+    if (insn->comment != NULL) {
+        fprintf(output, "  ; %s", insn->comment);
+    }
+    fprintf(output, "\n");
+}
+
+/**
+ * @brief Print a phi function as a chain of @c phi instructions
+ *
+ * Arguments from unreachable predecessors are empty and skipped; if only one
+ * argument is left, it is printed as both operands.
+ */
+void Phi_print (Phi* phi, int num_args, FILE* output)
+{
+    ILOCInsn insn;
+    memset(&insn, 0, sizeof(ILOCInsn));
+    insn.form = PHI;
+    insn.op[2] = phi->dest;
+    int printed = 0;
+    bool first = true;
+    for (int p = 0; p < num_args; p++) {
+        if (phi->args[p].type == EMPTY) {
+            continue;
+        }
+        if (first) {
+            insn.op[0] = phi->args[p];
+            first = false;
+        } else {
+            insn.op[1] = phi->args[p];
+            ILOCInsn_print_line(&insn, output);
+            insn.op[0] = phi->dest;
+            printed++;
+        }
+    }
+    if (printed == 0 && !first) {
+        insn.op[1] = insn.op[0];
+        ILOCInsn_print_line(&insn, output);
+    }
+}
+
+void SSAFunction_print (SSAFunction* ssa, FILE* output)
+{
+    ControlFlowGraph* cfg = ssa->cfg;
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        BasicBlock* block = &cfg->blocks[b];
+        bool phis_printed = false;
+        for (int i = block->first; i <= block->end; i++) {
+            ILOCInsn* insn = (i < block->end ? cfg->insns[i] : NULL);
+            if (!phis_printed && (i == block->end || (insn != NULL && insn->form != LABEL))) {
+                for (int p = 0; p < ssa->num_phis[b]; p++) {
+                    if (ssa->phis[b][p].live) {
+                        Phi_print(&ssa->phis[b][p], block->num_preds, output);
+                    }
+                }
+                phis_printed = true;
+            }
+            if (insn != NULL) {
+                ILOCInsn_print_line(insn, output);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Test whether a phi function needs a copy on an incoming edge (i.e.,
+ * the argument was not coalesced with the destination)
+ */
+bool Phi_needs_copy (SSAFunction* ssa, Phi* phi, int pred)
+{
+    Operand* arg = &phi->args[pred];
+    return phi->live && arg->type == VIRTUAL_REG && arg->id != phi->dest.id &&
+        arg->id >= ssa->first_name && arg->id < ssa->first_name + ssa->num_names;
+}
+
+/**
+ * @brief Test whether any phi function of a block needs a copy on an
+ * incoming edge
+ */
+bool SSAFunction_needs_copies (SSAFunction* ssa, int to, int pred)
+{
+    for (int p = 0; p < ssa->num_phis[to]; p++) {
+        if (Phi_needs_copy(ssa, &ssa->phis[to][p], pred)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Emit the copies that implement the phi functions of a block for one
+ * incoming edge
+ *
+ * The copies happen in parallel, so they are ordered such that no register
+ * is overwritten before it is read; cycles are broken with a temporary.
+ *
+ * @returns Number of copies emitted
+ */
+int SSAFunction_emit_copies (SSAFunction* ssa, int to, int pred, InsnVector* output, IDAllocator* ids)
+{
+    int n = ssa->num_phis[to];
+    int* dest = (int*)malloc(n * sizeof(int) + 1);
+    int* src = (int*)malloc(n * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(dest);
+    CHECK_MALLOC_PTR(src);
+    int pending = 0;
+    for (int p = 0; p < n; p++) {
+        Phi* phi = &ssa->phis[to][p];
+        if (Phi_needs_copy(ssa, phi, pred)) {
+            dest[pending] = phi->dest.id;
+            src[pending] = phi->args[pred].id;
+            pending++;
+        }
+    }
+
+    int num_copies = 0;
+    while (pending > 0) {
+        /* find a copy whose destination is not read by another copy */
+        int ready = -1;
+        for (int c = 0; c < pending && ready < 0; c++) {
+            ready = c;
+            for (int d = 0; d < pending; d++) {
+                if (d != c && src[d] == dest[c]) {
+                    ready = -1;
+                    break;
+                }
+            }
+        }
+        if (ready < 0) {
+            /* only cycles are left: save one destination in a temporary */
+            int temp = ids->next_reg++;
+            InsnVector_add(output, ILOCInsn_new_2op(I2I, register_with_id(dest[0]), register_with_id(temp)));
+            num_copies++;
+            for (int d = 0; d < pending; d++) {
+                if (src[d] == dest[0]) {
+                    src[d] = temp;
+                }
+            }
+            continue;
+        }
+        InsnVector_add(output, ILOCInsn_new_2op(I2I, register_with_id(src[ready]), register_with_id(dest[ready])));
+        num_copies++;
+        pending--;
+        dest[ready] = dest[pending];
+        src[ready] = src[pending];
+    }
+
+    free(src);
+    free(dest);
+    return num_copies;
+}
+
+/**
+ * @brief Look up the index of a predecessor in a block's predecessor list
+ */
+int BasicBlock_pred_index (BasicBlock* block, int pred)
+{
+    for (int p = 0; p < block->num_preds; p++) {
+        if (block->preds[p] == pred) {
+            return p;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Find the representative of a register's congruence class (with path
+ * halving)
+ */
+int find_class (int* parent, int n)
+{
+    while (parent[n] != n) {
+        parent[n] = parent[parent[n]];
+        n = parent[n];
+    }
+    return n;
+}
+
+/**
+ * @brief Rename a register operand to its class representative
+ */
+void SSAFunction_rename_to_class (SSAFunction* ssa, int* parent, Operand* op)
+{
+    if (op != NULL && op->type == VIRTUAL_REG && op->id >= ssa->first_name &&
+            op->id < ssa->first_name + ssa->num_names) {
+        op->id = ssa->first_name + find_class(parent, op->id - ssa->first_name);
+    }
+}
+
+int SSAFunction_coalesce (SSAFunction* ssa)
+{
+    ControlFlowGraph* cfg = ssa->cfg;
+    int* parent = (int*)malloc(ssa->num_names * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(parent);
+    for (int n = 0; n < ssa->num_names; n++) {
+        parent[n] = n;
+    }
+
+    int num_merged = 0;
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        BasicBlock* block = &cfg->blocks[b];
+        if (!ssa->executable[b]) {
+            continue;
+        }
+        for (int k = 0; k < ssa->num_phis[b]; k++) {
+            Phi* phi = &ssa->phis[b][k];
+            for (int p = 0; phi->live && p < block->num_preds; p++) {
+                Operand* arg = &phi->args[p];
+                if (arg->type != VIRTUAL_REG || arg->id < ssa->first_name ||
+                        arg->id >= ssa->first_name + ssa->num_names ||
+                        !ssa->edge_executable[SSAFunction_edge(ssa, block->preds[p], b)]) {
+                    continue;
+                }
+                int x = find_class(parent, phi->dest.id - ssa->first_name);
+                int y = find_class(parent, arg->id - ssa->first_name);
+                if (x != y) {
+                    parent[x < y ? y : x] = (x < y ? x : y);
+                    num_merged++;
+                }
+            }
+        }
+    }
+
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        for (int k = 0; k < ssa->num_phis[b]; k++) {
+            SSAFunction_rename_to_class(ssa, parent, &ssa->phis[b][k].dest);
+            for (int p = 0; p < cfg->blocks[b].num_preds; p++) {
+                SSAFunction_rename_to_class(ssa, parent, &ssa->phis[b][k].args[p]);
+            }
+        }
+    }
+    for (int i = 0; i < cfg->num_insns; i++) {
+        for (int j = 0; cfg->insns[i] != NULL && j < 3; j++) {
+            SSAFunction_rename_to_class(ssa, parent, &cfg->insns[i]->op[j]);
+        }
+    }
+
+    free(parent);
+    return num_merged;
+}
+
+int SSAFunction_destroy (SSAFunction* ssa, InsnVector* output, IDAllocator* ids)
+{
+    ControlFlowGraph* cfg = ssa->cfg;
+    int num_copies = 0;
+
+    /* edges out of conditional branches get a block of their own */
+    int num_split = 0;
+    int* split_from = (int*)malloc(2 * cfg->num_blocks * sizeof(int) + 1);
+    int* split_to = (int*)malloc(2 * cfg->num_blocks * sizeof(int) + 1);
+    int* split_label = (int*)malloc(2 * cfg->num_blocks * sizeof(int) + 1);
+    int* block_label = (int*)malloc(cfg->num_blocks * sizeof(int) + 1);
+    CHECK_MALLOC_PTR(split_from);
+    CHECK_MALLOC_PTR(split_to);
+    CHECK_MALLOC_PTR(split_label);
+    CHECK_MALLOC_PTR(block_label);
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        block_label[b] = BasicBlock_label(cfg, &cfg->blocks[b]);
+    }
+
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        BasicBlock* block = &cfg->blocks[b];
+        if (!ssa->executable[b]) {
+            continue;
+        }
+        ILOCInsn* last = BasicBlock_last_insn(cfg, block);
+        ILOCInsn* branch = (last != NULL && (last->form == JUMP || last->form == CBR) ? last : NULL);
+        for (int i = block->first; i < block->end; i++) {
+            if (cfg->insns[i] != NULL && cfg->insns[i] != branch) {
+                InsnVector_add(output, cfg->insns[i]);
+                cfg->insns[i] = NULL;
+            }
+        }
+        for (int s = 0; s < block->num_succs; s++) {
+            int to = block->succs[s];
+            if (!ssa->edge_executable[SSAFunction_edge(ssa, b, to)] ||
+                    !SSAFunction_needs_copies(ssa, to, BasicBlock_pred_index(&cfg->blocks[to], b))) {
+                continue;
+            }
+            if (branch != NULL && branch->form == CBR) {
+                int label = block_label[to];
+                split_from[num_split] = b;
+                split_to[num_split] = to;
+                split_label[num_split] = ids->next_label++;
+                for (int t = 1; t <= 2; t++) {
+                    if (branch->op[t].id == label) {
+                        branch->op[t].id = split_label[num_split];
+                    }
+                }
+                num_split++;
+            } else {
+                num_copies += SSAFunction_emit_copies(ssa, to,
+                        BasicBlock_pred_index(&cfg->blocks[to], b), output, ids);
+            }
+        }
+        if (branch != NULL) {
+            InsnVector_add(output, branch);
+            for (int i = block->end - 1; i >= block->first; i--) {
+                if (cfg->insns[i] == branch) {
+                    cfg->insns[i] = NULL;
+                }
+            }
+        }
+    }
+
+    /* the function ends in a return or jump, so new blocks can follow it */
+    for (int k = 0; k < num_split; k++) {
+        Operand label = { .type = JUMP_LABEL, .id = split_label[k] };
+        Operand target = { .type = JUMP_LABEL, .id = block_label[split_to[k]] };
+        InsnVector_add(output, ILOCInsn_new_1op(LABEL, label));
+        num_copies += SSAFunction_emit_copies(ssa, split_to[k],
+                BasicBlock_pred_index(&cfg->blocks[split_to[k]], split_from[k]), output, ids);
+        InsnVector_add(output, ILOCInsn_new_1op(JUMP, target));
+    }
+
+    free(block_label);
+    free(split_label);
+    free(split_to);
+    free(split_from);
+    return num_copies;
+}
+
+void SSAFunction_free (SSAFunction* ssa)
+{
+    for (int b = 0; b < ssa->cfg->num_blocks; b++) {
+        for (int p = 0; p < ssa->num_phis[b]; p++) {
+            free(ssa->phis[b][p].args);
+        }
+        free(ssa->phis[b]);
+    }
+    free(ssa->edge_executable);
+    free(ssa->executable);
+    free(ssa->num_phis);
+    free(ssa->phis);
+    free(ssa);
+}
+
+void print_ssa (InsnVector* program, FILE* output)
+{
+    IDAllocator ids = IDAllocator_init(program);
+    CFGList* cfgs = build_cfgs(program);
+    bool* supported = find_ssa_functions(cfgs);
+    int f = 0;
+    FOR_EACH(ControlFlowGraph*, cfg, cfgs) {
+        if (supported[f++]) {
+            SSAFunction* ssa = SSAFunction_new(cfg, &ids);
+            SSAFunction_print(ssa, output);
+            SSAFunction_free(ssa);
+        } else {
+            for (int i = 0; i < cfg->num_insns; i++) {
+                if (cfg->insns[i] != NULL) {
+                    ILOCInsn_print_line(cfg->insns[i], output);
+                }
+            }
+        }
+    }
+    free(supported);
+    CFGList_free(cfgs);
+}
@@ -0,0 +1,373 @@
+#include "trace.h"
+
+/**
+ * @brief Fixed-size header at the start of every trace file
+ *
+ * The header is followed by the recorded events (oldest first), the final
+ * register file and address space, and one line of text per instruction.
+ */
+typedef struct TraceFileHeader
+{
+    char magic[8];          /**< @brief Always "ILOCTRC" */
+    int32_t version;        /**< @brief @ref TRACE_FORMAT_VERSION */
+    int32_t word_size;      /**< @brief @c WORD_SIZE of the simulator */
+    int32_t num_regs;       /**< @brief Number of entries in the register file */
+    int32_t mem_size;       /**< @brief Size of the address space in bytes */
+    int32_t num_insns;      /**< @brief Number of instructions in the listing */
+    int32_t capacity;       /**< @brief Capacity of the ring buffer */
+    int64_t count;          /**< @brief Total number of steps executed */
+    int64_t num_events;     /**< @brief Number of events in the file */
+} TraceFileHeader;
+
+const char trace_magic[8] = "ILOCTRC";
+
+/**
+ * @brief Trace buffer to write if the simulator exits early
+ */
+TraceBuffer* trace_active = NULL;
+
+void trace_write_at_exit ()
+{
+    if (trace_active != NULL) {
+        TraceBuffer_finish(trace_active);
+    }
+}
+
+TraceBuffer* TraceBuffer_new (int capacity, const char* filename)
+{
+    TraceBuffer* trace = (TraceBuffer*)calloc(1, sizeof(TraceBuffer));
+    CHECK_MALLOC_PTR(trace);
+    trace->capacity = (capacity > 0 ? capacity : DEFAULT_TRACE_SIZE);
+    trace->events = (TraceEvent*)malloc(trace->capacity * sizeof(TraceEvent));
+    CHECK_MALLOC_PTR(trace->events);
+    trace->filename = (char*)malloc(strlen(filename) + 1);
+    CHECK_MALLOC_PTR(trace->filename);
+    strcpy(trace->filename, filename);
+    return trace;
+}
+
+void TraceBuffer_start (TraceBuffer* trace, DecodedProgram* program, word_t* reg, byte_t* mem, int mem_size)
+{
+    static bool registered = false;
+    if (!registered) {
+        atexit(trace_write_at_exit);
+        registered = true;
+    }
+    trace->program = program;
+    trace->reg = reg;
+    trace->mem = mem;
+    trace->mem_size = mem_size;
+    trace->count = 0;
+    trace->pending = false;
+    trace_active = trace;
+}
+
+/**
+ * @brief Fill in the new values of the most recent event from the live
+ * machine state
+ */
+void TraceBuffer_complete (TraceBuffer* trace)
+{
+    if (!trace->pending) {
+        return;
+    }
+    TraceEvent* event = &trace->events[(trace->count - 1) % trace->capacity];
+    if (event->reg >= 0) {
+        event->new_reg = trace->reg[event->reg];
+    }
+    if (event->address >= 0) {
+        event->new_mem = *(word_t*)(trace->mem + event->address);
+    }
+    trace->pending = false;
+}
+
+void TraceBuffer_record (TraceBuffer* trace, DecodedProgram* program, int pc)
+{
+    TraceBuffer_complete(trace);
+    DecodedInsn* insn = &program->code[pc];
+    if (insn->form == HALT) {
+        return;
+    }
+
+    /* destination register and memory address (computed before execution) */
+    word_t* reg = trace->reg;
+    word_t sp = reg[REG_SP];
+    int dest = -1;
+    word_t address = -1;
+    switch (insn->form) {
+        case LOAD_I: case LOAD: case I2I: case NOT: case NEG:
+            dest = insn->op[1];
+            break;
+        case LOAD_AI: case LOAD_AO:
+        case ADD: case SUB: case MULT: case DIV: case AND: case OR:
+        case CMP_LT: case CMP_LE: case CMP_EQ: case CMP_GE: case CMP_GT: case CMP_NE:
+        case ADD_I: case MULT_I:
+            dest = insn->op[2];
+            break;
+        case POP:
+            dest = insn->op[0];
+            break;
+        case STORE:     address = reg[insn->op[1]];                     break;
+        case STORE_AI:  address = reg[insn->op[1]] + insn->imm;         break;
+        case STORE_AO:  address = reg[insn->op[1]] + reg[insn->op[2]];  break;
+        case PUSH: case CALL:
+            address = sp - WORD_SIZE;
+            break;
+        default:
+            break;
+    }
+    if (address < 0 || address > trace->mem_size - WORD_SIZE) {
+        address = -1;   /* invalid accesses are reported by the simulator */
+    }
+
+    TraceEvent* event = &trace->events[trace->count % trace->capacity];
+    event->pc = pc;
+    event->reg = dest;
+    event->address = (int32_t)address;
+    event->sp = (int32_t)sp;
+    event->old_reg = event->new_reg = (dest >= 0 ? reg[dest] : 0);
+    event->old_mem = event->new_mem = (address >= 0 ? *(word_t*)(trace->mem + address) : 0);
+    trace->count++;
+    trace->pending = true;
+}
+
+void TraceBuffer_finish (TraceBuffer* trace)
+{
+    TraceBuffer_complete(trace);
+    trace_active = NULL;
+
+    FILE* output = fopen(trace->filename, "wb");
+    if (output == NULL) {
+        fprintf(stderr, "Could not write file: %s\n", trace->filename);
+        return;
+    }
+
+    long num_events = (trace->count < trace->capacity ? trace->count : trace->capacity);
+    TraceFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, trace_magic, sizeof(header.magic));
+    header.version = TRACE_FORMAT_VERSION;
+    header.word_size = WORD_SIZE;
+    header.num_regs = trace->program->num_regs;
+    header.mem_size = trace->mem_size;
+    header.num_insns = trace->program->size;
+    header.capacity = trace->capacity;
+    header.count = trace->count;
+    header.num_events = num_events;
+    fwrite(&header, sizeof(header), 1, output);
+
+    /* events in chronological order (the oldest one is next to be overwritten) */
+    long first = trace->count - num_events;
+    for (long i = first; i < trace->count; i++) {
+        fwrite(&trace->events[i % trace->capacity], sizeof(TraceEvent), 1, output);
+    }
+
+    /* final state and program listing */
+    fwrite(trace->reg, sizeof(word_t), header.num_regs, output);
+    fwrite(trace->mem, sizeof(byte_t), header.mem_size, output);
+    for (int i = 0; i < trace->program->size; i++) {
+        ILOCInsn_print(trace->program->source[i], output);
+        fputc('\n', output);
+    }
+    fclose(output);
+}
+
+void TraceBuffer_free (TraceBuffer* trace)
+{
+    if (trace_active == trace) {
+        trace_active = NULL;
+    }
+    free(trace->events);
+    free(trace->filename);
+    free(trace);
+}
+
+/**
+ * @brief Read one line of text (without the newline) from a file
+ *
+ * @returns Newly-allocated string (or @c NULL at the end of the file)
+ */
+char* trace_read_line (FILE* input)
+{
+    int c = fgetc(input);
+    if (c == EOF) {
+        return NULL;
+    }
+    size_t length = 0;
+    size_t capacity = 64;
+    char* line = (char*)malloc(capacity);
+    CHECK_MALLOC_PTR(line);
+    while (c != EOF && c != '\n') {
+        if (length + 1 == capacity) {
+            capacity *= 2;
+            line = (char*)realloc(line, capacity);
+            CHECK_MALLOC_PTR(line);
+        }
+        line[length++] = (char)c;
+        c = fgetc(input);
+    }
+    line[length] = '\0';
+    return line;
+}
+
+TraceFile* TraceFile_load (const char* filename)
+{
+    FILE* input = fopen(filename, "rb");
+    if (input == NULL) {
+        return NULL;
+    }
+    TraceFileHeader header;
+    if (fread(&header, sizeof(header), 1, input) != 1 ||
+            memcmp(header.magic, trace_magic, sizeof(header.magic)) != 0 ||
+            header.version != TRACE_FORMAT_VERSION || header.word_size != WORD_SIZE ||
+            header.num_regs < FIRST_VIRTUAL_REG || header.num_regs > FIRST_VIRTUAL_REG + MAX_VIRTUAL_REGS ||
+            header.mem_size <= STATIC_VAR_OFFSET || header.mem_size % WORD_SIZE != 0 ||
+            header.num_events < 0 || header.num_events > header.count ||
+            header.num_events > header.capacity || header.num_insns < 0) {
+        fclose(input);
+        return NULL;
+    }
+
+    TraceFile* trace = (TraceFile*)calloc(1, sizeof(TraceFile));
+    CHECK_MALLOC_PTR(trace);
+    trace->first_step = header.count - header.num_events;
+    trace->num_events = header.num_events;
+    trace->num_regs = header.num_regs;
+    trace->mem_size = header.mem_size;
+    trace->events = (TraceEvent*)malloc((header.num_events + 1) * sizeof(TraceEvent));
+    CHECK_MALLOC_PTR(trace->events);
+    trace->reg = (word_t*)malloc(trace->num_regs * sizeof(word_t));
+    CHECK_MALLOC_PTR(trace->reg);
+    trace->mem = (byte_t*)malloc(trace->mem_size);
+    CHECK_MALLOC_PTR(trace->mem);
+    trace->listing = (char**)calloc(header.num_insns + 1, sizeof(char*));
+    CHECK_MALLOC_PTR(trace->listing);
+
+    bool valid = fread(trace->events, sizeof(TraceEvent), header.num_events, input) == (size_t)header.num_events &&
+                 fread(trace->reg, sizeof(word_t), trace->num_regs, input) == (size_t)trace->num_regs &&
+                 fread(trace->mem, sizeof(byte_t), trace->mem_size, input) == (size_t)trace->mem_size;
+    for (int i = 0; valid && i < header.num_insns; i++) {
+        trace->listing[i] = trace_read_line(input);
+        trace->num_insns++;
+        valid = (trace->listing[i] != NULL);
+    }
+
+    /* reject events that do not fit the machine */
+    for (long i = 0; valid && i < trace->num_events; i++) {
+        TraceEvent* event = &trace->events[i];
+        valid = event->pc >= 0 && event->pc < header.num_insns &&
+                event->reg >= -1 && event->reg < trace->num_regs &&
+                event->address >= -1 && event->address <= trace->mem_size - WORD_SIZE;
+    }
+    fclose(input);
+
+    if (!valid) {
+        TraceFile_free(trace);
+        return NULL;
+    }
+    return trace;
+}
+
+/**
+ * @brief Print the name of a register file entry
+ */
+void trace_print_reg (int reg, FILE* output)
+{
+    switch (reg) {
+        case REG_SP:  fprintf(output, "SP");                            break;
+        case REG_BP:  fprintf(output, "BP");                            break;
+        case REG_RET: fprintf(output, "RET");                           break;
+        default:      fprintf(output, "r%d", reg - FIRST_VIRTUAL_REG);  break;
+    }
+}
+
+/**
+ * @brief Print a register or memory value (marking uninitialized registers)
+ */
+void trace_print_value (word_t value, bool is_reg, FILE* output)
+{
+    if (is_reg && value == UNINIT_REG) {
+        fprintf(output, "?");
+    } else {
+        fprintf(output, PRIW, value);
+    }
+}
+
+void TraceFile_print_steps (TraceFile* trace, long max_steps, FILE* output)
+{
+    fprintf(output, "TRACE (%ld steps executed, last %ld recorded)\n",
+            trace->first_step + trace->num_events, trace->num_events);
+    long start = (max_steps < trace->num_events ? trace->num_events - max_steps : 0);
+    for (long i = start; i < trace->num_events; i++) {
+        TraceEvent* event = &trace->events[i];
+        word_t new_sp = (i + 1 < trace->num_events ? trace->events[i + 1].sp : trace->reg[REG_SP]);
+        bool changes_sp = (new_sp != event->sp && event->reg != REG_SP);
+        fprintf(output, (event->reg >= 0 || event->address >= 0 || changes_sp ? "%10ld %7d  %-32s" : "%10ld %7d  %s"),
+                trace->first_step + i, event->pc, trace->listing[event->pc]);
+        if (event->reg >= 0) {
+            fprintf(output, "  ");
+            trace_print_reg(event->reg, output);
+            fprintf(output, ": ");
+            trace_print_value(event->old_reg, true, output);
+            fprintf(output, " -> ");
+            trace_print_value(event->new_reg, true, output);
+        }
+        if (changes_sp) {
+            fprintf(output, "  SP: %d -> " PRIW, event->sp, new_sp);
+        }
+        if (event->address >= 0) {
+            fprintf(output, "  [%d]: ", event->address);
+            trace_print_value(event->old_mem, false, output);
+            fprintf(output, " -> ");
+            trace_print_value(event->new_mem, false, output);
+        }
+        fprintf(output, "\n");
+    }
+}
+
+bool TraceFile_print_state (TraceFile* trace, long step, FILE* output)
+{
+    long index = step - trace->first_step;
+    if (index < 0 || index > trace->num_events) {
+        return false;
+    }
+
+    /* undo events from the final state back to the requested step */
+    word_t* reg = (word_t*)malloc(trace->num_regs * sizeof(word_t));
+    CHECK_MALLOC_PTR(reg);
+    byte_t* mem = (byte_t*)malloc(trace->mem_size);
+    CHECK_MALLOC_PTR(mem);
+    memcpy(reg, trace->reg, trace->num_regs * sizeof(word_t));
+    memcpy(mem, trace->mem, trace->mem_size);
+    for (long i = trace->num_events - 1; i >= index; i--) {
+        TraceEvent* event = &trace->events[i];
+        if (event->address >= 0) {
+            *(word_t*)(mem + event->address) = event->old_mem;
+        }
+        if (event->reg >= 0) {
+            reg[event->reg] = event->old_reg;
+        }
+        reg[REG_SP] = event->sp;
+    }
+
+    fprintf(output, "STATE BEFORE STEP %ld\n", step);
+    print_machine_state(reg, trace->num_regs, mem, trace->mem_size, output);
+    if (index < trace->num_events) {
+        fprintf(output, "\nExecuting: %s\n", trace->listing[trace->events[index].pc]);
+    }
+    free(reg);
+    free(mem);
+    return true;
+}
+
+void TraceFile_free (TraceFile* trace)
+{
+    for (int i = 0; i < trace->num_insns; i++) {
+        free(trace->listing[i]);
+    }
+    free(trace->listing);
+    free(trace->events);
+    free(trace->reg);
+    free(trace->mem);
+    free(trace);
+}
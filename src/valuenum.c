@@ -0,0 +1,538 @@
+#include "valuenum.h"
+#include "dataflow.h"
+
+/**
+ * @brief Key of a computed value (operation and operand value numbers or
+ * constants)
+ */
+typedef struct ValueKey
+{
+    InsnForm form;          /**< @brief Operation */
+    long a;                 /**< @brief First operand */
+    long b;                 /**< @brief Second operand */
+} ValueKey;
+
+/**
+ * @brief Memory address (a base value plus an offset)
+ *
+ * Constant bases are folded into the offset (with base -1). If the offset is
+ * not a known constant, it holds the value number of the offset register
+ * instead and the address is not exact.
+ */
+typedef struct MemoryAddress
+{
+    int base;               /**< @brief Value number of the base (or -1 for absolute addresses) */
+    long offset;            /**< @brief Constant offset (or value number of the offset register) */
+    bool exact;             /**< @brief True if and only if the offset is a constant */
+} MemoryAddress;
+
+/**
+ * @brief Known contents of a memory location
+ */
+typedef struct MemoryEntry
+{
+    MemoryAddress address;  /**< @brief Address of the location */
+    int value;              /**< @brief Value number of the contents */
+    bool stored;            /**< @brief True if the contents are known from a store (not a load) */
+} MemoryEntry;
+
+/**
+ * @brief Value numbering state of the current basic block
+ *
+ * Maps registers to value numbers, operations and constants to value
+ * numbers (open addressing), and addresses to the value numbers of their
+ * contents. Value numbers are only compared within one epoch, which starts
+ * at every block and every call.
+ */
+typedef struct ValueTable
+{
+    RegisterIndex* regs;    /**< @brief Register numbering of the function */
+    int num_slots;          /**< @brief Number of registers (virtual registers plus SP, BP, and RET) */
+    int* value_of;          /**< @brief Value number held by every register */
+    int* reg_stamp;         /**< @brief Epoch in which every register's value number was set */
+    int epoch;              /**< @brief Current epoch */
+
+    int num_values;         /**< @brief Number of value numbers in the current epoch */
+    int capacity;           /**< @brief Allocated size of the per-value arrays */
+    Operand* holder;        /**< @brief First register that held every value (if it still does) */
+    bool* is_const;         /**< @brief True for values that are known constants */
+    long* const_val;        /**< @brief Known constant of every value */
+
+    ValueKey* keys;         /**< @brief Hash table keys */
+    int* key_value;         /**< @brief Hash table values (value numbers) */
+    int* key_stamp;         /**< @brief Epoch in which every hash table entry was added */
+    int table_size;         /**< @brief Number of hash table buckets (a power of two) */
+
+    MemoryEntry* memory;    /**< @brief Known memory contents */
+    int num_memory;         /**< @brief Number of known memory locations */
+    int memory_capacity;    /**< @brief Allocated size of the memory array */
+} ValueTable;
+
+/**
+ * @brief Allocate a value table for a function
+ */
+ValueTable* ValueTable_new (ControlFlowGraph* cfg)
+{
+    ValueTable* table = (ValueTable*)calloc(1, sizeof(ValueTable));
+    CHECK_MALLOC_PTR(table);
+    table->regs = RegisterIndex_new(cfg);
+    table->num_slots = table->regs->num_regs + 3;
+    table->value_of = (int*)calloc(table->num_slots, sizeof(int));
+    table->reg_stamp = (int*)calloc(table->num_slots, sizeof(int));
+    CHECK_MALLOC_PTR(table->value_of);
+    CHECK_MALLOC_PTR(table->reg_stamp);
+
+    table->table_size = 16;
+    while (table->table_size < 2 * cfg->num_insns) {
+        table->table_size *= 2;
+    }
+    table->keys = (ValueKey*)malloc(table->table_size * sizeof(ValueKey));
+    table->key_value = (int*)malloc(table->table_size * sizeof(int));
+    table->key_stamp = (int*)calloc(table->table_size, sizeof(int));
+    CHECK_MALLOC_PTR(table->keys);
+    CHECK_MALLOC_PTR(table->key_value);
+    CHECK_MALLOC_PTR(table->key_stamp);
+    return table;
+}
+
+/**
+ * @brief Forget all registers, values, and memory contents
+ */
+void ValueTable_reset (ValueTable* table)
+{
+    table->epoch++;
+    table->num_values = 0;
+    table->num_memory = 0;
+}
+
+/**
+ * @brief Look up the register slot of an operand
+ *
+ * @returns Slot index (or -1 if the operand is not a register)
+ */
+int ValueTable_slot (ValueTable* table, Operand* op)
+{
+    switch (op->type) {
+        case VIRTUAL_REG:   return RegisterIndex_lookup(table->regs, op);
+        case STACK_REG:     return table->num_slots - 3;
+        case BASE_REG:      return table->num_slots - 2;
+        case RETURN_REG:    return table->num_slots - 1;
+        default:            return -1;
+    }
+}
+
+/**
+ * @brief Create a new value number
+ */
+int ValueTable_new_value (ValueTable* table)
+{
+    if (table->num_values == table->capacity) {
+        table->capacity = (table->capacity == 0 ? 64 : table->capacity * 2);
+        table->holder = (Operand*)realloc(table->holder, table->capacity * sizeof(Operand));
+        table->is_const = (bool*)realloc(table->is_const, table->capacity * sizeof(bool));
+        table->const_val = (long*)realloc(table->const_val, table->capacity * sizeof(long));
+        CHECK_MALLOC_PTR(table->holder);
+        CHECK_MALLOC_PTR(table->is_const);
+        CHECK_MALLOC_PTR(table->const_val);
+    }
+    int value = table->num_values++;
+    table->holder[value] = empty_operand();
+    table->is_const[value] = false;
+    return value;
+}
+
+/**
+ * @brief Test whether a register currently holds a value
+ */
+bool ValueTable_holds (ValueTable* table, Operand* reg, int value)
+{
+    int slot = ValueTable_slot(table, reg);
+    return slot >= 0 && table->reg_stamp[slot] == table->epoch && table->value_of[slot] == value;
+}
+
+/**
+ * @brief Record that a register now holds a value
+ *
+ * The register becomes the value's holder if the previous holder was
+ * overwritten (or is not a virtual register).
+ */
+void ValueTable_assign (ValueTable* table, Operand* reg, int value)
+{
+    int slot = ValueTable_slot(table, reg);
+    if (slot < 0) {
+        return;
+    }
+    table->value_of[slot] = value;
+    table->reg_stamp[slot] = table->epoch;
+    Operand* holder = &table->holder[value];
+    if (!ValueTable_holds(table, holder, value) || (holder->type != VIRTUAL_REG && reg->type == VIRTUAL_REG)) {
+        *holder = *reg;
+    }
+}
+
+/**
+ * @brief Look up the value held by a register (numbering it if unknown)
+ *
+ * Operands that are not registers (which only malformed code has where a
+ * register is expected) get a new value, so they match nothing.
+ *
+ * @returns Value number
+ */
+int ValueTable_value (ValueTable* table, Operand* reg)
+{
+    int slot = ValueTable_slot(table, reg);
+    if (slot < 0) {
+        return ValueTable_new_value(table);
+    }
+    if (table->reg_stamp[slot] != table->epoch) {
+        ValueTable_assign(table, reg, ValueTable_new_value(table));
+    }
+    return table->value_of[slot];
+}
+
+/**
+ * @brief Find a virtual register that currently holds a value
+ *
+ * @returns Register operand (or @c NULL if there is none)
+ */
+Operand* ValueTable_virtual_holder (ValueTable* table, int value)
+{
+    Operand* holder = &table->holder[value];
+    if (holder->type == VIRTUAL_REG && ValueTable_holds(table, holder, value)) {
+        return holder;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Look up (or add) the value number of a key
+ *
+ * @param table Value table
+ * @param key Key to look up
+ * @param found Set to true if and only if the key was already present
+ * @returns Value number
+ */
+int ValueTable_lookup (ValueTable* table, ValueKey key, bool* found)
+{
+    unsigned long hash = (unsigned long)key.form * 0x9E3779B97F4A7C15UL;
+    hash ^= (unsigned long)key.a + 0x7F4A7C15UL + (hash << 6) + (hash >> 2);
+    hash ^= (unsigned long)key.b + 0x7F4A7C15UL + (hash << 6) + (hash >> 2);
+    int mask = table->table_size - 1;
+    int bucket = (int)(hash & (unsigned long)mask);
+    while (table->key_stamp[bucket] == table->epoch) {
+        ValueKey* entry = &table->keys[bucket];
+        if (entry->form == key.form && entry->a == key.a && entry->b == key.b) {
+            *found = true;
+            return table->key_value[bucket];
+        }
+        bucket = (bucket + 1) & mask;
+    }
+    *found = false;
+    table->keys[bucket] = key;
+    table->key_value[bucket] = ValueTable_new_value(table);
+    table->key_stamp[bucket] = table->epoch;
+    return table->key_value[bucket];
+}
+
+/**
+ * @brief Compute the address accessed by a load or store
+ *
+ * @param table Value table
+ * @param form Memory access form
+ * @param base Base register operand
+ * @param offset Offset operand (register, constant, or empty)
+ */
+MemoryAddress ValueTable_address (ValueTable* table, InsnForm form, Operand* base, Operand* offset)
+{
+    MemoryAddress address;
+    address.base = ValueTable_value(table, base);
+    address.offset = 0;
+    address.exact = true;
+    if (form == LOAD_AI || form == STORE_AI) {
+        address.offset = offset->imm;
+    } else if (form == LOAD_AO || form == STORE_AO) {
+        int index = ValueTable_value(table, offset);
+        if (table->is_const[index]) {
+            address.offset = table->const_val[index];
+        } else if (table->is_const[address.base]) {
+            address.offset = table->const_val[address.base];
+            address.base = index;
+        } else {
+            address.offset = index;
+            address.exact = false;
+        }
+    }
+    if (address.exact && table->is_const[address.base]) {
+        address.offset = (long)((unsigned long)address.offset + (unsigned long)table->const_val[address.base]);
+        address.base = -1;
+    }
+    return address;
+}
+
+/**
+ * @brief Test whether two memory accesses may overlap
+ */
+bool MemoryAddress_may_alias (MemoryAddress a, MemoryAddress b)
+{
+    if (a.exact && b.exact && a.base == b.base) {
+        unsigned long distance = (unsigned long)a.offset - (unsigned long)b.offset;
+        return distance + (WORD_SIZE - 1) < 2 * WORD_SIZE - 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Find the known contents of a memory location
+ *
+ * @returns Memory entry (or @c NULL if the contents are unknown)
+ */
+MemoryEntry* ValueTable_find_memory (ValueTable* table, MemoryAddress address)
+{
+    for (int i = 0; i < table->num_memory; i++) {
+        MemoryAddress known = table->memory[i].address;
+        if (known.base == address.base && known.offset == address.offset && known.exact == address.exact) {
+            return &table->memory[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Record the contents of a memory location
+ *
+ * For stores, all known locations that may overlap the address are
+ * forgotten first.
+ */
+void ValueTable_set_memory (ValueTable* table, MemoryAddress address, int value, bool stored)
+{
+    if (stored) {
+        int kept = 0;
+        for (int i = 0; i < table->num_memory; i++) {
+            if (!MemoryAddress_may_alias(table->memory[i].address, address)) {
+                table->memory[kept++] = table->memory[i];
+            }
+        }
+        table->num_memory = kept;
+    }
+    if (table->num_memory == table->memory_capacity) {
+        table->memory_capacity = (table->memory_capacity == 0 ? 16 : table->memory_capacity * 2);
+        table->memory = (MemoryEntry*)realloc(table->memory, table->memory_capacity * sizeof(MemoryEntry));
+        CHECK_MALLOC_PTR(table->memory);
+    }
+    MemoryEntry* entry = &table->memory[table->num_memory++];
+    entry->address = address;
+    entry->value = value;
+    entry->stored = stored;
+}
+
+/**
+ * @brief Deallocate a value table
+ */
+void ValueTable_free (ValueTable* table)
+{
+    free(table->memory);
+    free(table->key_stamp);
+    free(table->key_value);
+    free(table->keys);
+    free(table->const_val);
+    free(table->is_const);
+    free(table->holder);
+    free(table->reg_stamp);
+    free(table->value_of);
+    RegisterIndex_free(table->regs);
+    free(table);
+}
+
+/**
+ * @brief Build the key of an operation (normalizing operand order)
+ */
+ValueKey ValueKey_operation (InsnForm form, long a, long b)
+{
+    ValueKey key;
+    switch (form) {
+        case CMP_GT: form = CMP_LT; key.a = b; key.b = a; break;
+        case CMP_GE: form = CMP_LE; key.a = b; key.b = a; break;
+        case ADD: case MULT: case AND: case OR: case CMP_EQ: case CMP_NE:
+            key.a = (a < b ? a : b);
+            key.b = (a < b ? b : a);
+            break;
+        default:
+            key.a = a;
+            key.b = b;
+            break;
+    }
+    key.form = form;
+    return key;
+}
+
+/**
+ * @brief Replace an instruction that recomputes a value by a copy (if a
+ * virtual register still holds the value)
+ *
+ * @returns True if and only if the instruction was replaced
+ */
+bool ValueTable_reuse (ValueTable* table, ILOCInsn* insn, Operand* def, int value)
+{
+    Operand* holder = ValueTable_virtual_holder(table, value);
+    if (holder == NULL || (def->type == holder->type && def->id == holder->id)) {
+        return false;
+    }
+    Operand dest = *def;
+    insn->form = I2I;
+    insn->op[0] = *holder;
+    insn->op[1] = dest;
+    insn->op[2] = empty_operand();
+    return true;
+}
+
+/**
+ * @brief Number the value computed by one instruction and replace it if it
+ * is redundant
+ */
+void ValueTable_process (ValueTable* table, ILOCInsn* insn, ValueNumberingStats* stats)
+{
+    /* read the earliest register that holds each operand's value */
+    Operand* uses[MAX_INSN_USES];
+    int num_uses = ILOCInsn_get_uses(insn, uses);
+    for (int u = 0; u < num_uses; u++) {
+        int value = ValueTable_value(table, uses[u]);
+        if (uses[u]->type != VIRTUAL_REG) {
+            continue;
+        }
+        Operand* holder = ValueTable_virtual_holder(table, value);
+        if (holder != NULL && holder->id != uses[u]->id) {
+            *uses[u] = *holder;
+            stats->propagated++;
+        }
+    }
+
+    Operand* def = ILOCInsn_get_def(insn);
+    int value = -1;
+    bool found = false;
+    MemoryAddress address;
+    switch (insn->form) {
+        case ADD: case SUB: case MULT: case DIV: case AND: case OR:
+        case CMP_LT: case CMP_LE: case CMP_EQ: case CMP_GE: case CMP_GT: case CMP_NE:
+            value = ValueTable_lookup(table, ValueKey_operation(insn->form,
+                        ValueTable_value(table, &insn->op[0]), ValueTable_value(table, &insn->op[1])), &found);
+            if (found && ValueTable_reuse(table, insn, def, value)) {
+                stats->expressions++;
+            }
+            break;
+
+        case ADD_I: case MULT_I: case NOT: case NEG:
+            value = ValueTable_lookup(table, ValueKey_operation(insn->form, ValueTable_value(table, &insn->op[0]),
+                        (insn->form == ADD_I || insn->form == MULT_I ? insn->op[1].imm : 0)), &found);
+            if (found && ValueTable_reuse(table, insn, def, value)) {
+                stats->expressions++;
+            }
+            break;
+
+        case LOAD_I:
+            value = ValueTable_lookup(table, ValueKey_operation(LOAD_I, insn->op[0].imm, 0), &found);
+            table->is_const[value] = true;
+            table->const_val[value] = insn->op[0].imm;
+            if (found && ValueTable_reuse(table, insn, def, value)) {
+                stats->constants++;
+            }
+            break;
+
+        case I2I:
+            value = ValueTable_value(table, &insn->op[0]);
+            break;
+
+        case LOAD: case LOAD_AI: case LOAD_AO: {
+            address = ValueTable_address(table, insn->form, &insn->op[0], &insn->op[1]);
+            MemoryEntry* entry = ValueTable_find_memory(table, address);
+            if (entry != NULL) {
+                value = entry->value;
+                bool stored = entry->stored;
+                if (ValueTable_reuse(table, insn, def, value)) {
+                    if (stored) {
+                        stats->forwarded++;
+                    } else {
+                        stats->loads++;
+                    }
+                }
+            } else {
+                value = ValueTable_new_value(table);
+                ValueTable_set_memory(table, address, value, false);
+            }
+            break;
+        }
+
+        case STORE: case STORE_AI: case STORE_AO:
+            address = ValueTable_address(table, insn->form, &insn->op[1], &insn->op[2]);
+            ValueTable_set_memory(table, address, ValueTable_value(table, &insn->op[0]), true);
+            break;
+
+        case PUSH: case POP: {
+            Operand sp = stack_register();
+            ValueTable_assign(table, &sp, ValueTable_new_value(table));
+            if (insn->form == PUSH) {
+                table->num_memory = 0;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    /* a replaced instruction writes its result with a different operand slot */
+    def = ILOCInsn_get_def(insn);
+    if (def != NULL) {
+        ValueTable_assign(table, def, (value >= 0 ? value : ValueTable_new_value(table)));
+    }
+}
+
+/**
+ * @brief Number values within each block of a function
+ */
+void number_function_values (ControlFlowGraph* cfg, ValueNumberingStats* stats)
+{
+    ValueTable* table = ValueTable_new(cfg);
+    for (int b = 0; b < cfg->num_blocks; b++) {
+        ValueTable_reset(table);
+        for (int i = cfg->blocks[b].first; i < cfg->blocks[b].end; i++) {
+            ILOCInsn* insn = cfg->insns[i];
+            if (insn == NULL) {
+                continue;
+            }
+            if (insn->form == CALL) {
+                ValueTable_reset(table);
+                continue;
+            }
+            ValueTable_process(table, insn, stats);
+        }
+    }
+    ValueTable_free(table);
+}
+
+void number_local_values (InsnList* program, ValueNumberingStats* stats)
+{
+    ValueNumberingStats local_stats = { 0, 0, 0, 0, 0, 0 };
+    if (stats == NULL) {
+        stats = &local_stats;
+    }
+    InsnVector* code = InsnVector_from_list(program);
+
+    /* the rewrites do not change control flow, so the CFGs stay valid; the
+     * rewrites keep every definition, but removing dead code needs liveness
+     * beyond the function for registers that are shared with others */
+    CFGList* cfgs = build_cfgs(code);
+    CallGraph* graph = CallGraph_new(cfgs);
+    for (int f = 0; f < graph->num_funcs; f++) {
+        number_function_values(graph->funcs[f], stats);
+        if (!graph->shares_registers[f]) {
+            stats->removed += remove_dead_code(code, graph->funcs[f], ILOCInsn_is_pure);
+        }
+    }
+    CallGraph_free(graph);
+    CFGList_free(cfgs);
+
+    InsnList* result = InsnVector_to_list(code);
+    InsnList_splice(program, result);
+    InsnList_free(result);
+    InsnVector_free(code);
+}
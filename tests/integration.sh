@@ -60,6 +60,45 @@ function run_test {
     fi
 }
 
+function run_native_test {
+
+    # parameters
+    TAG=$1
+    ARGS=$2
+    PTAG=$(printf '%-30s' "$TAG")
+
+    # file paths
+    OUTPUT=outputs/$TAG.txt
+    NATIVE=outputs/$TAG.exe
+    DIFF=outputs/$TAG.diff
+
+    # building needs the system assembler and C compiler driver
+    if ! command -v as &>/dev/null || ! command -v cc &>/dev/null; then
+        echo "$PTAG skipped (no as/cc)"
+        return
+    fi
+
+    # the native executable must print the same output as the simulator
+    # (except for the simulator's warnings)
+    $TIMEOUT $TIMEOUT_INTERVAL $EXE $ARGS 2>/dev/null | grep -v '^WARNING' >"$OUTPUT.expected"
+    $TIMEOUT $TIMEOUT_INTERVAL $EXE --native=$NATIVE $ARGS &>/dev/null
+    if [ ! -x "$NATIVE" ]; then
+        echo "$PTAG FAIL (could not build $NATIVE)"
+        return
+    fi
+    $TIMEOUT $TIMEOUT_INTERVAL ./$NATIVE 2>/dev/null >"$OUTPUT"
+    if [ "$?" -lt 124 ]; then
+        diff -u "$OUTPUT" "$OUTPUT.expected" >"$DIFF"
+        if [ -s "$DIFF" ]; then
+            echo "$PTAG FAIL (see $DIFF for details)"
+        else
+            echo "$PTAG pass"
+        fi
+    else
+        echo "$PTAG FAIL (timeout)"
+    fi
+}
+
 # initialize output folders
 mkdir -p outputs
 mkdir -p valgrind
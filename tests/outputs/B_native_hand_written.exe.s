@@ -0,0 +1,330 @@
+# generated by decaf (9 native registers, 5 spill slots)
+	.text
+	.globl	main
+	.type	main, @function
+main:
+	pushq	%rbx
+	pushq	%rbp
+	pushq	%r12
+	pushq	%r13
+	pushq	%r14
+	pushq	%r15
+	subq	$8, %rsp
+	leaq	.Lmem(%rip), %r15
+	movq	$65536, %r13
+	movq	$-9999999, %r14
+	movq	$-9999999, %r12
+	movq	$-9999999, %rbp
+	movq	$-9999999, %r10
+	movq	$-9999999, %r11
+	movq	$-9999999, %rsi
+	movq	$-9999999, %rbx
+	movq	$-9999999, %rdi
+	movq	$-9999999, %r8
+	movq	$-9999999, %r9
+	jmp	.Li10
+	# helper:
+.Li1:
+	# push BP
+	subq	$8, %r13
+	movq	%r14, %rax
+	movq	%rax, (%r15,%r13)
+	# i2i SP => BP
+	movq	%r13, %rax
+	movq	%rax, %r14
+	# loadAI [BP+16] => r1
+	movq	%r14, %rax
+	addq	$16, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, %r10
+	# multI r1, -3 => r2
+	movq	%r10, %rax
+	imulq	$-3, %rax
+	movq	%rax, %r11
+	# i2i r2 => RET
+	movq	%r11, %rax
+	movq	%rax, %r12
+	# i2i BP => SP
+	movq	%r14, %rax
+	movq	%rax, %r13
+	# pop BP
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	movq	%rax, %r14
+	# return
+	cmpq	$65536, %r13
+	je	.Lexit
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	leaq	.Lreturn_table(%rip), %rcx
+	movslq	(%rcx,%rax,4), %rax
+	addq	%rcx, %rax
+	jmp	*%rax
+	# main:
+.Li10:
+	# push BP
+	subq	$8, %r13
+	movq	%r14, %rax
+	movq	%rax, (%r15,%r13)
+	# i2i SP => BP
+	movq	%r13, %rax
+	movq	%rax, %r14
+	# addI SP, -16 => SP
+	movq	%r13, %rax
+	addq	$-16, %rax
+	movq	%rax, %r13
+	# loadI 7 => r0
+	movq	$7, %rax
+	movq	%rax, %rbp
+	# storeAI r0 => [BP-8]
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movq	%rbp, %rcx
+	movslq	%eax, %rax
+	movq	%rcx, (%r15,%rax)
+	# loadAI [BP-8] => r3
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, .Lspill+0(%rip)
+	# push r3
+	subq	$8, %r13
+	movq	.Lspill+0(%rip), %rax
+	movq	%rax, (%r15,%r13)
+	# call helper
+	subq	$8, %r13
+	movq	$18, (%r15,%r13)
+	jmp	.Li1
+.Li18:
+	# addI SP, 8 => SP
+	movq	%r13, %rax
+	addq	$8, %rax
+	movq	%rax, %r13
+	# i2i RET => r4
+	movq	%r12, %rax
+	movq	%rax, %rsi
+	# print r4
+	movq	%rsi, %rax
+	call	.Lprint_int
+	# print "tab\there \"quoted\" \\ semi;colon\n"
+	leaq	.Lstr21(%rip), %rax
+	call	.Lprint_str
+	# loadI 1024 => r5
+	movq	$1024, %rax
+	movq	%rax, %rbx
+	# store r4 => [r5]
+	movq	%rbx, %rax
+	movq	%rsi, %rcx
+	movslq	%eax, %rax
+	movq	%rcx, (%r15,%rax)
+	# load [r5] => r6
+	movq	%rbx, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, .Lspill+8(%rip)
+	# loadI 8 => r7
+	movq	$8, %rax
+	movq	%rax, %rdi
+	# storeAO r6 => [r5+r7]
+	movq	%rbx, %rax
+	addq	%rdi, %rax
+	movq	.Lspill+8(%rip), %rcx
+	movslq	%eax, %rax
+	movq	%rcx, (%r15,%rax)
+	# loadAO [r5+r7] => r8
+	movq	%rbx, %rax
+	addq	%rdi, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, %r8
+	# cmp_LT r8, r0 => r9
+	movq	%r8, %rax
+	cmpq	%rbp, %rax
+	setl	%al
+	movzbl	%al, %eax
+	movq	%rax, %r9
+	# cbr r9 => l1, l2
+	movq	%r9, %rax
+	testq	%rax, %rax
+	jne	.Li31
+	jmp	.Li34
+	# l1:
+.Li31:
+	# print "less"
+	leaq	.Lstr31(%rip), %rax
+	call	.Lprint_str
+	# jump l3
+	jmp	.Li36
+	# l2:
+.Li34:
+	# print "not less"
+	leaq	.Lstr34(%rip), %rax
+	call	.Lprint_str
+	# l3:
+.Li36:
+	# nop
+	# neg r8 => r10
+	movq	%r8, %rax
+	negq	%rax
+	movq	%rax, .Lspill+16(%rip)
+	# not r9 => r11
+	movq	%r9, %rax
+	notq	%rax
+	andl	$1, %eax
+	movq	%rax, .Lspill+24(%rip)
+	# sub r10, r0 => r12
+	movq	.Lspill+16(%rip), %rax
+	subq	%rbp, %rax
+	movq	%rax, .Lspill+32(%rip)
+	# i2i r12 => RET
+	movq	.Lspill+32(%rip), %rax
+	movq	%rax, %r12
+	# i2i BP => SP
+	movq	%r14, %rax
+	movq	%rax, %r13
+	# pop BP
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	movq	%rax, %r14
+	# return
+	cmpq	$65536, %r13
+	je	.Lexit
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	leaq	.Lreturn_table(%rip), %rcx
+	movslq	(%rcx,%rax,4), %rax
+	addq	%rcx, %rax
+	jmp	*%rax
+.Li44:
+	jmp	.Lexit
+.Lexit:
+	movq	%r12, %rax
+	movl	%eax, %esi
+	leaq	.Lfmt_return(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r15
+	popq	%r14
+	popq	%r13
+	popq	%r12
+	popq	%rbp
+	popq	%rbx
+	xorl	%eax, %eax
+	ret
+	.size	main, .-main
+.Lbad_return:
+	ud2
+.Lprint_int:
+	pushq	%rsi
+	pushq	%rdi
+	pushq	%r8
+	pushq	%r9
+	pushq	%r10
+	pushq	%r11
+	subq	$8, %rsp
+	movq	%rax, %rsi
+	leaq	.Lfmt_int(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r11
+	popq	%r10
+	popq	%r9
+	popq	%r8
+	popq	%rdi
+	popq	%rsi
+	ret
+.Lprint_str:
+	pushq	%rsi
+	pushq	%rdi
+	pushq	%r8
+	pushq	%r9
+	pushq	%r10
+	pushq	%r11
+	subq	$8, %rsp
+	movq	%rax, %rsi
+	leaq	.Lfmt_str(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r11
+	popq	%r10
+	popq	%r9
+	popq	%r8
+	popq	%rdi
+	popq	%rsi
+	ret
+	.section	.rodata
+.Lfmt_int:
+	.string	"%ld"
+.Lfmt_str:
+	.string	"%s"
+.Lfmt_return:
+	.string	"RETURN VALUE = %d\n"
+.Lstr21:
+	.byte	116,97,98,9,104,101,114,101,32,34,113,117,111,116,101,100,34,32,92,32,115,101,109,105,59,99,111,108,111,110,10,0
+.Lstr31:
+	.byte	108,101,115,115,0
+.Lstr34:
+	.byte	110,111,116,32,108,101,115,115,0
+	.p2align	2
+.Lreturn_table:
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Li18-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.data
+	.p2align	3
+.Lspill:
+	.rept	5
+	.quad	-9999999
+	.endr
+	.bss
+	.p2align	4
+.Lmem:
+	.zero	65536
+	.section	.note.GNU-stack,"",@progbits
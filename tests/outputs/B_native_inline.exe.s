@@ -0,0 +1,550 @@
+# generated by decaf (9 native registers, 10 spill slots)
+	.text
+	.globl	main
+	.type	main, @function
+main:
+	pushq	%rbx
+	pushq	%rbp
+	pushq	%r12
+	pushq	%r13
+	pushq	%r14
+	pushq	%r15
+	subq	$8, %rsp
+	leaq	.Lmem(%rip), %r15
+	movq	$65536, %r13
+	movq	$-9999999, %r14
+	movq	$-9999999, %rbx
+	movq	$-9999999, %rbp
+	movq	$-9999999, %r9
+	movq	$-9999999, %r10
+	movq	$-9999999, %r11
+	movq	$-9999999, %rsi
+	movq	$-9999999, %r12
+	movq	$-9999999, %rdi
+	movq	$-9999999, %r8
+	jmp	.Li60
+	# square:
+.Li1:
+	# push BP
+	subq	$8, %r13
+	movq	%r14, %rax
+	movq	%rax, (%r15,%r13)
+	# i2i SP => BP
+	movq	%r13, %rax
+	movq	%rax, %r14
+	# loadAI [BP+16] => r0
+	movq	%r14, %rax
+	addq	$16, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, %rbp
+	# mult r0, r0 => r1
+	movq	%rbp, %rax
+	imulq	%rbp, %rax
+	movq	%rax, %r9
+	# i2i r1 => RET
+	movq	%r9, %rax
+	movq	%rax, %rbx
+	# i2i BP => SP
+	movq	%r14, %rax
+	movq	%rax, %r13
+	# pop BP
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	movq	%rax, %r14
+	# return
+	cmpq	$65536, %r13
+	je	.Lexit
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	leaq	.Lreturn_table(%rip), %rcx
+	movslq	(%rcx,%rax,4), %rax
+	addq	%rcx, %rax
+	jmp	*%rax
+	# sum_squares:
+.Li10:
+	# push BP
+	subq	$8, %r13
+	movq	%r14, %rax
+	movq	%rax, (%r15,%r13)
+	# i2i SP => BP
+	movq	%r13, %rax
+	movq	%rax, %r14
+	# addI SP, -8 => SP
+	movq	%r13, %rax
+	addq	$-8, %rax
+	movq	%rax, %r13
+	# loadAI [BP+16] => r10
+	movq	%r14, %rax
+	addq	$16, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, %r10
+	# loadAI [BP+24] => r11
+	movq	%r14, %rax
+	addq	$24, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, %r11
+	# push r10
+	subq	$8, %r13
+	movq	%r10, %rax
+	movq	%rax, (%r15,%r13)
+	# call square
+	subq	$8, %r13
+	movq	$17, (%r15,%r13)
+	jmp	.Li1
+.Li17:
+	# addI SP, 8 => SP
+	movq	%r13, %rax
+	addq	$8, %rax
+	movq	%rax, %r13
+	# storeAI RET => [BP-8]
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movq	%rbx, %rcx
+	movslq	%eax, %rax
+	movq	%rcx, (%r15,%rax)
+	# push r11
+	subq	$8, %r13
+	movq	%r11, %rax
+	movq	%rax, (%r15,%r13)
+	# call square
+	subq	$8, %r13
+	movq	$21, (%r15,%r13)
+	jmp	.Li1
+.Li21:
+	# addI SP, 8 => SP
+	movq	%r13, %rax
+	addq	$8, %rax
+	movq	%rax, %r13
+	# loadAI [BP-8] => r12
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, .Lspill+0(%rip)
+	# add r12, RET => r13
+	movq	.Lspill+0(%rip), %rax
+	addq	%rbx, %rax
+	movq	%rax, %rsi
+	# loadI 100 => r14
+	movq	$100, %rax
+	movq	%rax, .Lspill+8(%rip)
+	# cmp_GT r13, r14 => r15
+	movq	%rsi, %rax
+	cmpq	.Lspill+8(%rip), %rax
+	setg	%al
+	movzbl	%al, %eax
+	movq	%rax, .Lspill+16(%rip)
+	# cbr r15 => l1, l2
+	movq	.Lspill+16(%rip), %rax
+	testq	%rax, %rax
+	jne	.Li28
+	jmp	.Li33
+	# l1:
+.Li28:
+	# loadI 100 => RET
+	movq	$100, %rax
+	movq	%rax, %rbx
+	# i2i BP => SP
+	movq	%r14, %rax
+	movq	%rax, %r13
+	# pop BP
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	movq	%rax, %r14
+	# return
+	cmpq	$65536, %r13
+	je	.Lexit
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	leaq	.Lreturn_table(%rip), %rcx
+	movslq	(%rcx,%rax,4), %rax
+	addq	%rcx, %rax
+	jmp	*%rax
+	# l2:
+.Li33:
+	# i2i r13 => RET
+	movq	%rsi, %rax
+	movq	%rax, %rbx
+	# i2i BP => SP
+	movq	%r14, %rax
+	movq	%rax, %r13
+	# pop BP
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	movq	%rax, %r14
+	# return
+	cmpq	$65536, %r13
+	je	.Lexit
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	leaq	.Lreturn_table(%rip), %rcx
+	movslq	(%rcx,%rax,4), %rax
+	addq	%rcx, %rax
+	jmp	*%rax
+	# fact:
+.Li38:
+	# push BP
+	subq	$8, %r13
+	movq	%r14, %rax
+	movq	%rax, (%r15,%r13)
+	# i2i SP => BP
+	movq	%r13, %rax
+	movq	%rax, %r14
+	# addI SP, -8 => SP
+	movq	%r13, %rax
+	addq	$-8, %rax
+	movq	%rax, %r13
+	# loadAI [BP+16] => r20
+	movq	%r14, %rax
+	addq	$16, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, %r12
+	# storeAI r20 => [BP-8]
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movq	%r12, %rcx
+	movslq	%eax, %rax
+	movq	%rcx, (%r15,%rax)
+	# loadI 1 => RET
+	movq	$1, %rax
+	movq	%rax, %rbx
+	# loadI 1 => r21
+	movq	$1, %rax
+	movq	%rax, .Lspill+24(%rip)
+	# cmp_LE r20, r21 => r22
+	movq	%r12, %rax
+	cmpq	.Lspill+24(%rip), %rax
+	setle	%al
+	movzbl	%al, %eax
+	movq	%rax, .Lspill+32(%rip)
+	# cbr r22 => l3, l4
+	movq	.Lspill+32(%rip), %rax
+	testq	%rax, %rax
+	jne	.Li56
+	jmp	.Li48
+	# l4:
+.Li48:
+	# addI r20, -1 => r23
+	movq	%r12, %rax
+	addq	$-1, %rax
+	movq	%rax, .Lspill+40(%rip)
+	# push r23
+	subq	$8, %r13
+	movq	.Lspill+40(%rip), %rax
+	movq	%rax, (%r15,%r13)
+	# call fact
+	subq	$8, %r13
+	movq	$51, (%r15,%r13)
+	jmp	.Li38
+.Li51:
+	# addI SP, 8 => SP
+	movq	%r13, %rax
+	addq	$8, %rax
+	movq	%rax, %r13
+	# loadAI [BP-8] => r25
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, .Lspill+56(%rip)
+	# mult r25, RET => r24
+	movq	.Lspill+56(%rip), %rax
+	imulq	%rbx, %rax
+	movq	%rax, .Lspill+48(%rip)
+	# i2i r24 => RET
+	movq	.Lspill+48(%rip), %rax
+	movq	%rax, %rbx
+	# l3:
+.Li56:
+	# i2i BP => SP
+	movq	%r14, %rax
+	movq	%rax, %r13
+	# pop BP
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	movq	%rax, %r14
+	# return
+	cmpq	$65536, %r13
+	je	.Lexit
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	leaq	.Lreturn_table(%rip), %rcx
+	movslq	(%rcx,%rax,4), %rax
+	addq	%rcx, %rax
+	jmp	*%rax
+	# main:
+.Li60:
+	# push BP
+	subq	$8, %r13
+	movq	%r14, %rax
+	movq	%rax, (%r15,%r13)
+	# i2i SP => BP
+	movq	%r13, %rax
+	movq	%rax, %r14
+	# addI SP, -8 => SP
+	movq	%r13, %rax
+	addq	$-8, %rax
+	movq	%rax, %r13
+	# loadI 3 => r30
+	movq	$3, %rax
+	movq	%rax, %rdi
+	# storeAI r30 => [BP-8]
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movq	%rdi, %rcx
+	movslq	%eax, %rax
+	movq	%rcx, (%r15,%rax)
+	# loadI 4 => r31
+	movq	$4, %rax
+	movq	%rax, .Lspill+64(%rip)
+	# push r31
+	subq	$8, %r13
+	movq	.Lspill+64(%rip), %rax
+	movq	%rax, (%r15,%r13)
+	# push r30
+	subq	$8, %r13
+	movq	%rdi, %rax
+	movq	%rax, (%r15,%r13)
+	# call sum_squares
+	subq	$8, %r13
+	movq	$69, (%r15,%r13)
+	jmp	.Li10
+.Li69:
+	# addI SP, 16 => SP
+	movq	%r13, %rax
+	addq	$16, %rax
+	movq	%rax, %r13
+	# print RET
+	movq	%rbx, %rax
+	call	.Lprint_int
+	# loadI 9 => r32
+	movq	$9, %rax
+	movq	%rax, %r8
+	# push r32
+	subq	$8, %r13
+	movq	%r8, %rax
+	movq	%rax, (%r15,%r13)
+	# push r32
+	subq	$8, %r13
+	movq	%r8, %rax
+	movq	%rax, (%r15,%r13)
+	# call sum_squares
+	subq	$8, %r13
+	movq	$75, (%r15,%r13)
+	jmp	.Li10
+.Li75:
+	# addI SP, 16 => SP
+	movq	%r13, %rax
+	addq	$16, %rax
+	movq	%rax, %r13
+	# print RET
+	movq	%rbx, %rax
+	call	.Lprint_int
+	# loadAI [BP-8] => r33
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, .Lspill+72(%rip)
+	# push r33
+	subq	$8, %r13
+	movq	.Lspill+72(%rip), %rax
+	movq	%rax, (%r15,%r13)
+	# call fact
+	subq	$8, %r13
+	movq	$80, (%r15,%r13)
+	jmp	.Li38
+.Li80:
+	# addI SP, 8 => SP
+	movq	%r13, %rax
+	addq	$8, %rax
+	movq	%rax, %r13
+	# print RET
+	movq	%rbx, %rax
+	call	.Lprint_int
+	# i2i BP => SP
+	movq	%r14, %rax
+	movq	%rax, %r13
+	# pop BP
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	movq	%rax, %r14
+	# return
+	cmpq	$65536, %r13
+	je	.Lexit
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	leaq	.Lreturn_table(%rip), %rcx
+	movslq	(%rcx,%rax,4), %rax
+	addq	%rcx, %rax
+	jmp	*%rax
+.Li85:
+	jmp	.Lexit
+.Lexit:
+	movq	%rbx, %rax
+	movl	%eax, %esi
+	leaq	.Lfmt_return(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r15
+	popq	%r14
+	popq	%r13
+	popq	%r12
+	popq	%rbp
+	popq	%rbx
+	xorl	%eax, %eax
+	ret
+	.size	main, .-main
+.Lbad_return:
+	ud2
+.Lprint_int:
+	pushq	%rsi
+	pushq	%rdi
+	pushq	%r8
+	pushq	%r9
+	pushq	%r10
+	pushq	%r11
+	subq	$8, %rsp
+	movq	%rax, %rsi
+	leaq	.Lfmt_int(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r11
+	popq	%r10
+	popq	%r9
+	popq	%r8
+	popq	%rdi
+	popq	%rsi
+	ret
+.Lprint_str:
+	pushq	%rsi
+	pushq	%rdi
+	pushq	%r8
+	pushq	%r9
+	pushq	%r10
+	pushq	%r11
+	subq	$8, %rsp
+	movq	%rax, %rsi
+	leaq	.Lfmt_str(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r11
+	popq	%r10
+	popq	%r9
+	popq	%r8
+	popq	%rdi
+	popq	%rsi
+	ret
+	.section	.rodata
+.Lfmt_int:
+	.string	"%ld"
+.Lfmt_str:
+	.string	"%s"
+.Lfmt_return:
+	.string	"RETURN VALUE = %d\n"
+	.p2align	2
+.Lreturn_table:
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Li17-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Li21-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Li51-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Li69-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Li75-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Li80-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.data
+	.p2align	3
+.Lspill:
+	.rept	10
+	.quad	-9999999
+	.endr
+	.bss
+	.p2align	4
+.Lmem:
+	.zero	65536
+	.section	.note.GNU-stack,"",@progbits
@@ -0,0 +1,284 @@
+# generated by decaf (9 native registers, 0 spill slots)
+	.text
+	.globl	main
+	.type	main, @function
+main:
+	pushq	%rbx
+	pushq	%rbp
+	pushq	%r12
+	pushq	%r13
+	pushq	%r14
+	pushq	%r15
+	subq	$8, %rsp
+	leaq	.Lmem(%rip), %r15
+	movq	$65536, %r13
+	movq	$-9999999, %r14
+	movq	$-9999999, %rsi
+	movq	$-9999999, %rdi
+	movq	$-9999999, %rbp
+	movq	$-9999999, %rbx
+	movq	$-9999999, %r8
+	movq	$-9999999, %r12
+	movq	$-9999999, %r9
+	movq	$-9999999, %r10
+	movq	$-9999999, %r11
+	jmp	.Li28
+	# sum:
+.Li1:
+	# push BP
+	subq	$8, %r13
+	movq	%r14, %rax
+	movq	%rax, (%r15,%r13)
+	# i2i SP => BP
+	movq	%r13, %rax
+	movq	%rax, %r14
+	# loadAI [BP+16] => r1
+	movq	%r14, %rax
+	addq	$16, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, %rdi
+	# loadI 0 => r2
+	movq	$0, %rax
+	movq	%rax, %rbp
+	# loadI 0 => r3
+	movq	$0, %rax
+	movq	%rax, %rbx
+	# l0:
+.Li7:
+	# cmp_LT r3, r1 => r4
+	movq	%rbx, %rax
+	cmpq	%rdi, %rax
+	setl	%al
+	movzbl	%al, %eax
+	movq	%rax, %r8
+	# cbr r4 => l1, l4
+	movq	%r8, %rax
+	testq	%rax, %rax
+	jne	.Li10
+	jmp	.Li22
+	# l1:
+.Li10:
+	# loadI 0 => r5
+	movq	$0, %rax
+	movq	%rax, %r12
+	# l2:
+.Li12:
+	# cmp_LT r5, r3 => r6
+	movq	%r12, %rax
+	cmpq	%rbx, %rax
+	setl	%al
+	movzbl	%al, %eax
+	movq	%rax, %r9
+	# cbr r6 => l3, l5
+	movq	%r9, %rax
+	testq	%rax, %rax
+	jne	.Li15
+	jmp	.Li19
+	# l3:
+.Li15:
+	# add r2, r5 => r2
+	movq	%rbp, %rax
+	addq	%r12, %rax
+	movq	%rax, %rbp
+	# addI r5, 1 => r5
+	movq	%r12, %rax
+	addq	$1, %rax
+	movq	%rax, %r12
+	# jump l2
+	jmp	.Li12
+	# l5:
+.Li19:
+	# addI r3, 1 => r3
+	movq	%rbx, %rax
+	addq	$1, %rax
+	movq	%rax, %rbx
+	# jump l0
+	jmp	.Li7
+	# l4:
+.Li22:
+	# i2i r2 => RET
+	movq	%rbp, %rax
+	movq	%rax, %rsi
+	# i2i BP => SP
+	movq	%r14, %rax
+	movq	%rax, %r13
+	# pop BP
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	movq	%rax, %r14
+	# return
+	cmpq	$65536, %r13
+	je	.Lexit
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	leaq	.Lreturn_table(%rip), %rcx
+	movslq	(%rcx,%rax,4), %rax
+	addq	%rcx, %rax
+	jmp	*%rax
+	# print "unreachable"
+	leaq	.Lstr26(%rip), %rax
+	call	.Lprint_str
+	# main:
+.Li28:
+	# push BP
+	subq	$8, %r13
+	movq	%r14, %rax
+	movq	%rax, (%r15,%r13)
+	# i2i SP => BP
+	movq	%r13, %rax
+	movq	%rax, %r14
+	# loadI 5 => r7
+	movq	$5, %rax
+	movq	%rax, %r10
+	# push r7
+	subq	$8, %r13
+	movq	%r10, %rax
+	movq	%rax, (%r15,%r13)
+	# call sum
+	subq	$8, %r13
+	movq	$33, (%r15,%r13)
+	jmp	.Li1
+.Li33:
+	# addI SP, 8 => SP
+	movq	%r13, %rax
+	addq	$8, %rax
+	movq	%rax, %r13
+	# i2i RET => r8
+	movq	%rsi, %rax
+	movq	%rax, %r11
+	# print r8
+	movq	%r11, %rax
+	call	.Lprint_int
+	# i2i BP => SP
+	movq	%r14, %rax
+	movq	%rax, %r13
+	# pop BP
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	movq	%rax, %r14
+	# return
+	cmpq	$65536, %r13
+	je	.Lexit
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	leaq	.Lreturn_table(%rip), %rcx
+	movslq	(%rcx,%rax,4), %rax
+	addq	%rcx, %rax
+	jmp	*%rax
+.Li39:
+	jmp	.Lexit
+.Lexit:
+	movq	%rsi, %rax
+	movl	%eax, %esi
+	leaq	.Lfmt_return(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r15
+	popq	%r14
+	popq	%r13
+	popq	%r12
+	popq	%rbp
+	popq	%rbx
+	xorl	%eax, %eax
+	ret
+	.size	main, .-main
+.Lbad_return:
+	ud2
+.Lprint_int:
+	pushq	%rsi
+	pushq	%rdi
+	pushq	%r8
+	pushq	%r9
+	pushq	%r10
+	pushq	%r11
+	subq	$8, %rsp
+	movq	%rax, %rsi
+	leaq	.Lfmt_int(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r11
+	popq	%r10
+	popq	%r9
+	popq	%r8
+	popq	%rdi
+	popq	%rsi
+	ret
+.Lprint_str:
+	pushq	%rsi
+	pushq	%rdi
+	pushq	%r8
+	pushq	%r9
+	pushq	%r10
+	pushq	%r11
+	subq	$8, %rsp
+	movq	%rax, %rsi
+	leaq	.Lfmt_str(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r11
+	popq	%r10
+	popq	%r9
+	popq	%r8
+	popq	%rdi
+	popq	%rsi
+	ret
+	.section	.rodata
+.Lfmt_int:
+	.string	"%ld"
+.Lfmt_str:
+	.string	"%s"
+.Lfmt_return:
+	.string	"RETURN VALUE = %d\n"
+.Lstr26:
+	.byte	117,110,114,101,97,99,104,97,98,108,101,0
+	.p2align	2
+.Lreturn_table:
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Li33-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.bss
+	.p2align	4
+.Lmem:
+	.zero	65536
+	.section	.note.GNU-stack,"",@progbits
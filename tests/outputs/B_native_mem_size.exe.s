@@ -0,0 +1,307 @@
+# generated by decaf (9 native registers, 15 spill slots)
+	.text
+	.globl	main
+	.type	main, @function
+main:
+	pushq	%rbx
+	pushq	%rbp
+	pushq	%r12
+	pushq	%r13
+	pushq	%r14
+	pushq	%r15
+	subq	$8, %rsp
+	leaq	.Lmem(%rip), %r15
+	movq	$4096, %r13
+	movq	$-9999999, %r14
+	movq	$-9999999, %rbx
+	movq	$-9999999, %r12
+	movq	$-9999999, %rbp
+	movq	$-9999999, %rsi
+	movq	$-9999999, %rdi
+	movq	$-9999999, %r8
+	movq	$-9999999, %r9
+	movq	$-9999999, %r10
+	movq	$-9999999, %r11
+	jmp	.Li1
+	# main:
+.Li1:
+	# push BP
+	subq	$8, %r13
+	movq	%r14, %rax
+	movq	%rax, (%r15,%r13)
+	# i2i SP => BP
+	movq	%r13, %rax
+	movq	%rax, %r14
+	# addI SP, -16 => SP
+	movq	%r13, %rax
+	addq	$-16, %rax
+	movq	%rax, %r13
+	# loadI 3 => r1
+	movq	$3, %rax
+	movq	%rax, %r12
+	# loadAI [BP-8] => r0
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, .Lspill+0(%rip)
+	# storeAI r1 => [BP-8]
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movq	%r12, %rcx
+	movslq	%eax, %rax
+	movq	%rcx, (%r15,%rax)
+	# loadAI [BP-8] => r4
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, %rsi
+	# loadAI [BP-8] => r5
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, %rdi
+	# mult r4, r5 => r6
+	movq	%rsi, %rax
+	imulq	%rdi, %rax
+	movq	%rax, %r8
+	# loadAI [BP-8] => r7
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, %r9
+	# loadAI [BP-8] => r8
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, %r10
+	# mult r7, r8 => r9
+	movq	%r9, %rax
+	imulq	%r10, %rax
+	movq	%rax, %r11
+	# add r6, r9 => r10
+	movq	%r8, %rax
+	addq	%r11, %rax
+	movq	%rax, .Lspill+16(%rip)
+	# loadI 256 => r2
+	movq	$256, %rax
+	movq	%rax, %rbp
+	# loadAI [r2+0] => r3
+	movq	%rbp, %rax
+	addq	$0, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, .Lspill+8(%rip)
+	# loadI 256 => r11
+	movq	$256, %rax
+	movq	%rax, .Lspill+24(%rip)
+	# storeAI r10 => [r11+0]
+	movq	.Lspill+24(%rip), %rax
+	addq	$0, %rax
+	movq	.Lspill+16(%rip), %rcx
+	movslq	%eax, %rax
+	movq	%rcx, (%r15,%rax)
+	# loadI 256 => r13
+	movq	$256, %rax
+	movq	%rax, .Lspill+40(%rip)
+	# loadAI [r13+0] => r14
+	movq	.Lspill+40(%rip), %rax
+	addq	$0, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, .Lspill+48(%rip)
+	# loadI 256 => r15
+	movq	$256, %rax
+	movq	%rax, .Lspill+56(%rip)
+	# loadAI [r15+0] => r16
+	movq	.Lspill+56(%rip), %rax
+	addq	$0, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, .Lspill+64(%rip)
+	# add r14, r16 => r17
+	movq	.Lspill+48(%rip), %rax
+	addq	.Lspill+64(%rip), %rax
+	movq	%rax, .Lspill+72(%rip)
+	# loadAI [BP-16] => r12
+	movq	%r14, %rax
+	addq	$-16, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, .Lspill+32(%rip)
+	# storeAI r17 => [BP-16]
+	movq	%r14, %rax
+	addq	$-16, %rax
+	movq	.Lspill+72(%rip), %rcx
+	movslq	%eax, %rax
+	movq	%rcx, (%r15,%rax)
+	# loadAI [BP-16] => r18
+	movq	%r14, %rax
+	addq	$-16, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, .Lspill+80(%rip)
+	# loadAI [BP-8] => r19
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, .Lspill+88(%rip)
+	# loadAI [BP-8] => r20
+	movq	%r14, %rax
+	addq	$-8, %rax
+	movslq	%eax, %rax
+	movq	(%r15,%rax), %rax
+	movq	%rax, .Lspill+96(%rip)
+	# mult r19, r20 => r21
+	movq	.Lspill+88(%rip), %rax
+	imulq	.Lspill+96(%rip), %rax
+	movq	%rax, .Lspill+104(%rip)
+	# add r18, r21 => r22
+	movq	.Lspill+80(%rip), %rax
+	addq	.Lspill+104(%rip), %rax
+	movq	%rax, .Lspill+112(%rip)
+	# i2i r22 => RET
+	movq	.Lspill+112(%rip), %rax
+	movq	%rax, %rbx
+	# jump l0
+	jmp	.Li33
+	# l0:
+.Li33:
+	# i2i BP => SP
+	movq	%r14, %rax
+	movq	%rax, %r13
+	# pop BP
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	movq	%rax, %r14
+	# return
+	cmpq	$4096, %r13
+	je	.Lexit
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	leaq	.Lreturn_table(%rip), %rcx
+	movslq	(%rcx,%rax,4), %rax
+	addq	%rcx, %rax
+	jmp	*%rax
+.Li36:
+	jmp	.Lexit
+.Lexit:
+	movq	%rbx, %rax
+	movl	%eax, %esi
+	leaq	.Lfmt_return(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r15
+	popq	%r14
+	popq	%r13
+	popq	%r12
+	popq	%rbp
+	popq	%rbx
+	xorl	%eax, %eax
+	ret
+	.size	main, .-main
+.Lbad_return:
+	ud2
+.Lprint_int:
+	pushq	%rsi
+	pushq	%rdi
+	pushq	%r8
+	pushq	%r9
+	pushq	%r10
+	pushq	%r11
+	subq	$8, %rsp
+	movq	%rax, %rsi
+	leaq	.Lfmt_int(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r11
+	popq	%r10
+	popq	%r9
+	popq	%r8
+	popq	%rdi
+	popq	%rsi
+	ret
+.Lprint_str:
+	pushq	%rsi
+	pushq	%rdi
+	pushq	%r8
+	pushq	%r9
+	pushq	%r10
+	pushq	%r11
+	subq	$8, %rsp
+	movq	%rax, %rsi
+	leaq	.Lfmt_str(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r11
+	popq	%r10
+	popq	%r9
+	popq	%r8
+	popq	%rdi
+	popq	%rsi
+	ret
+	.section	.rodata
+.Lfmt_int:
+	.string	"%ld"
+.Lfmt_str:
+	.string	"%s"
+.Lfmt_return:
+	.string	"RETURN VALUE = %d\n"
+	.p2align	2
+.Lreturn_table:
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.data
+	.p2align	3
+.Lspill:
+	.rept	15
+	.quad	-9999999
+	.endr
+	.bss
+	.p2align	4
+.Lmem:
+	.zero	4096
+	.section	.note.GNU-stack,"",@progbits
@@ -0,0 +1,167 @@
+# generated by decaf (9 native registers, 0 spill slots)
+	.text
+	.globl	main
+	.type	main, @function
+main:
+	pushq	%rbx
+	pushq	%rbp
+	pushq	%r12
+	pushq	%r13
+	pushq	%r14
+	pushq	%r15
+	subq	$8, %rsp
+	leaq	.Lmem(%rip), %r15
+	movq	$65536, %r13
+	movq	$-9999999, %r14
+	movq	$-9999999, %rbx
+	movq	$-9999999, %r12
+	jmp	.Li1
+	# main:
+.Li1:
+	# push BP
+	subq	$8, %r13
+	movq	%r14, %rax
+	movq	%rax, (%r15,%r13)
+	# i2i SP => BP
+	movq	%r13, %rax
+	movq	%rax, %r14
+	# print 5
+	movq	$5, %rax
+	call	.Lprint_int
+	# print " "
+	leaq	.Lstr4(%rip), %rax
+	call	.Lprint_str
+	# print -42
+	movq	$-42, %rax
+	call	.Lprint_int
+	# print " "
+	leaq	.Lstr6(%rip), %rax
+	call	.Lprint_str
+	# loadI 7 => r1
+	movq	$7, %rax
+	movq	%rax, %r12
+	# print r1
+	movq	%r12, %rax
+	call	.Lprint_int
+	# print " "
+	leaq	.Lstr9(%rip), %rax
+	call	.Lprint_str
+	# print 1234567890123
+	movabsq	$1234567890123, %rcx
+	movq	%rcx, %rax
+	call	.Lprint_int
+	# loadI 0 => RET
+	movq	$0, %rax
+	movq	%rax, %rbx
+	# i2i BP => SP
+	movq	%r14, %rax
+	movq	%rax, %r13
+	# pop BP
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	movq	%rax, %r14
+	# return
+	cmpq	$65536, %r13
+	je	.Lexit
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	leaq	.Lreturn_table(%rip), %rcx
+	movslq	(%rcx,%rax,4), %rax
+	addq	%rcx, %rax
+	jmp	*%rax
+.Li15:
+	jmp	.Lexit
+.Lexit:
+	movq	%rbx, %rax
+	movl	%eax, %esi
+	leaq	.Lfmt_return(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r15
+	popq	%r14
+	popq	%r13
+	popq	%r12
+	popq	%rbp
+	popq	%rbx
+	xorl	%eax, %eax
+	ret
+	.size	main, .-main
+.Lbad_return:
+	ud2
+.Lprint_int:
+	pushq	%rsi
+	pushq	%rdi
+	pushq	%r8
+	pushq	%r9
+	pushq	%r10
+	pushq	%r11
+	subq	$8, %rsp
+	movq	%rax, %rsi
+	leaq	.Lfmt_int(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r11
+	popq	%r10
+	popq	%r9
+	popq	%r8
+	popq	%rdi
+	popq	%rsi
+	ret
+.Lprint_str:
+	pushq	%rsi
+	pushq	%rdi
+	pushq	%r8
+	pushq	%r9
+	pushq	%r10
+	pushq	%r11
+	subq	$8, %rsp
+	movq	%rax, %rsi
+	leaq	.Lfmt_str(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r11
+	popq	%r10
+	popq	%r9
+	popq	%r8
+	popq	%rdi
+	popq	%rsi
+	ret
+	.section	.rodata
+.Lfmt_int:
+	.string	"%ld"
+.Lfmt_str:
+	.string	"%s"
+.Lfmt_return:
+	.string	"RETURN VALUE = %d\n"
+.Lstr4:
+	.byte	32,0
+.Lstr6:
+	.byte	32,0
+.Lstr9:
+	.byte	32,0
+	.p2align	2
+.Lreturn_table:
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.bss
+	.p2align	4
+.Lmem:
+	.zero	65536
+	.section	.note.GNU-stack,"",@progbits
@@ -0,0 +1,228 @@
+# generated by decaf (9 native registers, 2 spill slots)
+	.text
+	.globl	main
+	.type	main, @function
+main:
+	pushq	%rbx
+	pushq	%rbp
+	pushq	%r12
+	pushq	%r13
+	pushq	%r14
+	pushq	%r15
+	subq	$8, %rsp
+	leaq	.Lmem(%rip), %r15
+	movq	$65536, %r13
+	movq	$-9999999, %r14
+	movq	$-9999999, %rdi
+	movq	$-9999999, %r8
+	movq	$-9999999, %r12
+	movq	$-9999999, %r9
+	movq	$-9999999, %r10
+	movq	$-9999999, %rbp
+	movq	$-9999999, %r11
+	movq	$-9999999, %rbx
+	movq	$-9999999, %rsi
+	jmp	.Li1
+	# main:
+.Li1:
+	# push BP
+	subq	$8, %r13
+	movq	%r14, %rax
+	movq	%rax, (%r15,%r13)
+	# i2i SP => BP
+	movq	%r13, %rax
+	movq	%rax, %r14
+	# loadI 0 => r0
+	movq	$0, %rax
+	movq	%rax, %r8
+	# loadI 1 => r1
+	movq	$1, %rax
+	movq	%rax, %r12
+	# cmp_LT r0, r1 => r2
+	movq	%r8, %rax
+	cmpq	%r12, %rax
+	setl	%al
+	movzbl	%al, %eax
+	movq	%rax, %r9
+	# cbr r2 => l0, l1
+	movq	%r9, %rax
+	testq	%rax, %rax
+	jne	.Li8
+	jmp	.Li12
+	# l0:
+.Li8:
+	# loadI 10 => r3
+	movq	$10, %rax
+	movq	%rax, %r10
+	# loadI 20 => r4
+	movq	$20, %rax
+	movq	%rax, %rbp
+	# jump l2
+	jmp	.Li14
+	# l1:
+.Li12:
+	# loadI 30 => r4
+	movq	$30, %rax
+	movq	%rax, %rbp
+	# l2:
+.Li14:
+	# add r3, r4 => r5
+	movq	%r10, %rax
+	addq	%rbp, %rax
+	movq	%rax, %r11
+	# loadI 0 => r6
+	movq	$0, %rax
+	movq	%rax, %rbx
+	# l3:
+.Li17:
+	# addI r6, 1 => r6
+	movq	%rbx, %rax
+	addq	$1, %rax
+	movq	%rax, %rbx
+	# cmp_LT r6, r1 => r7
+	movq	%rbx, %rax
+	cmpq	%r12, %rax
+	setl	%al
+	movzbl	%al, %eax
+	movq	%rax, .Lspill+0(%rip)
+	# cbr r7 => l3, l4
+	movq	.Lspill+0(%rip), %rax
+	testq	%rax, %rax
+	jne	.Li17
+	jmp	.Li21
+	# l4:
+.Li21:
+	# add r5, r8 => r9
+	movq	%r11, %rax
+	addq	.Lspill+8(%rip), %rax
+	movq	%rax, %rsi
+	# print r9
+	movq	%rsi, %rax
+	call	.Lprint_int
+	# i2i r9 => RET
+	movq	%rsi, %rax
+	movq	%rax, %rdi
+	# i2i BP => SP
+	movq	%r14, %rax
+	movq	%rax, %r13
+	# pop BP
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	movq	%rax, %r14
+	# return
+	cmpq	$65536, %r13
+	je	.Lexit
+	movq	(%r15,%r13), %rax
+	addq	$8, %r13
+	leaq	.Lreturn_table(%rip), %rcx
+	movslq	(%rcx,%rax,4), %rax
+	addq	%rcx, %rax
+	jmp	*%rax
+.Li27:
+	jmp	.Lexit
+.Lexit:
+	movq	%rdi, %rax
+	movl	%eax, %esi
+	leaq	.Lfmt_return(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r15
+	popq	%r14
+	popq	%r13
+	popq	%r12
+	popq	%rbp
+	popq	%rbx
+	xorl	%eax, %eax
+	ret
+	.size	main, .-main
+.Lbad_return:
+	ud2
+.Lprint_int:
+	pushq	%rsi
+	pushq	%rdi
+	pushq	%r8
+	pushq	%r9
+	pushq	%r10
+	pushq	%r11
+	subq	$8, %rsp
+	movq	%rax, %rsi
+	leaq	.Lfmt_int(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r11
+	popq	%r10
+	popq	%r9
+	popq	%r8
+	popq	%rdi
+	popq	%rsi
+	ret
+.Lprint_str:
+	pushq	%rsi
+	pushq	%rdi
+	pushq	%r8
+	pushq	%r9
+	pushq	%r10
+	pushq	%r11
+	subq	$8, %rsp
+	movq	%rax, %rsi
+	leaq	.Lfmt_str(%rip), %rdi
+	xorl	%eax, %eax
+	call	printf@PLT
+	addq	$8, %rsp
+	popq	%r11
+	popq	%r10
+	popq	%r9
+	popq	%r8
+	popq	%rdi
+	popq	%rsi
+	ret
+	.section	.rodata
+.Lfmt_int:
+	.string	"%ld"
+.Lfmt_str:
+	.string	"%s"
+.Lfmt_return:
+	.string	"RETURN VALUE = %d\n"
+	.p2align	2
+.Lreturn_table:
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.long	.Lbad_return-.Lreturn_table
+	.data
+	.p2align	3
+.Lspill:
+	.rept	2
+	.quad	-9999999
+	.endr
+	.bss
+	.p2align	4
+.Lmem:
+	.zero	65536
+	.section	.note.GNU-stack,"",@progbits
@@ -6,6 +6,7 @@
  */
 
 #include "testsuite.h"
+#include "insnvector.h"
 
 #ifndef SKIP_IN_DOXYGEN
 
@@ -41,6 +42,110 @@ TEST_PROGRAM(A_funccall_params, 5,
         "def int add(int a, int b) { return a + b; } "
         "def int main() { return add(2,3); }")
 
+/**
+ * @brief Build an instruction whose operands follow the role table of its form
+ */
+ILOCInsn* insn_from_roles (InsnForm form)
+{
+    Operand op[3];
+    for (int i = 0; i < 3; i++) {
+        switch (InsnForm_operand_role(form, i)) {
+            case OPERAND_USE:
+            case OPERAND_DEF:       op[i] = register_with_id(i + 1);    break;
+            case OPERAND_CONST:     op[i] = int_const(8);               break;
+            case OPERAND_TARGET:    op[i] = (form == CALL ? call_label("main") : anonymous_label()); break;
+            case OPERAND_LABEL:     op[i] = anonymous_label();          break;
+            default:                op[i] = empty_operand();            break;
+        }
+    }
+    return ILOCInsn_new_3op(form, op[0], op[1], op[2]);
+}
+
+/* the role table must agree with the instruction validator for every form */
+START_TEST (B_operand_roles)
+{
+    for (InsnForm form = ADD; form <= PHI; form++) {
+        InsnList* list = InsnList_new();
+        ILOCInsn* insn = insn_from_roles(form);
+        InsnList_add(list, insn);
+        InsnList_verify(list);      /* exits if the shape is invalid */
+
+        Operand* uses[MAX_INSN_USES];
+        int num_uses = ILOCInsn_get_uses(insn, uses);
+        int expected_uses = 0;
+        for (int i = 0; i < 3; i++) {
+            if (InsnForm_operand_role(form, i) == OPERAND_USE) {
+                ck_assert_ptr_eq(uses[expected_uses++], &insn->op[i]);
+            }
+        }
+        ck_assert_int_eq(num_uses, expected_uses);
+
+        Operand* def = ILOCInsn_get_def(insn);
+        if (def != NULL) {
+            ck_assert_int_eq(InsnForm_operand_role(form, (int)(def - insn->op)), OPERAND_DEF);
+        }
+        InsnList_free(list);
+    }
+
+    /* spot checks */
+    ck_assert_int_eq(InsnForm_operand_role(STORE_AI, 1), OPERAND_USE);
+    ck_assert_int_eq(InsnForm_operand_role(STORE_AO, 2), OPERAND_USE);
+    ck_assert_int_eq(InsnForm_operand_role(POP, 0), OPERAND_DEF);
+    ck_assert_int_eq(InsnForm_operand_role(CBR, 1), OPERAND_TARGET);
+    ck_assert_int_eq(InsnForm_operand_role(LOAD_I, 1), OPERAND_DEF);
+    ck_assert_int_eq(InsnForm_operand_role(RETURN, 0), OPERAND_UNUSED);
+}
+END_TEST
+
+START_TEST (B_insn_vector)
+{
+    InsnList* list = InsnList_new();
+    for (int i = 0; i < 5; i++) {
+        InsnList_add(list, ILOCInsn_new_2op(LOAD_I, int_const(i), register_with_id(i)));
+    }
+    InsnVector* vector = InsnVector_from_list(list);
+    ck_assert_int_eq(InsnVector_size(vector), 5);
+    ck_assert_int_eq(InsnList_size(list), 0);
+    InsnList_free(list);
+
+    /* deleting keeps the other indices stable */
+    InsnVector_delete(vector, 1);
+    InsnVector_delete(vector, 3);
+    InsnVector_delete(vector, 3);
+    ck_assert_int_eq(InsnVector_size(vector), 5);
+    ck_assert_int_eq(InsnVector_count(vector), 3);
+    ck_assert_ptr_eq(InsnVector_get(vector, 1), NULL);
+    ck_assert_int_eq(InsnVector_get(vector, 2)->op[0].imm, 2);
+    ck_assert_int_eq(InsnVector_get(vector, 4)->op[0].imm, 4);
+
+    /* adding appends; inserting shifts later instructions */
+    ck_assert_int_eq(InsnVector_add(vector, ILOCInsn_new_2op(LOAD_I, int_const(5), register_with_id(5))), 5);
+    InsnVector_insert(vector, 0, ILOCInsn_new_2op(LOAD_I, int_const(-1), register_with_id(6)));
+    ck_assert_int_eq(InsnVector_get(vector, 3)->op[0].imm, 2);
+
+    /* compacting reports where every instruction moved */
+    int new_index[7];
+    InsnVector_compact(vector, new_index);
+    int expected_index[7] = { 0, 1, -1, 2, -1, 3, 4 };
+    for (int i = 0; i < 7; i++) {
+        ck_assert_int_eq(new_index[i], expected_index[i]);
+    }
+    ck_assert_int_eq(InsnVector_size(vector), 5);
+
+    /* converting back keeps the order */
+    long expected_imm[5] = { -1, 0, 2, 4, 5 };
+    list = InsnVector_to_list(vector);
+    int i = 0;
+    FOR_EACH(ILOCInsn*, insn, list) {
+        ck_assert_int_eq(insn->op[0].imm, expected_imm[i++]);
+    }
+    ck_assert_int_eq(i, 5);
+    ck_assert_int_eq(InsnVector_size(vector), 0);
+    InsnList_free(list);
+    InsnVector_free(vector);
+}
+END_TEST
+
 #endif
 
 /**
@@ -66,6 +171,9 @@ void public_tests (Suite *s)
     TEST(B_whileloop);
     TEST(B_funccall);
 
+    TEST(B_operand_roles);
+    TEST(B_insn_vector);
+
     TEST(A_funccall_params);
 
     suite_add_tcase (s, tc);